@@ -1,5 +1,6 @@
 #include "DataFlashFileReader.h"
 #include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Logger/AP_Logger_Compress.h>
 
 #include <fcntl.h>
 #include <string.h>
@@ -8,6 +9,10 @@
 #include <unistd.h>
 #include <time.h>
 #include <cinttypes>
+#if AP_REPLAY_MMAP_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #ifndef PRIu64
 #define PRIu64 "llu"
@@ -19,20 +24,152 @@ AP_LoggerFileReader::AP_LoggerFileReader()
 AP_LoggerFileReader::~AP_LoggerFileReader()
 {
     ::printf("Replay counts: %" PRIu64 " bytes  %u entries\n", bytes_read, message_count);
+    free(compressed.data);
+    free(compressed.frame);
+    free(index.entries);
+#if AP_REPLAY_MMAP_ENABLED
+    if (mapped != nullptr) {
+        munmap((void *)mapped, file_size);
+    }
+#endif
 }
 
 bool AP_LoggerFileReader::open_log(const char *logfile)
 {
+#if AP_REPLAY_MMAP_ENABLED
+    if (open_mapped(logfile)) {
+        return open_compressed();
+    }
+#endif
     fd = AP::FS().open(logfile, O_RDONLY);
     if (fd == -1) {
         return false;
     }
+    struct stat st;
+    if (AP::FS().stat(logfile, &st) == 0) {
+        file_size = st.st_size;
+    }
+    return open_compressed();
+}
+
+#if AP_REPLAY_MMAP_ENABLED
+/*
+  map the log into memory. Returns false if it can't be mapped, in
+  which case it is read through AP_Filesystem
+ */
+bool AP_LoggerFileReader::open_mapped(const char *logfile)
+{
+    const int map_fd = ::open(logfile, O_RDONLY | O_CLOEXEC);
+    if (map_fd == -1) {
+        return false;
+    }
+    struct stat st;
+    if (fstat(map_fd, &st) != 0 || st.st_size == 0) {
+        ::close(map_fd);
+        return false;
+    }
+    void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, map_fd, 0);
+    // the mapping stays valid after the file is closed
+    ::close(map_fd);
+    if (p == MAP_FAILED) {
+        return false;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    mapped = (const uint8_t *)p;
+    file_size = st.st_size;
+    return true;
+}
+#endif
+
+ssize_t AP_LoggerFileReader::read_file(void *buf, size_t count)
+{
+#if AP_REPLAY_MMAP_ENABLED
+    if (mapped != nullptr) {
+        const size_t n = MIN(uint64_t(count), file_size - file_offset);
+        memcpy(buf, &mapped[file_offset], n);
+        file_offset += n;
+        return n;
+    }
+#endif
+    const int32_t ret = AP::FS().read(fd, buf, count);
+    if (ret > 0) {
+        file_offset += ret;
+    }
+    return ret;
+}
+
+/*
+  check for a compressed log header. Compressed logs are decompressed
+  frame by frame in read_input(), other logs are read from the start
+ */
+bool AP_LoggerFileReader::open_compressed()
+{
+    AP_Logger_Compress::FileHeader hdr;
+    if (read_file(&hdr, sizeof(hdr)) != sizeof(hdr) ||
+        !AP_Logger_Compress::valid_file_header(hdr)) {
+        return seek(0);
+    }
+    compressed.frame_size = hdr.frame_size;
+    compressed.data = (uint8_t *)malloc(AP_Logger_Compress::max_compressed_size(hdr.frame_size));
+    compressed.frame = (uint8_t *)malloc(2 * hdr.frame_size);
+    if (compressed.data == nullptr || compressed.frame == nullptr) {
+        return false;
+    }
+    ::printf("Reading compressed log, frame size %u\n", unsigned(hdr.frame_size));
+    compressed.active = true;
+    return true;
+}
+
+// read and decompress the next frame of a compressed log
+bool AP_LoggerFileReader::read_compressed_frame()
+{
+    AP_Logger_Compress::FrameHeader hdr;
+    if (read_file(&hdr, sizeof(hdr)) != sizeof(hdr)) {
+        return false;
+    }
+    if (!AP_Logger_Compress::valid_frame_header(hdr, compressed.frame_size)) {
+        ::printf("bad compressed frame header\n");
+        return false;
+    }
+    if (read_file(compressed.data, hdr.data_len) != hdr.data_len) {
+        // log truncated mid-frame
+        return false;
+    }
+    // the previous frame is kept immediately before the new one as
+    // matches may refer back into it
+    uint8_t *frame = &compressed.frame[compressed.frame_size];
+    memmove(frame - compressed.len, frame, compressed.len);
+    if (!AP_Logger_Compress::decode_frame(hdr, compressed.data, frame, compressed.len)) {
+        ::printf("corrupt compressed frame\n");
+        return false;
+    }
+    compressed.len = hdr.raw_len;
+    compressed.ofs = 0;
     return true;
 }
 
 ssize_t AP_LoggerFileReader::read_input(void *buffer, const size_t count)
 {
-    uint64_t ret = AP::FS().read(fd, buffer, count);
+    if (!compressed.active) {
+        const ssize_t ret = read_file(buffer, count);
+        if (ret > 0) {
+            bytes_read += ret;
+        }
+        return ret;
+    }
+
+    // messages may span frames
+    uint8_t *b = (uint8_t *)buffer;
+    size_t ret = 0;
+    while (ret < count) {
+        if (compressed.ofs == compressed.len && !read_compressed_frame()) {
+            break;
+        }
+        const size_t n = MIN(count - ret, size_t(compressed.len - compressed.ofs));
+        memcpy(&b[ret], &compressed.frame[compressed.frame_size + compressed.ofs], n);
+        compressed.ofs += n;
+        ret += n;
+    }
     bytes_read += ret;
     return ret;
 }
@@ -53,6 +190,11 @@ void AP_LoggerFileReader::get_packet_counts(uint64_t dest[])
 
 bool AP_LoggerFileReader::update()
 {
+    if (index.loaded && file_offset >= index.end && !index_next()) {
+        // nothing more of interest in the log
+        return false;
+    }
+
     uint8_t hdr[3];
     if (read_input(hdr, 3) != 3) {
         return false;
@@ -78,6 +220,14 @@ bool AP_LoggerFileReader::update()
         }
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
 
+        if (index.requested && !index.loaded && strncmp(f.name, "LIDX", 4) == 0) {
+            // formats are logged before any messages, so the index
+            // can be used from here on
+            if (!load_index(f)) {
+                index.requested = false;
+            }
+        }
+
         message_count++;
         return handle_log_format_msg(f);
     }
@@ -100,3 +250,213 @@ bool AP_LoggerFileReader::update()
     message_count++;
     return handle_msg(f, msg);
 }
+
+void AP_LoggerFileReader::set_index_filter(uint64_t start_us, uint64_t end_us,
+                                           const uint64_t types[4], const uint64_t always_types[4])
+{
+    index.requested = true;
+    index.start_us = start_us;
+    index.end_us = end_us;
+    memcpy(index.types, types, sizeof(index.types));
+    memcpy(index.always_types, always_types, sizeof(index.always_types));
+    // format messages are needed to parse everything else
+    index.always_types[LOG_FORMAT_MSG/64] |= 1ULL << (LOG_FORMAT_MSG%64);
+}
+
+/*
+  seek to an offset in the log file. AP_Filesystem offsets are 32
+  bit, so large logs are seeked in steps
+ */
+bool AP_LoggerFileReader::seek(uint64_t offset)
+{
+#if AP_REPLAY_MMAP_ENABLED
+    if (mapped != nullptr) {
+        if (offset > file_size) {
+            return false;
+        }
+        file_offset = offset;
+        return true;
+    }
+#endif
+    if (AP::FS().lseek(fd, 0, SEEK_SET) != 0) {
+        return false;
+    }
+    for (uint64_t pos = 0; pos < offset; ) {
+        const int32_t step = MIN(offset - pos, uint64_t(INT32_MAX));
+        if (AP::FS().lseek(fd, step, SEEK_CUR) == -1) {
+            return false;
+        }
+        pos += step;
+    }
+    file_offset = offset;
+    return true;
+}
+
+// read and check the LIDX message at offset
+bool AP_LoggerFileReader::read_index_entry(const struct log_Format &f, uint64_t offset, IndexEntry &entry, uint64_t &prev)
+{
+    struct log_Index pkt;
+    if (!seek(offset) || read_file(&pkt, sizeof(pkt)) != sizeof(pkt)) {
+        return false;
+    }
+    const uint8_t *hdr = (const uint8_t *)&pkt;
+    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2 || hdr[2] != f.type) {
+        return false;
+    }
+    if (pkt.prev >= offset) {
+        // the chain must lead back towards the start of the log
+        return false;
+    }
+    entry.offset = offset;
+    entry.time_us = pkt.time_us;
+    memcpy(entry.types, pkt.types, sizeof(entry.types));
+    prev = pkt.prev;
+    return true;
+}
+
+/*
+  find the last LIDX message by searching back from the end of the
+  log. A log which was not closed cleanly will have other messages,
+  possibly a partial one, after the last LIDX
+ */
+bool AP_LoggerFileReader::find_last_index(const struct log_Format &f, uint64_t &offset)
+{
+    // LIDX messages are written once a second, so there is no point
+    // searching a long way back
+    const uint64_t search_limit = 16*1024*1024;
+    uint8_t buf[4096];
+    uint64_t end = file_size;
+    while (end >= f.length && file_size - end < search_limit) {
+        const uint32_t n = MIN(end, uint64_t(sizeof(buf)));
+        const uint64_t start = end - n;
+        if (!seek(start) || read_file(buf, n) != ssize_t(n)) {
+            return false;
+        }
+        for (int32_t i = n - 3; i >= 0; i--) {
+            if (buf[i] != HEAD_BYTE1 || buf[i+1] != HEAD_BYTE2 || buf[i+2] != f.type ||
+                start + i + f.length > file_size) {
+                continue;
+            }
+            // check the candidate links to another LIDX, as the
+            // header bytes can also appear in message data
+            IndexEntry entry, prev_entry;
+            uint64_t prev, prev_prev;
+            if (read_index_entry(f, start + i, entry, prev) &&
+                (prev == 0 || read_index_entry(f, prev, prev_entry, prev_prev))) {
+                offset = start + i;
+                return true;
+            }
+        }
+        if (start == 0) {
+            break;
+        }
+        // overlap so headers split across reads are found
+        end = start + 2;
+    }
+    return false;
+}
+
+/*
+  load the chain of LIDX messages. Called when the LIDX format message
+  is read, which is before any LIDX messages
+ */
+bool AP_LoggerFileReader::load_index(const struct log_Format &f)
+{
+    if (compressed.active) {
+        ::printf("Log index not used for compressed logs\n");
+        return false;
+    }
+    if (f.length != sizeof(struct log_Index)) {
+        ::printf("Unexpected LIDX length %u\n", unsigned(f.length));
+        return false;
+    }
+
+    const uint64_t resume_offset = file_offset;
+    uint64_t offset;
+    bool ok = find_last_index(f, offset);
+    uint32_t space = 0;
+    while (ok) {
+        if (index.count == space) {
+            space = MAX(2*space, 64U);
+            IndexEntry *entries = (IndexEntry *)realloc(index.entries, space*sizeof(IndexEntry));
+            if (entries == nullptr) {
+                ok = false;
+                break;
+            }
+            index.entries = entries;
+        }
+        uint64_t prev;
+        if (!read_index_entry(f, offset, index.entries[index.count], prev)) {
+            ok = false;
+            break;
+        }
+        index.count++;
+        if (prev == 0) {
+            // the first LIDX covers the log from the start
+            break;
+        }
+        offset = prev;
+    }
+    if (!seek(resume_offset)) {
+        ::printf("Failed to seek log\n");
+        exit(1);
+    }
+    if (!ok) {
+        ::printf("No usable log index\n");
+        free(index.entries);
+        index.entries = nullptr;
+        index.count = 0;
+        return false;
+    }
+
+    // entries were read from the end of the log backwards
+    for (uint32_t i=0; i<index.count/2; i++) {
+        const IndexEntry tmp = index.entries[i];
+        index.entries[i] = index.entries[index.count-1-i];
+        index.entries[index.count-1-i] = tmp;
+    }
+
+    // finish reading the data we are part way through
+    uint32_t current = 0;
+    while (current < index.count && index.entries[current].offset <= file_offset) {
+        current++;
+    }
+    index.end = current < index.count ? index.entries[current].offset : UINT64_MAX;
+    index.next = current + 1;
+    index.loaded = true;
+    ::printf("Loaded log index with %u entries\n", unsigned(index.count));
+    return true;
+}
+
+/*
+  move on to the next part of the log which passes the index
+  filter. Returns false if there is nothing more of interest
+ */
+bool AP_LoggerFileReader::index_next()
+{
+    while (index.next <= index.count) {
+        const uint32_t i = index.next++;
+        const uint64_t start = i > 0 ? index.entries[i-1].offset : 0;
+        const uint64_t start_us = i > 0 ? index.entries[i-1].time_us : 0;
+        if (start_us > index.end_us) {
+            return false;
+        }
+        if (i < index.count) {
+            // data after the last LIDX is always read as we don't
+            // know what it contains
+            const IndexEntry &e = index.entries[i];
+            bool always = false;
+            bool wanted = false;
+            for (uint8_t j=0; j<4; j++) {
+                always |= (e.types[j] & index.always_types[j]) != 0;
+                wanted |= (e.types[j] & index.types[j]) != 0;
+            }
+            if (!always && (!wanted || e.time_us < index.start_us)) {
+                continue;
+            }
+        }
+        index.end = i < index.count ? index.entries[i].offset : UINT64_MAX;
+        return start == file_offset || seek(start);
+    }
+    return false;
+}
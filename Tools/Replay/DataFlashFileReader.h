@@ -4,6 +4,12 @@
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
+// map the whole log into memory rather than reading it through
+// AP_Filesystem, avoiding system calls for each message
+#ifndef AP_REPLAY_MMAP_ENABLED
+#define AP_REPLAY_MMAP_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
 class AP_LoggerFileReader
 {
 public:
@@ -14,6 +20,15 @@ public:
     bool open_log(const char *logfile);
     bool update();
 
+    /*
+      use the LIDX index in the log, if it has one, to skip log data
+      which has no messages in types or is entirely outside start_us
+      to end_us. Data containing any of always_types is always read,
+      as are format messages. Must be called before the first update()
+     */
+    void set_index_filter(uint64_t start_us, uint64_t end_us,
+                          const uint64_t types[4], const uint64_t always_types[4]);
+
     virtual bool handle_log_format_msg(const struct log_Format &f) = 0;
     virtual bool handle_msg(const struct log_Format &f, uint8_t *msg) = 0;
 
@@ -28,6 +43,54 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+    // read from the log file, advancing file_offset
+    ssize_t read_file(void *buf, size_t count);
+#if AP_REPLAY_MMAP_ENABLED
+    const uint8_t *mapped = nullptr;
+    bool open_mapped(const char *logfile);
+#endif
+
+    // state for reading logs written with LOG_FILE_OPTS Compress
+    struct {
+        bool active;
+        uint16_t frame_size;
+        uint8_t *data;      // compressed frame as read from the file
+        uint8_t *frame;     // previous then current decompressed frame, each frame_size bytes
+        uint16_t len;       // number of bytes in the current frame
+        uint16_t ofs;       // number of bytes of the current frame already consumed
+    } compressed {};
+    bool open_compressed();
+    bool read_compressed_frame();
+
+    // offset in the file of the next byte to be read
+    uint64_t file_offset = 0;
+    uint64_t file_size = 0;
+    bool seek(uint64_t offset);
+
+    // one LIDX message, covering the data before it back to the
+    // previous one
+    struct IndexEntry {
+        uint64_t offset;    // offset of the LIDX message
+        uint64_t time_us;
+        uint64_t types[4];
+    };
+    struct {
+        bool requested;
+        bool loaded;
+        uint64_t start_us;
+        uint64_t end_us;
+        uint64_t types[4];
+        uint64_t always_types[4];
+        IndexEntry *entries;
+        uint32_t count;
+        uint32_t next;      // next entry to consider reading up to
+        uint64_t end;       // end offset of the data being read
+    } index {};
+    bool load_index(const struct log_Format &f);
+    bool find_last_index(const struct log_Format &f, uint64_t &offset);
+    bool read_index_entry(const struct log_Format &f, uint64_t offset, IndexEntry &entry, uint64_t &prev);
+    bool index_next();
+
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
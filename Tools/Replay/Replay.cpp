@@ -39,6 +39,8 @@ static ReplayVehicle replayvehicle;
 user_parameter *user_parameters;
 bool replay_force_ekf2;
 bool replay_force_ekf3;
+uint64_t replay_start_us;
+uint64_t replay_end_us = UINT64_MAX;
 
 const AP_Param::Info ReplayVehicle::var_info[] = {
     GSCALAR(dummy,         "_DUMMY", 0),
@@ -130,11 +132,15 @@ void Replay::usage(void)
     ::printf("\t--param-file FILENAME  load parameters from a file\n");
     ::printf("\t--force-ekf2 force enable EKF2\n");
     ::printf("\t--force-ekf3 force enable EKF3\n");
+    ::printf("\t--start-time SECONDS  skip log data before SECONDS using the log index\n");
+    ::printf("\t--end-time SECONDS  stop after SECONDS using the log index\n");
 }
 
 enum param_key : uint8_t {
     FORCE_EKF2 = 1,
     FORCE_EKF3,
+    START_TIME,
+    END_TIME,
 };
 
 void Replay::_parse_command_line(uint8_t argc, char * const argv[])
@@ -146,6 +152,8 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
         {"param-file",      true,   0, 'F'},
         {"force-ekf2",      false,  0, param_key::FORCE_EKF2},
         {"force-ekf3",      false,  0, param_key::FORCE_EKF3},
+        {"start-time",      true,   0, param_key::START_TIME},
+        {"end-time",        true,   0, param_key::END_TIME},
         {"help",            false,  0, 'h'},
         {0, false, 0, 0}
     };
@@ -181,6 +189,14 @@ void Replay::_parse_command_line(uint8_t argc, char * const argv[])
             replay_force_ekf3 = true;
             break;
 
+        case param_key::START_TIME:
+            replay_start_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
+        case param_key::END_TIME:
+            replay_end_us = atof(gopt.optarg) * 1.0e6;
+            break;
+
         case 'h':
         default:
             usage();
@@ -239,6 +255,16 @@ void Replay::setup()
         ::printf("open(%s): %m\n", filename);
         exit(1);
     }
+
+    if (replay_start_us != 0 || replay_end_us != UINT64_MAX) {
+        // all message types are wanted in the time range, but
+        // parameters are always needed to setup the EKF
+        uint64_t types[4];
+        memset(types, 0xff, sizeof(types));
+        uint64_t always_types[4] {};
+        always_types[LOG_PARAMETER_MSG/64] |= 1ULL << (LOG_PARAMETER_MSG%64);
+        reader.set_index_filter(replay_start_us, replay_end_us, types, always_types);
+    }
 }
 
 void Replay::loop()
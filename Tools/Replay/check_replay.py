@@ -6,8 +6,11 @@ check that replay produced identical results
 
 from __future__ import print_function
 
-def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose=False, accuracy=0.0, ignores=set()):
-    '''check replay log for matching output'''
+def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose=False, accuracy=0.0, ignores=set(),
+              stats=None):
+    '''check replay log for matching output. If stats is a dict it is
+    filled in with message counts and the largest difference seen in
+    each mismatched field'''
     from pymavlink import mavutil
     progress("Processing log %s" % logfile)
     failure = 0
@@ -33,6 +36,9 @@ def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose
     for m in mlist:
         base[m] = {}
 
+    if stats is not None:
+        stats['max_delta'] = {}
+
     while True:
         m = mlog.recv_match(type=mlist)
         if m is None:
@@ -69,6 +75,14 @@ def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose
             if not ok:
                 mismatch = True
                 errors += 1
+                if stats is not None:
+                    key = "%s.%s" % (mtype, f)
+                    try:
+                        delta = abs(v1-v2)
+                    except TypeError:
+                        delta = float('nan')
+                    if key not in stats['max_delta'] or delta > stats['max_delta'][key]:
+                        stats['max_delta'][key] = delta
                 progress("Mismatch in field %s.%s: %s %s" % (mtype, f, str(v1), str(v2)))
         if mismatch:
             progress(mb)
@@ -78,6 +92,10 @@ def check_log(logfile, progress=print, ekf2_only=False, ekf3_only=False, verbose
         for mtype in counts.keys():
             progress("%s %u/%u %d" % (mtype, counts[mtype], base_counts[mtype], base_counts[mtype]-counts[mtype]))
     count_delta = abs(count - base_count)
+    if stats is not None:
+        stats['count'] = count
+        stats['base_count'] = base_count
+        stats['errors'] = errors
     if count == 0 or count_delta > 100:
         progress("count=%u count_delta=%u" % (count, count_delta))
         failure += 1
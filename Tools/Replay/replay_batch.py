@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+
+'''
+run Replay over many logs in parallel, checking each replayed log
+with check_replay.py and printing a summary of timing and EKF
+divergence for each log
+
+AP_FLAKE8_CLEAN
+'''
+
+import argparse
+import glob
+import multiprocessing
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+import check_replay
+
+
+def replay_log(job):
+    '''replay one log in a scratch directory, returning a result dict'''
+    (logfile, opts) = job
+    result = {
+        'log': logfile,
+        'ok': False,
+        'status': 'ok',
+        'replay_s': 0,
+        'check_s': 0,
+        'bytes': 0,
+        'count': 0,
+        'errors': 0,
+        'worst': None,
+    }
+    # each Replay writes its output log to logs/ in its working directory
+    tmpdir = tempfile.mkdtemp(prefix='replay_batch_')
+    try:
+        cmd = [opts.replay] + opts.replay_args + [os.path.abspath(logfile)]
+        t0 = time.time()
+        try:
+            p = subprocess.run(cmd, cwd=tmpdir, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                               timeout=opts.timeout)
+        except subprocess.TimeoutExpired:
+            result['status'] = 'timeout'
+            return result
+        result['replay_s'] = time.time() - t0
+        output = p.stdout.decode('utf-8', 'replace')
+        m = re.search(r'Replay counts: (\d+) bytes', output)
+        if m is not None:
+            result['bytes'] = int(m.group(1))
+        if p.returncode != 0:
+            result['status'] = 'replay exit %d' % p.returncode
+            return result
+
+        out_logs = sorted(glob.glob(os.path.join(tmpdir, 'logs', '*.BIN')))
+        if len(out_logs) == 0:
+            result['status'] = 'no output log'
+            return result
+
+        stats = {}
+        t0 = time.time()
+        result['ok'] = check_replay.check_log(out_logs[-1], progress=lambda x: None,
+                                              accuracy=opts.accuracy, stats=stats)
+        result['check_s'] = time.time() - t0
+        result['count'] = stats.get('count', 0)
+        result['errors'] = stats.get('errors', 0)
+        if stats.get('max_delta'):
+            result['worst'] = max(stats['max_delta'].items(), key=lambda x: x[1])
+        if not result['ok']:
+            result['status'] = 'mismatch'
+        if opts.keep:
+            dest = os.path.join(opts.keep, os.path.basename(logfile) + '.replay.BIN')
+            shutil.copy(out_logs[-1], dest)
+    finally:
+        shutil.rmtree(tmpdir, ignore_errors=True)
+    return result
+
+
+def print_summary(results, wall_s):
+    print("%-40s %-14s %8s %8s %8s %8s %7s  %s" % (
+        "Log", "Status", "Replay", "Check", "MB/s", "Msgs", "Errors", "Worst field"))
+    for r in results:
+        rate = r['bytes'] / (1.0e6 * r['replay_s']) if r['replay_s'] > 0 else 0
+        worst = ''
+        if r['worst'] is not None:
+            worst = "%s %g" % r['worst']
+        print("%-40s %-14s %7.1fs %7.1fs %8.1f %8u %7u  %s" % (
+            os.path.basename(r['log'])[-40:], r['status'], r['replay_s'], r['check_s'],
+            rate, r['count'], r['errors'], worst))
+    cpu_s = sum(r['replay_s'] + r['check_s'] for r in results)
+    failed = [r for r in results if not r['ok']]
+    print("%u logs, %u failed, %.1fs wall, %.1fs total (%.1fx)" % (
+        len(results), len(failed), wall_s, cpu_s, cpu_s / wall_s if wall_s > 0 else 0))
+    return len(failed) == 0
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--replay", default="build/sitl/tool/Replay", help="Replay binary")
+    parser.add_argument("-j", "--jobs", type=int, default=multiprocessing.cpu_count(),
+                        help="number of logs to replay at once")
+    parser.add_argument("--accuracy", type=float, default=0.0, help="accuracy percentage for match")
+    parser.add_argument("--timeout", type=float, default=None, help="timeout in seconds for each Replay")
+    parser.add_argument("--keep", default=None, help="directory to copy replayed logs to")
+    parser.add_argument("--replay-arg", dest='replay_args', action='append', default=[],
+                        help="extra argument to pass to Replay, may be repeated")
+    parser.add_argument("logs", metavar="LOG", nargs="+")
+    opts = parser.parse_args()
+
+    opts.replay = os.path.abspath(opts.replay)
+    if not os.path.exists(opts.replay):
+        print("Replay binary %s not found, build with ./waf replay" % opts.replay)
+        sys.exit(1)
+
+    t0 = time.time()
+    pool = multiprocessing.Pool(processes=opts.jobs)
+    results = []
+    for r in pool.imap_unordered(replay_log, [(log, opts) for log in opts.logs]):
+        print("%s: %s" % (r['log'], r['status']))
+        results.append(r)
+    pool.close()
+    pool.join()
+
+    results.sort(key=lambda r: r['log'])
+    if not print_summary(results, time.time() - t0):
+        sys.exit(1)
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+
+'''
+decompress a dataflash log written with LOG_FILE_OPTS Compress set,
+producing a normal .BIN log
+
+AP_FLAKE8_CLEAN
+'''
+
+import argparse
+import struct
+import sys
+import zlib
+
+FILE_MAGIC = b'APLZ'
+FRAME_MAGIC = b'\xa5\x5a'
+FILE_HEADER = struct.Struct('<4sBBH')
+FRAME_HEADER = struct.Struct('<2sBHHI')
+FLAG_STORED = 1
+FLAG_PREFIXED = 2
+
+
+def crc32(data):
+    '''crc32 matching crc_crc32() with a zero initial value'''
+    return zlib.crc32(data, 0xFFFFFFFF) ^ 0xFFFFFFFF
+
+
+def lz4_block_decompress(src, raw_len, prev=b''):
+    '''decompress one LZ4 block, whose matches may refer back into prev'''
+    out = bytearray(prev)
+    i = 0
+    while i < len(src):
+        token = src[i]
+        i += 1
+        nlit = token >> 4
+        if nlit == 15:
+            while True:
+                b = src[i]
+                i += 1
+                nlit += b
+                if b != 255:
+                    break
+        out += src[i:i+nlit]
+        i += nlit
+        if i >= len(src):
+            # the last sequence has only literals
+            break
+        offset = src[i] | (src[i+1] << 8)
+        i += 2
+        if offset == 0 or offset > len(out):
+            raise ValueError("bad match offset")
+        mlen = token & 0xF
+        if mlen == 15:
+            while True:
+                b = src[i]
+                i += 1
+                mlen += b
+                if b != 255:
+                    break
+        mlen += 4
+        start = len(out) - offset
+        for n in range(mlen):
+            out.append(out[start+n])
+    if len(out) != len(prev) + raw_len:
+        raise ValueError("bad decompressed length")
+    return bytes(out[len(prev):])
+
+
+def decompress_log(infile, outfile):
+    data = open(infile, 'rb').read()
+    if len(data) < FILE_HEADER.size:
+        print("%s: too short" % infile)
+        return False
+    (magic, version, algorithm, frame_size) = FILE_HEADER.unpack_from(data, 0)
+    if magic != FILE_MAGIC or version != 2 or algorithm != 1:
+        print("%s: not a compressed log" % infile)
+        return False
+    ofs = FILE_HEADER.size
+    out = open(outfile, 'wb')
+    frames = 0
+    prev = b''
+    while ofs + FRAME_HEADER.size <= len(data):
+        (magic, flags, raw_len, data_len, crc) = FRAME_HEADER.unpack_from(data, ofs)
+        ofs += FRAME_HEADER.size
+        if magic != FRAME_MAGIC or raw_len == 0 or raw_len > frame_size:
+            print("bad frame header at frame %u" % frames)
+            break
+        if ofs + data_len > len(data):
+            print("log truncated in frame %u" % frames)
+            break
+        frame = data[ofs:ofs+data_len]
+        ofs += data_len
+        try:
+            if not (flags & FLAG_STORED):
+                frame = lz4_block_decompress(frame, raw_len, prev if flags & FLAG_PREFIXED else b'')
+        except (ValueError, IndexError) as ex:
+            print("corrupt frame %u: %s" % (frames, ex))
+            break
+        if len(frame) != raw_len or crc32(frame) != crc:
+            print("crc error in frame %u" % frames)
+            break
+        out.write(frame)
+        prev = frame
+        frames += 1
+    out.close()
+    print("Decompressed %u frames to %s" % (frames, outfile))
+    return True
+
+
+parser = argparse.ArgumentParser(description=__doc__)
+parser.add_argument("infile", help="compressed log")
+parser.add_argument("outfile", help="output .BIN log")
+args = parser.parse_args()
+
+if not decompress_log(args.infile, args.outfile):
+    sys.exit(1)
@@ -816,9 +816,24 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
         find_max_quadrant_velocity(backup_vel_inc, quad_1_back_vel, quad_2_back_vel, quad_3_back_vel, quad_4_back_vel);
     }
 
+    // position used to skip exclusion polygons that are too far away to matter
+    Vector2f position_xy;
+    const bool have_position = AP::ahrs().get_relative_position_NE_origin(position_xy);
+    position_xy *= 100.0f;  // m to cm
+    const float margin_cm = MAX(fence->get_margin() * 100.0f, 0.0f);
+
     // iterate through exclusion polygons
     const uint8_t num_exclusion_polygons = fence->polyfence().get_exclusion_polygon_count();
     for (uint8_t i = 0; i < num_exclusion_polygons; i++) {
+        Vector2f bounds_min_cm, bounds_max_cm;
+        if (have_position && fence->polyfence().get_exclusion_polygon_bounds(i, bounds_min_cm, bounds_max_cm)) {
+            // no edge can be closer than the bounding box
+            const Vector2f to_bounds{MAX(MAX(bounds_min_cm.x - position_xy.x, position_xy.x - bounds_max_cm.x), 0.0f),
+                                     MAX(MAX(bounds_min_cm.y - position_xy.y, position_xy.y - bounds_max_cm.y), 0.0f)};
+            if (polygon_out_of_reach(kP, accel_cmss, desired_vel_cms, to_bounds.length(), margin_cm, dt)) {
+                continue;
+            }
+        }
         uint16_t num_points;
         const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
         Vector2f backup_vel_exc;
@@ -830,6 +845,32 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
     backup_vel = quad_1_back_vel + quad_2_back_vel + quad_3_back_vel + quad_4_back_vel;
 }
 
+/*
+ * Returns true if a polygon whose closest edge is at least distance_cm away
+ * cannot back the vehicle away or limit desired_vel_cms, so
+ * adjust_velocity_polygon() can be skipped for it
+ */
+bool AC_Avoid::polygon_out_of_reach(float kP, float accel_cmss, const Vector2f &desired_vel_cms, float distance_cm, float margin_cm, float dt) const
+{
+    // vehicle is within the margin and may need to back away
+    if (distance_cm <= margin_cm) {
+        return false;
+    }
+    if (desired_vel_cms.is_zero()) {
+        return true;
+    }
+    const float speed = desired_vel_cms.length();
+    switch (_behavior) {
+    case BEHAVIOR_SLIDE:
+        // every edge allows at least this speed towards it
+        return get_max_speed(kP, accel_cmss, distance_cm - margin_cm, dt) > speed;
+    case BEHAVIOR_STOP:
+        // the stopping point plus margin cannot reach any edge
+        return distance_cm > 2.0f + margin_cm + get_stopping_distance(kP, accel_cmss, speed);
+    }
+    return false;
+}
+
 /*
  * Adjusts the desired velocity for the inclusion circles
  */
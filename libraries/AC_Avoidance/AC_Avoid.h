@@ -134,6 +134,11 @@ private:
      */
     void adjust_velocity_inclusion_and_exclusion_polygons(float kP, float accel_cmss, Vector2f &desired_vel_cms, Vector2f &backup_vel, float dt);
 
+    /*
+     * Returns true if a polygon at least distance_cm away cannot change the desired velocity or back the vehicle away
+     */
+    bool polygon_out_of_reach(float kP, float accel_cmss, const Vector2f &desired_vel_cms, float distance_cm, float margin_cm, float dt) const;
+
     /*
      * Adjusts the desired velocity for the inclusion and exclusion circles
      */
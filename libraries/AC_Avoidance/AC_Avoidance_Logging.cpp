@@ -5,6 +5,7 @@
 #include "AC_Avoid.h"
 #include "AP_OADijkstra.h"
 #include "AP_OABendyRuler.h"
+#include "AP_OADatabase.h"
 #include <AP_Logger/AP_Logger.h>
 
 void AP_OABendyRuler::Write_OABendyRuler(const uint8_t type, const bool active, const float target_yaw, const float target_pitch, const bool resist_chg, const float margin, const Location &final_dest, const Location &oa_dest) const
@@ -28,7 +29,8 @@ void AP_OABendyRuler::Write_OABendyRuler(const uint8_t type, const bool active,
         final_alt   : got_final_dest ? final_alt : final_dest.alt,
         oa_lat      : oa_dest.lat,
         oa_lng      : oa_dest.lng,
-        oa_alt      : got_oa_dest ? oa_dest_alt : oa_dest.alt
+        oa_alt      : got_oa_dest ? oa_dest_alt : oa_dest.alt,
+        update_us   : AP_HAL::micros() - _update_start_us
     };
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
@@ -81,4 +83,18 @@ void AC_Avoid::Write_SimpleAvoidance(const uint8_t state, const Vector3f& desire
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
 
+void AP_OADatabase::Write_OADatabase() const
+{
+    const struct log_OADatabase pkt{
+        LOG_PACKET_HEADER_INIT(LOG_OA_DATABASE_MSG),
+        time_us     : AP_HAL::micros64(),
+        count       : _database.count,
+        processed   : _stats.processed,
+        compared    : _stats.compared,
+        process_us  : _stats.process_us,
+        radius_max  : _grid.radius_max,
+    };
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+}
+
 #endif  // HAL_LOGGING_ENABLED
@@ -32,6 +32,7 @@ const float OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO = 1.0f; // step2's lookahead len
 const float OA_BENDYRULER_LOOKAHEAD_STEP2_MIN = 2.0f;   // step2 checks at least this many meters past step1's location
 const float OA_BENDYRULER_LOOKAHEAD_PAST_DEST = 2.0f;   // lookahead length will be at least this many meters past the destination
 const float OA_BENDYRULER_LOW_SPEED_SQUARED = (0.2f * 0.2f);    // when ground course is below this speed squared, vehicle's heading will be used
+const uint32_t OA_BENDYRULER_GRID_BUILD_US = 5000;      // time spent building the fence margin grid on each update
 
 #define VERTICAL_ENABLED APM_BUILD_COPTER_OR_HELI
 
@@ -69,6 +70,15 @@ const AP_Param::GroupInfo AP_OABendyRuler::var_info[] = {
     // @User: Standard
     AP_GROUPINFO_FRAME("TYPE", 4, AP_OABendyRuler, _bendy_type, OA_BENDYRULER_TYPE_DEFAULT, AP_PARAM_FRAME_COPTER | AP_PARAM_FRAME_HELI | AP_PARAM_FRAME_TRICOPTER),
 
+    // @Param: GRID
+    // @DisplayName: BendyRuler fence margin grid cell size
+    // @Description: BendyRuler keeps a grid of distances to the polygon fences with cells of this size to quickly find paths that are well clear of the fence. Paths near the fence are always checked against every fence edge. The grid is rebuilt in the background when the fence changes. Larger cells are used on large fences. Margins of clear paths found from the grid are a lower bound so may be less than the exact margin, which changes the margins compared with CONT_RATIO and logged. Zero disables the grid
+    // @Units: m
+    // @Range: 0 50
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("GRID", 5, AP_OABendyRuler, _grid_cell_size, 0),
+
     AP_GROUPEND
 };
 
@@ -83,9 +93,14 @@ AP_OABendyRuler::AP_OABendyRuler()
 // bendy_type is set to the type of BendyRuler used
 bool AP_OABendyRuler::update(const Location& current_loc, const Location& destination, const Vector2f &ground_speed_vec, Location &origin_new, Location &destination_new, OABendyType &bendy_type, bool proximity_only)
 {
+    _update_start_us = AP_HAL::micros();
+
     // bendy ruler always sets origin to current_loc
     origin_new = current_loc;
 
+    // continue building the fence margin grid
+    update_margin_grid();
+
     // init bendy_type returned
     bendy_type = OABendyType::OA_BENDY_DISABLED;
 
@@ -550,6 +565,18 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons(const Lo
     // get fence margin
     const float fence_margin = fence->get_margin();
 
+    // the grid gives a lower bound on the margin which is used if it shows the path
+    // is clear of the fence, otherwise every fence edge is checked.
+    // The bound is returned as the margin rather than clamped to _margin_max, as the
+    // callers treat only margins strictly above _margin_max as clear. It is less than
+    // the exact margin, so the margins compared against CONT_RATIO and logged as Mar
+    // differ from those found without the grid, but only for paths already found clear
+    float grid_dist;
+    if (_margin_grid.segment_lower_bound(start_NE, end_NE, grid_dist) && (grid_dist - fence_margin > _margin_max)) {
+        margin = grid_dist - fence_margin;
+        return true;
+    }
+
     // iterate through inclusion polygons and calculate minimum margin
     bool margin_updated = false;
     for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
@@ -589,6 +616,103 @@ bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_polygons(const Lo
 #endif // AP_FENCE_ENABLED
 }
 
+#if AP_FENCE_ENABLED
+// calculate signed distance in cm from a point to the closest edge of any polygon fence
+// positive if the point is inside all inclusion polygons and outside all exclusion polygons
+static float calc_signed_distance_from_polygons(const AC_PolyFence_loader &polyfence, const Vector2f &pos_cm)
+{
+    const uint8_t num_inclusion_polygons = polyfence.get_inclusion_polygon_count();
+    const uint8_t num_exclusion_polygons = polyfence.get_exclusion_polygon_count();
+    float dist_min = FLT_MAX;
+    for (uint8_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+        const bool inclusion = i < num_inclusion_polygons;
+        uint16_t num_points;
+        const Vector2f* boundary = inclusion ? polyfence.get_inclusion_polygon(i, num_points) : polyfence.get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+        if (boundary == nullptr || num_points < 3) {
+            continue;
+        }
+        // include the closing edge so the distance is continuous across the whole boundary
+        const float dist = MIN(Polygon_closest_distance_point(boundary, num_points, pos_cm),
+                               Vector2f::closest_distance_between_line_and_point(boundary[num_points-1], boundary[0], pos_cm));
+        const bool inside = !Polygon_outside(pos_cm, boundary, num_points);
+        dist_min = MIN(dist_min, (inside == inclusion) ? dist : -dist);
+    }
+    return dist_min;
+}
+#endif // AP_FENCE_ENABLED
+
+// build the fence margin grid a few rows at a time, starting again whenever the fence changes
+void AP_OABendyRuler::update_margin_grid()
+{
+#if AP_FENCE_ENABLED
+    const AC_Fence *fence = AC_Fence::get_singleton();
+    if ((fence == nullptr) || !is_positive(_grid_cell_size) || ((fence->get_enabled_fences() & AC_FENCE_TYPE_POLYGON) == 0)) {
+        _margin_grid.clear();
+        _margin_grid_cell_size = 0;
+        return;
+    }
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
+
+    // start again if the fence or cell size has changed
+    if ((_margin_grid_inclusion_ms != polyfence.get_inclusion_polygon_update_ms()) ||
+        (_margin_grid_exclusion_ms != polyfence.get_exclusion_polygon_update_ms()) ||
+        !is_equal(_margin_grid_cell_size, _grid_cell_size.get())) {
+        _margin_grid_inclusion_ms = polyfence.get_inclusion_polygon_update_ms();
+        _margin_grid_exclusion_ms = polyfence.get_exclusion_polygon_update_ms();
+        _margin_grid_cell_size = _grid_cell_size;
+        _margin_grid.clear();
+        _margin_grid_rows_done = 0;
+
+        // find the area covered by the polygons
+        const uint8_t num_inclusion_polygons = polyfence.get_inclusion_polygon_count();
+        const uint8_t num_exclusion_polygons = polyfence.get_exclusion_polygon_count();
+        Vector2f min_cm{FLT_MAX, FLT_MAX};
+        Vector2f max_cm{-FLT_MAX, -FLT_MAX};
+        for (uint8_t i = 0; i < num_inclusion_polygons + num_exclusion_polygons; i++) {
+            uint16_t num_points;
+            const Vector2f* boundary = (i < num_inclusion_polygons) ? polyfence.get_inclusion_polygon(i, num_points) : polyfence.get_exclusion_polygon(i - num_inclusion_polygons, num_points);
+            for (uint16_t j = 0; (boundary != nullptr) && (j < num_points); j++) {
+                min_cm.x = MIN(min_cm.x, boundary[j].x);
+                min_cm.y = MIN(min_cm.y, boundary[j].y);
+                max_cm.x = MAX(max_cm.x, boundary[j].x);
+                max_cm.y = MAX(max_cm.y, boundary[j].y);
+            }
+        }
+        if (min_cm.x > max_cm.x) {
+            // no polygons
+            return;
+        }
+
+        // extend the grid to cover paths from vehicles outside exclusion polygons
+        const float pad_cm = _lookahead * (1.0f + OA_BENDYRULER_LOOKAHEAD_STEP2_RATIO) * 100.0f;
+        const Vector2f pad{pad_cm, pad_cm};
+        if (!_margin_grid.init(min_cm - pad, max_cm + pad, _grid_cell_size * 100.0f)) {
+            return;
+        }
+    }
+
+    if ((_margin_grid.num_rows() == 0) || _margin_grid.ready()) {
+        return;
+    }
+
+    // calculate rows of the grid until this update's time is used up
+    const uint32_t start_us = AP_HAL::micros();
+    while (_margin_grid_rows_done < _margin_grid.num_rows()) {
+        const uint16_t row = _margin_grid_rows_done++;
+        for (uint16_t col = 0; col < _margin_grid.num_cols(); col++) {
+            const float dist_cm = calc_signed_distance_from_polygons(polyfence, _margin_grid.node_position(row, col));
+            _margin_grid.set_node(row, col, dist_cm * 0.01f);
+        }
+        if (AP_HAL::micros() - start_us > OA_BENDYRULER_GRID_BUILD_US) {
+            break;
+        }
+    }
+    if (_margin_grid_rows_done == _margin_grid.num_rows()) {
+        _margin_grid.set_ready();
+    }
+#endif // AP_FENCE_ENABLED
+}
+
 // calculate minimum distance between a path and all inclusion and exclusion circles
 // on success returns true and updates margin
 bool AP_OABendyRuler::calc_margin_from_inclusion_and_exclusion_circles(const Location &start, const Location &end, float &margin) const
@@ -688,23 +812,6 @@ bool AP_OABendyRuler::calc_margin_from_object_database(const Location &start, co
         return false;
     }
 
-    // check each obstacle's distance from segment
-    float smallest_margin = FLT_MAX;
-    for (uint16_t i=0; i<oaDb->database_count(); i++) {
-        const AP_OADatabase::OA_DbItem& item = oaDb->get_item(i);
-        const Vector3f point_cm = item.pos * 100.0f;
-        // margin is distance between line segment and obstacle minus obstacle's radius
-        const float m = Vector3f::closest_distance_between_line_and_point(start_NEU, end_NEU, point_cm) * 0.01f - item.radius;
-        if (m < smallest_margin) {
-            smallest_margin = m;
-        }
-    }
-
-    // return smallest margin
-    if (smallest_margin < FLT_MAX) {
-        margin = smallest_margin;
-        return true;
-    }
-
-    return false;
+    // margin is distance between line segment and obstacle minus obstacle's radius
+    return oaDb->get_smallest_margin(start_NEU * 0.01f, end_NEU * 0.01f, margin);
 }
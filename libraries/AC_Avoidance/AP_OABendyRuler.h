@@ -4,6 +4,7 @@
 #include <AP_Common/Location.h>
 #include <AP_Math/AP_Math.h>
 #include <AP_Logger/AP_Logger_config.h>
+#include "AP_OAMarginGrid.h"
 
 /*
  * BendyRuler avoidance algorithm for avoiding the polygon and circular fence and dynamic objects detected by the proximity sensor
@@ -67,6 +68,9 @@ private:
     // on success returns true and updates margin
     bool calc_margin_from_object_database(const Location &start, const Location &end, float &margin) const;
 
+    // build the fence margin grid a few rows at a time, starting again whenever the fence changes
+    void update_margin_grid();
+
     // Logging function
 #if HAL_LOGGING_ENABLED
     void Write_OABendyRuler(const uint8_t type, const bool active, const float target_yaw, const float target_pitch, const bool resist_chg, const float margin, const Location &final_dest, const Location &oa_dest) const;
@@ -82,9 +86,18 @@ private:
     AP_Float _bendy_ratio;          // object avoidance will avoid major directional change if change in margin ratio is less than this param
     AP_Int16 _bendy_angle;          // object avoidance will try avoiding change in direction over this much angle
     AP_Int8  _bendy_type;           // Type of BendyRuler to run
+    AP_Float _grid_cell_size;       // fence margin grid cell size in meters, zero disables the grid
     
     // internal variables used by background thread
     float _current_lookahead;       // distance (in meters) ahead of the vehicle we are looking for obstacles
     float _bearing_prev;            // stored bearing in degrees 
     Location _destination_prev;     // previous destination, to check if there has been a change in destination
+    uint32_t _update_start_us;      // system time the latest update started, for logging
+
+    // grid of distances to polygon fences used to quickly find paths well clear of them
+    AP_OAMarginGrid _margin_grid;
+    uint16_t _margin_grid_rows_done;        // rows of grid nodes calculated so far
+    uint32_t _margin_grid_inclusion_ms;     // inclusion polygon update time the grid is for
+    uint32_t _margin_grid_exclusion_ms;     // exclusion polygon update time the grid is for
+    float _margin_grid_cell_size;           // cell size parameter the grid is for
 };
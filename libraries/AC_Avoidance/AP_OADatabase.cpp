@@ -36,6 +36,12 @@ extern const AP_HAL::HAL& hal;
     #define AP_OADATABASE_DISTANCE_FROM_HOME 3
 #endif
 
+#ifndef AP_OADATABASE_GRID_CELL_SIZE
+    #define AP_OADATABASE_GRID_CELL_SIZE 4.0f   // size of spatial hash grid cells in meters
+#endif
+
+#define AP_OADATABASE_GRID_INDEX_NONE UINT16_MAX // marks the end of a grid bucket's list of items
+
 const AP_Param::GroupInfo AP_OADatabase::var_info[] = {
 
     // @Param: SIZE
@@ -128,6 +134,8 @@ void AP_OADatabase::init()
         GCS_SEND_TEXT(MAV_SEVERITY_INFO, "DB init failed . Sizes queue:%u, db:%u", (unsigned int)_queue.size, (unsigned int)_database.size);
         delete _queue.items;
         delete[] _database.items;
+        delete[] _grid.bucket_head;
+        delete[] _grid.next;
         return;
     }
 }
@@ -140,6 +148,11 @@ void AP_OADatabase::update()
 
     process_queue();
     database_items_remove_all_expired();
+
+#if HAL_LOGGING_ENABLED
+    Write_OADatabase();
+#endif
+    _stats = {};
 }
 
 // push a location into the database
@@ -174,6 +187,8 @@ void AP_OADatabase::queue_push(const Vector3f &pos, uint32_t timestamp_ms, float
 
     const OA_DbItem item = {pos, timestamp_ms, MAX(_radius_min, distance * dist_to_radius_scalar), 0, AP_OADatabase::OA_DbItemImportance::Normal};
     {
+        // the queue is single producer, so producers take turns. The
+        // consumer in process_queue() never takes this semaphore
         WITH_SEMAPHORE(_queue.sem);
         _queue.items->push(item);
     }
@@ -186,7 +201,7 @@ void AP_OADatabase::init_queue()
         return;
     }
 
-    _queue.items = new ObjectBuffer<OA_DbItem>(_queue.size);
+    _queue.items = new ObjectBuffer_SPSC<OA_DbItem>(_queue.size);
     if (_queue.items != nullptr && _queue.items->get_size() == 0) {
         // allocation failed
         delete _queue.items;
@@ -202,6 +217,102 @@ void AP_OADatabase::init_database()
     }
 
     _database.items = new OA_DbItem[_database.size];
+    if (_database.items != nullptr) {
+        init_grid();
+    }
+}
+
+// allocate spatial hash grid, on failure the whole database is searched instead
+void AP_OADatabase::init_grid()
+{
+    if (_database.size >= AP_OADATABASE_GRID_INDEX_NONE) {
+        return;
+    }
+
+    // use at least as many buckets as database items so buckets hold about one cell each
+    uint16_t num_buckets = 1;
+    while (num_buckets < _database.size) {
+        num_buckets <<= 1;
+    }
+
+    _grid.bucket_head = new uint16_t[num_buckets];
+    _grid.next = new uint16_t[_database.size];
+    if ((_grid.bucket_head == nullptr) || (_grid.next == nullptr)) {
+        delete[] _grid.bucket_head;
+        delete[] _grid.next;
+        _grid.bucket_head = nullptr;
+        _grid.next = nullptr;
+        return;
+    }
+    _grid.num_buckets = num_buckets;
+    for (uint16_t i = 0; i < num_buckets; i++) {
+        _grid.bucket_head[i] = AP_OADATABASE_GRID_INDEX_NONE;
+    }
+}
+
+// get horizontal grid cell holding a position
+void AP_OADatabase::grid_get_cell(const Vector3f &pos, int32_t &cell_x, int32_t &cell_y) const
+{
+    cell_x = (int32_t)floorf(pos.x * (1.0f / AP_OADATABASE_GRID_CELL_SIZE));
+    cell_y = (int32_t)floorf(pos.y * (1.0f / AP_OADATABASE_GRID_CELL_SIZE));
+}
+
+// get bucket holding a grid cell's items.  Many cells share each bucket
+uint16_t AP_OADatabase::grid_get_bucket(int32_t cell_x, int32_t cell_y) const
+{
+    const uint32_t hash = ((uint32_t)cell_x * 73856093U) ^ ((uint32_t)cell_y * 19349663U);
+    return hash & (_grid.num_buckets - 1);
+}
+
+// add database item to the head of its bucket's list
+void AP_OADatabase::grid_add(const uint16_t index)
+{
+    int32_t cell_x, cell_y;
+    grid_get_cell(_database.items[index].pos, cell_x, cell_y);
+    const uint16_t bucket = grid_get_bucket(cell_x, cell_y);
+    _grid.next[index] = _grid.bucket_head[bucket];
+    _grid.bucket_head[bucket] = index;
+}
+
+// remove database item from its bucket's list
+void AP_OADatabase::grid_remove(const uint16_t index)
+{
+    int32_t cell_x, cell_y;
+    grid_get_cell(_database.items[index].pos, cell_x, cell_y);
+    uint16_t *idx_ptr = &_grid.bucket_head[grid_get_bucket(cell_x, cell_y)];
+    while (*idx_ptr != AP_OADATABASE_GRID_INDEX_NONE) {
+        if (*idx_ptr == index) {
+            *idx_ptr = _grid.next[index];
+            return;
+        }
+        idx_ptr = &_grid.next[*idx_ptr];
+    }
+}
+
+// update grid after database item has been copied from index_from to index_to
+void AP_OADatabase::grid_move(const uint16_t index_from, const uint16_t index_to)
+{
+    int32_t cell_x, cell_y;
+    grid_get_cell(_database.items[index_to].pos, cell_x, cell_y);
+    uint16_t *idx_ptr = &_grid.bucket_head[grid_get_bucket(cell_x, cell_y)];
+    while (*idx_ptr != AP_OADATABASE_GRID_INDEX_NONE) {
+        if (*idx_ptr == index_from) {
+            *idx_ptr = index_to;
+            _grid.next[index_to] = _grid.next[index_from];
+            return;
+        }
+        idx_ptr = &_grid.next[*idx_ptr];
+    }
+}
+
+// returns true if the window of cells is small enough that searching it is quicker than searching the whole database
+bool AP_OADatabase::grid_window_searchable(int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y) const
+{
+    if (!grid_enabled()) {
+        return false;
+    }
+    const int64_t num_cells = ((int64_t)max_x - min_x + 1) * ((int64_t)max_y - min_y + 1);
+    return num_cells <= MIN(_database.count, _grid.num_buckets);
 }
 
 // get bitmask of gcs channels item should be sent to based on its importance
@@ -246,36 +357,118 @@ bool AP_OADatabase::process_queue()
     if (queue_available == 0) {
         return false;
     }
+    const uint32_t start_us = AP_HAL::micros();
 
     for (uint16_t queue_index=0; queue_index<queue_available; queue_index++) {
         OA_DbItem item;
 
-        bool pop_success;
-        {
-            WITH_SEMAPHORE(_queue.sem);
-            pop_success = _queue.items->pop(item);
-        }
-        if (!pop_success) {
+        if (!_queue.items->pop(item)) {
+            _stats.process_us += AP_HAL::micros() - start_us;
             return false;
         }
 
         item.send_to_gcs = get_send_to_gcs_flags(item.importance);
 
-        // compare item to all items in database. If found a similar item, update the existing, else add it as a new one
-        bool found = false;
+        // compare item to items in database. If found a similar item, update the existing, else add it as a new one
+        uint16_t index;
+        if (find_close_item_in_database(item, index)) {
+            database_item_refresh(index, item.timestamp_ms, item.radius);
+        } else {
+            database_item_add(item);
+        }
+        _stats.processed++;
+    }
+    _stats.process_us += AP_HAL::micros() - start_us;
+    return (_queue.items->available() > 0);
+}
+
+// find lowest index database item close to "item", returns true on success and updates index
+// only items in grid cells within reach of the largest object radius are checked
+bool AP_OADatabase::find_close_item_in_database(const OA_DbItem &item, uint16_t &index)
+{
+    // items are close if within either item's radius
+    const float reach = MAX(item.radius, _grid.radius_max);
+    int32_t min_x, min_y, max_x, max_y;
+    grid_get_cell(item.pos - Vector3f{reach, reach, 0}, min_x, min_y);
+    grid_get_cell(item.pos + Vector3f{reach, reach, 0}, max_x, max_y);
+
+    // compare with all items if the search window covers too many cells
+    if (!grid_window_searchable(min_x, min_y, max_x, max_y)) {
         for (uint16_t i=0; i<_database.count; i++) {
+            _stats.compared++;
             if (is_close_to_item_in_database(i, item)) {
-                database_item_refresh(i, item.timestamp_ms, item.radius);
-                found = true;
-                break;
+                index = i;
+                return true;
             }
         }
+        return false;
+    }
 
-        if (!found) {
-            database_item_add(item);
+    // compare with items in buckets covering the window.  Several cells may share a bucket
+    // so the lowest index is chosen to return the same item as the search of all items
+    bool found = false;
+    for (int32_t x = min_x; x <= max_x; x++) {
+        for (int32_t y = min_y; y <= max_y; y++) {
+            uint16_t i = _grid.bucket_head[grid_get_bucket(x, y)];
+            while (i != AP_OADATABASE_GRID_INDEX_NONE) {
+                _stats.compared++;
+                if ((!found || (i < index)) && is_close_to_item_in_database(i, item)) {
+                    index = i;
+                    found = true;
+                }
+                i = _grid.next[i];
+            }
         }
     }
-    return (_queue.items->available() > 0);
+    return found;
+}
+
+// find the smallest margin between a line segment and the objects in the database
+// start and end are offsets in meters from the EKF origin, margin is the distance from the segment minus the object's radius
+// returns true on success and updates margin, false if the database is empty
+bool AP_OADatabase::get_smallest_margin(const Vector3f &start, const Vector3f &end, float &margin) const
+{
+    if (!healthy() || (_database.count == 0)) {
+        return false;
+    }
+
+    // cells covered by the segment
+    int32_t seg_min_x, seg_min_y, seg_max_x, seg_max_y;
+    grid_get_cell(Vector3f{MIN(start.x, end.x), MIN(start.y, end.y), 0}, seg_min_x, seg_min_y);
+    grid_get_cell(Vector3f{MAX(start.x, end.x), MAX(start.y, end.y), 0}, seg_max_x, seg_max_y);
+
+    // search rings of cells around the segment until no unsearched object can be closer
+    float smallest_margin = FLT_MAX;
+    for (int32_t ring = 0; grid_window_searchable(seg_min_x - ring, seg_min_y - ring, seg_max_x + ring, seg_max_y + ring); ring++) {
+        for (int32_t x = seg_min_x - ring; x <= seg_max_x + ring; x++) {
+            // only the edges of the window have not already been searched
+            const bool edge_x = (ring == 0) || (x == seg_min_x - ring) || (x == seg_max_x + ring);
+            const int32_t step_y = edge_x ? 1 : MAX(seg_max_y - seg_min_y + ring * 2, 1);
+            for (int32_t y = seg_min_y - ring; y <= seg_max_y + ring; y += step_y) {
+                uint16_t i = _grid.bucket_head[grid_get_bucket(x, y)];
+                while (i != AP_OADATABASE_GRID_INDEX_NONE) {
+                    const OA_DbItem &item = _database.items[i];
+                    const float m = Vector3f::closest_distance_between_line_and_point(start, end, item.pos) - item.radius;
+                    smallest_margin = MIN(smallest_margin, m);
+                    i = _grid.next[i];
+                }
+            }
+        }
+        // objects outside the window are at least this far from the segment
+        if (smallest_margin <= ring * AP_OADATABASE_GRID_CELL_SIZE - _grid.radius_max) {
+            margin = smallest_margin;
+            return true;
+        }
+    }
+
+    // check all objects
+    for (uint16_t i=0; i<_database.count; i++) {
+        const OA_DbItem &item = _database.items[i];
+        const float m = Vector3f::closest_distance_between_line_and_point(start, end, item.pos) - item.radius;
+        smallest_margin = MIN(smallest_margin, m);
+    }
+    margin = smallest_margin;
+    return true;
 }
 
 void AP_OADatabase::database_item_add(const OA_DbItem &item)
@@ -285,6 +478,10 @@ void AP_OADatabase::database_item_add(const OA_DbItem &item)
     }
     _database.items[_database.count] = item;
     _database.items[_database.count].send_to_gcs = get_send_to_gcs_flags(_database.items[_database.count].importance);
+    if (grid_enabled()) {
+        grid_add(_database.count);
+    }
+    _grid.radius_max = MAX(_grid.radius_max, item.radius);
     _database.count++;
 }
 
@@ -295,6 +492,10 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
         return;
     }
 
+    if (grid_enabled()) {
+        grid_remove(index);
+    }
+
     // radius of 0 tells the GCS we don't care about it any more (aka it expired)
     _database.items[index].radius = 0;
     _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
@@ -308,6 +509,9 @@ void AP_OADatabase::database_item_remove(const uint16_t index)
         // copy last object in array over expired object
         _database.items[index] = _database.items[_database.count];
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+        if (grid_enabled()) {
+            grid_move(_database.count, index);
+        }
     }
 }
 
@@ -328,6 +532,7 @@ void AP_OADatabase::database_item_refresh(const uint16_t index, const uint32_t t
         _database.items[index].timestamp_ms = timestamp_ms;
         _database.items[index].radius = radius;
         _database.items[index].send_to_gcs = get_send_to_gcs_flags(_database.items[index].importance);
+        _grid.radius_max = MAX(_grid.radius_max, radius);
     }
 }
 
@@ -344,13 +549,18 @@ void AP_OADatabase::database_items_remove_all_expired()
     const uint32_t now_ms = AP_HAL::millis();
     const uint32_t expiry_ms = (uint32_t)_database_expiry_seconds * 1000;
     uint16_t index = 0;
+    float radius_max = 0;
     while (index < _database.count) {
         if (now_ms - _database.items[index].timestamp_ms > expiry_ms) {
             database_item_remove(index);
         } else {
+            radius_max = MAX(radius_max, _database.items[index].radius);
             index++;
         }
     }
+
+    // largest radius may have expired
+    _grid.radius_max = radius_max;
 }
 
 // returns true if a similar object already exists in database. When true, the object timer is also reset
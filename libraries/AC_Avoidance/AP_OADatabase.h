@@ -4,6 +4,7 @@
 #include <AP_Math/AP_Math.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Param/AP_Param.h>
+#include <AP_Logger/AP_Logger_config.h>
 
 class AP_OADatabase {
 public:
@@ -46,6 +47,11 @@ public:
     // get number of items in the database
     uint16_t database_count() const { return _database.count; }
 
+    // find the smallest margin between a line segment and the objects in the database
+    // start and end are offsets in meters from the EKF origin, margin is the distance from the segment minus the object's radius
+    // returns true on success and updates margin, false if the database is empty
+    bool get_smallest_margin(const Vector3f &start, const Vector3f &end, float &margin) const;
+
     // empty queue and try and put into database. Return true if there's more work to do
     bool process_queue();
 
@@ -73,6 +79,26 @@ private:
     // returns true if database item "index" is close to "item"
     bool is_close_to_item_in_database(const uint16_t index, const OA_DbItem &item) const;
 
+    // find lowest index database item close to "item", returns true on success and updates index
+    bool find_close_item_in_database(const OA_DbItem &item, uint16_t &index);
+
+    // spatial hash of database item positions on a horizontal grid
+    // allows finding items near a position without checking the whole database
+    void init_grid();
+    bool grid_enabled() const { return _grid.bucket_head != nullptr; }
+    void grid_get_cell(const Vector3f &pos, int32_t &cell_x, int32_t &cell_y) const;
+    uint16_t grid_get_bucket(int32_t cell_x, int32_t cell_y) const;
+    void grid_add(const uint16_t index);
+    void grid_remove(const uint16_t index);
+    void grid_move(const uint16_t index_from, const uint16_t index_to);
+
+    // returns true if the window of cells is small enough that searching it is quicker than searching the whole database
+    bool grid_window_searchable(int32_t min_x, int32_t min_y, int32_t max_x, int32_t max_y) const;
+
+#if HAL_LOGGING_ENABLED
+    void Write_OADatabase() const;
+#endif
+
     // enum for use with _OUTPUT parameter
     enum class OutputLevel {
         NONE = 0,
@@ -92,9 +118,9 @@ private:
     AP_Float        _min_alt;                               // OADatabase minimum vehicle height check (in meters)
 
     struct {
-        ObjectBuffer<OA_DbItem> *items;                     // thread safe incoming queue of points from proximity sensor to be put into database
+        ObjectBuffer_SPSC<OA_DbItem> *items;                // lock-free incoming queue of points from proximity sensor to be put into database
         uint16_t        size;                               // cached value of _queue_size_param.
-        HAL_Semaphore   sem;                                // semaphore for multi-thread use of queue
+        HAL_Semaphore   sem;                                // serialises producers, proximity backends may push from several threads
     } _queue;
     float dist_to_radius_scalar;                            // scalar to convert the distance and beam width to an object radius
 
@@ -104,6 +130,20 @@ private:
         uint16_t        size;                               // cached value of _database_size_param that sticks after initialized
     } _database;
 
+    struct {
+        uint16_t        *bucket_head;                       // index of first database item in each bucket
+        uint16_t        *next;                              // index of next database item in the same bucket as each database item
+        uint16_t        num_buckets;                        // number of buckets, always a power of two
+        float           radius_max;                         // largest radius of any object in the database (in meters)
+    } _grid;
+
+    // statistics for the OADB log message
+    struct {
+        uint16_t        processed;                          // number of queue items processed since last log
+        uint32_t        compared;                           // number of database items compared against since last log
+        uint32_t        process_us;                         // time spent processing the queue since last log
+    } _stats;
+
     uint16_t _next_index_to_send[MAVLINK_COMM_NUM_BUFFERS]; // index of next object in _database to send to GCS
     uint16_t _highest_index_sent[MAVLINK_COMM_NUM_BUFFERS]; // highest index in _database sent to GCS
     uint32_t _last_send_to_gcs_ms[MAVLINK_COMM_NUM_BUFFERS];// system time that send_adsb_vehicle was last called
@@ -25,7 +25,6 @@
 #include <GCS_MAVLink/GCS.h>
 
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
-#define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        255     // index use to indicate we do not have a tentative short path for a node
 #define OA_DIJKSTRA_ERROR_REPORTING_INTERVAL_MS         5000    // failure messages sent to GCS every 5 seconds
 
 /// Constructor
@@ -33,9 +32,7 @@ AP_OADijkstra::AP_OADijkstra(AP_Int16 &options) :
         _options(options),
         _inclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
-        _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
-        _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
-        _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
+        _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
 {
 }
 
@@ -684,7 +681,7 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
     }
 
     // fail if more fence points than algorithm can handle
-    if (total_numpoints() >= OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+    if (total_numpoints() > AP_OAShortestPath::MAX_POINTS) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_TOO_MANY_FENCE_POINTS;
         return false;
     }
@@ -714,6 +711,20 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
         }
     }
 
+    // pass fence points to the shortest path search
+    if (!_shortest_path.set_fence(_fence_visgraph, total_numpoints())) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+    for (uint8_t i = 0; i < total_numpoints(); i++) {
+        Vector2f point;
+        if (!get_point(i, point)) {
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
+            return false;
+        }
+        _shortest_path.set_point(i, point);
+    }
+
     return true;
 }
 
@@ -751,123 +762,6 @@ bool AP_OADijkstra::update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph
     return true;
 }
 
-// update total distance for all nodes visible from current node
-// curr_node_idx is an index into the _short_path_data array
-void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
-{
-    // sanity check
-    if (curr_node_idx >= _short_path_data_numpoints) {
-        return;
-    }
-
-    // get current node for convenience
-    const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
-
-    // for each visibility graph
-    const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
-    for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
-
-        // skip if empty
-        const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
-            continue;
-        }
-
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
-                node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
-                    }
-                }
-            }
-        }
-    }
-}
-
-// find a node's index into _short_path_data array from it's id (i.e. id type and id number)
-// returns true if successful and node_idx is updated
-bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const
-{
-    switch (id.id_type) {
-    case AP_OAVisGraph::OATYPE_SOURCE:
-        // source node is always the first node
-        if (_short_path_data_numpoints > 0) {
-            node_idx = 0;
-            return true;
-        }
-        break;
-    case AP_OAVisGraph::OATYPE_DESTINATION:
-        // destination is always the 2nd node
-        if (_short_path_data_numpoints > 1) {
-            node_idx = 1;
-            return true;
-        }
-        break;
-    case AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT:
-        // intermediate nodes start from 3rd node
-        if (_short_path_data_numpoints > id.id_num + 2) {
-            node_idx = id.id_num + 2;
-            return true;
-        }
-        break;
-    }
-
-    // could not find node
-    return false;
-}
-
-// find index of node with lowest tentative distance (ignore visited nodes)
-// returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
-{
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
-
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (node.visited || is_equal(_short_path_data[i].distance_cm, FLT_MAX)) {
-            // if node is already visited OR cannot be reached yet, we can't use it
-            continue;
-        }
-        // figure out the pos of this node
-        Vector2f node_pos;
-        float dist_with_heuristics = FLT_MAX;
-        if (convert_node_to_point(node.id, node_pos)) {
-            // heuristics is is simple Euclidean distance from the node to the destination
-            // This should be admissible, therefore optimal path is guaranteed
-            const float heuristics = (node_pos-_path_destination).length();
-            dist_with_heuristics = node.distance_cm + heuristics;
-        } else {
-            // shouldn't happen
-            return false;
-        }
-        if (dist_with_heuristics < lowest_dist) {
-            // for NOW, this is the closest node
-            lowest_idx = i;
-            lowest_dist = dist_with_heuristics;
-        }
-    }
-
-    if (lowest_dist < FLT_MAX) {
-        // found the closest node
-        node_idx = lowest_idx;
-        return true;
-    }
-    return false;
-}
-
 // calculate shortest path from origin to destination
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run: create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin, create_polygon_fence_visgraph
@@ -890,105 +784,27 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         return false;
     }
 
-    // expand _short_path_data if necessary
-    if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
+    switch (_shortest_path.find(_fence_visgraph, _source_visgraph, _destination_visgraph, _path_source, _path_destination)) {
+    case AP_OAShortestPath::Result::SUCCESS:
+        return true;
+    case AP_OAShortestPath::Result::OUT_OF_MEMORY:
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
+    case AP_OAShortestPath::Result::NO_PATH:
+        break;
     }
-
-    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm) to short_path_data array
-    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0};
-    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
-    _short_path_data_numpoints = 2;
-
-    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm)
-    for (uint8_t i=0; i<total_numpoints(); i++) {
-        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
-    }
-
-    // start algorithm from source point
-    node_index current_node_idx = 0;
-
-    // update nodes visible from source point
-    for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
-        node_index node_idx;
-        if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
-            _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
-            _short_path_data[node_idx].distance_from_idx = current_node_idx;
-        } else {
-            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
-            return false;
-        }
-    }
-    // mark source node as visited
-    _short_path_data[current_node_idx].visited = true;
-
-    // move current_node_idx to node with lowest distance
-    while (find_closest_node_idx(current_node_idx)) {
-        node_index dest_node;
-        // See if this next "closest" node is actually the destination
-        if (find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, dest_node) && current_node_idx == dest_node) {
-            // We have discovered destination.. Don't bother with the rest of the graph
-            break;
-        }
-        // update distances to all neighbours of current node
-        update_visible_node_distances(current_node_idx);
-
-        // mark current node as visited
-        _short_path_data[current_node_idx].visited = true;
-    }
-
-    // extract path starting from destination
-    bool success = false;
-    node_index nidx;
-    if (!find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, nidx)) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
-        return false;
-    }
-    _path_numpoints = 0;
-    while (true) {
-        if (!_path.expand_to_hold(_path_numpoints + 1)) {
-            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-            return false;
-        }
-        // fail if newest node has invalid distance_from_index
-        if ((_short_path_data[nidx].distance_from_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) ||
-            (_short_path_data[nidx].distance_cm >= FLT_MAX)) {
-            break;
-        } else {
-            // add node's id to path array
-            _path[_path_numpoints] = _short_path_data[nidx].id;
-            _path_numpoints++;
-
-            // we are done if node is the source
-            if (_short_path_data[nidx].id.id_type == AP_OAVisGraph::OATYPE_SOURCE) {
-                success = true;
-                break;
-            } else {
-                // follow node's "distance_from_idx" to previous node on path
-                nidx = _short_path_data[nidx].distance_from_idx;
-            }
-        }
-    }
-    // report error in case path not found
-    if (!success) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
-    }
-
-    return success;
+    err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
+    return false;
 }
 
 // return point from final path as an offset (in cm) from the ekf origin
 bool AP_OADijkstra::get_shortest_path_point(uint8_t point_num, Vector2f& pos) const
 {
-    if ((_path_numpoints == 0) || (point_num >= _path_numpoints)) {
+    if (point_num >= _shortest_path.get_num_path_points()) {
         return false;
     }
 
-    // get id from path
-    AP_OAVisGraph::OAItemID id = _path[_path_numpoints - point_num - 1];
-
-    return convert_node_to_point(id, pos);
+    return convert_node_to_point(_shortest_path.get_path_id(point_num), pos);
 }
 
 // find the position of a node as an offset (in cm) from the ekf origin
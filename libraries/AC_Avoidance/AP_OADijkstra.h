@@ -4,6 +4,7 @@
 #include <AP_Common/Location.h>
 #include <AP_Math/AP_Math.h>
 #include "AP_OAVisGraph.h"
+#include "AP_OAShortestPath.h"
 #include <AP_Logger/AP_Logger_config.h>
 
 /*
@@ -158,42 +159,21 @@ private:
     AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
     AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
 
+    // search for the shortest path through the visgraphs
+    AP_OAShortestPath _shortest_path;
+
     // updates visibility graph for a given position which is an offset (in cm) from the ekf origin
     // to add an additional position (i.e. the destination) set add_extra_position = true and provide the position in the extra_position argument
     // requires create_polygon_fence_with_margin to have been run
     // returns true on success
     bool update_visgraph(AP_OAVisGraph& visgraph, const AP_OAVisGraph::OAItemID& oaid, const Vector2f &position, bool add_extra_position = false, Vector2f extra_position = Vector2f(0,0));
 
-    typedef uint8_t node_index;         // indices into short path data
-    struct ShortPathNode {
-        AP_OAVisGraph::OAItemID id;     // unique id for node (combination of type and id number)
-        bool visited;                   // true if all this node's neighbour's distances have been updated
-        node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
-        float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
-    };
-    AP_ExpandingArray<ShortPathNode> _short_path_data;
-    node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
-
-    // update total distance for all nodes visible from current node
-    // curr_node_idx is an index into the _short_path_data array
-    void update_visible_node_distances(node_index curr_node_idx);
-
-    // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
-    // returns true if successful and node_idx is updated
-    bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
-
-    // find index of node with lowest tentative distance (ignore visited nodes)
-    // returns true if successful and node_idx argument is updated
-    bool find_closest_node_idx(node_index &node_idx) const;
-
     // final path variables and functions
-    AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;   // ids of points on return path in reverse order (i.e. destination is first element)
-    uint8_t _path_numpoints;                            // number of points on return path
     Vector2f _path_source;                              // source point used in shortest path calculations (offset in cm from EKF origin)
     Vector2f _path_destination;                         // destination position used in shortest path calculations (offset in cm from EKF origin)
 
     // return number of points on path
-    uint8_t get_shortest_path_numpoints() const { return _path_numpoints; }
+    uint8_t get_shortest_path_numpoints() const { return _shortest_path.get_num_path_points(); }
 
     // return point from final path as an offset (in cm) from the ekf origin
     bool get_shortest_path_point(uint8_t point_num, Vector2f& pos) const;
@@ -0,0 +1,115 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_OAMarginGrid.h"
+
+const uint16_t OA_MARGIN_GRID_NODES_MAX = 4096;     // 16k of floats
+const float OA_MARGIN_GRID_CELL_GROWTH = 1.1f;      // cell size is increased by this ratio until the grid fits
+
+// allocate a grid covering min_cm to max_cm (offsets from EKF origin) with cells of at least cell_size_cm.
+// cells are made larger if needed to keep the grid within OA_MARGIN_GRID_NODES_MAX nodes
+// returns false if memory could not be allocated
+bool AP_OAMarginGrid::init(const Vector2f &min_cm, const Vector2f &max_cm, float cell_size_cm)
+{
+    clear();
+
+    if (!is_positive(cell_size_cm) || (max_cm.x < min_cm.x) || (max_cm.y < min_cm.y)) {
+        return false;
+    }
+
+    // at least two nodes in each direction so every point has a cell to interpolate within
+    const Vector2f size_cm = max_cm - min_cm;
+    uint32_t rows, cols;
+    while (true) {
+        rows = MAX(ceilf(size_cm.x / cell_size_cm) + 1, 2);
+        cols = MAX(ceilf(size_cm.y / cell_size_cm) + 1, 2);
+        if (rows * cols <= OA_MARGIN_GRID_NODES_MAX) {
+            break;
+        }
+        cell_size_cm *= OA_MARGIN_GRID_CELL_GROWTH;
+    }
+
+    _nodes = new float[rows * cols];
+    if (_nodes == nullptr) {
+        return false;
+    }
+    _num_rows = rows;
+    _num_cols = cols;
+    _origin_cm = min_cm;
+    _cell_size_cm = cell_size_cm;
+    return true;
+}
+
+// free the grid
+void AP_OAMarginGrid::clear()
+{
+    delete[] _nodes;
+    _nodes = nullptr;
+    _num_rows = 0;
+    _num_cols = 0;
+    _ready = false;
+}
+
+// position of a node as an offset from the EKF origin in cm
+Vector2f AP_OAMarginGrid::node_position(uint16_t row, uint16_t col) const
+{
+    return _origin_cm + Vector2f{row * _cell_size_cm, col * _cell_size_cm};
+}
+
+// calculate a lower bound in meters on the signed distance of every point on a segment
+// returns false if the grid is not ready or the segment leaves the grid
+bool AP_OAMarginGrid::segment_lower_bound(const Vector2f &start_cm, const Vector2f &end_cm, float &dist_m) const
+{
+    if (!_ready) {
+        return false;
+    }
+
+    // the grid is a rectangle so the segment is within it if both ends are
+    const Vector2f max_cm = node_position(_num_rows - 1, _num_cols - 1);
+    if ((MIN(start_cm.x, end_cm.x) < _origin_cm.x) || (MAX(start_cm.x, end_cm.x) > max_cm.x) ||
+        (MIN(start_cm.y, end_cm.y) < _origin_cm.y) || (MAX(start_cm.y, end_cm.y) > max_cm.y)) {
+        return false;
+    }
+
+    // sample the segment at least once per cell
+    const Vector2f delta_cm = end_cm - start_cm;
+    const float length_cm = delta_cm.length();
+    const uint16_t steps = MAX(ceilf(length_cm / _cell_size_cm), 1);
+    float lowest_m = FLT_MAX;
+    for (uint16_t i = 0; i <= steps; i++) {
+        lowest_m = MIN(lowest_m, interpolate(start_cm + delta_cm * (float(i) / steps)));
+    }
+
+    // the distance to the fence changes by no more than the distance moved, so every point
+    // on the segment is at most half a step closer to the fence than the nearest sample,
+    // and each sample is at most a cell diagonal closer than the nodes it was interpolated from
+    dist_m = lowest_m - (0.5f * length_cm / steps + M_SQRT2 * _cell_size_cm) * 0.01f;
+    return true;
+}
+
+// bilinear interpolation of the nodes around pos_cm which must be within the grid
+float AP_OAMarginGrid::interpolate(const Vector2f &pos_cm) const
+{
+    const float fx = (pos_cm.x - _origin_cm.x) / _cell_size_cm;
+    const float fy = (pos_cm.y - _origin_cm.y) / _cell_size_cm;
+    const uint16_t row = MIN(uint16_t(fx), _num_rows - 2);
+    const uint16_t col = MIN(uint16_t(fy), _num_cols - 2);
+    const float tx = fx - row;
+    const float ty = fy - col;
+
+    const float *n0 = &_nodes[row * _num_cols + col];
+    const float *n1 = n0 + _num_cols;
+    return (n0[0] * (1 - ty) + n0[1] * ty) * (1 - tx) + (n1[0] * (1 - ty) + n1[1] * ty) * tx;
+}
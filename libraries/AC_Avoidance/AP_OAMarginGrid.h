@@ -0,0 +1,54 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+ * Coarse grid of signed distances from the fence, positive where the vehicle is allowed to be.
+ * Used by BendyRuler to find paths that are well clear of the fence without checking every fence edge
+ */
+class AP_OAMarginGrid {
+public:
+    AP_OAMarginGrid() {}
+    ~AP_OAMarginGrid() { clear(); }
+
+    CLASS_NO_COPY(AP_OAMarginGrid);  /* Do not allow copies */
+
+    // allocate a grid covering min_cm to max_cm (offsets from EKF origin) with cells of at least cell_size_cm.
+    // cells are made larger if needed to keep the grid within OA_MARGIN_GRID_NODES_MAX nodes
+    // returns false if memory could not be allocated
+    bool init(const Vector2f &min_cm, const Vector2f &max_cm, float cell_size_cm);
+
+    // free the grid
+    void clear();
+
+    // number of rows (north) and columns (east) of nodes
+    uint16_t num_rows() const { return _num_rows; }
+    uint16_t num_cols() const { return _num_cols; }
+
+    // position of a node as an offset from the EKF origin in cm
+    Vector2f node_position(uint16_t row, uint16_t col) const;
+
+    // set the signed distance in meters at a node
+    void set_node(uint16_t row, uint16_t col, float dist_m) { _nodes[row * _num_cols + col] = dist_m; }
+
+    // mark the grid as complete, queries fail until this is called
+    void set_ready() { _ready = true; }
+    bool ready() const { return _ready; }
+
+    // calculate a lower bound in meters on the signed distance of every point on a segment
+    // returns false if the grid is not ready or the segment leaves the grid
+    bool segment_lower_bound(const Vector2f &start_cm, const Vector2f &end_cm, float &dist_m) const;
+
+private:
+
+    // bilinear interpolation of the nodes around pos_cm which must be within the grid
+    float interpolate(const Vector2f &pos_cm) const;
+
+    float *_nodes = nullptr;    // signed distance in meters at each node, stored row by row
+    uint16_t _num_rows = 0;
+    uint16_t _num_cols = 0;
+    Vector2f _origin_cm;        // position of the first node
+    float _cell_size_cm = 0;
+    bool _ready = false;
+};
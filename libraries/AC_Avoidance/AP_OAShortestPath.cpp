@@ -0,0 +1,346 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_OAShortestPath.h"
+
+#define OA_SHORTEST_PATH_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK 32   // expanding arrays for nodes and paths grow in increments of 32 elements
+#define OA_SHORTEST_PATH_FENCE_ADJ_ELEMENTS_PER_CHUNK      128  // fence point adjacency lists hold two elements per visgraph item
+#define OA_SHORTEST_PATH_NOTSET_IDX                        255  // index use to indicate we do not have a tentative short path for a node
+
+/// Constructor
+AP_OAShortestPath::AP_OAShortestPath() :
+        _short_path_data(OA_SHORTEST_PATH_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _points(OA_SHORTEST_PATH_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _fence_adj(OA_SHORTEST_PATH_FENCE_ADJ_ELEMENTS_PER_CHUNK),
+        _fence_adj_start(OA_SHORTEST_PATH_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _open_set(OA_SHORTEST_PATH_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _path(OA_SHORTEST_PATH_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
+{
+}
+
+// set the fence points and the visibility graph between them
+// lists of the fence points visible from each fence point are built from fence_visgraph
+// so the search can visit a point's neighbours without searching the whole visgraph
+// returns false if there are too many points or out of memory
+bool AP_OAShortestPath::set_fence(const AP_OAVisGraph &fence_visgraph, uint16_t num_points)
+{
+    _num_points = 0;
+    const uint16_t num_items = fence_visgraph.num_items();
+    if ((num_points > MAX_POINTS) || (num_items > UINT16_MAX / 2) ||
+        !_points.expand_to_hold(num_points) ||
+        !_fence_adj_start.expand_to_hold(num_points + 1) ||
+        !_fence_adj.expand_to_hold(num_items * 2)) {
+        return false;
+    }
+
+    // count the items involving each point
+    for (uint16_t i = 0; i <= num_points; i++) {
+        _fence_adj_start[i] = 0;
+    }
+    for (uint16_t i = 0; i < num_items; i++) {
+        _fence_adj_start[fence_visgraph[i].id1.id_num]++;
+        _fence_adj_start[fence_visgraph[i].id2.id_num]++;
+    }
+
+    // convert counts to the index of the end of each point's list
+    uint16_t total = 0;
+    for (uint16_t i = 0; i <= num_points; i++) {
+        total += _fence_adj_start[i];
+        _fence_adj_start[i] = total;
+    }
+
+    // fill lists from the end, leaving _fence_adj_start at the start of each list
+    for (uint16_t i = num_items; i > 0; i--) {
+        const AP_OAVisGraph::VisGraphItem &item = fence_visgraph[i-1];
+        _fence_adj[--_fence_adj_start[item.id1.id_num]] = i-1;
+        _fence_adj[--_fence_adj_start[item.id2.id_num]] = i-1;
+    }
+
+    _num_points = num_points;
+    return true;
+}
+
+// update total distance for all nodes visible from current node
+// curr_node_idx is an index into the _short_path_data array
+void AP_OAShortestPath::update_visible_node_distances(const AP_OAVisGraph &fence_visgraph, node_index curr_node_idx)
+{
+    // sanity check
+    if (curr_node_idx >= _short_path_data_numpoints) {
+        return;
+    }
+
+    // get current node for convenience
+    const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
+
+    // only fence points are searched from here, the source's neighbours
+    // are added at the start of the search and the search ends at the destination
+    if (curr_node.id.id_type != AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT) {
+        return;
+    }
+
+    // update fence points visible from the current node
+    const uint16_t adj_end = _fence_adj_start[curr_node.id.id_num + 1];
+    for (uint16_t i = _fence_adj_start[curr_node.id.id_num]; i < adj_end; i++) {
+        const AP_OAVisGraph::VisGraphItem &item = fence_visgraph[_fence_adj[i]];
+        const AP_OAVisGraph::OAItemID &matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
+        node_index item_node_idx;
+        if (find_node_from_id(matching_id, item_node_idx)) {
+            update_node_distance(curr_node_idx, item_node_idx, item.distance_cm);
+        }
+    }
+
+    // update destination if visible from the current node
+    if (curr_node.dist_to_dest_cm < FLT_MAX) {
+        node_index dest_node_idx;
+        if (find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION, 0}, dest_node_idx)) {
+            update_node_distance(curr_node_idx, dest_node_idx, curr_node.dist_to_dest_cm);
+        }
+    }
+}
+
+// update a node's distance if it is shorter via the current node
+void AP_OAShortestPath::update_node_distance(node_index curr_node_idx, node_index node_idx, float distance_cm)
+{
+    ShortPathNode &node = _short_path_data[node_idx];
+    if (node.visited) {
+        return;
+    }
+    // if current node's distance + distance to item is less than item's current distance, update item's distance
+    const float dist_via_current_node = _short_path_data[curr_node_idx].distance_cm + distance_cm;
+    if (dist_via_current_node < node.distance_cm) {
+        // update item's distance and set "distance_from_idx" to current node's index
+        node.distance_cm = dist_via_current_node;
+        node.distance_from_idx = curr_node_idx;
+        open_set_update(node_idx);
+    }
+}
+
+// find a node's index into _short_path_data array from it's id (i.e. id type and id number)
+// returns true if successful and node_idx is updated
+bool AP_OAShortestPath::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const
+{
+    switch (id.id_type) {
+    case AP_OAVisGraph::OATYPE_SOURCE:
+        // source node is always the first node
+        if (_short_path_data_numpoints > 0) {
+            node_idx = 0;
+            return true;
+        }
+        break;
+    case AP_OAVisGraph::OATYPE_DESTINATION:
+        // destination is always the 2nd node
+        if (_short_path_data_numpoints > 1) {
+            node_idx = 1;
+            return true;
+        }
+        break;
+    case AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT:
+        // intermediate nodes start from 3rd node
+        if (_short_path_data_numpoints > id.id_num + 2) {
+            node_idx = id.id_num + 2;
+            return true;
+        }
+        break;
+    }
+
+    // could not find node
+    return false;
+}
+
+// return distance plus heuristic for a node in the open set
+float AP_OAShortestPath::open_set_cost(node_index heap_idx) const
+{
+    const ShortPathNode &node = _short_path_data[_open_set[heap_idx]];
+    return node.distance_cm + node.heuristic_cm;
+}
+
+// swap two elements of the open set
+void AP_OAShortestPath::open_set_swap(node_index heap_idx1, node_index heap_idx2)
+{
+    const node_index node_idx1 = _open_set[heap_idx1];
+    const node_index node_idx2 = _open_set[heap_idx2];
+    _open_set[heap_idx1] = node_idx2;
+    _open_set[heap_idx2] = node_idx1;
+    _short_path_data[node_idx1].open_set_idx = heap_idx2;
+    _short_path_data[node_idx2].open_set_idx = heap_idx1;
+}
+
+// add a node to the open set, or move it if its distance has decreased
+void AP_OAShortestPath::open_set_update(node_index node_idx)
+{
+    node_index heap_idx = _short_path_data[node_idx].open_set_idx;
+    if (heap_idx == OA_SHORTEST_PATH_NOTSET_IDX) {
+        heap_idx = _open_set_numpoints++;
+        _open_set[heap_idx] = node_idx;
+        _short_path_data[node_idx].open_set_idx = heap_idx;
+    }
+
+    // distances only decrease so the node can only move towards the top of the heap
+    while (heap_idx > 0) {
+        const node_index parent_idx = (heap_idx - 1) / 2;
+        if (open_set_cost(parent_idx) <= open_set_cost(heap_idx)) {
+            break;
+        }
+        open_set_swap(parent_idx, heap_idx);
+        heap_idx = parent_idx;
+    }
+}
+
+// remove the node with lowest distance plus heuristic from the open set
+// heuristic is simple Euclidean distance from the node to the destination
+// This should be admissible, therefore optimal path is guaranteed
+// returns true if successful and node_idx argument is updated
+bool AP_OAShortestPath::open_set_pop(node_index &node_idx)
+{
+    if (_open_set_numpoints == 0) {
+        return false;
+    }
+    node_idx = _open_set[0];
+    _short_path_data[node_idx].open_set_idx = OA_SHORTEST_PATH_NOTSET_IDX;
+    _open_set_numpoints--;
+    if (_open_set_numpoints == 0) {
+        return true;
+    }
+
+    // move the last node to the top and then down to its place
+    _open_set[0] = _open_set[_open_set_numpoints];
+    _short_path_data[_open_set[0]].open_set_idx = 0;
+    uint16_t heap_idx = 0;
+    while (true) {
+        const uint16_t left_idx = heap_idx * 2 + 1;
+        const uint16_t right_idx = left_idx + 1;
+        uint16_t lowest_idx = heap_idx;
+        if ((left_idx < _open_set_numpoints) && (open_set_cost(left_idx) < open_set_cost(lowest_idx))) {
+            lowest_idx = left_idx;
+        }
+        if ((right_idx < _open_set_numpoints) && (open_set_cost(right_idx) < open_set_cost(lowest_idx))) {
+            lowest_idx = right_idx;
+        }
+        if (lowest_idx == heap_idx) {
+            break;
+        }
+        open_set_swap(heap_idx, lowest_idx);
+        heap_idx = lowest_idx;
+    }
+    return true;
+}
+
+// find the shortest path from source to destination
+// source_visgraph holds the fence points and destination visible from the source
+// destination_visgraph holds the fence points visible from the destination
+AP_OAShortestPath::Result AP_OAShortestPath::find(const AP_OAVisGraph &fence_visgraph,
+                                                  const AP_OAVisGraph &source_visgraph,
+                                                  const AP_OAVisGraph &destination_visgraph,
+                                                  const Vector2f &source, const Vector2f &destination)
+{
+    _path_numpoints = 0;
+
+    // expand _short_path_data and _open_set if necessary
+    if (!_short_path_data.expand_to_hold(2 + _num_points) ||
+        !_open_set.expand_to_hold(2 + _num_points)) {
+        return Result::OUT_OF_MEMORY;
+    }
+
+    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm, heuristic_cm, dist_to_dest_cm, open_set_idx) to short_path_data array
+    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0, (source - destination).length(), FLT_MAX, OA_SHORTEST_PATH_NOTSET_IDX};
+    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_SHORTEST_PATH_NOTSET_IDX, FLT_MAX, 0, FLT_MAX, OA_SHORTEST_PATH_NOTSET_IDX};
+    _short_path_data_numpoints = 2;
+
+    // add all inclusion and exclusion fence points to short_path_data array
+    for (uint8_t i=0; i<_num_points; i++) {
+        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_SHORTEST_PATH_NOTSET_IDX, FLT_MAX, (_points[i] - destination).length(), FLT_MAX, OA_SHORTEST_PATH_NOTSET_IDX};
+    }
+
+    // record distance to destination for nodes that can see it
+    for (uint16_t i = 0; i < destination_visgraph.num_items(); i++) {
+        node_index node_idx;
+        if (find_node_from_id(destination_visgraph[i].id2, node_idx)) {
+            _short_path_data[node_idx].dist_to_dest_cm = destination_visgraph[i].distance_cm;
+        }
+    }
+
+    // start algorithm from source point
+    _open_set_numpoints = 0;
+    node_index current_node_idx = 0;
+
+    // mark source node as visited
+    _short_path_data[current_node_idx].visited = true;
+
+    // update nodes visible from source point
+    for (uint16_t i = 0; i < source_visgraph.num_items(); i++) {
+        node_index node_idx;
+        if (find_node_from_id(source_visgraph[i].id2, node_idx)) {
+            update_node_distance(current_node_idx, node_idx, source_visgraph[i].distance_cm);
+        } else {
+            return Result::NO_PATH;
+        }
+    }
+
+    // move current_node_idx to node with lowest distance plus heuristic
+    node_index dest_node;
+    if (!find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, dest_node)) {
+        return Result::NO_PATH;
+    }
+    while (open_set_pop(current_node_idx)) {
+        // See if this next "closest" node is actually the destination
+        if (current_node_idx == dest_node) {
+            // We have discovered destination.. Don't bother with the rest of the graph
+            break;
+        }
+        // mark current node as visited
+        _short_path_data[current_node_idx].visited = true;
+
+        // update distances to all neighbours of current node
+        update_visible_node_distances(fence_visgraph, current_node_idx);
+    }
+
+    // extract path starting from destination
+    bool success = false;
+    node_index nidx;
+    if (!find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, nidx)) {
+        return Result::NO_PATH;
+    }
+    _path_numpoints = 0;
+    while (true) {
+        if (!_path.expand_to_hold(_path_numpoints + 1)) {
+            _path_numpoints = 0;
+            return Result::OUT_OF_MEMORY;
+        }
+        // fail if newest node has invalid distance_from_index
+        if ((_short_path_data[nidx].distance_from_idx == OA_SHORTEST_PATH_NOTSET_IDX) ||
+            (_short_path_data[nidx].distance_cm >= FLT_MAX)) {
+            break;
+        } else {
+            // add node's id to path array
+            _path[_path_numpoints] = _short_path_data[nidx].id;
+            _path_numpoints++;
+
+            // we are done if node is the source
+            if (_short_path_data[nidx].id.id_type == AP_OAVisGraph::OATYPE_SOURCE) {
+                success = true;
+                break;
+            } else {
+                // follow node's "distance_from_idx" to previous node on path
+                nidx = _short_path_data[nidx].distance_from_idx;
+            }
+        }
+    }
+    if (!success) {
+        _path_numpoints = 0;
+        return Result::NO_PATH;
+    }
+
+    return Result::SUCCESS;
+}
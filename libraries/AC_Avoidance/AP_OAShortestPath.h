@@ -0,0 +1,103 @@
+#pragma once
+
+#include <AP_Common/AP_Common.h>
+#include <AP_Common/AP_ExpandingArray.h>
+#include <AP_Math/AP_Math.h>
+#include "AP_OAVisGraph.h"
+
+/*
+ * A* search for the shortest path from a source to a destination through
+ * fence points, given visibility graphs between the fence points and
+ * from the source and destination to them
+ */
+class AP_OAShortestPath {
+public:
+
+    AP_OAShortestPath();
+
+    CLASS_NO_COPY(AP_OAShortestPath);  /* Do not allow copies */
+
+    // maximum number of fence points, leaving node indices for the source and destination
+    static const uint8_t MAX_POINTS = 252;
+
+    // set the fence points and the visibility graph between them
+    // fence_visgraph must only hold OATYPE_INTERMEDIATE_POINT items and must be
+    // passed unchanged to find() until set_fence is called again
+    // returns false if there are too many points or out of memory
+    bool set_fence(const AP_OAVisGraph &fence_visgraph, uint16_t num_points);
+
+    // set the position of a fence point as an offset (in cm) from the ekf origin
+    void set_point(uint8_t index, const Vector2f &pos) { _points[index] = pos; }
+
+    enum class Result : uint8_t {
+        SUCCESS = 0,
+        OUT_OF_MEMORY,
+        NO_PATH,
+    };
+
+    // find the shortest path from source to destination
+    // source_visgraph holds the fence points and destination visible from the source
+    // destination_visgraph holds the fence points visible from the destination
+    Result find(const AP_OAVisGraph &fence_visgraph,
+                const AP_OAVisGraph &source_visgraph,
+                const AP_OAVisGraph &destination_visgraph,
+                const Vector2f &source, const Vector2f &destination);
+
+    // number of points on the path found, including the source and destination
+    uint8_t get_num_path_points() const { return _path_numpoints; }
+
+    // id of a point on the path found, with point 0 being the source
+    const AP_OAVisGraph::OAItemID &get_path_id(uint8_t point_num) const { return _path[_path_numpoints - point_num - 1]; }
+
+private:
+
+    typedef uint8_t node_index;         // indices into short path data
+    struct ShortPathNode {
+        AP_OAVisGraph::OAItemID id;     // unique id for node (combination of type and id number)
+        bool visited;                   // true if all this node's neighbour's distances have been updated
+        node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
+        float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
+        float heuristic_cm;             // straight line distance to destination
+        float dist_to_dest_cm;          // distance to destination if visible, FLT_MAX if not
+        node_index open_set_idx;        // index into _open_set (or 255 if not in open set)
+    };
+    AP_ExpandingArray<ShortPathNode> _short_path_data;
+    node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
+
+    // fence point positions and lists of the fence visgraph items involving each fence point
+    AP_ExpandingArray<Vector2f> _points;
+    uint16_t _num_points;
+    AP_ExpandingArray<uint16_t> _fence_adj;         // indices into fence visgraph grouped by fence point
+    AP_ExpandingArray<uint16_t> _fence_adj_start;   // index into _fence_adj of first item for each fence point, with an extra element for the end of the last
+
+    // update total distance for all nodes visible from current node
+    // curr_node_idx is an index into the _short_path_data array
+    void update_visible_node_distances(const AP_OAVisGraph &fence_visgraph, node_index curr_node_idx);
+
+    // update a node's distance if it is shorter via the current node
+    void update_node_distance(node_index curr_node_idx, node_index node_idx, float distance_cm);
+
+    // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
+    // returns true if successful and node_idx is updated
+    bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
+
+    // open set of nodes to be visited, as a binary heap ordered by
+    // distance from source plus heuristic
+    AP_ExpandingArray<node_index> _open_set;
+    node_index _open_set_numpoints;     // number of elements in _open_set array
+
+    // add a node to the open set, or move it if its distance has decreased
+    void open_set_update(node_index node_idx);
+
+    // remove the node with lowest distance plus heuristic from the open set
+    // returns true if successful and node_idx argument is updated
+    bool open_set_pop(node_index &node_idx);
+
+    // return distance plus heuristic for a node in the open set
+    float open_set_cost(node_index heap_idx) const;
+    void open_set_swap(node_index heap_idx1, node_index heap_idx2);
+
+    // ids of points on the path in reverse order (i.e. destination is first element)
+    AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;
+    uint8_t _path_numpoints;
+};
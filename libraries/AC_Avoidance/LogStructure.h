@@ -6,7 +6,8 @@
     LOG_OA_BENDYRULER_MSG, \
     LOG_OA_DIJKSTRA_MSG, \
     LOG_SIMPLE_AVOID_MSG, \
-    LOG_OD_VISGRAPH_MSG
+    LOG_OD_VISGRAPH_MSG, \
+    LOG_OA_DATABASE_MSG
 
 // @LoggerMessage: OABR
 // @Description: Object avoidance (Bendy Ruler) diagnostics
@@ -24,6 +25,7 @@
 // @Field: OLt: Intermediate location chosen for avoidance
 // @Field: OLg: Intermediate location chosen for avoidance
 // @Field: OAlt: Intermediate alt chosen for avoidance above EKF origin
+// @Field: UT: Time taken by this BendyRuler update
 struct PACKED log_OABendyRuler {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -40,6 +42,7 @@ struct PACKED log_OABendyRuler {
     int32_t oa_lat;
     int32_t oa_lng;
     int32_t oa_alt;
+    uint32_t update_us;
 };
 
 // @LoggerMessage: OADJ
@@ -106,12 +109,32 @@ struct PACKED log_OD_Visgraph {
   int32_t Lon;
 };
 
+// @LoggerMessage: OADB
+// @Description: Object avoidance database processing
+// @Field: TimeUS: Time since system startup
+// @Field: Count: number of objects in the database
+// @Field: Proc: number of proximity points processed from the queue since last message
+// @Field: Cmp: number of database objects compared with incoming points since last message
+// @Field: PrcT: time spent processing the queue since last message
+// @Field: RMax: largest object radius in the database
+struct PACKED log_OADatabase {
+  LOG_PACKET_HEADER;
+  uint64_t time_us;
+  uint16_t count;
+  uint16_t processed;
+  uint32_t compared;
+  uint32_t process_us;
+  float radius_max;
+};
+
 #define LOG_STRUCTURE_FROM_AVOIDANCE \
     { LOG_OA_BENDYRULER_MSG, sizeof(log_OABendyRuler), \
-      "OABR","QBBHHHBfLLiLLi","TimeUS,Type,Act,DYaw,Yaw,DP,RChg,Mar,DLt,DLg,DAlt,OLt,OLg,OAlt", "s--ddd-mDUmDUm", "F-------GGBGGB" , true }, \
+      "OABR","QBBHHHBfLLiLLiI","TimeUS,Type,Act,DYaw,Yaw,DP,RChg,Mar,DLt,DLg,DAlt,OLt,OLg,OAlt,UT", "s--ddd-mDUmDUms", "F-------GGBGGBF" , true }, \
     { LOG_OA_DIJKSTRA_MSG, sizeof(log_OADijkstra), \
       "OADJ","QBBBBLLLL","TimeUS,State,Err,CurrPoint,TotPoints,DLat,DLng,OALat,OALng", "s----DUDU", "F----GGGG" , true }, \
     { LOG_SIMPLE_AVOID_MSG, sizeof(log_SimpleAvoid), \
       "SA",  "QBffffffB","TimeUS,State,DVelX,DVelY,DVelZ,MVelX,MVelY,MVelZ,Back", "s-nnnnnn-", "F--------", true }, \
      { LOG_OD_VISGRAPH_MSG, sizeof(log_OD_Visgraph), \
-      "OAVG", "QBBLL", "TimeUS,version,point_num,Lat,Lon", "s--DU", "F--GG", true},
+      "OAVG", "QBBLL", "TimeUS,version,point_num,Lat,Lon", "s--DU", "F--GG", true}, \
+    { LOG_OA_DATABASE_MSG, sizeof(log_OADatabase), \
+      "OADB", "QHHIIf", "TimeUS,Count,Proc,Cmp,PrcT,RMax", "s---sm", "F---F-", true},
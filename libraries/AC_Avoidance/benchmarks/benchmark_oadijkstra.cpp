@@ -0,0 +1,121 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_Avoidance/AP_OAShortestPath.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  synthetic fence made of a square grid of square exclusion polygons,
+  with the source below and left of the grid and the destination above
+  and right of it so the path must weave between the polygons
+ */
+class OAShortestPath_Benchmark {
+public:
+    OAShortestPath_Benchmark(uint8_t grid_size) :
+        _grid_size(grid_size),
+        _num_points(0)
+    {
+        const float spacing_cm = 3000;
+        const float half_side_cm = 500;
+        const float margin_cm = 200;
+        const Vector2f corners[4] {{-1, -1}, {1, -1}, {1, 1}, {-1, 1}};
+
+        // create fence polygons and the points around them plus a margin
+        for (uint8_t i = 0; i < _grid_size; i++) {
+            for (uint8_t j = 0; j < _grid_size; j++) {
+                const Vector2f centre{i * spacing_cm, j * spacing_cm};
+                Vector2f *polygon = _polygons[i * _grid_size + j];
+                for (uint8_t k = 0; k < 4; k++) {
+                    polygon[k] = centre + corners[k] * half_side_cm;
+                    _points[_num_points++] = centre + corners[k] * (half_side_cm + margin_cm);
+                }
+            }
+        }
+
+        // create fence visgraph
+        for (uint8_t i = 0; i < _num_points; i++) {
+            for (uint8_t j = i + 1; j < _num_points; j++) {
+                if (!intersects(_points[i], _points[j])) {
+                    _fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
+                                             {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
+                                             (_points[i] - _points[j]).length());
+                }
+            }
+        }
+        _fence_ok = _shortest_path.set_fence(_fence_visgraph, _num_points);
+        for (uint8_t i = 0; i < _num_points; i++) {
+            _shortest_path.set_point(i, _points[i]);
+        }
+
+        // create source and destination visgraphs
+        const float far_cm = (_grid_size - 1) * spacing_cm + 2000;
+        _source = Vector2f{-2000, -2000};
+        _destination = Vector2f{far_cm, far_cm};
+        update_visgraph(_source_visgraph, {AP_OAVisGraph::OATYPE_SOURCE, 0}, _source, true);
+        update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, _destination, false);
+    }
+
+    bool find_shortest_path()
+    {
+        return _fence_ok &&
+               _shortest_path.find(_fence_visgraph, _source_visgraph, _destination_visgraph, _source, _destination) == AP_OAShortestPath::Result::SUCCESS;
+    }
+
+private:
+
+    // returns true if segment crosses any fence polygon
+    bool intersects(const Vector2f &start, const Vector2f &end) const
+    {
+        for (uint16_t i = 0; i < _grid_size * _grid_size; i++) {
+            Vector2f intersection;
+            if (Polygon_intersects(_polygons[i], 4, start, end, intersection)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void update_visgraph(AP_OAVisGraph &visgraph, const AP_OAVisGraph::OAItemID &oaid, const Vector2f &position, bool add_destination)
+    {
+        for (uint8_t i = 0; i < _num_points; i++) {
+            if (!intersects(position, _points[i])) {
+                visgraph.add_item(oaid, {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, (position - _points[i]).length());
+            }
+        }
+        if (add_destination && !intersects(position, _destination)) {
+            visgraph.add_item(oaid, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, (position - _destination).length());
+        }
+    }
+
+    uint8_t _grid_size;
+    Vector2f _polygons[64][4];
+    Vector2f _points[256];
+    uint8_t _num_points;
+    Vector2f _source;
+    Vector2f _destination;
+    AP_OAVisGraph _fence_visgraph;
+    AP_OAVisGraph _source_visgraph;
+    AP_OAVisGraph _destination_visgraph;
+    AP_OAShortestPath _shortest_path;
+    bool _fence_ok;
+};
+
+static void BM_OADijkstraShortestPath(benchmark::State &state)
+{
+    // AP_OAVisGraph doesn't initialise its item count, so rely on the zeroing
+    // operator new as AP_OAPathPlanner does when it allocates AP_OADijkstra
+    OAShortestPath_Benchmark *bench = new OAShortestPath_Benchmark(state.range(0));
+    while (state.KeepRunning()) {
+        gbenchmark_escape(bench);
+        if (!bench->find_shortest_path()) {
+            state.SkipWithError("no path found");
+            break;
+        }
+    }
+    delete bench;
+}
+
+// 3x3, 5x5 and 7x7 grids of squares, giving 36, 100 and 196 fence points
+BENCHMARK(BM_OADijkstraShortestPath)->Arg(3)->Arg(5)->Arg(7);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,147 @@
+#include <AP_gtest.h>
+#include <AP_Common/AP_Common.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AC_Avoidance/AP_OAMarginGrid.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// deterministic pseudo-random numbers so failures are repeatable
+static uint32_t margin_grid_seed = 1;
+static float margin_grid_rand(float lo, float hi)
+{
+    margin_grid_seed = margin_grid_seed * 1103515245U + 12345U;
+    return lo + (hi - lo) * ((margin_grid_seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+/*
+  a fence of one inclusion polygon with exclusion polygons inside it,
+  each a closed star shaped polygon with a jagged radius. Positions
+  are in cm
+ */
+struct MarginGridFence {
+    static const uint8_t MAX_POLYGONS = 4;
+    static const uint8_t MAX_POINTS = 20;
+    Vector2f polygons[MAX_POLYGONS][MAX_POINTS+1];
+    uint8_t num_points[MAX_POLYGONS];
+    uint8_t num_polygons;
+
+    void create()
+    {
+        num_polygons = 1 + uint8_t(margin_grid_rand(0, MAX_POLYGONS - 0.01f));
+        for (uint8_t p = 0; p < num_polygons; p++) {
+            // first polygon is the inclusion fence, the rest are exclusions within it
+            const Vector2f centre = (p == 0) ? Vector2f{} : Vector2f{margin_grid_rand(-4000, 4000), margin_grid_rand(-4000, 4000)};
+            const float radius = (p == 0) ? 15000 : margin_grid_rand(1000, 3000);
+            num_points[p] = uint8_t(margin_grid_rand(3, MAX_POINTS));
+            for (uint8_t i = 0; i < num_points[p]; i++) {
+                const float angle = radians(360.0f * i / num_points[p]);
+                const float r = radius * margin_grid_rand(0.5f, 1.0f);
+                polygons[p][i] = centre + Vector2f{r * cosf(angle), r * sinf(angle)};
+            }
+            polygons[p][num_points[p]] = polygons[p][0];
+        }
+    }
+
+    // signed distance in cm from a point to the fence, positive where the vehicle may be
+    float point_distance(const Vector2f &pos) const
+    {
+        float dist_min = FLT_MAX;
+        for (uint8_t p = 0; p < num_polygons; p++) {
+            const float dist = Polygon_closest_distance_point(polygons[p], num_points[p] + 1, pos);
+            const bool inside = !Polygon_outside(pos, polygons[p], num_points[p] + 1);
+            dist_min = MIN(dist_min, (inside == (p == 0)) ? dist : -dist);
+        }
+        return dist_min;
+    }
+
+    /*
+      least signed distance in cm of any point on a segment. This is
+      exact if the segment does not cross the fence. If it does the
+      least distance found by sampling along the segment is returned,
+      which is no less than the exact distance
+     */
+    float segment_distance(const Vector2f &start, const Vector2f &end) const
+    {
+        float dist_min = FLT_MAX;
+        for (uint8_t p = 0; p < num_polygons; p++) {
+            float dist_sq = FLT_MAX;
+            for (uint8_t i = 0; i < num_points[p]; i++) {
+                Vector2f intersection;
+                if (Vector2f::segment_intersection(start, end, polygons[p][i], polygons[p][i+1], intersection)) {
+                    return sampled_segment_distance(start, end);
+                }
+                dist_sq = MIN(dist_sq, Vector2f::closest_distance_between_lines_squared(polygons[p][i], polygons[p][i+1], start, end));
+            }
+            const bool inside = !Polygon_outside(start, polygons[p], num_points[p] + 1);
+            dist_min = MIN(dist_min, (inside == (p == 0)) ? sqrtf(dist_sq) : -sqrtf(dist_sq));
+        }
+        return dist_min;
+    }
+
+    float sampled_segment_distance(const Vector2f &start, const Vector2f &end) const
+    {
+        const uint16_t steps = 1000;
+        float dist_min = FLT_MAX;
+        for (uint16_t i = 0; i <= steps; i++) {
+            dist_min = MIN(dist_min, point_distance(start + (end - start) * (float(i) / steps)));
+        }
+        return dist_min;
+    }
+};
+
+/*
+  the margin grid's lower bound must never exceed the distance of the
+  segment from the fence, or BendyRuler could take a path that is
+  closer to the fence than OA_MARGIN_MAX without checking it
+ */
+TEST(AP_OAMarginGrid, segment_lower_bound)
+{
+    MarginGridFence fence;
+    AP_OAMarginGrid grid;
+    uint32_t num_checked = 0;
+    uint32_t num_clear = 0;
+
+    for (uint8_t f = 0; f < 20; f++) {
+        fence.create();
+        const float cell_size_cm = margin_grid_rand(100, 5000);
+        const Vector2f min_cm{-20000, -20000};
+        const Vector2f max_cm{20000, 20000};
+        EXPECT_TRUE(grid.init(min_cm, max_cm, cell_size_cm));
+        for (uint16_t row = 0; row < grid.num_rows(); row++) {
+            for (uint16_t col = 0; col < grid.num_cols(); col++) {
+                grid.set_node(row, col, fence.point_distance(grid.node_position(row, col)) * 0.01f);
+            }
+        }
+
+        // queries fail until the grid is complete
+        float dist_m;
+        EXPECT_FALSE(grid.segment_lower_bound(Vector2f{}, Vector2f{100, 100}, dist_m));
+        grid.set_ready();
+
+        // segments leaving the grid can't be bounded
+        EXPECT_FALSE(grid.segment_lower_bound(Vector2f{}, Vector2f{25000, 0}, dist_m));
+
+        for (uint16_t i = 0; i < 200; i++) {
+            const Vector2f start{margin_grid_rand(-18000, 18000), margin_grid_rand(-18000, 18000)};
+            const float length = margin_grid_rand(0, 3000);
+            const float angle = margin_grid_rand(0, M_2PI);
+            const Vector2f end = start + Vector2f{length * cosf(angle), length * sinf(angle)};
+            if (!grid.segment_lower_bound(start, end, dist_m)) {
+                continue;
+            }
+            const float exact_m = fence.segment_distance(start, end) * 0.01f;
+            // allow for float rounding of distances of up to a few hundred meters
+            EXPECT_LE(dist_m, exact_m + 0.01f);
+            num_checked++;
+            num_clear += (dist_m > 0) ? 1 : 0;
+        }
+    }
+
+    // make sure both clear paths and paths near the fence were tested
+    EXPECT_GT(num_checked, 3000U);
+    EXPECT_GT(num_clear, 50U);
+    EXPECT_LT(num_clear, num_checked - 50U);
+}
+
+AP_GTEST_MAIN()
@@ -15,3 +15,9 @@
 #ifndef AC_POLYFENCE_FENCE_POINT_PROTOCOL_SUPPORT
 #define AC_POLYFENCE_FENCE_POINT_PROTOCOL_SUPPORT HAL_GCS_ENABLED && AP_FENCE_ENABLED
 #endif
+
+// maximum number of edge bands indexed per fence polygon, 0 disables
+// the bands and only the bounding boxes are used
+#ifndef AC_POLYFENCE_EDGE_BANDS_MAX
+#define AC_POLYFENCE_EDGE_BANDS_MAX ((HAL_MEM_CLASS >= HAL_MEM_CLASS_500) ? 64 : 0)
+#endif
@@ -218,7 +218,7 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     // check we are inside each inclusion zone:
     for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
         const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        if (Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (boundary.index.outside(pos)) {
             num_inclusion_outside++;
         }
     }
@@ -226,7 +226,7 @@ bool AC_PolyFence_loader::breached(const Location& loc) const
     // check we are outside each exclusion zone:
     for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
         const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        if (!Polygon_outside(pos, boundary.points_lla, boundary.count)) {
+        if (!boundary.index.outside(pos)) {
             return true;
         }
     }
@@ -710,6 +710,9 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
+            if (!boundary.index.init(boundary.points_lla, boundary.count, 16, AC_POLYFENCE_EDGE_BANDS_MAX)) {
+                Debug("Fence: no edge bands for inc. fence");
+            }
             _num_loaded_inclusion_boundaries++;
             break;
         }
@@ -729,6 +732,18 @@ bool AC_PolyFence_loader::load_from_eeprom()
                 storage_valid = false;
                 break;
             }
+            if (!boundary.index.init(boundary.points_lla, boundary.count, 16, AC_POLYFENCE_EDGE_BANDS_MAX)) {
+                Debug("Fence: no edge bands for exc. fence");
+            }
+            boundary.bounds_min_cm = boundary.points[0];
+            boundary.bounds_max_cm = boundary.points[0];
+            for (uint8_t j=1; j<boundary.count; j++) {
+                const Vector2f &p = boundary.points[j];
+                boundary.bounds_min_cm.x = MIN(boundary.bounds_min_cm.x, p.x);
+                boundary.bounds_min_cm.y = MIN(boundary.bounds_min_cm.y, p.y);
+                boundary.bounds_max_cm.x = MAX(boundary.bounds_max_cm.x, p.x);
+                boundary.bounds_max_cm.y = MAX(boundary.bounds_max_cm.y, p.y);
+            }
             _num_loaded_exclusion_boundaries++;
             break;
         }
@@ -842,6 +857,19 @@ Vector2f* AC_PolyFence_loader::get_exclusion_polygon(uint16_t index, uint16_t &n
     return boundary.points;
 }
 
+/// fills in the bounding box of an exclusion polygon, returns false if there is no such polygon
+/// corners are offsets in cm from EKF origin in NE frame
+bool AC_PolyFence_loader::get_exclusion_polygon_bounds(uint16_t index, Vector2f &min_cm, Vector2f &max_cm) const
+{
+    if (index >= _num_loaded_exclusion_boundaries) {
+        return false;
+    }
+    const ExclusionBoundary &boundary = _loaded_exclusion_boundary[index];
+    min_cm = boundary.bounds_min_cm;
+    max_cm = boundary.bounds_max_cm;
+    return true;
+}
+
 /// returns pointer to array of inclusion polygon points and num_points is filled in with the number of points in the polygon
 /// points are offsets in cm from EKF origin in NE frame
 Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &num_points) const
@@ -1624,6 +1652,7 @@ void AC_PolyFence_loader::init() {};
 bool AC_PolyFence_loader::get_item(const uint16_t seq, AC_PolyFenceItem &item) { return false; }
 
 Vector2f* AC_PolyFence_loader::get_exclusion_polygon(uint16_t index, uint16_t &num_points) const { return nullptr; }
+bool AC_PolyFence_loader::get_exclusion_polygon_bounds(uint16_t index, Vector2f &min_cm, Vector2f &max_cm) const { return false; }
 Vector2f* AC_PolyFence_loader::get_inclusion_polygon(uint16_t index, uint16_t &num_points) const { return nullptr; }
 
 bool AC_PolyFence_loader::get_exclusion_circle(uint8_t index, Vector2f &center_pos_cm, float &radius) const { return false; }
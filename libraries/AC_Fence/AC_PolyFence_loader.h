@@ -70,6 +70,10 @@ public:
     /// points are offsets in cm from EKF origin in NE frame
     Vector2f* get_exclusion_polygon(uint16_t index, uint16_t &num_points) const;
 
+    /// fills in the bounding box of an exclusion polygon, returns false if there is no such polygon
+    /// corners are offsets in cm from EKF origin in NE frame
+    bool get_exclusion_polygon_bounds(uint16_t index, Vector2f &min_cm, Vector2f &max_cm) const;
+
     /// return system time of last update to the exclusion polygon points
     uint32_t get_exclusion_polygon_update_ms() const {
         return _load_time_ms;
@@ -282,6 +286,7 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla array
         uint8_t count; // count of points in the boundary
+        Polygon_index<int32_t> index; // index over points_lla for breach checks
     };
     InclusionBoundary *_loaded_inclusion_boundary;
 
@@ -292,6 +297,9 @@ private:
         Vector2f *points; // pointer into the _loaded_offsets_from_origin array
         Vector2l *points_lla; // pointer into the _loaded_points_lla_lla array
         uint8_t count; // count of points in the boundary
+        Polygon_index<int32_t> index; // index over points_lla for breach checks
+        Vector2f bounds_min_cm; // bounding box of points
+        Vector2f bounds_max_cm;
     };
     ExclusionBoundary *_loaded_exclusion_boundary;
 
@@ -26,6 +26,11 @@
 #include <AP_CANManager/AP_CANManager.h>
 #include <AP_Scheduler/AP_Scheduler.h>
 #include <AP_Common/ExpandingString.h>
+#include <GCS_MAVLink/GCS_config.h>
+#if AP_MAVLINK_FTP_ENABLED
+#include <GCS_MAVLink/GCS.h>
+#endif
+#include <AP_Scripting/AP_Scripting.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -52,6 +57,13 @@ static const SysFileList sysfs_file_list[] = {
 #endif
     {"crash_dump.bin"},
     {"storage.bin"},
+    {"storage.txt"},
+#if AP_MAVLINK_FTP_ENABLED
+    {"ftp.txt"},
+#endif
+#if AP_SCRIPTING_ENABLED
+    {"scripts.txt"},
+#endif
 #if AP_FILESYSTEM_SYS_FLASH_ENABLED
     {"flash.bin"},
 #endif
@@ -155,6 +167,19 @@ int AP_Filesystem_Sys::open(const char *fname, int flags, bool allow_absolute_pa
             r.str->set_buffer((char*)ptr, size, size);
         }
     }
+    if (strcmp(fname, "storage.txt") == 0) {
+        hal.storage->storage_info(*r.str);
+    }
+#if AP_MAVLINK_FTP_ENABLED
+    if (strcmp(fname, "ftp.txt") == 0) {
+        GCS_MAVLINK::ftp_info(*r.str);
+    }
+#endif
+#if AP_SCRIPTING_ENABLED
+    if (strcmp(fname, "scripts.txt") == 0) {
+        AP::scripting()->scripts_info(*r.str);
+    }
+#endif
 #if AP_FILESYSTEM_SYS_FLASH_ENABLED
     if (strcmp(fname, "flash.bin") == 0) {
         void *ptr = (void*)0x08000000;
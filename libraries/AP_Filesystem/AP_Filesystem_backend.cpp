@@ -54,6 +54,26 @@ FileData *AP_Filesystem_Backend::load_file(const char *filename)
     return fd;
 }
 
+/*
+  gather write for backends without native support. Stops at the
+  first short write, returning the number of bytes written
+*/
+int32_t AP_Filesystem_Backend::writev(int fd, const IoVec *iov, uint8_t iovcnt)
+{
+    int32_t total = 0;
+    for (uint8_t i=0; i<iovcnt; i++) {
+        const int32_t ret = write(fd, iov[i].data, iov[i].len);
+        if (ret < 0) {
+            return total > 0 ? total : ret;
+        }
+        total += ret;
+        if (uint32_t(ret) != iov[i].len) {
+            break;
+        }
+    }
+    return total;
+}
+
 /*
   unload a FileData object
 */
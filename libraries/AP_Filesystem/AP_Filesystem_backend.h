@@ -23,6 +23,7 @@
 #include "AP_Filesystem_config.h"
 
 #include <AP_InternalError/AP_InternalError.h>
+#include <AP_HAL/utility/IoVec.h>
 
 // returned structure from a load_file() call
 class FileData {
@@ -49,6 +50,9 @@ public:
     virtual int close(int fd) { return -1; }
     virtual int32_t read(int fd, void *buf, uint32_t count) { return -1; }
     virtual int32_t write(int fd, const void *buf, uint32_t count) { return -1; }
+    // gather write of iovcnt buffers in a single call. The default
+    // implementation calls write() for each buffer
+    virtual int32_t writev(int fd, const IoVec *iov, uint8_t iovcnt);
     virtual int fsync(int fd) { return 0; }
     virtual int32_t lseek(int fd, int32_t offset, int whence) { return -1; }
     virtual int stat(const char *pathname, struct stat *stbuf) { return -1; }
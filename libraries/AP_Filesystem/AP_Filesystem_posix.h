@@ -27,6 +27,7 @@
 #include <dirent.h>
 #include <unistd.h>
 #include <errno.h>
+#include <sys/uio.h>
 #include "AP_Filesystem_backend.h"
 
 class AP_Filesystem_Posix : public AP_Filesystem_Backend
@@ -37,6 +38,7 @@ public:
     int close(int fd) override;
     int32_t read(int fd, void *buf, uint32_t count) override;
     int32_t write(int fd, const void *buf, uint32_t count) override;
+    int32_t writev(int fd, const IoVec *iov, uint8_t iovcnt) override;
     int fsync(int fd) override;
     int32_t lseek(int fd, int32_t offset, int whence) override;
     int stat(const char *pathname, struct stat *stbuf) override;
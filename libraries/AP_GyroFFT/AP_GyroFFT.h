@@ -30,6 +30,11 @@
 
 #define DEBUG_FFT   0
 
+// allow each axis to be analysed by its own thread on multi-core boards
+#ifndef AP_GYROFFT_AXIS_THREADS_ENABLED
+#define AP_GYROFFT_AXIS_THREADS_ENABLED (CONFIG_HAL_BOARD == HAL_BOARD_LINUX || CONFIG_HAL_BOARD == HAL_BOARD_SITL)
+#endif
+
 // a library that leverages the HAL DSP support to perform FFT analysis on gyro samples
 class AP_GyroFFT
 {
@@ -40,7 +45,8 @@ public:
 
     enum class Options : uint32_t {
         FFTPostFilter = 1 << 0,
-        ESCNoiseCheck = 1 << 1
+        ESCNoiseCheck = 1 << 1,
+        AxisThreads = 1 << 2,
     };
 
     AP_GyroFFT();
@@ -60,6 +66,10 @@ public:
     void update_parameters() { update_parameters(false); }
     // thread for processing gyro data via FFT
     void update_thread();
+#if AP_GYROFFT_AXIS_THREADS_ENABLED
+    // thread for processing gyro data for a single axis via FFT
+    void update_axis_thread();
+#endif
     // start the update thread
     bool start_update_thread();
     // is the subsystem enabled
@@ -111,6 +121,8 @@ public:
     bool using_post_filter_samples() const { return (_options & uint32_t(Options::FFTPostFilter)) != 0; }
     // post filter mask of IMUs
     bool check_esc_noise() const { return (_options & uint32_t(Options::ESCNoiseCheck)) != 0; }
+    // analyse each axis in its own thread
+    bool using_axis_threads() const { return _num_axis_states == XYZ_AXIS_COUNT; }
     // look for a frequency in the detected noise
     float has_noise_at_frequency_hz(float freq) const;
     static float calculate_notch_frequency(float* freqs, uint16_t numpeaks, float harmonic_fit, uint8_t& harmonics);
@@ -164,7 +176,7 @@ private:
     // structure for holding noise peak data while calculating swaps
     class FrequencyData {
     public:
-        FrequencyData(const AP_GyroFFT& gyrofft, const EngineConfig& config);
+        FrequencyData(const AP_GyroFFT& gyrofft, const EngineConfig& config, uint8_t axis);
         float get_weighted_frequency(FrequencyPeak i) const { return frequency[i]; }
         float get_signal_to_noise(FrequencyPeak i) const { return snr[i]; }
         bool is_valid(FrequencyPeak i) const { return valid[i]; }
@@ -192,26 +204,30 @@ private:
     }
     // write single log messages
     void log_noise_peak(uint8_t id, FrequencyPeak peak) const;
+    // analyse the next frame of the axis, returns true if a frame was analysed
+    bool analyse_axis(uint8_t axis);
+    // wait for enough samples to arrive for the next frame
+    void wait_for_samples(uint16_t remaining_samples) const;
     // calculate the peak noise frequency
-    void calculate_noise(bool calibrating, const EngineConfig& config);
+    void calculate_noise(bool calibrating, const EngineConfig& config, uint8_t axis);
     // calculate noise peaks based on energy and history
-    uint8_t calculate_tracking_peaks(float& weighted_peak_freq_hz, bool calibrating, const EngineConfig& config);
-    uint8_t calculate_tracking_peaks(float& weighted_center_freq_hz, const FrequencyData& freqs, const EngineConfig& config);
+    uint8_t calculate_tracking_peaks(float& weighted_peak_freq_hz, bool calibrating, const EngineConfig& config, uint8_t axis);
+    uint8_t calculate_tracking_peaks(float& weighted_center_freq_hz, const FrequencyData& freqs, const EngineConfig& config, uint8_t axis);
     // calculate noise peak frequency characteristics
-    bool calculate_filtered_noise(FrequencyPeak target_peak, FrequencyPeak source_peak, const FrequencyData& freqs, const EngineConfig& config);
-    void update_snr_values(const FrequencyData& freqs);
+    bool calculate_filtered_noise(FrequencyPeak target_peak, FrequencyPeak source_peak, const FrequencyData& freqs, const EngineConfig& config, uint8_t axis);
+    void update_snr_values(const FrequencyData& freqs, uint8_t axis);
     // get the weighted frequency
-    bool get_weighted_frequency(FrequencyPeak peak, float& weighted_peak_freq_hz, float& snr, const EngineConfig& config) const;
+    bool get_weighted_frequency(FrequencyPeak peak, float& weighted_peak_freq_hz, float& snr, const EngineConfig& config, uint8_t axis) const;
     // return the tracked noise peak
     FrequencyPeak get_tracked_noise_peak() const;
     // calculate the distance matrix between the current estimates and the current cycle
-    void find_distance_matrix(DistanceMatrix& distance_matrix, const FrequencyData& freqs, const EngineConfig& config) const;
+    void find_distance_matrix(DistanceMatrix& distance_matrix, const FrequencyData& freqs, const EngineConfig& config, uint8_t axis) const;
     // return the instantaneous peak that is closest to the target estimate peak
     FrequencyPeak find_closest_peak(const FrequencyPeak target, const DistanceMatrix& distance_matrix, uint8_t ignore = 0) const;
     // detected peak frequency weighted by energy
     float calculate_weighted_freq_hz(const Vector3f& energy, const Vector3f& freq) const;
     // update the estimation of the background noise energy
-    void update_ref_energy(uint16_t max_bin);
+    void update_ref_energy(uint16_t max_bin, uint8_t axis);
     // test frequency detection for all of the allowable bins
     float self_test_bin_frequencies();
     // detect the provided frequency
@@ -219,7 +235,7 @@ private:
     // whether to run analysis or not
     bool analysis_enabled() const { return _initialized && _analysis_enabled && _thread_created; };
     // whether analysis can be run again or not
-    bool start_analysis();
+    bool start_analysis(uint8_t axis);
     // return samples available in the gyro window
     uint16_t get_available_samples(uint8_t axis) {
         return _sample_mode == 0 ?_ins->get_raw_gyro_window(axis).available() : _downsampled_gyro_data[axis].available();
@@ -257,10 +273,12 @@ private:
         Vector3f _center_freq_energy_filtered[FrequencyPeak::MAX_TRACKED_PEAKS];
         // filtered detected peak width
         Vector3f _center_bandwidth_hz_filtered[FrequencyPeak::MAX_TRACKED_PEAKS];
+        // number of frames analysed on each axis
+        Vector3ul _frame_count;
         // axes that still require noise calibration
         uint8_t _noise_needs_calibration : 3;
-        // whether the analyzer is mid-cycle
-        bool _analysis_started;
+        // whether the analyzer is mid-cycle on each axis
+        bool _analysis_started[XYZ_AXIS_COUNT];
     };
 
     // Shared FFT engine state local to the FFT thread
@@ -283,6 +301,18 @@ private:
 
     // state of the FFT engine
     AP_HAL::DSP::FFTWindowState* _state;
+    // state of the FFT engine used for each axis, these are all _state unless
+    // each axis is analysed in its own thread
+    AP_HAL::DSP::FFTWindowState* _axis_state[XYZ_AXIS_COUNT];
+    // number of separate FFT engine states
+    uint8_t _num_axis_states;
+#if AP_GYROFFT_AXIS_THREADS_ENABLED
+    // number of axis threads that have started
+    uint8_t _num_axis_threads;
+#endif
+    // total number of frames analysed at the last log message
+    uint32_t _last_log_frame_count;
+    uint32_t _last_log_us;
     // update state machine step information
     uint8_t _update_axis;
     // noise base of the gyros
@@ -59,6 +59,20 @@ void AP_HAL::Device::set_device_type(uint8_t devtype) {
 }
 
 
+/*
+  default implementation of transfer_batch(), one transfer at a time
+ */
+bool AP_HAL::Device::transfer_batch(const Transfer *transfers, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        if (!transfer(t.send, t.send_len, t.recv, t.recv_len)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool AP_HAL::Device::read_bank_registers(uint8_t bank, uint8_t first_reg, uint8_t *recv, uint32_t recv_len)
 {
     first_reg |= _read_flag;
@@ -119,6 +119,35 @@ public:
                           uint8_t *recv, uint32_t recv_len) = 0;
 
 
+    /*
+     * One bus transaction for #transfer_batch(), with the same meaning
+     * for the fields as the arguments of #transfer()
+     */
+    struct Transfer {
+        const uint8_t *send;
+        uint32_t send_len;
+        uint8_t *recv;
+        uint32_t recv_len;
+    };
+
+    /*
+     * Perform count independent bus transactions in order, as if
+     * #transfer() was called for each of them. Backends which can queue
+     * transactions submit them to the bus together, saving the overhead
+     * of a transfer on each of them. Processing stops at the first
+     * failed transaction.
+     *
+     * Return: true if all the transfers succeeded, false otherwise.
+     */
+    virtual bool transfer_batch(const Transfer *transfers, uint8_t count);
+
+    /*
+     * Return true if #transfer_batch() is cheaper than doing the same
+     * transfers one by one. Drivers can use this to decide whether it
+     * is worth batching a speculative read with the one it depends on.
+     */
+    virtual bool transfer_batch_supported() const { return false; }
+
     /*
      * Sets the required flags before transaction starts
      * this is to be used by Wide SPI communication interfaces like
@@ -0,0 +1,57 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/utility/RingBuffer.h>
+
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// objects passed between the threads in each iteration
+#define OBJECTS_PER_ITERATION 100000
+
+// roughly the size of a proximity sample queued for the OA database
+struct bench_object {
+    float pos[3];
+    uint32_t timestamp_ms;
+    float radius;
+};
+
+/*
+  pass objects from a producer thread to the benchmark thread through
+  a ring buffer of the given size, yielding when it is full or empty
+ */
+template <typename B>
+static void BM_RingBufferCrossThread(benchmark::State &state)
+{
+    B *buf = new B(state.range(0));
+
+    while (state.KeepRunning()) {
+        std::thread producer([buf]() {
+            bench_object obj {};
+            for (uint32_t i = 0; i < OBJECTS_PER_ITERATION; i++) {
+                obj.timestamp_ms = i;
+                while (!buf->push(obj)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        for (uint32_t i = 0; i < OBJECTS_PER_ITERATION; ) {
+            bench_object obj;
+            if (!buf->pop(obj)) {
+                std::this_thread::yield();
+                continue;
+            }
+            gbenchmark_escape(&obj);
+            i++;
+        }
+        producer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * OBJECTS_PER_ITERATION);
+
+    delete buf;
+}
+
+BENCHMARK_TEMPLATE(BM_RingBufferCrossThread, ObjectBuffer_TS<bench_object>)->Arg(16)->Arg(256)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_RingBufferCrossThread, ObjectBuffer_SPSC<bench_object>)->Arg(16)->Arg(256)->UseRealTime();
+
+BENCHMARK_MAIN();
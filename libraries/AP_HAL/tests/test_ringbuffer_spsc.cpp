@@ -0,0 +1,166 @@
+#include <AP_gtest.h>
+#include <AP_HAL/HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+#include <thread>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+struct test_object {
+    uint32_t seq;
+    float value;
+};
+
+TEST(ObjectBuffer_SPSC, Empty)
+{
+    ObjectBuffer_SPSC<test_object> buf(8);
+    test_object obj;
+
+    EXPECT_EQ(buf.get_size(), 8U);
+    EXPECT_EQ(buf.available(), 0U);
+    EXPECT_EQ(buf.space(), 8U);
+    EXPECT_TRUE(buf.is_empty());
+    EXPECT_FALSE(buf.pop(obj));
+    EXPECT_FALSE(buf.peek(obj));
+    EXPECT_FALSE(buf.pop());
+}
+
+TEST(ObjectBuffer_SPSC, ZeroSize)
+{
+    ObjectBuffer_SPSC<test_object> buf(0);
+    test_object obj {1, 1};
+
+    EXPECT_EQ(buf.get_size(), 0U);
+    EXPECT_FALSE(buf.push(obj));
+    EXPECT_FALSE(buf.push(&obj, 1));
+    EXPECT_FALSE(buf.pop(obj));
+}
+
+TEST(ObjectBuffer_SPSC, FillAndDrain)
+{
+    ObjectBuffer_SPSC<test_object> buf(8);
+
+    for (uint32_t i = 0; i < 8; i++) {
+        EXPECT_TRUE(buf.push(test_object{i, i * 0.5f}));
+        EXPECT_EQ(buf.available(), i + 1);
+        EXPECT_EQ(buf.space(), 7 - i);
+    }
+    EXPECT_FALSE(buf.push(test_object{8, 0}));
+
+    test_object obj;
+    EXPECT_TRUE(buf.peek(obj));
+    EXPECT_EQ(obj.seq, 0U);
+    for (uint32_t i = 0; i < 8; i++) {
+        EXPECT_TRUE(buf.pop(obj));
+        EXPECT_EQ(obj.seq, i);
+        EXPECT_FLOAT_EQ(obj.value, i * 0.5f);
+    }
+    EXPECT_FALSE(buf.pop(obj));
+    EXPECT_TRUE(buf.is_empty());
+}
+
+TEST(ObjectBuffer_SPSC, WrapAround)
+{
+    ObjectBuffer_SPSC<test_object> buf(5);
+    uint32_t next_push = 0;
+    uint32_t next_pop = 0;
+
+    // push and pop in uneven amounts so the indices wrap at every offset
+    for (uint32_t loop = 0; loop < 100; loop++) {
+        const uint32_t npush = 1 + loop % 5;
+        for (uint32_t i = 0; i < npush; i++) {
+            if (buf.space() == 0) {
+                EXPECT_FALSE(buf.push(test_object{next_push, 0}));
+                break;
+            }
+            EXPECT_TRUE(buf.push(test_object{next_push++, 0}));
+        }
+        const uint32_t npop = 1 + (loop * 3) % 4;
+        for (uint32_t i = 0; i < npop && !buf.is_empty(); i++) {
+            test_object obj;
+            EXPECT_TRUE(buf.pop(obj));
+            EXPECT_EQ(obj.seq, next_pop++);
+        }
+        EXPECT_EQ(buf.available(), next_push - next_pop);
+    }
+}
+
+TEST(ObjectBuffer_SPSC, PushMultiple)
+{
+    ObjectBuffer_SPSC<test_object> buf(6);
+    test_object objs[4];
+    for (uint32_t i = 0; i < 4; i++) {
+        objs[i] = {i, 0};
+    }
+
+    EXPECT_TRUE(buf.push(objs, 4));
+    // not enough room for all of them, so none are pushed
+    EXPECT_FALSE(buf.push(objs, 4));
+    EXPECT_EQ(buf.available(), 4U);
+
+    // make room and push across the end of the buffer
+    EXPECT_TRUE(buf.pop());
+    EXPECT_TRUE(buf.pop());
+    EXPECT_TRUE(buf.push(objs, 4));
+    EXPECT_EQ(buf.available(), 6U);
+
+    const uint32_t expected[] {2, 3, 0, 1, 2, 3};
+    for (uint32_t seq : expected) {
+        test_object obj;
+        EXPECT_TRUE(buf.pop(obj));
+        EXPECT_EQ(obj.seq, seq);
+    }
+}
+
+TEST(ObjectBuffer_SPSC, Clear)
+{
+    ObjectBuffer_SPSC<test_object> buf(4);
+    EXPECT_TRUE(buf.push(test_object{1, 0}));
+    EXPECT_TRUE(buf.push(test_object{2, 0}));
+    buf.clear();
+    EXPECT_TRUE(buf.is_empty());
+    EXPECT_EQ(buf.space(), 4U);
+
+    test_object obj;
+    EXPECT_TRUE(buf.push(test_object{3, 0}));
+    EXPECT_TRUE(buf.pop(obj));
+    EXPECT_EQ(obj.seq, 3U);
+}
+
+/*
+  a producer thread pushes a sequence through a small buffer while the
+  consumer checks nothing is lost, duplicated or reordered
+ */
+TEST(ObjectBuffer_SPSC, CrossThread)
+{
+    const uint32_t count = 1000000;
+    ObjectBuffer_SPSC<test_object> buf(16);
+
+    std::thread producer([&buf, count]() {
+        for (uint32_t i = 0; i < count; i++) {
+            while (!buf.push(test_object{i, float(i)})) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t next = 0;
+    uint32_t errors = 0;
+    while (next < count) {
+        test_object obj;
+        if (!buf.pop(obj)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (obj.seq != next || obj.value != float(next)) {
+            errors++;
+        }
+        next++;
+    }
+    producer.join();
+
+    EXPECT_EQ(errors, 0U);
+    EXPECT_TRUE(buf.is_empty());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * One region of memory in a scatter/gather read or write, as filled
+ * out by ByteBuffer::peekiovec() and ByteBuffer::reserve().
+ */
+struct IoVec {
+    uint8_t *data;
+    uint32_t len;
+};
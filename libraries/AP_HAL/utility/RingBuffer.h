@@ -5,6 +5,7 @@
 #include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_HAL/AP_HAL_Macros.h>
 #include <AP_HAL/Semaphores.h>
+#include "IoVec.h"
 
 /*
  * Circular buffer of bytes.
@@ -73,10 +74,7 @@ public:
     // Similar to peekbytes(), but will fill out IoVec struct with
     // both parts of the ring buffer if wraparound is happening, or
     // just one part. Returns the number of parts written to.
-    struct IoVec {
-        uint8_t *data;
-        uint32_t len;
-    };
+    using IoVec = ::IoVec;
     uint8_t peekiovec(IoVec vec[2], uint32_t len);
 
     // Reserve `len` bytes and fills out `vec` with both parts of the
@@ -461,6 +459,189 @@ private:
     HAL_Semaphore sem;
 };
 
+/*
+  padding used to keep the read and write indices of ObjectBuffer_SPSC
+  on separate cache lines. Microcontrollers have no cache coherency
+  traffic between cores to avoid, so they only pay for a word
+ */
+#ifndef RINGBUFFER_SPSC_PAD_SIZE
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX
+#define RINGBUFFER_SPSC_PAD_SIZE 64
+#else
+#define RINGBUFFER_SPSC_PAD_SIZE 4
+#endif
+#endif
+
+/*
+  Lock-free ring buffer class for objects of fixed size, for use with
+  exactly one producer thread and one consumer thread. The producer
+  may only call push(), the consumer may only call pop(), peek() and
+  clear(). available(), space() and is_empty() may be called from
+  either side, but are only a snapshot when called by the other side.
+  If there is more than one producer they must be serialised by the
+  caller.
+ */
+template <class T>
+class ObjectBuffer_SPSC {
+public:
+    ObjectBuffer_SPSC(uint32_t _size = 0) {
+        // one slot is always left empty to tell a full buffer from an
+        // empty one
+        buffer = new T[_size+1];
+        if (buffer != nullptr) {
+            size = _size+1;
+        }
+    }
+    ~ObjectBuffer_SPSC(void) {
+        delete[] buffer;
+    }
+
+    CLASS_NO_COPY(ObjectBuffer_SPSC);
+
+    // return size of ringbuffer
+    uint32_t get_size(void) const {
+        return size>0?size-1:0;
+    }
+
+    // return number of objects available to be read from the front of the queue
+    uint32_t available(void) const {
+        return used_slots(reader.idx.load(std::memory_order_acquire),
+                          writer.idx.load(std::memory_order_acquire));
+    }
+
+    // return number of objects that could be written to the back of the queue
+    uint32_t space(void) const {
+        return get_size() - available();
+    }
+
+    // true is available() == 0
+    bool is_empty(void) const WARN_IF_UNUSED {
+        return reader.idx.load(std::memory_order_acquire) == writer.idx.load(std::memory_order_acquire);
+    }
+
+    // push one object onto the back of the queue, producer only
+    bool push(const T &object) {
+        if (size == 0) {
+            return false;
+        }
+        const uint32_t _tail = writer.idx.load(std::memory_order_relaxed);
+        const uint32_t next = next_index(_tail);
+        if (next == writer.other_idx) {
+            // looks full, refresh our copy of the read index
+            writer.other_idx = reader.idx.load(std::memory_order_acquire);
+            if (next == writer.other_idx) {
+                return false;
+            }
+        }
+        buffer[_tail] = object;
+        writer.idx.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // push N objects onto the back of the queue, producer only. Either
+    // all or none of the objects are pushed
+    bool push(const T *object, uint32_t n) {
+        if (size == 0) {
+            return false;
+        }
+        uint32_t _tail = writer.idx.load(std::memory_order_relaxed);
+        if (get_size() - used_slots(writer.other_idx, _tail) < n) {
+            // looks full, refresh our copy of the read index
+            writer.other_idx = reader.idx.load(std::memory_order_acquire);
+            if (get_size() - used_slots(writer.other_idx, _tail) < n) {
+                return false;
+            }
+        }
+        for (uint32_t i=0; i<n; i++) {
+            buffer[_tail] = object[i];
+            _tail = next_index(_tail);
+        }
+        writer.idx.store(_tail, std::memory_order_release);
+        return true;
+    }
+
+    /*
+      throw away an object from the front of the queue, consumer only
+     */
+    bool pop(void) {
+        const uint32_t _head = reader.idx.load(std::memory_order_relaxed);
+        if (!consumer_has_data(_head)) {
+            return false;
+        }
+        reader.idx.store(next_index(_head), std::memory_order_release);
+        return true;
+    }
+
+    /*
+      pop earliest object off the front of the queue, consumer only
+     */
+    bool pop(T &object) WARN_IF_UNUSED {
+        const uint32_t _head = reader.idx.load(std::memory_order_relaxed);
+        if (!consumer_has_data(_head)) {
+            return false;
+        }
+        object = buffer[_head];
+        reader.idx.store(next_index(_head), std::memory_order_release);
+        return true;
+    }
+
+    /*
+      peek copies an object out from the front of the queue without
+      advancing the read pointer, consumer only
+     */
+    bool peek(T &object) WARN_IF_UNUSED {
+        const uint32_t _head = reader.idx.load(std::memory_order_relaxed);
+        if (!consumer_has_data(_head)) {
+            return false;
+        }
+        object = buffer[_head];
+        return true;
+    }
+
+    // Discards the buffer content, emptying it. Consumer only
+    void clear(void) {
+        reader.other_idx = writer.idx.load(std::memory_order_acquire);
+        reader.idx.store(reader.other_idx, std::memory_order_release);
+    }
+
+private:
+    uint32_t next_index(uint32_t idx) const {
+        return idx+1 >= size ? 0 : idx+1;
+    }
+
+    // number of objects between _head and _tail
+    uint32_t used_slots(uint32_t _head, uint32_t _tail) const {
+        return _tail >= _head ? _tail - _head : size - _head + _tail;
+    }
+
+    // true if there is an object at _head, only refreshing the
+    // consumer's copy of the write index when the buffer looks empty
+    bool consumer_has_data(uint32_t _head) {
+        if (_head != reader.other_idx) {
+            return true;
+        }
+        reader.other_idx = writer.idx.load(std::memory_order_acquire);
+        return _head != reader.other_idx;
+    }
+
+    /*
+      each side only writes its own index and keeps a copy of the
+      other side's index, so the other side's cache line is only read
+      when the buffer looks full or empty
+     */
+    struct side {
+        std::atomic<uint32_t> idx{0};
+        uint32_t other_idx = 0;
+        uint8_t pad[RINGBUFFER_SPSC_PAD_SIZE];
+    };
+    side reader;        // head, the next object to be read
+    side writer;        // tail, the next slot to be written
+
+    // only written by the constructor
+    T *buffer = nullptr;
+    uint32_t size = 0;
+};
+
 /*
   ring buffer class for objects of fixed size with pointer
   access. Note that this is not thread safe, buf offers efficient
@@ -15,6 +15,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "SPIDevice.h"
+#include "SPIDevice_internal.h"
 
 #include <assert.h>
 #include <errno.h>
@@ -45,28 +46,6 @@ namespace Linux {
 
 #define MHZ (1000U*1000U)
 #define KHZ (1000U)
-#define SPI_CS_KERNEL -1
-
-struct SPIDesc {
-    SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
-            uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
-            uint32_t highspeed_)
-        : name(name_), bus(bus_), subdev(subdev_), mode(mode_)
-        , bits_per_word(bits_per_word_), cs_pin(cs_pin_), lowspeed(lowspeed_)
-        , highspeed(highspeed_)
-    {
-    }
-
-    const char *name;
-    uint16_t bus;
-    uint16_t subdev;
-    uint8_t mode;
-    uint8_t bits_per_word;
-    int16_t cs_pin;
-    uint32_t lowspeed;
-    uint32_t highspeed;
-};
-
 
 #if CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_PXF || CONFIG_HAL_BOARD_SUBTYPE == HAL_BOARD_SUBTYPE_LINUX_ERLEBOARD
 SPIDesc SPIDeviceManager::_device[] = {
@@ -167,34 +146,9 @@ SPIDesc SPIDeviceManager::_device[] = {
 #define LINUX_SPI_DEVICE_NUM_DEVICES ARRAY_SIZE(SPIDeviceManager::_device)
 #endif
 
-#define MAX_SUBDEVS 6
-
 const uint8_t SPIDeviceManager::_n_device_desc = LINUX_SPI_DEVICE_NUM_DEVICES;
 
 
-/* Private struct to maintain for each bus */
-class SPIBus : public TimerPollable::WrapperCb {
-public:
-    SPIBus(uint16_t bus_);
-    ~SPIBus();
-
-    /*
-     * TimerPollable::WrapperCb methods to take
-     * and release semaphore while calling the callback
-     */
-    void start_cb() override;
-    void end_cb() override;
-
-    void open(uint16_t subdev);
-
-    PollerThread thread;
-    Semaphore sem;
-    int fd[MAX_SUBDEVS];
-    uint16_t bus;
-    int16_t last_mode = -1;
-    uint8_t ref;
-};
-
 SPIBus::SPIBus(uint16_t bus_)
     : bus(bus_)
 {
@@ -277,14 +231,29 @@ bool SPIDevice::set_speed(AP_HAL::Device::Speed speed)
     return true;
 }
 
-bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
-                         uint8_t *recv, uint32_t recv_len)
+/*
+  fill in the segments for one transaction, returning the number of
+  segments used. As on other HALs, a send buffer which is also the
+  receive buffer with the same length is a full duplex transfer
+ */
+unsigned SPIDevice::_fill_msgs(struct spi_ioc_transfer *msgs,
+                               const uint8_t *send, uint32_t send_len,
+                               uint8_t *recv, uint32_t recv_len)
 {
-    struct spi_ioc_transfer msgs[2] = { };
     unsigned nmsgs = 0;
-    int fd = _bus.fd[_desc.subdev];
+
+    if (send && recv && send == recv && send_len == recv_len && send_len != 0) {
+        msgs[nmsgs] = { };
+        msgs[nmsgs].tx_buf = (uint64_t) send;
+        msgs[nmsgs].rx_buf = (uint64_t) recv;
+        msgs[nmsgs].len = send_len;
+        msgs[nmsgs].speed_hz = _speed;
+        msgs[nmsgs].bits_per_word = _desc.bits_per_word;
+        return 1;
+    }
 
     if (send && send_len != 0) {
+        msgs[nmsgs] = { };
         msgs[nmsgs].tx_buf = (uint64_t) send;
         msgs[nmsgs].rx_buf = 0;
         msgs[nmsgs].len = send_len;
@@ -296,6 +265,7 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 
     if (recv && recv_len != 0) {
+        msgs[nmsgs] = { };
         msgs[nmsgs].tx_buf = 0;
         msgs[nmsgs].rx_buf = (uint64_t) recv;
         msgs[nmsgs].len = recv_len;
@@ -306,10 +276,15 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         nmsgs++;
     }
 
-    if (!nmsgs) {
-        return false;
-    }
+    return nmsgs;
+}
 
+/*
+  set the bus mode for this device if the last user of the bus left it
+  in a different mode
+ */
+bool SPIDevice::_set_mode(int fd)
+{
 #if DEBUG
     if (_desc.mode == _bus.last_mode) {
         /*
@@ -333,9 +308,8 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 #endif
 
-    int r;
     if (_desc.mode != _bus.last_mode) {
-        r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
+        int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
         if (r < 0) {
             hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                                 fd, strerror(errno));
@@ -344,8 +318,27 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
         _bus.last_mode = _desc.mode;
     }
 
+    return true;
+}
+
+/*
+  submit nmsgs segments to the bus in a single syscall. The chip select
+  is released after any segment with cs_change set, except the last
+ */
+bool SPIDevice::_submit(struct spi_ioc_transfer *msgs, unsigned nmsgs)
+{
+    int fd = _bus.fd[_desc.subdev];
+
+    if (!_set_mode(fd)) {
+        return false;
+    }
+
+    // on the last segment cs_change would instead keep the chip
+    // selected after the message
+    msgs[nmsgs-1].cs_change = 0;
+
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), msgs);
     _cs_release();
 
     if (r == -1) {
@@ -357,11 +350,23 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     return true;
 }
 
+bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
+                         uint8_t *recv, uint32_t recv_len)
+{
+    struct spi_ioc_transfer msgs[2];
+    const unsigned nmsgs = _fill_msgs(msgs, send, send_len, recv, recv_len);
+
+    if (!nmsgs) {
+        return false;
+    }
+
+    return _submit(msgs, nmsgs);
+}
+
 bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                                     uint32_t len)
 {
     struct spi_ioc_transfer msgs[1] = { };
-    int fd = _bus.fd[_desc.subdev];
 
     if (!send || !recv || len == 0) {
         return false;
@@ -375,26 +380,61 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
     msgs[0].bits_per_word = _desc.bits_per_word;
     msgs[0].cs_change = 0;
 
-    int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
-    if (r < 0) {
-        hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                            fd, strerror(errno));
-        return false;
+    return _submit(msgs, 1);
+}
+
+bool SPIDevice::transfer_batch_supported() const
+{
+    return _desc.cs_pin == SPI_CS_KERNEL;
+}
+
+/*
+  submit a batch of transactions in as few syscalls as possible, with
+  the kernel releasing the chip select between them
+ */
+bool SPIDevice::transfer_batch(const Transfer *transfers, uint8_t count)
+{
+    if (_desc.cs_pin != SPI_CS_KERNEL) {
+        // chip select is driven from userspace around each syscall
+        return AP_HAL::SPIDevice::transfer_batch(transfers, count);
     }
 
-    _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(1), &msgs);
-    _cs_release();
+    struct spi_ioc_transfer msgs[SPI_BATCH_MAX_SEGMENTS];
+    unsigned nmsgs = 0;
+    uint32_t nbytes = 0;
 
-    if (r == -1) {
-        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
-                            fd, strerror(errno));
-        return false;
+    for (uint8_t i = 0; i < count; i++) {
+        const Transfer &t = transfers[i];
+        uint32_t len = t.recv_len;
+        if (t.send != t.recv || t.send_len != t.recv_len) {
+            len += t.send_len;
+        }
+        // spidev limits both the number of segments and the bytes
+        // in a message, so start another one when either is reached
+        if (nmsgs > 0 &&
+            (nmsgs + 2 > SPI_BATCH_MAX_SEGMENTS || nbytes + len > SPI_BATCH_MAX_BYTES)) {
+            if (!_submit(msgs, nmsgs)) {
+                return false;
+            }
+            nmsgs = 0;
+            nbytes = 0;
+        }
+        const unsigned n = _fill_msgs(&msgs[nmsgs], t.send, t.send_len, t.recv, t.recv_len);
+        if (n == 0) {
+            return false;
+        }
+        nmsgs += n;
+        nbytes += len;
+        // release chip select between transactions
+        msgs[nmsgs-1].cs_change = 1;
     }
 
-    return true;
-}
+    if (nmsgs == 0) {
+        return true;
+    }
 
+    return _submit(msgs, nmsgs);
+}
 
 void SPIDevice::_cs_assert()
 {
@@ -22,6 +22,8 @@
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+struct spi_ioc_transfer;
+
 namespace Linux {
 
 class SPIBus;
@@ -46,6 +48,12 @@ public:
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
 
+    /* See AP_HAL::Device::transfer_batch() */
+    bool transfer_batch(const Transfer *transfers, uint8_t count) override;
+
+    /* See AP_HAL::Device::transfer_batch_supported() */
+    bool transfer_batch_supported() const override;
+
     /* See AP_HAL::Device::get_semaphore() */
     AP_HAL::Semaphore *get_semaphore() override;
 
@@ -63,6 +71,19 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Fill in the spidev segments for one transaction
+     */
+    unsigned _fill_msgs(struct spi_ioc_transfer *msgs,
+                        const uint8_t *send, uint32_t send_len,
+                        uint8_t *recv, uint32_t recv_len);
+
+    /*
+     * Set the bus mode if needed and submit segments in one syscall
+     */
+    bool _set_mode(int fd);
+    bool _submit(struct spi_ioc_transfer *msgs, unsigned nmsgs);
+
     /*
      * Select device if using userspace CS
      */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2015  Intel Corporation. All rights reserved.
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+/*
+  bus and device descriptions private to the Linux SPIDevice
+  implementation. Only SPIDevice.cpp and its tests include this
+ */
+
+#include <inttypes.h>
+
+#include "PollerThread.h"
+#include "Semaphores.h"
+#include "SPIDevice.h"
+
+// chip select driven by the kernel rather than a GPIO
+#define SPI_CS_KERNEL -1
+
+// limits on the size of a batched message. The byte limit is the
+// default bufsiz of the spidev driver
+#define SPI_BATCH_MAX_SEGMENTS 16
+#define SPI_BATCH_MAX_BYTES 4096
+
+#define MAX_SUBDEVS 6
+
+namespace Linux {
+
+struct SPIDesc {
+    SPIDesc(const char *name_, uint16_t bus_, uint16_t subdev_, uint8_t mode_,
+            uint8_t bits_per_word_, int16_t cs_pin_, uint32_t lowspeed_,
+            uint32_t highspeed_)
+        : name(name_), bus(bus_), subdev(subdev_), mode(mode_)
+        , bits_per_word(bits_per_word_), cs_pin(cs_pin_), lowspeed(lowspeed_)
+        , highspeed(highspeed_)
+    {
+    }
+
+    const char *name;
+    uint16_t bus;
+    uint16_t subdev;
+    uint8_t mode;
+    uint8_t bits_per_word;
+    int16_t cs_pin;
+    uint32_t lowspeed;
+    uint32_t highspeed;
+};
+
+/* Private struct to maintain for each bus */
+class SPIBus : public TimerPollable::WrapperCb {
+public:
+    SPIBus(uint16_t bus_);
+    ~SPIBus();
+
+    /*
+     * TimerPollable::WrapperCb methods to take
+     * and release semaphore while calling the callback
+     */
+    void start_cb() override;
+    void end_cb() override;
+
+    void open(uint16_t subdev);
+
+    PollerThread thread;
+    Semaphore sem;
+    int fd[MAX_SUBDEVS];
+    uint16_t bus;
+    int16_t last_mode = -1;
+    uint8_t ref;
+};
+
+}
@@ -3,12 +3,15 @@
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdio.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Math/AP_Math.h>
 #include <AP_Vehicle/AP_Vehicle_Type.h>
 
 using namespace Linux;
@@ -22,6 +25,11 @@ using namespace Linux;
 // card for ArduCopter and ArduPlane
 #define STORAGE_FILE AP_BUILD_TARGET_NAME ".stg"
 
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+#define STORAGE_JOURNAL_FILE AP_BUILD_TARGET_NAME ".stj"
+#define STORAGE_JOURNAL_MAGIC 0x4A475453 // "STGJ"
+#endif
+
 extern const AP_HAL::HAL& hal;
 
 static inline int is_dir(const char *path)
@@ -148,6 +156,12 @@ void Storage::init()
         dpath = HAL_BOARD_STORAGE_DIRECTORY;
     }
 
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+    _journal_init(dpath);
+    _initialised = true;
+    return;
+#endif
+
     int fd = open(dpath, O_RDWR|O_CLOEXEC);
     if (fd == -1) {
         fd = _storage_create(dpath);
@@ -174,24 +188,95 @@ void Storage::init()
     _initialised = true;
 }
 
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+// load the latest complete copy from the journal
+void Storage::_journal_init(const char *dpath)
+{
+    char path[PATH_MAX];
+
+    mkdir_p(dpath, strlen(dpath), 0777);
+    snprintf(path, sizeof(path), "%s/%s", dpath, STORAGE_JOURNAL_FILE);
+    int fd = open(path, O_RDWR|O_CREAT|O_CLOEXEC, 0666);
+    if (fd == -1) {
+        AP_HAL::panic("Cannot create storage %s (%m)", path);
+    }
+
+    const journal_header &header = *(const journal_header *)_journal_buffer;
+    const uint8_t *data = &_journal_buffer[sizeof(journal_header)];
+    bool found = false;
+    for (uint8_t copy = 0; copy < 2; copy++) {
+        // a copy that was being written when power was lost fails the crc
+        if (pread(fd, _journal_buffer, sizeof(_journal_buffer), _journal_offset(copy)) != (ssize_t)sizeof(_journal_buffer) ||
+            header.magic != STORAGE_JOURNAL_MAGIC ||
+            header.crc != crc_crc32(0, data, LINUX_STORAGE_SIZE) ||
+            (found && header.sequence < _journal_sequence)) {
+            continue;
+        }
+        memcpy(_buffer, data, sizeof(_buffer));
+        _journal_sequence = header.sequence;
+        found = true;
+    }
+
+    if (!found) {
+        // start from the storage file if there is one, and commit it as soon as possible
+        snprintf(path, sizeof(path), "%s/%s", dpath, STORAGE_FILE);
+        const int stg_fd = open(path, O_RDONLY|O_CLOEXEC);
+        if (stg_fd == -1 || read(stg_fd, _buffer, sizeof(_buffer)) != sizeof(_buffer)) {
+            memset(_buffer, 0, sizeof(_buffer));
+        }
+        if (stg_fd != -1) {
+            close(stg_fd);
+        }
+        _dirty_mask = UINT32_MAX;
+    }
+
+    _fd = fd;
+}
+
+// write a copy of storage over the older copy, returns false on a write error
+bool Storage::_journal_commit()
+{
+    // changes made from here on are left for the next commit
+    _dirty_mask = 0;
+
+    // commit a snapshot so the crc matches what is written even if storage changes meanwhile
+    journal_header &header = *(journal_header *)_journal_buffer;
+    uint8_t *data = &_journal_buffer[sizeof(journal_header)];
+    memcpy(data, _buffer, LINUX_STORAGE_SIZE);
+    header.magic = STORAGE_JOURNAL_MAGIC;
+    header.sequence = _journal_sequence + 1;
+    header.crc = crc_crc32(0, data, LINUX_STORAGE_SIZE);
+
+    if (pwrite(_fd, _journal_buffer, sizeof(_journal_buffer), _journal_offset(header.sequence % 2)) != (ssize_t)sizeof(_journal_buffer)) {
+        _dirty_mask = UINT32_MAX;
+        return false;
+    }
+    _journal_sequence = header.sequence;
+    _stats.writes++;
+    _stats.bytes_written += sizeof(_journal_buffer);
+    return true;
+}
+#endif // HAL_LINUX_STORAGE_JOURNAL_ENABLED
+
 /*
-  mark some lines as dirty. Note that there is no attempt to avoid
-  the race condition between this code and the _timer_tick() code
-  below, which both update _dirty_mask. If we lose the race then the
-  result is that a line is written more than once, but it won't result
-  in a line not being written.
+  mark some lines as dirty. The timer thread clears the lines it is
+  about to write atomically, so a line changed while it is being
+  written stays dirty and is written again
  */
 void Storage::_mark_dirty(uint16_t loc, uint16_t length)
 {
     if (length == 0) {
         return;
     }
+    uint32_t mask = 0;
     uint16_t end = loc + length - 1;
     for (uint8_t line=loc>>LINUX_STORAGE_LINE_SHIFT;
          line <= end>>LINUX_STORAGE_LINE_SHIFT;
          line++) {
-        _dirty_mask |= 1U << line;
+        mask |= 1U << line;
     }
+    _last_dirty_ms = AP_HAL::millis();
+    _dirty_mask |= mask;
 }
 
 void Storage::read_block(void *dst, uint16_t loc, size_t n)
@@ -217,54 +302,108 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
 
 void Storage::_timer_tick(void)
 {
-    if (!_initialised || _dirty_mask == 0 || _fd == -1) {
+    if (!_initialised || _fd == -1) {
         return;
     }
 
-    // write out the first dirty set of lines. We don't write more
-    // than one to keep the latency of this call to a minimum
-    uint8_t i, n;
-    for (i=0; i<LINUX_STORAGE_NUM_LINES; i++) {
-        if (_dirty_mask & (1<<i)) {
-            break;
+    const uint32_t now_ms = AP_HAL::millis();
+    if (_dirty_mask != 0) {
+        if (!_dirty_seen) {
+            _dirty_seen = true;
+            _first_dirty_ms = now_ms;
         }
-    }
-    if (i == LINUX_STORAGE_NUM_LINES) {
-        // this shouldn't be possible
-        return;
-    }
-    uint32_t write_mask = (1U<<i);
-    // see how many lines to write
-    for (n=1; (i+n) < LINUX_STORAGE_NUM_LINES &&
-             n < (LINUX_STORAGE_MAX_WRITE>>LINUX_STORAGE_LINE_SHIFT); n++) {
-        if (!(_dirty_mask & (1<<(n+i)))) {
-            break;
+        // wait for changes to stop so they are written together
+        if ((now_ms - _last_dirty_ms < LINUX_STORAGE_WRITE_DELAY_MS) &&
+            (now_ms - _first_dirty_ms < LINUX_STORAGE_MAX_WRITE_DELAY_MS)) {
+            return;
+        }
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+        // a commit overwrites the older copy, so the last commit must be on disk first
+        if (now_ms - _last_fsync_ms < LINUX_STORAGE_FSYNC_INTERVAL_MS) {
+            return;
+        }
+        const bool written = _journal_commit();
+#else
+        const bool written = _write_lines();
+#endif
+        if (!written) {
+            // write error - likely EINTR
+            _stats.errors++;
+            close(_fd);
+            _fd = -1;
+            return;
         }
-        // mark that line clean
-        write_mask |= (1<<(n+i));
+        _dirty_seen = false;
+        _fsync_pending = true;
     }
 
-    /*
-      write the lines. This also updates _dirty_mask. Note that
-      because this is a SCHED_FIFO thread it will not be preempted
-      by the main task except during blocking calls. This means we
-      don't need a semaphore around the _dirty_mask updates.
-     */
-    if (lseek(_fd, i<<LINUX_STORAGE_LINE_SHIFT, SEEK_SET) == (i<<LINUX_STORAGE_LINE_SHIFT)) {
-        _dirty_mask &= ~write_mask;
-        if (write(_fd, &_buffer[i<<LINUX_STORAGE_LINE_SHIFT], n<<LINUX_STORAGE_LINE_SHIFT) != n<<LINUX_STORAGE_LINE_SHIFT) {
-            // write error - likely EINTR
-            _dirty_mask |= write_mask;
+    if (_fsync_pending && (now_ms - _last_fsync_ms >= LINUX_STORAGE_FSYNC_INTERVAL_MS)) {
+        if (fsync(_fd) != 0) {
+            _stats.errors++;
             close(_fd);
             _fd = -1;
+            return;
         }
-        if (_dirty_mask == 0) {
-            if (fsync(_fd) != 0) {
-                close(_fd);
-                _fd = -1;
-            }
+        _fsync_pending = false;
+        _last_fsync_ms = now_ms;
+        _stats.fsyncs++;
+    }
+}
+
+/*
+  write the dirty lines in whole pages, with one write for each run of
+  dirty pages. This is run in the IO thread, so the latency of the
+  writes does not affect the main loop
+ */
+bool Storage::_write_lines()
+{
+    // lines changed from here on are left dirty for the next write
+    const uint32_t dirty = _dirty_mask.exchange(0);
+
+    const uint32_t page_mask = (1U << LINUX_STORAGE_LINES_PER_PAGE) - 1;
+    const uint8_t num_pages = LINUX_STORAGE_NUM_LINES / LINUX_STORAGE_LINES_PER_PAGE;
+    uint8_t page = 0;
+    while (page < num_pages) {
+        if (((dirty >> (page * LINUX_STORAGE_LINES_PER_PAGE)) & page_mask) == 0) {
+            page++;
+            continue;
+        }
+        uint8_t end = page + 1;
+        while (end < num_pages && ((dirty >> (end * LINUX_STORAGE_LINES_PER_PAGE)) & page_mask) != 0) {
+            end++;
+        }
+
+        const off_t ofs = off_t(page) << LINUX_STORAGE_PAGE_SHIFT;
+        const size_t length = size_t(end - page) << LINUX_STORAGE_PAGE_SHIFT;
+        if (pwrite(_fd, &_buffer[ofs], length, ofs) != (ssize_t)length) {
+            _dirty_mask |= dirty;
+            return false;
         }
+        _stats.writes++;
+        _stats.bytes_written += length;
+        page = end;
     }
+    return true;
+}
+
+/*
+  print write statistics, with rates since they were last printed
+ */
+void Storage::storage_info(ExpandingString &str)
+{
+    const uint32_t now_ms = AP_HAL::millis();
+    const float dt = MAX(now_ms - _last_stats_ms, 1U) * 0.001f;
+
+    // a header to allow for machine parsers to determine format
+    str.printf("StorageV1\n");
+    str.printf("WRITES=%u (%.1f/s) BYTES=%u (%.0f/s) FSYNC=%u (%.1f/s) ERR=%u\n",
+               unsigned(_stats.writes), (_stats.writes - _last_stats.writes) / dt,
+               unsigned(_stats.bytes_written), (_stats.bytes_written - _last_stats.bytes_written) / dt,
+               unsigned(_stats.fsyncs), (_stats.fsyncs - _last_stats.fsyncs) / dt,
+               unsigned(_stats.errors));
+
+    _last_stats = _stats;
+    _last_stats_ms = now_ms;
 }
 
 /*
@@ -1,13 +1,45 @@
 #pragma once
 
+#include <atomic>
+
 #include <AP_HAL/AP_HAL.h>
+#include <AP_Common/AP_Common.h>
 
 #define LINUX_STORAGE_SIZE HAL_STORAGE_SIZE
-#define LINUX_STORAGE_MAX_WRITE 512
 #define LINUX_STORAGE_LINE_SHIFT 9
 #define LINUX_STORAGE_LINE_SIZE (1<<LINUX_STORAGE_LINE_SHIFT)
 #define LINUX_STORAGE_NUM_LINES (LINUX_STORAGE_SIZE/LINUX_STORAGE_LINE_SIZE)
 
+// dirty lines are written in whole pages of this size. The kernel writes
+// back whole pages anyway, so including clean lines in a dirty page costs
+// no extra wear and lets nearby changes go in a single write
+#define LINUX_STORAGE_PAGE_SHIFT 12
+#define LINUX_STORAGE_LINES_PER_PAGE (1<<(LINUX_STORAGE_PAGE_SHIFT-LINUX_STORAGE_LINE_SHIFT))
+
+// changes are written once storage has not been changed for
+// LINUX_STORAGE_WRITE_DELAY_MS, or once the first change is
+// LINUX_STORAGE_MAX_WRITE_DELAY_MS old, so a parameter save or mission
+// upload is written in one go rather than a line at a time
+#define LINUX_STORAGE_WRITE_DELAY_MS 100
+#define LINUX_STORAGE_MAX_WRITE_DELAY_MS 1000
+
+// minimum time between calls to fsync
+#define LINUX_STORAGE_FSYNC_INTERVAL_MS 1000
+
+/*
+  keep two copies of storage in a journal file and commit changes by
+  writing a whole copy over the older one, so a power loss during a
+  write always leaves one complete copy. Costs a write of all of
+  storage for each commit
+ */
+#ifndef HAL_LINUX_STORAGE_JOURNAL_ENABLED
+#define HAL_LINUX_STORAGE_JOURNAL_ENABLED 0
+#endif
+
+static_assert(LINUX_STORAGE_NUM_LINES <= 32, "dirty lines must fit in a 32 bit mask");
+static_assert(LINUX_STORAGE_NUM_LINES % LINUX_STORAGE_LINES_PER_PAGE == 0, "storage must be a whole number of pages");
+static_assert(LINUX_STORAGE_LINES_PER_PAGE < 32, "a page of lines must fit in a 32 bit mask");
+
 namespace Linux {
 
 class Storage : public AP_HAL::Storage
@@ -34,16 +66,55 @@ public:
 
     bool get_storage_ptr(void *&ptr, size_t &size) override;
 
+    void storage_info(ExpandingString &str) override;
+
     virtual void _timer_tick(void) override;
 
 protected:
     void _mark_dirty(uint16_t loc, uint16_t length);
     int _storage_create(const char *dpath);
 
+    // write the dirty lines, returns false on a write error
+    bool _write_lines();
+
     int _fd;
     volatile bool _initialised;
-    volatile uint32_t _dirty_mask;
+    std::atomic<uint32_t> _dirty_mask;
+    volatile uint32_t _last_dirty_ms;   // time of the latest change
+    uint32_t _first_dirty_ms;           // time the timer first saw changes since storage was last written
+    bool _dirty_seen;
+    uint32_t _last_fsync_ms;
+    bool _fsync_pending;
     uint8_t _buffer[LINUX_STORAGE_SIZE];
+
+#if HAL_LINUX_STORAGE_JOURNAL_ENABLED
+    struct PACKED journal_header {
+        uint32_t magic;
+        uint32_t sequence;  // the copy with the highest sequence is the latest
+        uint32_t crc;       // crc32 of the copy
+    };
+
+    // load the latest complete copy from the journal
+    void _journal_init(const char *dpath);
+
+    // write a copy of storage over the older copy, returns false on a write error
+    bool _journal_commit();
+
+    // offset of a copy in the journal file
+    static off_t _journal_offset(uint8_t copy) { return copy * off_t(sizeof(journal_header) + LINUX_STORAGE_SIZE); }
+
+    uint32_t _journal_sequence;
+    uint8_t _journal_buffer[sizeof(journal_header) + LINUX_STORAGE_SIZE];
+#endif
+
+    // flush statistics for @SYS/storage.txt
+    struct {
+        uint32_t writes;
+        uint32_t bytes_written;
+        uint32_t fsyncs;
+        uint32_t errors;
+    } _stats, _last_stats;
+    uint32_t _last_stats_ms;
 };
 
 }
@@ -0,0 +1,222 @@
+#include <AP_gtest.h>
+
+#include <linux/spi/spidev.h>
+#include <stdarg.h>
+#include <sys/ioctl.h>
+#include <vector>
+
+#include <AP_Common/AP_Common.h>
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_HAL_Linux/SPIDevice.h>
+#include <AP_HAL_Linux/SPIDevice_internal.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define FAKE_SPIDEV_FD 1000
+
+/*
+  spidev replacement recording the messages submitted by SPIDevice,
+  each as the list of its segments
+ */
+static struct {
+    std::vector<std::vector<struct spi_ioc_transfer>> messages;
+    unsigned mode_sets;
+    bool fail;
+} fake_spidev;
+
+extern "C" int ioctl(int fd, unsigned long request, ...) __THROW
+{
+    va_list ap;
+    va_start(ap, request);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (fd != FAKE_SPIDEV_FD || _IOC_TYPE(request) != SPI_IOC_MAGIC) {
+        errno = ENOTTY;
+        return -1;
+    }
+    if (request == SPI_IOC_WR_MODE) {
+        fake_spidev.mode_sets++;
+        return 0;
+    }
+    if (fake_spidev.fail) {
+        errno = EIO;
+        return -1;
+    }
+    const unsigned nsegments = _IOC_SIZE(request) / sizeof(struct spi_ioc_transfer);
+    const struct spi_ioc_transfer *segments = (const struct spi_ioc_transfer *)arg;
+    fake_spidev.messages.emplace_back(segments, segments + nsegments);
+    return 0;
+}
+
+class SPIDeviceBatchTest : public ::testing::Test {
+protected:
+    SPIDeviceBatchTest() :
+        bus(0),
+        desc("test", 0, 0, SPI_MODE_0, 8, SPI_CS_KERNEL, 1000000, 10000000)
+    {
+        bus.fd[0] = FAKE_SPIDEV_FD;
+        fake_spidev.messages.clear();
+        fake_spidev.mode_sets = 0;
+        fake_spidev.fail = false;
+        dev = new SPIDevice(bus, desc);
+    }
+
+    ~SPIDeviceBatchTest()
+    {
+        delete dev;
+        bus.fd[0] = -1;
+    }
+
+    // check the segments of a message release the chip select after
+    // the last segment of each transaction except the last one
+    void check_cs_change(const std::vector<struct spi_ioc_transfer> &message,
+                         const std::vector<unsigned> &transaction_ends)
+    {
+        for (unsigned i = 0; i < message.size(); i++) {
+            bool end = false;
+            for (auto e : transaction_ends) {
+                end |= (e == i);
+            }
+            const bool expected = end && (i != message.size() - 1);
+            EXPECT_EQ(message[i].cs_change, expected ? 1 : 0) << "segment " << i;
+        }
+    }
+
+    SPIBus bus;
+    SPIDesc desc;
+    SPIDevice *dev;
+};
+
+TEST_F(SPIDeviceBatchTest, Supported)
+{
+    EXPECT_TRUE(dev->transfer_batch_supported());
+}
+
+TEST_F(SPIDeviceBatchTest, OneMessage)
+{
+    uint8_t reg_write[2] { 0x10, 0x01 };
+    uint8_t reg_read = 0x80 | 0x20;
+    uint8_t value[6];
+    uint8_t duplex[4] { 0x80 | 0x30 };
+    const AP_HAL::Device::Transfer transfers[] {
+        { reg_write, sizeof(reg_write), nullptr, 0 },
+        { &reg_read, 1, value, sizeof(value) },
+        { duplex, sizeof(duplex), duplex, sizeof(duplex) },
+    };
+
+    EXPECT_TRUE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    ASSERT_EQ(fake_spidev.messages.size(), 1U);
+    EXPECT_EQ(fake_spidev.mode_sets, 1U);
+
+    const auto &m = fake_spidev.messages[0];
+    ASSERT_EQ(m.size(), 4U);
+    EXPECT_EQ(m[0].tx_buf, (uint64_t)reg_write);
+    EXPECT_EQ(m[0].rx_buf, 0U);
+    EXPECT_EQ(m[0].len, sizeof(reg_write));
+    EXPECT_EQ(m[1].tx_buf, (uint64_t)&reg_read);
+    EXPECT_EQ(m[1].len, 1U);
+    EXPECT_EQ(m[2].rx_buf, (uint64_t)value);
+    EXPECT_EQ(m[2].len, sizeof(value));
+    // the same send and receive buffer is one full duplex segment
+    EXPECT_EQ(m[3].tx_buf, (uint64_t)duplex);
+    EXPECT_EQ(m[3].rx_buf, (uint64_t)duplex);
+    EXPECT_EQ(m[3].len, sizeof(duplex));
+    for (const auto &s : m) {
+        EXPECT_EQ(s.speed_hz, desc.highspeed);
+        EXPECT_EQ(s.bits_per_word, desc.bits_per_word);
+    }
+    check_cs_change(m, { 0, 2, 3 });
+
+    // the mode is only set when it changes
+    EXPECT_TRUE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+    EXPECT_EQ(fake_spidev.messages.size(), 2U);
+    EXPECT_EQ(fake_spidev.mode_sets, 1U);
+}
+
+TEST_F(SPIDeviceBatchTest, SegmentLimit)
+{
+    // two segments per transaction, so a message holds half as many
+    // transactions as segments and they are never split across messages
+    const uint8_t count = SPI_BATCH_MAX_SEGMENTS + 3;
+    uint8_t reg[count];
+    uint8_t value[count][2];
+    AP_HAL::Device::Transfer transfers[count];
+    for (uint8_t i = 0; i < count; i++) {
+        reg[i] = 0x80 | i;
+        transfers[i] = { &reg[i], 1, value[i], sizeof(value[i]) };
+    }
+
+    EXPECT_TRUE(dev->transfer_batch(transfers, count));
+
+    const unsigned per_message = SPI_BATCH_MAX_SEGMENTS / 2;
+    const unsigned num_messages = (count + per_message - 1) / per_message;
+    ASSERT_EQ(fake_spidev.messages.size(), num_messages);
+    unsigned t = 0;
+    for (const auto &m : fake_spidev.messages) {
+        const unsigned n = MIN(per_message, count - t);
+        ASSERT_EQ(m.size(), n * 2);
+        std::vector<unsigned> ends;
+        for (unsigned i = 0; i < n; i++, t++) {
+            EXPECT_EQ(m[i*2].tx_buf, (uint64_t)&reg[t]);
+            EXPECT_EQ(m[i*2+1].rx_buf, (uint64_t)value[t]);
+            ends.push_back(i*2+1);
+        }
+        check_cs_change(m, ends);
+    }
+    EXPECT_EQ(t, count);
+}
+
+TEST_F(SPIDeviceBatchTest, ByteLimit)
+{
+    // each transaction is a one byte command and a read of most of a third
+    // of the spidev buffer, so only two fit in each message
+    const uint8_t count = 5;
+    const uint32_t read_len = SPI_BATCH_MAX_BYTES / 3 + 100;
+    uint8_t reg = 0x80;
+    std::vector<uint8_t> data(read_len * count);
+    AP_HAL::Device::Transfer transfers[count];
+    for (uint8_t i = 0; i < count; i++) {
+        transfers[i] = { &reg, 1, &data[i * read_len], read_len };
+    }
+
+    EXPECT_TRUE(dev->transfer_batch(transfers, count));
+
+    ASSERT_EQ(fake_spidev.messages.size(), 3U);
+    const unsigned expected_transactions[] { 2, 2, 1 };
+    for (unsigned i = 0; i < 3; i++) {
+        const auto &m = fake_spidev.messages[i];
+        ASSERT_EQ(m.size(), expected_transactions[i] * 2);
+        uint32_t bytes = 0;
+        for (const auto &s : m) {
+            bytes += s.len;
+        }
+        EXPECT_LE(bytes, (uint32_t)SPI_BATCH_MAX_BYTES);
+        check_cs_change(m, { 1, 3 });
+    }
+}
+
+TEST_F(SPIDeviceBatchTest, Failure)
+{
+    uint8_t reg = 0x80;
+    uint8_t value;
+    const AP_HAL::Device::Transfer transfers[] {
+        { &reg, 1, &value, 1 },
+    };
+
+    fake_spidev.fail = true;
+    EXPECT_FALSE(dev->transfer_batch(transfers, ARRAY_SIZE(transfers)));
+
+    // an empty transaction is rejected without touching the bus
+    fake_spidev.fail = false;
+    const AP_HAL::Device::Transfer empty[] {
+        { nullptr, 0, nullptr, 0 },
+    };
+    EXPECT_FALSE(dev->transfer_batch(empty, ARRAY_SIZE(empty)));
+    EXPECT_TRUE(fake_spidev.messages.empty());
+}
+
+AP_GTEST_MAIN()
@@ -30,6 +30,17 @@ using namespace HALSITL;
 
 extern const AP_HAL::HAL& hal;
 
+// simple integer log2
+static uint16_t fft_log2(uint16_t n)
+{
+    uint16_t k = n, i = 0;
+    while (k) {
+        k >>= 1;
+        i++;
+    }
+    return i - 1;
+}
+
 // The algorithms originally came from betaflight but are now substantially modified based on theory and experiment.
 // https://holometer.fnal.gov/GH_FFT.pdf "Spectrum and spectral density estimation by the Discrete Fourier transform (DFT),
 // including a comprehensive list of window functions and some new flat-top windows." - Heinzel et. al is a great reference
@@ -40,7 +51,8 @@ extern const AP_HAL::HAL& hal;
 AP_HAL::DSP::FFTWindowState* DSP::fft_init(uint16_t window_size, uint16_t sample_rate, uint8_t sliding_window_size)
 {
     DSP::FFTWindowStateSITL* fft = new DSP::FFTWindowStateSITL(window_size, sample_rate, sliding_window_size);
-    if (fft == nullptr || fft->_hanning_window == nullptr || fft->_rfft_data == nullptr || fft->_freq_bins == nullptr || fft->_derivative_freq_bins == nullptr) {
+    if (fft == nullptr || fft->_hanning_window == nullptr || fft->_rfft_data == nullptr || fft->_freq_bins == nullptr || fft->_derivative_freq_bins == nullptr
+        || fft->buf == nullptr || fft->twiddles == nullptr || fft->bit_reverse == nullptr) {
         delete fft;
         return nullptr;
     }
@@ -71,12 +83,38 @@ DSP::FFTWindowStateSITL::FFTWindowStateSITL(uint16_t window_size, uint16_t sampl
         return;
     }
 
-    buf = new complexf[window_size];
+    // the real FFT of the window is calculated with a complex FFT of half the length
+    const uint16_t half_size = window_size / 2;
+    buf = new complexf[half_size];
+    twiddles = new complexf[half_size];
+    bit_reverse = new uint16_t[half_size];
+    if (buf == nullptr || twiddles == nullptr || bit_reverse == nullptr) {
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Failed to allocate window for DSP");
+        return;
+    }
+
+    // precalculate the twiddle factors rather than calling sinf() in every butterfly,
+    // the sign convention matches the original Cooley–Tukey implementation
+    for (uint16_t k = 0; k < half_size; k++) {
+        const double angle = 2 * M_PI * k / window_size;
+        twiddles[k] = complexf(cos(angle), sin(angle));
+    }
+
+    const uint16_t m = fft_log2(half_size);
+    for (uint16_t k = 0; k < half_size; k++) {
+        uint16_t kr = 0;
+        for (uint16_t i = 0; i < m; i++) {
+            kr = (kr << 1) | ((k >> i) & 1);
+        }
+        bit_reverse[k] = kr;
+    }
 }
 
 DSP::FFTWindowStateSITL::~FFTWindowStateSITL()
 {
     delete[] buf;
+    delete[] twiddles;
+    delete[] bit_reverse;
 }
 
 // step 1: filter the incoming samples through a Hanning window
@@ -93,23 +131,14 @@ void DSP::step_hanning(FFTWindowStateSITL* fft, FloatBuffer& samples, uint16_t a
     mult_f32(&fft->_freq_bins[0], &fft->_hanning_window[0], &fft->_freq_bins[0], fft->_window_size);
 }
 
-// step 2: perform an in-place FFT on the windowed data
+// step 2: perform a real FFT on the windowed data
 void DSP::step_fft(FFTWindowStateSITL* fft)
 {
-    for (uint16_t i = 0; i < fft->_window_size; i++) {
-        fft->buf[i] = complexf(fft->_freq_bins[i], 0);
-    }
+    // _rfft_data holds the complex bins from DC to nyquist
+    calculate_rfft(fft);
 
-    calculate_fft(fft->buf, fft->_window_size);
-
-    for (uint16_t i = 0; i < fft->_bin_count; i++) {
-        fft->_freq_bins[i] = std::norm(fft->buf[i]);
-    }
-
-    // components at the nyquist frequency are real only
-    for (uint16_t i = 0, j = 0; i <= fft->_bin_count; i++, j += 2) {
-        fft->_rfft_data[j] = fft->buf[i].real();
-        fft->_rfft_data[j+1] = fft->buf[i].imag();
+    for (uint16_t i = 0, j = 0; i < fft->_bin_count; i++, j += 2) {
+        fft->_freq_bins[i] = sq(fft->_rfft_data[j]) + sq(fft->_rfft_data[j+1]);
     }
 }
 
@@ -156,56 +185,68 @@ float DSP::vector_mean_float(const float* vin, uint16_t len) const
     return mean_value;
 }
 
-// simple integer log2
-static uint16_t fft_log2(uint16_t n)
+// calculate the FFT of the real windowed samples in _freq_bins into _rfft_data. The even samples
+// are packed into the real parts and the odd samples into the imaginary parts of a complex
+// sequence of half the length, whose FFT is then split into the spectrum of the real samples
+void DSP::calculate_rfft(FFTWindowStateSITL* fft)
 {
-    uint16_t k = n, i = 0;
-    while (k) {
-        k >>= 1;
-        i++;
+    const uint16_t half_size = fft->_bin_count;
+    const float* samples = fft->_freq_bins;
+    complexf* z = fft->buf;
+
+    // shuffle data using bit reversed addressing as it is packed
+    for (uint16_t k = 0; k < half_size; k++) {
+        z[fft->bit_reverse[k]] = complexf(samples[2*k], samples[2*k+1]);
     }
-    return i - 1;
-}
 
-// calculate the in-place FFT of the input using the Cooley–Tukey algorithm
-// this is a translation of Ron Nicholson's version in http://www.nicholson.com/dsp.fft1.html
-void DSP::calculate_fft(complexf *samples, uint16_t fftlen)
-{
-    uint16_t m = fft_log2(fftlen);
-    // shuffle data using bit reversed addressing ***
-    for (uint16_t k = 0; k < fftlen; k++) {
-        // generate a bit reversed address for samples[k] ***
-        uint16_t ki = k, kr = 0;
-        for (uint16_t i=1; i<=m; i++) {
-            kr <<= 1; //  left shift result kr by 1 bit
-            if (ki % 2 == 1) {
-                kr++;
-            }
-            ki >>= 1; // right shift temp ki by 1 bit
-        }
-        // swap data samples[k] to bit reversed address samples[kr]
-        if (kr > k) {
-            complexf t = samples[kr];
-            samples[kr] = samples[k];
-            samples[k] = t;
-        }
+    calculate_fft(fft, z, half_size);
+
+    // the DC and nyquist components are real only
+    float* out = fft->_rfft_data;
+    out[0] = z[0].real() + z[0].imag();
+    out[1] = 0.0f;
+    out[2*half_size] = z[0].real() - z[0].imag();
+    out[2*half_size+1] = 0.0f;
+
+    // X[k] = E[k] + W^k * O[k] where E and O are the spectra of the even and odd samples
+    // E[k] = (Z[k] + conj(Z[N/2-k])) / 2, O[k] = (Z[k] - conj(Z[N/2-k])) / 2i
+    for (uint16_t k = 1; k < half_size; k++) {
+        const float ar = z[k].real();
+        const float ai = z[k].imag();
+        const float br = z[half_size - k].real();
+        const float bi = -z[half_size - k].imag();
+        const float er = 0.5f * (ar + br);
+        const float ei = 0.5f * (ai + bi);
+        const float or_ = 0.5f * (ai - bi);
+        const float oi = -0.5f * (ar - br);
+        const float wr = fft->twiddles[k].real();
+        const float wi = fft->twiddles[k].imag();
+        out[2*k] = er + wr * or_ - wi * oi;
+        out[2*k+1] = ei + wr * oi + wi * or_;
     }
+}
 
-    // do fft butterflys in place
+// calculate the in-place FFT of bit reversed input using the Cooley–Tukey algorithm
+// this is derived from Ron Nicholson's version in http://www.nicholson.com/dsp.fft1.html
+// using the precalculated twiddle factors of the window, which has twice the length
+void DSP::calculate_fft(FFTWindowStateSITL* fft, complexf *samples, uint16_t fftlen)
+{
+    // do fft butterflys in place, the complex multiplication is written out to avoid
+    // the overhead of std::complex handling of infinities
     uint16_t istep = 2;
     while (istep <= fftlen) {// layers 2,4,8,16, ... ,n
-        uint16_t is2 = istep / 2;
-        uint16_t astep = fftlen / istep;
+        const uint16_t is2 = istep / 2;
+        const uint16_t astep = 2 * fftlen / istep;
         for (uint16_t km = 0; km < is2; km++) { // outer row loop
-            uint16_t a  = km * astep; // twiddle angle index
-            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
-            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) { // inner column loop
-                uint16_t i = km + ki;
-                uint16_t j = is2 + i;
-                complexf t = w * samples[j];
-                complexf q = samples[i];
-                samples[j] = q - t;
-                samples[i] = q + t;
+            const float wr = fft->twiddles[km * astep].real();
+            const float wi = fft->twiddles[km * astep].imag();
+            for (uint16_t i = km; i < fftlen; i += istep) { // inner column loop
+                const uint16_t j = is2 + i;
+                const float tr = wr * samples[j].real() - wi * samples[j].imag();
+                const float ti = wr * samples[j].imag() + wi * samples[j].real();
+                const complexf q = samples[i];
+                samples[j] = complexf(q.real() - tr, q.imag() - ti);
+                samples[i] = complexf(q.real() + tr, q.imag() + ti);
             }
         }
         istep <<= 1;
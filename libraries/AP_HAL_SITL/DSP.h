@@ -45,7 +45,12 @@ public:
         virtual ~FFTWindowStateSITL();
 
     private:
+        // workspace for the half length complex FFT of the real samples
         complexf* buf;
+        // twiddle factors exp(2*pi*i*k/window_size) for k < window_size/2
+        complexf* twiddles;
+        // bit reversed index for each element of buf
+        uint16_t* bit_reverse;
     };
 
 private:
@@ -56,7 +61,8 @@ private:
     void vector_scale_float(const float* vin, float scale, float* vout, uint16_t len) const override;
     float vector_mean_float(const float* vin, uint16_t len) const override;
     void vector_add_float(const float* vin1, const float* vin2, float* vout, uint16_t len) const override;
-    void calculate_fft(complexf* f, uint16_t length);
+    void calculate_fft(FFTWindowStateSITL* fft, complexf* samples, uint16_t fftlen);
+    void calculate_rfft(FFTWindowStateSITL* fft);
 };
 
 #endif
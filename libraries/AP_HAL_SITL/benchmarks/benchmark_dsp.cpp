@@ -0,0 +1,44 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_WITH_DSP
+
+/*
+  one frame of gyro FFT analysis: window the samples, FFT them and
+  find the peaks, as AP_GyroFFT does for each axis
+ */
+static void BM_DSPFFTAnalyse(benchmark::State &state)
+{
+    const uint16_t window_size = state.range(0);
+    const uint16_t sample_rate = 1000;
+    AP_HAL::DSP::FFTWindowState *fft = hal.dsp->fft_init(window_size, sample_rate);
+    if (fft == nullptr) {
+        state.SkipWithError("failed to allocate FFT");
+        return;
+    }
+
+    FloatBuffer samples(window_size);
+    for (uint16_t i = 0; i < window_size; i++) {
+        const float t = float(i) / sample_rate;
+        samples.push(sinf(2 * M_PI * 180 * t) + 0.3 * sinf(2 * M_PI * 67 * t));
+    }
+
+    while (state.KeepRunning()) {
+        // don't advance so each frame analyses the same samples
+        hal.dsp->fft_start(fft, samples, 0);
+        gbenchmark_escape(fft->_freq_bins);
+        hal.dsp->fft_analyse(fft, 1, fft->_bin_count - 1, 0.5);
+        gbenchmark_escape(fft->_freq_bins);
+    }
+    delete fft;
+}
+
+BENCHMARK(BM_DSPFFTAnalyse)->RangeMultiplier(2)->Range(32, 1024);
+
+#endif // HAL_WITH_DSP
+
+BENCHMARK_MAIN();
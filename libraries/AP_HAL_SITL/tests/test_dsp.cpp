@@ -0,0 +1,115 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Math/AP_Math.h>
+
+#include <complex>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if HAL_WITH_DSP
+
+typedef std::complex<float> complexf;
+
+/*
+  reference complex FFT of the full window, as SITL calculated it
+  before moving to a real FFT with precalculated twiddle factors
+ */
+static void reference_fft(complexf *samples, uint16_t fftlen)
+{
+    uint16_t m = 0;
+    while ((1U << (m+1)) <= fftlen) {
+        m++;
+    }
+    for (uint16_t k = 0; k < fftlen; k++) {
+        uint16_t ki = k, kr = 0;
+        for (uint16_t i=1; i<=m; i++) {
+            kr <<= 1;
+            if (ki % 2 == 1) {
+                kr++;
+            }
+            ki >>= 1;
+        }
+        if (kr > k) {
+            complexf t = samples[kr];
+            samples[kr] = samples[k];
+            samples[k] = t;
+        }
+    }
+
+    uint16_t istep = 2;
+    while (istep <= fftlen) {
+        uint16_t is2 = istep / 2;
+        uint16_t astep = fftlen / istep;
+        for (uint16_t km = 0; km < is2; km++) {
+            uint16_t a  = km * astep;
+            complexf w(sinf(2 * M_PI * (a+(fftlen/4)) / fftlen), sinf(2 * M_PI * a / fftlen));
+            for (uint16_t ki = 0; ki <= (fftlen - istep); ki += istep) {
+                uint16_t i = km + ki;
+                uint16_t j = is2 + i;
+                complexf t = w * samples[j];
+                complexf q = samples[i];
+                samples[j] = q - t;
+                samples[i] = q + t;
+            }
+        }
+        istep <<= 1;
+    }
+}
+
+/*
+  check the FFT bins and the detected peak against the reference
+  implementation for a range of window sizes and tones
+ */
+TEST(DSPTest, RealFFTMatchesReference)
+{
+    const uint16_t sample_rate = 1000;
+    const float noise_att_cutoff = 0.5;
+
+    for (uint16_t window_size = 32; window_size <= 1024; window_size *= 2) {
+        AP_HAL::DSP::FFTWindowState *state = hal.dsp->fft_init(window_size, sample_rate);
+        ASSERT_NE(state, nullptr);
+
+        FloatBuffer samples(window_size);
+        complexf *ref = new complexf[window_size];
+        const uint16_t end_bin = state->_bin_count - 1;
+
+        for (uint8_t tone = 0; tone < 10; tone++) {
+            // a dominant tone between bins plus two weaker ones
+            const float freq = 60 + 37.3 * tone;
+            for (uint16_t i = 0; i < window_size; i++) {
+                const float t = float(i) / sample_rate;
+                const float v = sinf(2 * M_PI * freq * t + tone)
+                    + 0.3 * sinf(2 * M_PI * (freq * 0.37) * t)
+                    + 0.2 * cosf(2 * M_PI * (freq * 1.61) * t);
+                samples.push(v);
+                ref[i] = complexf(v * state->_hanning_window[i], 0);
+            }
+            reference_fft(ref, window_size);
+
+            hal.dsp->fft_start(state, samples, window_size);
+            hal.dsp->fft_analyse(state, 1, end_bin, noise_att_cutoff);
+
+            float max_mag = 0;
+            uint16_t ref_peak = 1;
+            for (uint16_t i = 0; i <= state->_bin_count; i++) {
+                max_mag = MAX(max_mag, std::abs(ref[i]));
+                if (i >= 1 && i <= end_bin && std::norm(ref[i]) > std::norm(ref[ref_peak])) {
+                    ref_peak = i;
+                }
+            }
+            for (uint16_t i = 0; i <= state->_bin_count; i++) {
+                EXPECT_NEAR(state->_rfft_data[2*i], ref[i].real(), max_mag * 1e-5);
+                EXPECT_NEAR(state->_rfft_data[2*i+1], ref[i].imag(), max_mag * 1e-5);
+            }
+            EXPECT_EQ(state->_peak_data[AP_HAL::DSP::CENTER]._bin, ref_peak);
+        }
+
+        delete[] ref;
+        delete state;
+    }
+}
+
+#endif // HAL_WITH_DSP
+
+AP_GTEST_MAIN()
@@ -394,14 +394,34 @@ void AP_InertialSensor_BMI088::read_fifo_accel(void)
 void AP_InertialSensor_BMI088::read_fifo_gyro(void)
 {
     uint8_t num_frames;
-    if (!dev_gyro->read_registers(REGG_FIFO_STATUS, &num_frames, 1)) {
-        _inc_gyro_error_count(gyro_instance);
-        return;
-    }
     const float scale = radians(2000.0f) / 32767.0f;
     const uint8_t max_frames = 8;
     const Vector3i bad_frame{INT16_MIN,INT16_MIN,INT16_MIN};
     Vector3i data[max_frames];
+    uint8_t frames_read = 0;
+
+    if (dev_gyro->transfer_batch_supported()) {
+        /*
+          read the status and the first frame in one submission to the
+          bus. As we are synchronised with the ODR there is usually
+          exactly one frame waiting. Reading an empty fifo gives a bad
+          frame which is skipped below
+         */
+        const uint8_t status_reg = REGG_FIFO_STATUS | 0x80;
+        const uint8_t data_reg = REGG_FIFO_DATA | 0x80;
+        const AP_HAL::Device::Transfer transfers[2] {
+            { &status_reg, 1, &num_frames, 1 },
+            { &data_reg, 1, (uint8_t *)&data[0], 6 },
+        };
+        if (!dev_gyro->transfer_batch(transfers, ARRAY_SIZE(transfers))) {
+            _inc_gyro_error_count(gyro_instance);
+            return;
+        }
+        frames_read = 1;
+    } else if (!dev_gyro->read_registers(REGG_FIFO_STATUS, &num_frames, 1)) {
+        _inc_gyro_error_count(gyro_instance);
+        return;
+    }
 
     if (num_frames & 0x80) {
         // fifo overrun, reset, likely caused by scheduling error
@@ -413,17 +433,20 @@ void AP_InertialSensor_BMI088::read_fifo_gyro(void)
     
     // don't read more than 8 frames at a time
     num_frames = MIN(num_frames, max_frames);
-    if (num_frames == 0) {
-        goto check_next;
+    if (num_frames != 0) {
+        // adjust the periodic callback to be synchronous with the incoming data
+        // this means that we rarely run read_fifo_gyro() without updating the sensor data
+        dev_gyro->adjust_periodic_callback(gyro_periodic_handle, GYRO_BACKEND_PERIOD_US);
     }
 
-    // adjust the periodic callback to be synchronous with the incoming data
-    // this means that we rarely run read_fifo_gyro() without updating the sensor data
-    dev_gyro->adjust_periodic_callback(gyro_periodic_handle, GYRO_BACKEND_PERIOD_US);
-
-    if (!dev_gyro->read_registers(REGG_FIFO_DATA, (uint8_t *)data, num_frames*6)) {
-        _inc_gyro_error_count(gyro_instance);
-        goto check_next;
+    if (num_frames > frames_read) {
+        if (!dev_gyro->read_registers(REGG_FIFO_DATA, (uint8_t *)&data[frames_read], (num_frames-frames_read)*6)) {
+            _inc_gyro_error_count(gyro_instance);
+            goto check_next;
+        }
+    } else {
+        // a frame read with the status may have arrived after it
+        num_frames = frames_read;
     }
 
     // data is 16 bits with 2000dps range
@@ -503,6 +503,19 @@ bool AP_InertialSensor_Invensensev3::accumulate_highres_samples(const FIFODataHi
 }
 #endif
 
+/*
+  accumulate n_samples from the FIFO buffer in the current sample format
+ */
+bool AP_InertialSensor_Invensensev3::accumulate_fifo_samples(const void *data, uint8_t n_samples)
+{
+#if HAL_INS_HIGHRES_SAMPLE
+    if (highres_sampling) {
+        return accumulate_highres_samples((const FIFODataHighRes*)data, n_samples);
+    }
+#endif
+    return accumulate_samples((const FIFOData*)data, n_samples);
+}
+
 /*
   timer function called at ODR rate
  */
@@ -534,13 +547,40 @@ void AP_InertialSensor_Invensensev3::read_fifo()
 #else
     const uint8_t fifo_sample_size = INV3_SAMPLE_SIZE;
 #endif
-    if (!block_read(reg_counth, (uint8_t*)&n_samples, 2)) {
-        goto check_registers;
-    }
-
-    if (n_samples == 0) {
-        /* Not enough data in FIFO */
-        goto check_registers;
+    if (dev->transfer_batch_supported()) {
+        /*
+          read the count and the first sample in one submission to the
+          bus. As we are synchronised with the ODR there is usually
+          exactly one sample waiting, so that is all we need
+         */
+        const uint8_t count_reg = reg_counth | BIT_READ_FLAG;
+        const uint8_t data_reg = reg_data | BIT_READ_FLAG;
+        const AP_HAL::Device::Transfer transfers[2] {
+            { &count_reg, 1, (uint8_t*)&n_samples, 2 },
+            { &data_reg, 1, (uint8_t*)fifo_buffer, fifo_sample_size },
+        };
+        if (!dev->transfer_batch(transfers, ARRAY_SIZE(transfers))) {
+            goto check_registers;
+        }
+        if (n_samples == 0) {
+            // a sample may have arrived between the two reads,
+            // otherwise the header marks the FIFO as empty
+            accumulate_fifo_samples(fifo_buffer, 1);
+            goto check_registers;
+        }
+        if (!accumulate_fifo_samples(fifo_buffer, 1)) {
+            fifo_reset();
+            goto check_registers;
+        }
+        n_samples--;
+    } else {
+        if (!block_read(reg_counth, (uint8_t*)&n_samples, 2)) {
+            goto check_registers;
+        }
+        if (n_samples == 0) {
+            /* Not enough data in FIFO */
+            goto check_registers;
+        }
     }
 
     // adjust the periodic callback to be synchronous with the incoming data
@@ -552,15 +592,7 @@ void AP_InertialSensor_Invensensev3::read_fifo()
         if (!block_read(reg_data, (uint8_t*)fifo_buffer, n * fifo_sample_size)) {
             goto check_registers;
         }
-#if HAL_INS_HIGHRES_SAMPLE
-        if (highres_sampling) {
-            if (!accumulate_highres_samples((FIFODataHighRes*)fifo_buffer, n)) {
-                need_reset = true;
-                break;
-            }
-        } else
-#endif
-        if (!accumulate_samples((FIFOData*)fifo_buffer, n)) {
+        if (!accumulate_fifo_samples(fifo_buffer, n)) {
             need_reset = true;
             break;
         }
@@ -73,6 +73,7 @@ private:
 
     bool accumulate_samples(const struct FIFOData *data, uint8_t n_samples);
     bool accumulate_highres_samples(const struct FIFODataHighRes *data, uint8_t n_samples);
+    bool accumulate_fifo_samples(const void *data, uint8_t n_samples);
 
     // instance numbers of accel and gyro data
     uint8_t gyro_instance;
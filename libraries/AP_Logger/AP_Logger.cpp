@@ -188,6 +188,25 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @RebootRequired: True
     AP_GROUPINFO("_MAX_FILES", 12, AP_Logger, _params.max_log_files, MAX_LOG_FILES),
 
+#if HAL_LOGGING_FILESYSTEM_ENABLED
+    // @Param: _FILE_OPTS
+    // @DisplayName: File backend options
+    // @Description: Options for the File logging backend. GatherWrite makes the IO thread write all buffered log data with a single gather write instead of 4 kilobyte chunks, avoiding an extra copy and reducing the number of write calls. GatherWrite is only available on Linux and SITL. Compress writes new logs as a sequence of LZ4 compressed frames, which typically makes logs 20 to 45 percent smaller at the cost of some CPU on the IO thread. Compressed logs can be read by Replay or converted back to a normal log with Tools/scripts/decompress_log.py. Index adds an LIDX message once a second recording the message types logged since the previous one, which lets log readers such as Replay skip to a time range or message type without reading the whole log.
+    // @Bitmask: 0:GatherWrite,1:Compress,2:Index
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_OPTS", 13, AP_Logger, _params.file_options, 0),
+#endif
+
+#if HAL_LOGGING_MAVLINK_ENABLED
+    // @Param: _MAV_WINDOW
+    // @DisplayName: Maximum unacknowledged blocks for mavlink backend
+    // @Description: This sets the maximum number of log blocks the mavlink backend will have sent and not yet had acknowledged. Within this limit the window adapts to the losses and round trip time seen on the link. Larger windows suit links with a long round trip time; smaller windows limit the data resent over lossy radios. A value of zero allows the whole buffer to be in flight.
+    // @Range: 0 127
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("_MAV_WINDOW", 14, AP_Logger, _params.mav_window, 0),
+#endif
+
     AP_GROUPEND
 };
 
@@ -314,6 +314,16 @@ public:
 
     vehicle_startup_message_Writer _vehicle_messages;
 
+    // bits for LOG_FILE_OPTS
+    enum class FileOptions : uint8_t {
+        GATHER_WRITE = (1U<<0),
+        COMPRESS = (1U<<1),
+        INDEX = (1U<<2),
+    };
+    bool file_option_is_set(FileOptions option) const {
+        return (uint8_t(_params.file_options.get()) & uint8_t(option)) != 0;
+    }
+
     enum class LogDisarmed : uint8_t {
         NONE = 0,
         LOG_WHILE_DISARMED = 1,
@@ -337,6 +347,8 @@ public:
         AP_Float blk_ratemax;
         AP_Float disarm_ratemax;
         AP_Int16 max_log_files;
+        AP_Int8 file_options;
+        AP_Int8 mav_window;
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -0,0 +1,301 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  block compression for dataflash logs, using the LZ4 block format
+  so logs can also be decoded with standard LZ4 tools
+ */
+
+#include "AP_Logger_Compress.h"
+
+#include <string.h>
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/crc.h>
+
+const uint8_t AP_Logger_Compress::FILE_MAGIC[4] = { 'A', 'P', 'L', 'Z' };
+const uint8_t AP_Logger_Compress::FRAME_MAGIC[2] = { 0xA5, 0x5A };
+
+// LZ4 block format constants
+#define LZ4_MIN_MATCH 4
+#define LZ4_LAST_LITERALS 5     // the last 5 bytes are always literals
+#define LZ4_MFLIMIT 12          // the last match must start at least 12 bytes before the end
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+
+static_assert((1U<<LZ4_HASH_BITS) == AP_Logger_Compress::HASH_TABLE_SIZE, "hash table size mismatch");
+
+static inline uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint16_t hash4(uint32_t v)
+{
+    return (v * 2654435761U) >> (32 - LZ4_HASH_BITS);
+}
+
+// write an LZ4 length extension. Returns false on overflow
+static inline bool write_length(uint8_t *&op, const uint8_t *oend, uint32_t len)
+{
+    while (len >= 255) {
+        if (op >= oend) {
+            return false;
+        }
+        *op++ = 255;
+        len -= 255;
+    }
+    if (op >= oend) {
+        return false;
+    }
+    *op++ = len;
+    return true;
+}
+
+// write a literal run, optionally followed by a match
+static bool write_sequence(uint8_t *&op, const uint8_t *oend,
+                           const uint8_t *literals, uint32_t lit_len,
+                           uint16_t offset, uint32_t match_len)
+{
+    if (op >= oend) {
+        return false;
+    }
+    uint8_t *token = op++;
+    *token = MIN(lit_len, 15U) << 4;
+    if (lit_len >= 15 && !write_length(op, oend, lit_len - 15)) {
+        return false;
+    }
+    if (uint32_t(oend - op) < lit_len) {
+        return false;
+    }
+    memcpy(op, literals, lit_len);
+    op += lit_len;
+
+    if (match_len == 0) {
+        // final sequence has no match
+        return true;
+    }
+
+    if (oend - op < 2) {
+        return false;
+    }
+    *op++ = offset & 0xFF;
+    *op++ = offset >> 8;
+    const uint32_t ml = match_len - LZ4_MIN_MATCH;
+    *token |= MIN(ml, 15U);
+    if (ml >= 15 && !write_length(op, oend, ml - 15)) {
+        return false;
+    }
+    return true;
+}
+
+uint32_t AP_Logger_Compress::compress(const uint8_t *src, uint32_t src_len,
+                                      uint8_t *dst, uint32_t dst_size,
+                                      uint16_t *hash_table, uint16_t dict_len)
+{
+    if (dict_len + src_len > LZ4_MAX_OFFSET) {
+        return 0;
+    }
+    uint8_t *op = dst;
+    const uint8_t *oend = dst + dst_size;
+
+    // positions are relative to the start of the dictionary
+    const uint8_t *base = src - dict_len;
+    const uint32_t end = dict_len + src_len;
+    uint32_t anchor = dict_len;
+
+    if (src_len > LZ4_MFLIMIT) {
+        // positions are only valid within this block and its dictionary
+        memset(hash_table, 0, HASH_TABLE_SIZE * sizeof(hash_table[0]));
+        for (uint32_t p = 0; p + sizeof(uint32_t) <= dict_len; p++) {
+            hash_table[hash4(read32(&base[p]))] = p;
+        }
+
+        const uint32_t match_limit = end - LZ4_LAST_LITERALS;
+        const uint32_t search_limit = end - LZ4_MFLIMIT;
+        uint32_t ip = MAX(dict_len, 1U);
+        while (ip < search_limit) {
+            const uint32_t seq = read32(&base[ip]);
+            const uint16_t h = hash4(seq);
+            const uint32_t ref = hash_table[h];
+            hash_table[h] = ip;
+            if (ref >= ip || read32(&base[ref]) != seq) {
+                ip++;
+                continue;
+            }
+
+            // extend the match forwards
+            uint32_t len = LZ4_MIN_MATCH;
+            while (ip + len < match_limit && base[ref + len] == base[ip + len]) {
+                len++;
+            }
+
+            if (!write_sequence(op, oend, &base[anchor], ip - anchor, ip - ref, len)) {
+                return 0;
+            }
+            ip += len;
+            anchor = ip;
+
+            // seed the table with a position inside the match so
+            // repeated structures are found quickly
+            if (ip < search_limit) {
+                hash_table[hash4(read32(&base[ip-2]))] = ip - 2;
+            }
+        }
+    }
+
+    if (!write_sequence(op, oend, &base[anchor], end - anchor, 0, 0)) {
+        return 0;
+    }
+    return op - dst;
+}
+
+int32_t AP_Logger_Compress::decompress(const uint8_t *src, uint32_t src_len,
+                                       uint8_t *dst, uint32_t dst_size,
+                                       uint16_t dict_len)
+{
+    const uint8_t *ip = src;
+    const uint8_t *iend = src + src_len;
+    uint8_t *op = dst;
+    const uint8_t *oend = dst + dst_size;
+
+    while (ip < iend) {
+        const uint8_t token = *ip++;
+
+        // literal run
+        uint32_t lit_len = token >> 4;
+        if (lit_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                lit_len += b;
+            } while (b == 255);
+        }
+        if (uint32_t(iend - ip) < lit_len || uint32_t(oend - op) < lit_len) {
+            return -1;
+        }
+        memcpy(op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+
+        if (ip == iend) {
+            // last sequence is literals only
+            break;
+        }
+
+        // match
+        if (iend - ip < 2) {
+            return -1;
+        }
+        const uint16_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (op - dst) + dict_len) {
+            return -1;
+        }
+        uint32_t match_len = token & 0x0F;
+        if (match_len == 15) {
+            uint8_t b;
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                match_len += b;
+            } while (b == 255);
+        }
+        match_len += LZ4_MIN_MATCH;
+        if (uint32_t(oend - op) < match_len) {
+            return -1;
+        }
+        // byte copy as the match may overlap the output
+        const uint8_t *match = op - offset;
+        while (match_len--) {
+            *op++ = *match++;
+        }
+    }
+    return op - dst;
+}
+
+uint32_t AP_Logger_Compress::build_frame(const uint8_t *src, uint16_t src_len,
+                                         uint8_t *out, uint16_t *hash_table,
+                                         uint16_t prev_len)
+{
+    FrameHeader hdr;
+    memcpy(hdr.magic, FRAME_MAGIC, sizeof(hdr.magic));
+    hdr.raw_len = src_len;
+    hdr.crc = crc_crc32(0, src, src_len);
+
+    uint8_t *data = out + sizeof(hdr);
+    uint32_t data_len = compress(src, src_len, data, max_compressed_size(src_len), hash_table, prev_len);
+    if (data_len == 0 || data_len >= src_len) {
+        // incompressible, store it as-is
+        memcpy(data, src, src_len);
+        data_len = src_len;
+        hdr.flags = uint8_t(FrameFlags::STORED);
+    } else {
+        hdr.flags = prev_len > 0 ? uint8_t(FrameFlags::PREFIXED) : 0;
+    }
+    hdr.data_len = data_len;
+    memcpy(out, &hdr, sizeof(hdr));
+    return sizeof(hdr) + data_len;
+}
+
+void AP_Logger_Compress::init_file_header(FileHeader &hdr, uint16_t frame_size)
+{
+    memcpy(hdr.magic, FILE_MAGIC, sizeof(hdr.magic));
+    hdr.version = VERSION;
+    hdr.algorithm = uint8_t(Algorithm::LZ4_BLOCK);
+    hdr.frame_size = frame_size;
+}
+
+bool AP_Logger_Compress::valid_file_header(const FileHeader &hdr)
+{
+    return memcmp(hdr.magic, FILE_MAGIC, sizeof(hdr.magic)) == 0 &&
+        hdr.version == VERSION &&
+        hdr.algorithm == uint8_t(Algorithm::LZ4_BLOCK) &&
+        hdr.frame_size > 0;
+}
+
+bool AP_Logger_Compress::valid_frame_header(const FrameHeader &hdr, uint16_t frame_size)
+{
+    if (memcmp(hdr.magic, FRAME_MAGIC, sizeof(hdr.magic)) != 0) {
+        return false;
+    }
+    if (hdr.raw_len == 0 || hdr.raw_len > frame_size) {
+        return false;
+    }
+    if (hdr.flags & uint8_t(FrameFlags::STORED)) {
+        return hdr.data_len == hdr.raw_len;
+    }
+    return hdr.data_len <= max_compressed_size(hdr.raw_len);
+}
+
+bool AP_Logger_Compress::decode_frame(const FrameHeader &hdr, const uint8_t *data, uint8_t *dst,
+                                       uint16_t prev_len)
+{
+    if (hdr.flags & uint8_t(FrameFlags::STORED)) {
+        memcpy(dst, data, hdr.raw_len);
+    } else {
+        // without the flag the frame must not refer to earlier data
+        const uint16_t dict_len = (hdr.flags & uint8_t(FrameFlags::PREFIXED)) ? prev_len : 0;
+        if (decompress(data, hdr.data_len, dst, hdr.raw_len, dict_len) != hdr.raw_len) {
+            return false;
+        }
+    }
+    return crc_crc32(0, dst, hdr.raw_len) == hdr.crc;
+}
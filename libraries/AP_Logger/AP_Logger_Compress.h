@@ -0,0 +1,119 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  block compression for dataflash logs
+
+  A compressed log starts with a FileHeader followed by a sequence of
+  frames. Each frame is a FrameHeader followed by up to frame_size
+  bytes of log data, compressed with the LZ4 block format or stored
+  as-is if it did not compress. Matches in a PREFIXED frame may refer
+  back into the data of the frame before it, which finds much of the
+  repetition between consecutive frames. Frames only depend on the
+  one before, so a log truncated by a power loss can be read up to
+  the last complete frame.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <AP_Common/AP_Common.h>
+
+class AP_Logger_Compress {
+public:
+
+    static const uint8_t FILE_MAGIC[4];
+    static const uint8_t FRAME_MAGIC[2];
+    static const uint8_t VERSION = 2;
+
+    enum class Algorithm : uint8_t {
+        LZ4_BLOCK = 1,
+    };
+
+    struct PACKED FileHeader {
+        uint8_t magic[4];
+        uint8_t version;
+        uint8_t algorithm;
+        uint16_t frame_size;   // maximum uncompressed bytes per frame
+    };
+
+    enum class FrameFlags : uint8_t {
+        STORED = (1U<<0),      // data is not compressed
+        PREFIXED = (1U<<1),    // matches may refer to the previous frame
+    };
+
+    struct PACKED FrameHeader {
+        uint8_t magic[2];
+        uint8_t flags;
+        uint16_t raw_len;      // uncompressed length
+        uint16_t data_len;     // length of data following the header
+        uint32_t crc;          // crc32 of the uncompressed data
+    };
+
+    // worst case size of the compressed form of len bytes
+    static constexpr uint32_t max_compressed_size(uint32_t len) {
+        return len + len/255 + 16;
+    }
+
+    // number of entries in the compressor hash table
+    static const uint16_t HASH_TABLE_SIZE = (1U<<12);
+
+    /*
+      compress src_len bytes from src into dst using the LZ4 block
+      format. hash_table must have HASH_TABLE_SIZE entries. Matches
+      may refer to the dict_len bytes immediately before src. Returns
+      the compressed length, or 0 if the output did not fit in dst_size
+      bytes. dict_len + src_len must be no more than 65535
+     */
+    static uint32_t compress(const uint8_t *src, uint32_t src_len,
+                             uint8_t *dst, uint32_t dst_size,
+                             uint16_t *hash_table, uint16_t dict_len=0);
+
+    /*
+      decompress an LZ4 block into dst, which must be preceded by the
+      dict_len bytes the block was compressed against. Returns the
+      decompressed length, or -1 if the input is corrupt or would
+      overflow dst_size bytes
+     */
+    static int32_t decompress(const uint8_t *src, uint32_t src_len,
+                              uint8_t *dst, uint32_t dst_size,
+                              uint16_t dict_len=0);
+
+    /*
+      build a complete frame (header and data) from src_len bytes of
+      raw data, which may refer to the prev_len bytes of the previous
+      frame immediately before src. out must be at least
+      sizeof(FrameHeader) + max_compressed_size(src_len) bytes.
+      Returns the total frame length
+     */
+    static uint32_t build_frame(const uint8_t *src, uint16_t src_len,
+                                uint8_t *out, uint16_t *hash_table,
+                                uint16_t prev_len=0);
+
+    // fill in a file header for the given frame size
+    static void init_file_header(FileHeader &hdr, uint16_t frame_size);
+
+    // true if the header describes a compressed log we can read
+    static bool valid_file_header(const FileHeader &hdr);
+
+    // true if the frame header is sane for the given maximum frame size
+    static bool valid_frame_header(const FrameHeader &hdr, uint16_t frame_size);
+
+    /*
+      decode the data following a frame header into dst, which must be
+      at least hdr.raw_len bytes and be preceded by the prev_len bytes
+      of the previous frame. Returns false if the data is corrupt
+     */
+    static bool decode_frame(const FrameHeader &hdr, const uint8_t *data, uint8_t *dst,
+                             uint16_t prev_len=0);
+};
@@ -19,6 +19,7 @@
 
 #include "AP_Logger.h"
 #include "AP_Logger_File.h"
+#include "AP_Logger_Compress.h"
 
 #include <AP_Common/AP_Common.h>
 #include <AP_InternalError/AP_InternalError.h>
@@ -138,6 +139,15 @@ void AP_Logger_File::periodic_1Hz()
 {
     AP_Logger_Backend::periodic_1Hz();
 
+    if (logging_started()) {
+        Write_IO_Stats();
+#if AP_LOGGER_FILE_INDEX_ENABLED
+        if (_front.file_option_is_set(AP_Logger::FileOptions::INDEX)) {
+            Write_Index();
+        }
+#endif
+    }
+
     if (_initialised &&
         _write_fd == -1 && _read_fd == -1 &&
         erase.log_num == 0 &&
@@ -483,6 +493,9 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     if (AP::FS().write(_write_fd, pBuffer, size) != size) {
         AP_HAL::panic("Short write");
     }
+#if AP_LOGGER_FILE_INDEX_ENABLED
+    index_update(pBuffer, size);
+#endif
     return true;
 #endif
 
@@ -519,6 +532,17 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
 
     _writebuf.write((uint8_t*)pBuffer, size);
     df_stats_gather(size, _writebuf.space());
+
+    io_stats.bytes_queued += size;
+    if (!io_stats.probe_pending) {
+        // measure how long it takes this message to reach the file
+        io_stats.probe_offset = io_stats.bytes_queued;
+        io_stats.probe_us = AP_HAL::micros();
+        io_stats.probe_pending = true;
+    }
+#if AP_LOGGER_FILE_INDEX_ENABLED
+    index_update(pBuffer, size);
+#endif
     return true;
 }
 
@@ -812,6 +836,15 @@ void AP_Logger_File::start_new_log(void)
 
     start_new_log_reset_variables();
 
+#if AP_LOGGER_FILE_INDEX_ENABLED
+    {
+        // writers update the index with semaphore held. Reset it while
+        // no log is open, before the new _write_fd is published
+        WITH_SEMAPHORE(semaphore);
+        memset(&_index, 0, sizeof(_index));
+    }
+#endif
+
     if (_read_fd != -1) {
         AP::FS().close(_read_fd);
         _read_fd = -1;
@@ -873,6 +906,11 @@ void AP_Logger_File::start_new_log(void)
     _open_error_ms = 0;
     _write_offset = 0;
     _writebuf.clear();
+    io_stats.bytes_written = io_stats.bytes_queued;
+    io_stats.probe_pending = false;
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+    start_compression();
+#endif
     write_fd_semaphore.give();
 
     // now update lastlog.txt with the new log number
@@ -910,7 +948,8 @@ void AP_Logger_File::flush(void)
 #if APM_BUILD_TYPE(APM_BUILD_Replay)
 {
     uint32_t tnow = AP_HAL::millis();
-    while (_write_fd != -1 && _initialised && !recent_open_error() && _writebuf.available()) {
+    while (_write_fd != -1 && _initialised && !recent_open_error() &&
+           (_writebuf.available() || compressed_frame_pending())) {
         // convince the IO timer that it really is OK to write out
         // less than _writebuf_chunk bytes:
         if (tnow > 2001) { // avoid resetting _last_write_time to 0
@@ -962,10 +1001,11 @@ void AP_Logger_File::io_timer(void)
     }
 
     uint32_t nbytes = _writebuf.available();
-    if (nbytes == 0) {
+    const bool frame_pending = compressed_frame_pending();
+    if (nbytes == 0 && !frame_pending) {
         return;
     }
-    if (nbytes < _writebuf_chunk && 
+    if (nbytes < _writebuf_chunk && !frame_pending &&
         tnow - _last_write_time < 2000UL) {
         // write in _writebuf_chunk-sized chunks, but always write at
         // least once per 2 seconds if data is available
@@ -985,20 +1025,41 @@ void AP_Logger_File::io_timer(void)
     }
 
     _last_write_time = tnow;
-    if (nbytes > _writebuf_chunk) {
-        // be kind to the filesystem layer
-        nbytes = _writebuf_chunk;
-    }
+    bool gather_write = false;
+    const uint8_t *head;
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+    if (_compress.active) {
+        // write out the current compressed frame, compressing the
+        // next block of buffered data once the last one is complete
+        if (!frame_pending) {
+            last_io_operation = "compress";
+            compress_frame(nbytes);
+            last_io_operation = "";
+        }
+        head = &_compress.out[_compress.out_ofs];
+        nbytes = _compress.out_len - _compress.out_ofs;
+    } else
+#endif
+    {
+        gather_write = gather_write_enabled();
+        if (nbytes > _writebuf_chunk && !gather_write) {
+            // be kind to the filesystem layer
+            nbytes = _writebuf_chunk;
+        }
 
-    uint32_t size;
-    const uint8_t *head = _writebuf.readptr(size);
-    nbytes = MIN(nbytes, size);
+        uint32_t size;
+        head = _writebuf.readptr(size);
+        if (!gather_write) {
+            // only the contiguous part of the buffer can be written
+            nbytes = MIN(nbytes, size);
+        }
 
-    // try to align writes on a 512 byte boundary to avoid filesystem reads
-    if ((nbytes + _write_offset) % 512 != 0) {
-        uint32_t ofs = (nbytes + _write_offset) % 512;
-        if (ofs < nbytes) {
-            nbytes -= ofs;
+        // try to align writes on a 512 byte boundary to avoid filesystem reads
+        if ((nbytes + _write_offset) % 512 != 0) {
+            uint32_t ofs = (nbytes + _write_offset) % 512;
+            if (ofs < nbytes) {
+                nbytes -= ofs;
+            }
         }
     }
 
@@ -1010,7 +1071,18 @@ void AP_Logger_File::io_timer(void)
         write_fd_semaphore.give();
         return;
     }
-    ssize_t nwritten = AP::FS().write(_write_fd, head, nbytes);
+    const uint32_t write_start_us = AP_HAL::micros();
+    ssize_t nwritten;
+    if (gather_write) {
+        // hand both regions of the ring buffer to the filesystem in
+        // one call, avoiding a bounce through a linear buffer
+        ByteBuffer::IoVec vec[2];
+        const uint8_t n_vec = _writebuf.peekiovec(vec, nbytes);
+        nwritten = AP::FS().writev(_write_fd, vec, n_vec);
+    } else {
+        nwritten = AP::FS().write(_write_fd, head, nbytes);
+    }
+    const uint32_t write_us = AP_HAL::micros() - write_start_us;
     last_io_operation = "";
     if (nwritten <= 0) {
         if ((tnow - _last_write_ms)/1000U > unsigned(_front._params.file_timeout)) {
@@ -1028,7 +1100,19 @@ void AP_Logger_File::io_timer(void)
         _last_write_failed = false;
         _last_write_ms = tnow;
         _write_offset += nwritten;
-        _writebuf.advance(nwritten);
+        uint32_t buffer_bytes = nwritten;
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+        if (_compress.active) {
+            // the buffered data was consumed when the frame was
+            // built, count it as written once the frame is complete
+            _compress.out_ofs += nwritten;
+            buffer_bytes = compressed_frame_pending() ? 0 : _compress.raw_len;
+        } else
+#endif
+        {
+            _writebuf.advance(nwritten);
+        }
+        io_stats_update(buffer_bytes, nwritten, write_us);
         /*
           the best strategy for minimizing corruption on microSD cards
           seems to be to write in 4k chunks and fsync the file on each
@@ -1057,6 +1141,192 @@ void AP_Logger_File::io_timer(void)
     write_fd_semaphore.give();
 }
 
+// true if the io thread should use gather writes
+bool AP_Logger_File::gather_write_enabled() const
+{
+#if AP_LOGGER_FILE_GATHER_WRITE_ENABLED
+    return _front.file_option_is_set(AP_Logger::FileOptions::GATHER_WRITE);
+#else
+    return false;
+#endif
+}
+
+// method used to write the current log, for DFIO
+AP_Logger_File::WriteMode AP_Logger_File::write_mode() const
+{
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+    if (_compress.active) {
+        return WriteMode::COMPRESSED;
+    }
+#endif
+    return gather_write_enabled() ? WriteMode::GATHER : WriteMode::CHUNKED;
+}
+
+// true if a compressed frame has been built but not completely written
+bool AP_Logger_File::compressed_frame_pending() const
+{
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+    return _compress.out_ofs < _compress.out_len;
+#else
+    return false;
+#endif
+}
+
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+/*
+  setup compression for a newly opened log, writing the file
+  header. Called with write_fd_semaphore held. If compression is not
+  wanted, or buffers cannot be allocated, the log is written
+  uncompressed
+ */
+void AP_Logger_File::start_compression()
+{
+    _compress.active = false;
+    _compress.out_len = 0;
+    _compress.out_ofs = 0;
+    _compress.raw_len = 0;
+    _compress.prev_len = 0;
+    if (!_front.file_option_is_set(AP_Logger::FileOptions::COMPRESS)) {
+        return;
+    }
+    if (_compress.out == nullptr) {
+        _compress.raw = (uint8_t *)malloc(2 * _writebuf_chunk);
+        _compress.out = (uint8_t *)malloc(sizeof(AP_Logger_Compress::FrameHeader) +
+                                          AP_Logger_Compress::max_compressed_size(_writebuf_chunk));
+        _compress.hash_table = (uint16_t *)malloc(AP_Logger_Compress::HASH_TABLE_SIZE * sizeof(uint16_t));
+        if (_compress.raw == nullptr || _compress.out == nullptr || _compress.hash_table == nullptr) {
+            free(_compress.raw);
+            free(_compress.out);
+            free(_compress.hash_table);
+            _compress.raw = nullptr;
+            _compress.out = nullptr;
+            _compress.hash_table = nullptr;
+            DEV_PRINTF("AP_Logger: no memory for compression\n");
+            return;
+        }
+    }
+    AP_Logger_Compress::FileHeader hdr;
+    AP_Logger_Compress::init_file_header(hdr, _writebuf_chunk);
+    if (AP::FS().write(_write_fd, &hdr, sizeof(hdr)) != sizeof(hdr)) {
+        return;
+    }
+    _write_offset += sizeof(hdr);
+    _compress.active = true;
+}
+
+/*
+  take up to one frame of data from the write buffer and compress it
+  into _compress.out, against the data of the previous frame
+ */
+void AP_Logger_File::compress_frame(uint32_t nbytes)
+{
+    uint8_t *frame = &_compress.raw[_writebuf_chunk];
+    if (_compress.raw_len > 0) {
+        // move the last frame back so it ends where this one starts
+        memmove(frame - _compress.raw_len, frame, _compress.raw_len);
+    }
+    _compress.prev_len = _compress.raw_len;
+    _compress.raw_len = MIN(nbytes, uint32_t(_writebuf_chunk));
+    _writebuf.peekbytes(frame, _compress.raw_len);
+    _writebuf.advance(_compress.raw_len);
+    _compress.out_len = AP_Logger_Compress::build_frame(frame, _compress.raw_len,
+                                                        _compress.out, _compress.hash_table,
+                                                        _compress.prev_len);
+    _compress.out_ofs = 0;
+}
+#endif  // AP_LOGGER_FILE_COMPRESSION_ENABLED
+
+// update io thread statistics after a successful write. buffer_bytes
+// is the amount of log data the write completed and file_bytes the
+// amount written to the file, which differ when compressing
+void AP_Logger_File::io_stats_update(uint32_t buffer_bytes, uint32_t file_bytes, uint32_t write_us)
+{
+    io_stats.bytes_written += buffer_bytes;
+    io_stats.writes++;
+    io_stats.raw_bytes += buffer_bytes;
+    io_stats.bytes += file_bytes;
+    io_stats.write_us_sum += write_us;
+    io_stats.write_us_max = MAX(io_stats.write_us_max, write_us);
+
+    if (io_stats.probe_pending &&
+        int32_t(io_stats.bytes_written - io_stats.probe_offset) >= 0) {
+        const uint32_t latency_us = AP_HAL::micros() - io_stats.probe_us;
+        io_stats.latency_us_sum += latency_us;
+        io_stats.latency_us_max = MAX(io_stats.latency_us_max, latency_us);
+        io_stats.latency_count++;
+        io_stats.probe_pending = false;
+    }
+}
+
+// log io thread statistics and reset the accumulators
+void AP_Logger_File::Write_IO_Stats()
+{
+    const struct log_DFIO pkt {
+        LOG_PACKET_HEADER_INIT(LOG_DF_FILE_IO_STATS),
+        time_us        : AP_HAL::micros64(),
+        mode           : uint8_t(write_mode()),
+        writes         : io_stats.writes,
+        raw_bytes      : io_stats.raw_bytes,
+        bytes          : io_stats.bytes,
+        write_us_max   : io_stats.write_us_max,
+        write_us_avg   : io_stats.writes ? io_stats.write_us_sum / io_stats.writes : 0,
+        latency_us_max : io_stats.latency_us_max,
+        latency_us_avg : io_stats.latency_count ? io_stats.latency_us_sum / io_stats.latency_count : 0,
+    };
+    WriteBlock(&pkt, sizeof(pkt));
+
+    io_stats.writes = 0;
+    io_stats.raw_bytes = 0;
+    io_stats.bytes = 0;
+    io_stats.write_us_max = 0;
+    io_stats.write_us_sum = 0;
+    io_stats.latency_us_max = 0;
+    io_stats.latency_us_sum = 0;
+    io_stats.latency_count = 0;
+}
+
+#if AP_LOGGER_FILE_INDEX_ENABLED
+/*
+  account for a message added to the log. Offsets are in the
+  uncompressed log data, so match file offsets only for logs that are
+  not compressed. Called with semaphore held
+ */
+void AP_Logger_File::index_update(const void *pBuffer, uint16_t size)
+{
+    if (size >= 3) {
+        const uint8_t type = ((const uint8_t *)pBuffer)[2];
+        _index.types[type/64] |= 1ULL << (type%64);
+    }
+    _index.log_offset += size;
+}
+
+/*
+  write an LIDX message covering the log data since the last one. The
+  LIDX messages form a chain back from the end of the log which readers
+  use to find the data they want
+ */
+void AP_Logger_File::Write_Index()
+{
+    WITH_SEMAPHORE(semaphore);
+
+    const uint64_t offset = _index.log_offset;
+    struct log_Index pkt {
+        LOG_PACKET_HEADER_INIT(LOG_FILE_INDEX_MSG),
+        time_us : AP_HAL::micros64(),
+        prev    : _index.prev,
+    };
+    memcpy(pkt.types, _index.types, sizeof(pkt.types));
+    if (!WriteCriticalBlock(&pkt, sizeof(pkt))) {
+        // keep accumulating until an LIDX can be written
+        return;
+    }
+    // the LIDX starts the data covered by the next one
+    _index.prev = offset;
+    memset(_index.types, 0, sizeof(_index.types));
+    _index.types[LOG_FILE_INDEX_MSG/64] = 1ULL << (LOG_FILE_INDEX_MSG%64);
+}
+#endif  // AP_LOGGER_FILE_INDEX_ENABLED
+
 bool AP_Logger_File::io_thread_alive() const
 {
     if (!hal.scheduler->is_system_initialized()) {
@@ -6,6 +6,8 @@
  */
 #pragma once
 
+#include <atomic>
+
 #include <AP_Filesystem/AP_Filesystem.h>
 
 #include <AP_HAL/utility/RingBuffer.h>
@@ -109,6 +111,70 @@ private:
     const uint16_t _writebuf_chunk = HAL_LOGGER_WRITE_CHUNK_SIZE;
     uint32_t _last_write_time;
 
+    // true if the io thread should write both regions of _writebuf
+    // with a single gather write
+    bool gather_write_enabled() const;
+
+    enum class WriteMode : uint8_t {
+        CHUNKED = 0,
+        GATHER = 1,
+        COMPRESSED = 2,
+    };
+    WriteMode write_mode() const;
+
+    bool compressed_frame_pending() const;
+#if AP_LOGGER_FILE_COMPRESSION_ENABLED
+    // block compression state, see AP_Logger_Compress
+    struct {
+        bool active;           // current log is compressed
+        uint8_t *raw;          // previous frame then the current frame, each _writebuf_chunk bytes
+        uint16_t raw_len;
+        uint16_t prev_len;     // length of the previous frame, ending where the current one starts
+        uint8_t *out;          // frame header and compressed data
+        uint32_t out_len;
+        uint32_t out_ofs;      // amount of out already written
+        uint16_t *hash_table;
+    } _compress;
+    void start_compression();
+    void compress_frame(uint32_t nbytes);
+#endif
+
+    // io thread write statistics, logged as DFIO
+    struct {
+        // running totals of bytes put into and taken out of _writebuf
+        uint32_t bytes_queued;
+        uint32_t bytes_written;
+        // latency probe; the time at which the byte at probe_offset
+        // was queued. The writer fills in the probe before setting
+        // probe_pending, the io thread reads it before clearing it.
+        // The two hold different semaphores, so the flag is atomic
+        uint32_t probe_offset;
+        uint32_t probe_us;
+        std::atomic<bool> probe_pending{false};
+        // accumulated since the last DFIO message
+        uint16_t writes;
+        uint32_t raw_bytes;
+        uint32_t bytes;
+        uint32_t write_us_max;
+        uint32_t write_us_sum;
+        uint32_t latency_us_max;
+        uint32_t latency_us_sum;
+        uint16_t latency_count;
+    } io_stats;
+    void io_stats_update(uint32_t buffer_bytes, uint32_t file_bytes, uint32_t write_us);
+    void Write_IO_Stats();
+
+#if AP_LOGGER_FILE_INDEX_ENABLED
+    // LIDX index state, updated by the writer
+    struct {
+        uint64_t log_offset;   // bytes of log data queued since the log was opened
+        uint64_t prev;         // log offset of the last LIDX message
+        uint64_t types[4];     // message types queued since the last LIDX
+    } _index;
+    void index_update(const void *pBuffer, uint16_t size);
+    void Write_Index();
+#endif
+
     /* construct a file name given a log number. Caller must free. */
     char *_log_file_name(const uint16_t log_num) const;
     char *_log_file_name_long(const uint16_t log_num) const;
@@ -10,9 +10,15 @@
 
 #include "LogStructure.h"
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Math/AP_Math.h>
 
 #define REMOTE_LOG_DEBUGGING 0
 
+// number of times a block is resent on timeout before it is abandoned
+#define REMOTE_LOG_MAX_RESENDS 8
+// resend timeout to use before the round trip time has been measured
+#define REMOTE_LOG_INITIAL_RTO_MS 250
+
 #if REMOTE_LOG_DEBUGGING
 #include <stdio.h>
  # define Debug(fmt, args ...)  do {fprintf(stderr, "%s:%d: " fmt "\n", __FUNCTION__, __LINE__, ## args); hal.scheduler->delay(1); } while(0)
@@ -77,6 +83,7 @@ void AP_Logger_MAVLink::enqueue_block(dm_block_queue_t &queue, struct dm_block *
         queue.oldest = block;
     }
     queue.youngest = block;
+    queue.count++;
 }
 
 struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::dequeue_seqno(AP_Logger_MAVLink::dm_block_queue_t &queue, uint32_t seqno)
@@ -98,6 +105,7 @@ struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::dequeue_seqno(AP_Logger_M
                 prev->next = block->next;
             }
             block->next = nullptr;
+            queue.count--;
             return block;
         }
         prev = block;
@@ -109,13 +117,19 @@ bool AP_Logger_MAVLink::free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &
 {
     struct dm_block *block = dequeue_seqno(queue, seqno);
     if (block != nullptr) {
-        block->next = _blocks_free;
-        _blocks_free = block;
-        _blockcount_free++; // comment me out to expose a bug!
+        update_window_on_ack(*block, AP_HAL::millis());
+        free_block(block);
         return true;
     }
     return false;
 }
+
+void AP_Logger_MAVLink::free_block(struct dm_block *block)
+{
+    block->next = _blocks_free;
+    _blocks_free = block;
+    _blockcount_free++; // comment me out to expose a bug!
+}
     
 
 bool AP_Logger_MAVLink::WritesOK() const
@@ -189,6 +203,7 @@ struct AP_Logger_MAVLink::dm_block *AP_Logger_MAVLink::next_block()
         _blockcount_free--;
         ret->seqno = _next_seq_num++;
         ret->last_sent = 0;
+        ret->resend_count = 0;
         ret->next = nullptr;
         _latest_block_len = 0;
     }
@@ -201,10 +216,13 @@ void AP_Logger_MAVLink::free_all_blocks()
     _current_block = nullptr;
 
     _blocks_pending.sent_count = 0;
+    _blocks_pending.count = 0;
     _blocks_pending.oldest = _blocks_pending.youngest = nullptr;
     _blocks_retry.sent_count = 0;
+    _blocks_retry.count = 0;
     _blocks_retry.oldest = _blocks_retry.youngest = nullptr;
     _blocks_sent.sent_count = 0;
+    _blocks_sent.count = 0;
     _blocks_sent.oldest = _blocks_sent.youngest = nullptr;
 
     // add blocks to the free stack:
@@ -257,6 +275,11 @@ void AP_Logger_MAVLink::handle_ack(const GCS_MAVLINK &link,
             _target_component_id = msg.compid;
             _link = &link;
             _next_seq_num = 0;
+            // start with a small window and grow it as acks arrive
+            _cwnd_x16 = 4 * 16;
+            _ssthresh_x16 = _blockcount * 16;
+            _srtt_ms = 0;
+            _rttvar_ms = 0;
             start_new_log_reset_variables();
             _last_response_time = AP_HAL::millis();
             Debug("Target: (%u/%u)", _target_system_id, _target_component_id);
@@ -307,6 +330,8 @@ void AP_Logger_MAVLink::handle_retry(uint32_t seqno)
     struct dm_block *victim = dequeue_seqno(_blocks_sent, seqno);
     if (victim != nullptr) {
         _last_response_time = AP_HAL::millis();
+        victim->resend_count++;
+        update_window_on_loss(_last_response_time);
         enqueue_block(_blocks_retry, victim);
     }
 }
@@ -314,6 +339,7 @@ void AP_Logger_MAVLink::handle_retry(uint32_t seqno)
 void AP_Logger_MAVLink::stats_init() {
     _dropped = 0;
     stats.resends = 0;
+    stats.blocks_dropped = 0;
     stats_reset();
 }
 void AP_Logger_MAVLink::stats_reset() {
@@ -353,6 +379,10 @@ void AP_Logger_MAVLink::Write_logger_MAV(AP_Logger_MAVLink &logger_mav)
         state_sent_avg    : (uint8_t)(logger_mav.stats.state_sent/logger_mav.stats.collection_count),
         state_sent_min    : logger_mav.stats.state_sent_min,
         state_sent_max    : logger_mav.stats.state_sent_max,
+        blocks_sent       : logger_mav._blocks_pending.sent_count,
+        blocks_dropped    : logger_mav.stats.blocks_dropped,
+        srtt_ms           : logger_mav._srtt_ms,
+        window            : logger_mav.window_size(),
     };
     WriteBlock(&pkt,sizeof(pkt));
 }
@@ -453,15 +483,21 @@ void AP_Logger_MAVLink::stats_collect()
 }
 
 /* while we "successfully" send log blocks from a queue, move them to
- * the sent list. DO NOT call this for blocks already sent!
+ * the sent list. DO NOT call this for blocks already sent!  If
+ * limit_to_window is true then stop once the window of unacknowledged
+ * blocks is full
 */
-bool AP_Logger_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue)
+bool AP_Logger_MAVLink::send_log_blocks_from_queue(dm_block_queue_t &queue, bool limit_to_window)
 {
     uint8_t sent_count = 0;
     while (queue.oldest != nullptr) {
         if (sent_count++ > _max_blocks_per_send_blocks) {
             return false;
         }
+        if (limit_to_window &&
+            _blocks_sent.count + _blocks_retry.count >= window_size()) {
+            return false;
+        }
         if (! send_log_block(*queue.oldest)) {
             return false;
         }
@@ -488,46 +524,113 @@ void AP_Logger_MAVLink::push_log_blocks()
         return;
     }
 
-    if (! send_log_blocks_from_queue(_blocks_retry)) {
+    // blocks the client has NACKed are already counted in the window
+    if (! send_log_blocks_from_queue(_blocks_retry, false)) {
         semaphore.give();
         return;
     }
 
-    if (! send_log_blocks_from_queue(_blocks_pending)) {
+    if (! send_log_blocks_from_queue(_blocks_pending, true)) {
         semaphore.give();
         return;
     }
     semaphore.give();
 }
 
+/*
+  resend blocks which have not been acknowledged within the resend
+  timeout, oldest first.  The timeout doubles with each resend of a
+  block, and a block resent REMOTE_LOG_MAX_RESENDS times is abandoned
+  so one lost block can not hold the window shut
+ */
 void AP_Logger_MAVLink::do_resends(uint32_t now)
 {
     if (!_initialised || !_sending_to_client) {
         return;
     }
-
-    uint8_t count_to_send = 5;
-    if (_blockcount < count_to_send) {
-        count_to_send = _blockcount;
+    if (!semaphore.take_nonblocking()) {
+        return;
     }
-    uint32_t oldest = now - 100; // 100 milliseconds before resend.  Hmm.
-    while (count_to_send-- > 0) {
-        if (!semaphore.take_nonblocking()) {
-            return;
+
+    const uint16_t rto_ms = resend_timeout_ms();
+    uint8_t count_to_send = _max_blocks_per_send_blocks;
+    struct dm_block *next;
+    for (struct dm_block *block=_blocks_sent.oldest; block != nullptr && count_to_send > 0; block=next) {
+        next = block->next;
+        if (now - block->last_sent < uint32_t(rto_ms) << MIN(block->resend_count, 3)) {
+            continue;
         }
-        for (struct dm_block *block=_blocks_sent.oldest; block != nullptr; block=block->next) {
-            // only want to send blocks every now-and-then:
-            if (block->last_sent < oldest) {
-                if (! send_log_block(*block)) {
-                    // failed to send the block; try again later....
-                    semaphore.give();
-                    return;
-                }
-                stats.resends++;
-            }
+        if (block->resend_count >= REMOTE_LOG_MAX_RESENDS) {
+            free_block(dequeue_seqno(_blocks_sent, block->seqno));
+            stats.blocks_dropped++;
+            continue;
         }
-        semaphore.give();
+        if (! send_log_block(*block)) {
+            // failed to send the block; try again later....
+            break;
+        }
+        block->resend_count++;
+        stats.resends++;
+        count_to_send--;
+        update_window_on_loss(now);
+    }
+
+    semaphore.give();
+}
+
+// number of blocks which may be sent and not yet acknowledged
+uint8_t AP_Logger_MAVLink::window_size() const
+{
+    uint16_t window = MAX(_cwnd_x16 / 16, 2);
+    const int8_t max_window = _front._params.mav_window;
+    if (max_window > 0) {
+        window = MIN(window, uint16_t(max_window));
+    }
+    return MIN(window, _blockcount);
+}
+
+// resend timeout from the smoothed round trip time, as in RFC 6298
+uint16_t AP_Logger_MAVLink::resend_timeout_ms() const
+{
+    if (_srtt_ms == 0) {
+        return REMOTE_LOG_INITIAL_RTO_MS;
+    }
+    return constrain_uint32(_srtt_ms + 4U * _rttvar_ms, 50, 3000);
+}
+
+void AP_Logger_MAVLink::update_window_on_ack(const struct dm_block &block, uint32_t now)
+{
+    // only blocks sent once give an unambiguous round trip time
+    if (block.resend_count == 0) {
+        const uint16_t rtt_ms = MIN(now - block.last_sent, 10000U);
+        if (_srtt_ms == 0) {
+            _srtt_ms = MAX(rtt_ms, 1U);
+            _rttvar_ms = rtt_ms / 2;
+        } else {
+            const uint16_t err_ms = abs(int32_t(rtt_ms) - int32_t(_srtt_ms));
+            _rttvar_ms = (3U * _rttvar_ms + err_ms) / 4;
+            _srtt_ms = MAX((7U * _srtt_ms + rtt_ms) / 8, 1U);
+        }
+    }
+
+    // double the window each round trip up to the threshold, then
+    // grow it by a block each round trip
+    uint16_t increment = 16;
+    if (_cwnd_x16 >= _ssthresh_x16) {
+        increment = MAX(256U / _cwnd_x16, 1U);
+    }
+    _cwnd_x16 = MIN(_cwnd_x16 + increment, _blockcount * 16U);
+}
+
+void AP_Logger_MAVLink::update_window_on_loss(uint32_t now)
+{
+    // losses within a round trip are most likely from the same event
+    if (now - _last_loss_ms < MAX(_srtt_ms, 100U)) {
+        return;
     }
+    _last_loss_ms = now;
+    _ssthresh_x16 = MAX(_cwnd_x16 / 2, 2U * 16);
+    _cwnd_x16 = _ssthresh_x16;
 }
 
 // NOTE: any functions called from these periodic functions MUST
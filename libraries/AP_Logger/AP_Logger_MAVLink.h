@@ -66,6 +66,7 @@ private:
         uint32_t seqno;
         uint8_t buf[MAVLINK_MSG_REMOTE_LOG_DATA_BLOCK_FIELD_DATA_LEN];
         uint32_t last_sent;
+        uint8_t resend_count;
         struct dm_block *next;
     };
     bool send_log_block(struct dm_block &block);
@@ -77,6 +78,7 @@ private:
     // a stack for free blocks, queues for pending, sent, retries and sent
     struct dm_block_queue {
         uint32_t sent_count;
+        uint8_t count;
         struct dm_block *oldest;
         struct dm_block *youngest;
     };
@@ -85,7 +87,8 @@ private:
     bool queue_has_block(dm_block_queue_t &queue, struct dm_block *block);
     struct dm_block *dequeue_seqno(dm_block_queue_t &queue, uint32_t seqno);
     bool free_seqno_from_queue(uint32_t seqno, dm_block_queue_t &queue);
-    bool send_log_blocks_from_queue(dm_block_queue_t &queue);
+    void free_block(struct dm_block *block);
+    bool send_log_blocks_from_queue(dm_block_queue_t &queue, bool limit_to_window);
     uint8_t stack_size(struct dm_block *stack);
     uint8_t queue_size(dm_block_queue_t queue);
     
@@ -94,7 +97,22 @@ private:
     dm_block_queue_t _blocks_pending;
     dm_block_queue_t _blocks_retry;
 
+    // sliding window of unacknowledged blocks.  The window grows as
+    // blocks are acknowledged and is halved at most once per round
+    // trip when blocks are lost, so the send rate follows what the
+    // link delivers; LOG_MAV_WINDOW caps it
+    uint16_t _cwnd_x16;     // window in 1/16ths of a block
+    uint16_t _ssthresh_x16; // window size to stop doubling at
+    uint16_t _srtt_ms;      // smoothed round trip time
+    uint16_t _rttvar_ms;    // round trip time variation
+    uint32_t _last_loss_ms;
+    uint8_t window_size() const;
+    uint16_t resend_timeout_ms() const;
+    void update_window_on_ack(const struct dm_block &block, uint32_t now);
+    void update_window_on_loss(uint32_t now);
+
     struct _stats {
+        uint32_t blocks_dropped; // blocks abandoned after too many resends
         // the following are reset any time we log stats (see "reset_stats")
         uint32_t resends;
         uint8_t collection_count;
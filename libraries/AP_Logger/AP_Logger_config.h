@@ -39,6 +39,22 @@
 
 #endif
 
+// allow the file backend io thread to write both regions of its ring
+// buffer with a single gather write, rather than in 4k chunks
+#ifndef AP_LOGGER_FILE_GATHER_WRITE_ENABLED
+#define AP_LOGGER_FILE_GATHER_WRITE_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED && (CONFIG_HAL_BOARD == HAL_BOARD_SITL || CONFIG_HAL_BOARD == HAL_BOARD_LINUX)
+#endif
+
+// optional block compression of logs written by the file backend
+#ifndef AP_LOGGER_FILE_COMPRESSION_ENABLED
+#define AP_LOGGER_FILE_COMPRESSION_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED && BOARD_FLASH_SIZE > 1024
+#endif
+
+// optional LIDX index messages in logs written by the file backend
+#ifndef AP_LOGGER_FILE_INDEX_ENABLED
+#define AP_LOGGER_FILE_INDEX_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED && BOARD_FLASH_SIZE > 1024
+#endif
+
 #ifndef HAL_LOGGER_FILE_CONTENTS_ENABLED
 #define HAL_LOGGER_FILE_CONTENTS_ENABLED HAL_LOGGING_FILESYSTEM_ENABLED
 #endif
@@ -144,6 +144,7 @@ const struct MultiplierStructure log_Multipliers[] = {
 #include <AC_Fence/LogStructure.h>
 #include <AP_Landing/LogStructure.h>
 #include <AC_AttitudeControl/LogStructure.h>
+#include <AP_Scheduler/LogStructure.h>
 
 // structure used to define logging format
 // It is packed on ChibiOS to save flash space; however, this causes problems
@@ -224,6 +225,26 @@ struct PACKED log_DSF {
     uint32_t buf_space_avg;
 };
 
+struct PACKED log_DFIO {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t mode;
+    uint16_t writes;
+    uint32_t raw_bytes;
+    uint32_t bytes;
+    uint32_t write_us_max;
+    uint32_t write_us_avg;
+    uint32_t latency_us_max;
+    uint32_t latency_us_avg;
+};
+
+struct PACKED log_Index {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint64_t prev;
+    uint64_t types[4];
+};
+
 struct PACKED log_Event {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -310,6 +331,8 @@ struct PACKED log_MAV {
     uint8_t flags;
     uint16_t stream_slowdown_ms;
     uint16_t times_full;
+    float stream_rate_requested;
+    float stream_rate_achieved;
 };
 
 struct PACKED log_RSSI {
@@ -487,6 +510,9 @@ struct PACKED log_TERRAIN {
     uint16_t pending;
     uint16_t loaded;
     float reference_offset;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    uint32_t prefetched;
 };
 
 struct PACKED log_CSRV {
@@ -537,6 +563,10 @@ struct PACKED log_MAV_Stats {
     uint8_t state_sent_avg;
     uint8_t state_sent_min;
     uint8_t state_sent_max;
+    uint32_t blocks_sent;
+    uint32_t blocks_dropped;
+    uint16_t srtt_ms;
+    uint8_t window;
     // uint8_t state_retry_avg;
     // uint8_t state_retry_min;
     // uint8_t state_retry_max;
@@ -636,6 +666,18 @@ struct PACKED log_Scripting {
     int32_t run_mem;
 };
 
+struct PACKED log_ScriptStats {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    char name[16];
+    uint32_t runs;
+    uint32_t run_time;
+    uint32_t max_time;
+    float pct;
+    uint32_t p50_time;
+    uint32_t p99_time;
+};
+
 struct PACKED log_MotBatt {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -755,6 +797,10 @@ struct PACKED log_VER {
 // @Field: Sa: Average number of blocks on the sent list
 // @Field: Smn: Minimum number of blocks on the sent list
 // @Field: Smx: Maximum number of blocks on the sent list
+// @Field: Snt: Number of blocks sent for the first time
+// @Field: Drp: Number of blocks abandoned after being resent too many times
+// @Field: RTT: Smoothed round trip time from sending a block to its acknowledgement
+// @Field: W: Number of unacknowledged blocks currently allowed
 
 // @LoggerMessage: DSF
 // @Description: Onboard logging statistics
@@ -766,6 +812,28 @@ struct PACKED log_VER {
 // @Field: FMx: Maximum free space in write buffer in last time period
 // @Field: FAv: Average free space in write buffer in last time period
 
+// @LoggerMessage: DFIO
+// @Description: File logging backend IO thread write statistics
+// @Field: TimeUS: Time since system startup
+// @Field: Mode: Method used to write the log file
+// @FieldValueEnum: Mode: AP_Logger_File::WriteMode
+// @Field: NW: Number of write calls in last time period
+// @Field: Raw: Number of bytes of log data written in last time period
+// @Field: Bytes: Number of bytes written to the file in last time period, smaller than Raw when compressing
+// @Field: WMx: Maximum time taken by a single write call
+// @Field: WAv: Average time taken by a write call
+// @Field: LMx: Maximum time from a message being buffered to it being written
+// @Field: LAv: Average time from a message being buffered to it being written
+
+// @LoggerMessage: LIDX
+// @Description: Log index. Each LIDX covers the log data from the previous LIDX (or the start of the log) up to itself, allowing log readers to skip data they are not interested in
+// @Field: TimeUS: Time since system startup
+// @Field: Prev: Offset in the log of the previous LIDX message, 0 for the first
+// @Field: T0: Bitmask of message types 0 to 63 in the data covered
+// @Field: T1: Bitmask of message types 64 to 127 in the data covered
+// @Field: T2: Bitmask of message types 128 to 191 in the data covered
+// @Field: T3: Bitmask of message types 192 to 255 in the data covered
+
 // @LoggerMessage: ERR
 // @Description: Specifically coded error messages
 // @Field: TimeUS: Time since system startup
@@ -830,6 +898,8 @@ struct PACKED log_VER {
 // @FieldBitmaskEnum: flags: GCS_MAVLINK::Flags
 // @Field: ss: stream slowdown is the number of ms being added to each message to fit within bandwidth
 // @Field: tf: times buffer was full when a message was going to be sent
+// @Field: srq: total rate requested for stream-rated messages
+// @Field: sac: total rate stream-rated messages were actually sent at since the last MAV message
 
 // @LoggerMessage: MAVC
 // @Description: MAVLink command we have just executed
@@ -1097,6 +1167,9 @@ struct PACKED log_VER {
 // @Field: Pending: Number of tile requests outstanding
 // @Field: Loaded: Number of tiles in memory
 // @Field: ROfs: terrain reference offset for arming altitude
+// @Field: CHit: Number of terrain lookups found in the memory cache
+// @Field: CMiss: Number of terrain lookups that needed a tile loaded
+// @Field: Pref: Number of tiles loaded ahead of the vehicle on the mission
 
 // @LoggerMessage: TSYN
 // @Description: Time synchronisation response information
@@ -1157,6 +1230,17 @@ struct PACKED log_VER {
 // @Field: Total_mem: total memory usage of all scripts
 // @Field: Run_mem: run memory usage
 
+// @LoggerMessage: SCRS
+// @Description: Scripting CPU statistics of each script, written every 10 seconds when enabled with SCR_DEBUG_OPTS
+// @Field: TimeUS: Time since system startup
+// @Field: Name: script name
+// @Field: Runs: number of times the script ran since the last message
+// @Field: Time: time spent running the script since the last message
+// @Field: Max: longest run of the script
+// @Field: Pct: percentage of the time since the last message spent running the script
+// @Field: P50: median run time since the last message, rounded up to a power of two, or the longest run if above the largest histogram bucket
+// @Field: P99: 99th percentile run time since the last message, rounded up to a power of two, or the longest run if above the largest histogram bucket
+
 // @LoggerMessage: VER
 // @Description: Ardupilot version
 // @Field: TimeUS: Time since system startup
@@ -1231,18 +1315,19 @@ LOG_STRUCTURE_FROM_MOUNT \
     { LOG_RFND_MSG, sizeof(log_RFND), \
       "RFND", "QBCBBb", "TimeUS,Instance,Dist,Stat,Orient,Quality", "s#m--%", "F-B---", true }, \
     { LOG_MAV_STATS, sizeof(log_MAV_Stats), \
-      "DMS", "QIIIIBBBBBBBBB",         "TimeUS,N,Dp,RT,RS,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx", "s-------------", "F-------------" }, \
+      "DMS", "QIIIIBBBBBBBBBIIHB",         "TimeUS,N,Dp,RT,RS,Fa,Fmn,Fmx,Pa,Pmn,Pmx,Sa,Smn,Smx,Snt,Drp,RTT,W", "s---------------s-", "F---------------C-" }, \
     LOG_STRUCTURE_FROM_BEACON                                       \
     LOG_STRUCTURE_FROM_PROXIMITY                                    \
     { LOG_PERFORMANCE_MSG, sizeof(log_Performance),                     \
       "PM",  "QHHHIIHHIIIIII", "TimeUS,LR,NLon,NL,MaxT,Mem,Load,ErrL,IntE,ErrC,SPIC,I2CC,I2CI,Ex", "sz---b%------s", "F----0A------F" }, \
+LOG_STRUCTURE_FROM_SCHEDULER \
     { LOG_SRTL_MSG, sizeof(log_SRTL), \
       "SRTL", "QBHHBfff", "TimeUS,Active,NumPts,MaxPts,Action,N,E,D", "s----mmm", "F----000" }, \
 LOG_STRUCTURE_FROM_AVOIDANCE \
     { LOG_SIMSTATE_MSG, sizeof(log_AHRS), \
       "SIM","QccCfLLffff","TimeUS,Roll,Pitch,Yaw,Alt,Lat,Lng,Q1,Q2,Q3,Q4", "sddhmDU----", "FBBB0GG0000", true }, \
     { LOG_TERRAIN_MSG, sizeof(log_TERRAIN), \
-      "TERR","QBLLHffHHf","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded,ROfs", "s-DU-mm--m", "F-GG-00--0", true }, \
+      "TERR","QBLLHffHHfIII","TimeUS,Status,Lat,Lng,Spacing,TerrH,CHeight,Pending,Loaded,ROfs,CHit,CMiss,Pref", "s-DU-mm--m---", "F-GG-00--0---", true }, \
 LOG_STRUCTURE_FROM_ESC_TELEM \
     { LOG_CSRV_MSG, sizeof(log_CSRV), \
       "CSRV","QBfffBfffffB","TimeUS,Id,Pos,Force,Speed,Pow,PosCmd,V,A,MotT,PCBT,Err", "s#---%dvAOO-", "F-000000000-", true }, \
@@ -1272,10 +1357,14 @@ LOG_STRUCTURE_FROM_RPM \
 LOG_STRUCTURE_FROM_FENCE \
     { LOG_DF_FILE_STATS, sizeof(log_DSF), \
       "DSF", "QIHIIII", "TimeUS,Dp,Blk,Bytes,FMn,FMx,FAv", "s--b---", "F--0---" }, \
+    { LOG_DF_FILE_IO_STATS, sizeof(log_DFIO), \
+      "DFIO", "QBHIIIIII", "TimeUS,Mode,NW,Raw,Bytes,WMx,WAv,LMx,LAv", "s--bbssss", "F--00FFFF" }, \
+    { LOG_FILE_INDEX_MSG, sizeof(log_Index), \
+      "LIDX", "QQQQQQ", "TimeUS,Prev,T0,T1,T2,T3", "s-----", "F-----" }, \
     { LOG_RALLY_MSG, sizeof(log_Rally), \
       "RALY", "QBBLLhB", "TimeUS,Tot,Seq,Lat,Lng,Alt,Flags", "s--DUm-", "F--GGB-" },  \
     { LOG_MAV_MSG, sizeof(log_MAV),   \
-      "MAV", "QBHHHBHH",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf", "s#----s-", "F-000-C-" },   \
+      "MAV", "QBHHHBHHff",   "TimeUS,chan,txp,rxp,rxdp,flags,ss,tf,srq,sac", "s#----s-zz", "F-000-C-00" },   \
 LOG_STRUCTURE_FROM_VISUALODOM \
     { LOG_OPTFLOW_MSG, sizeof(log_Optflow), \
       "OF",   "QBffff",   "TimeUS,Qual,flowX,flowY,bodyX,bodyY", "s-EEnn", "F-0000" , true }, \
@@ -1299,6 +1388,8 @@ LOG_STRUCTURE_FROM_VISUALODOM \
 LOG_STRUCTURE_FROM_AIS \
     { LOG_SCRIPTING_MSG, sizeof(log_Scripting), \
       "SCR",   "QNIii", "TimeUS,Name,Runtime,Total_mem,Run_mem", "s#sbb", "F-F--", true }, \
+    { LOG_SCRIPT_STATS_MSG, sizeof(log_ScriptStats), \
+      "SCRS",  "QNIIIfII", "TimeUS,Name,Runs,Time,Max,Pct,P50,P99", "s#-ss%ss", "F--FF-FF", true }, \
     { LOG_VER_MSG, sizeof(log_VER), \
       "VER",   "QBHBBBBIZHB", "TimeUS,BT,BST,Maj,Min,Pat,FWT,GH,FWS,APJ,BU", "s----------", "F----------", false }, \
     { LOG_MOTBATT_MSG, sizeof(log_MotBatt), \
@@ -1382,12 +1473,16 @@ enum LogMessages : uint8_t {
     LOG_STAK_MSG,
     LOG_FILE_MSG,
     LOG_SCRIPTING_MSG,
+    LOG_SCRIPT_STATS_MSG,
     LOG_VIDEO_STABILISATION_MSG,
     LOG_MOTBATT_MSG,
     LOG_VER_MSG,
     LOG_RCOUT2_MSG,
     LOG_RCOUT3_MSG,
     LOG_IDS_FROM_FENCE,
+    LOG_IDS_FROM_SCHEDULER,
+    LOG_DF_FILE_IO_STATS,
+    LOG_FILE_INDEX_MSG,
 
     _LOG_LAST_MSG_
 };
@@ -0,0 +1,146 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Logger/AP_Logger_Compress.h>
+#include <AP_Logger/LogStructure.h>
+#include <AP_Math/AP_Math.h>
+
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t FRAME_SIZE = 4096;
+
+/*
+  fill a buffer with the messages a copter writes most often: IMU
+  messages from two IMUs, interleaved with ATT and RCOU. The vehicle is
+  gently rocking and the sensors are noisy, so the data compresses
+  about as well as a real log rather than as well as a repeating pattern
+ */
+static void fill_flight_log(uint8_t *buf, uint32_t len)
+{
+    uint32_t seed = 1;
+    auto noise = [&seed](float scale) {
+        seed = seed * 1103515245U + 12345U;
+        return scale * (int16_t(seed >> 16) / 32768.0f);
+    };
+
+    uint64_t time_us = 60000000;
+    uint32_t ofs = 0;
+    uint32_t tick = 0;
+    while (ofs < len) {
+        const float t = time_us * 1.0e-6f;
+        const float roll = 5 * sinf(t * 0.7f);
+        const float pitch = 3 * sinf(t * 0.4f);
+
+        uint8_t msg[64];
+        static_assert(sizeof(log_IMU) <= sizeof(msg) &&
+                      sizeof(log_Attitude) <= sizeof(msg) &&
+                      sizeof(log_RCOUT) <= sizeof(msg), "msg too small");
+        uint8_t msg_len;
+        if (tick % 4 != 3) {
+            const struct log_IMU pkt {
+                LOG_PACKET_HEADER_INIT(LOG_IMU_MSG),
+                time_us      : time_us,
+                instance     : uint8_t(tick % 2),
+                gyro_x       : noise(0.02f),
+                gyro_y       : noise(0.02f),
+                gyro_z       : noise(0.01f),
+                accel_x      : noise(0.3f),
+                accel_y      : noise(0.3f),
+                accel_z      : -GRAVITY_MSS + noise(0.5f),
+                gyro_error   : 0,
+                accel_error  : 0,
+                temperature  : 45.0f + noise(0.1f),
+                gyro_health  : 1,
+                accel_health : 1,
+                gyro_rate    : 400,
+                accel_rate   : 400,
+            };
+            memcpy(msg, &pkt, sizeof(pkt));
+            msg_len = sizeof(pkt);
+        } else if (tick % 8 == 3) {
+            const struct log_Attitude pkt {
+                LOG_PACKET_HEADER_INIT(LOG_ATTITUDE_MSG),
+                time_us       : time_us,
+                control_roll  : int16_t(roll * 100),
+                roll          : int16_t((roll + noise(0.3f)) * 100),
+                control_pitch : int16_t(pitch * 100),
+                pitch         : int16_t((pitch + noise(0.3f)) * 100),
+                control_yaw   : 9000,
+                yaw           : uint16_t(9000 + noise(50)),
+                error_rp      : 2,
+                error_yaw     : 3,
+                active        : 3,
+            };
+            memcpy(msg, &pkt, sizeof(pkt));
+            msg_len = sizeof(pkt);
+        } else {
+            const uint16_t hover = 1500 + int16_t(roll * 10);
+            const struct log_RCOUT pkt {
+                LOG_PACKET_HEADER_INIT(LOG_RCOUT_MSG),
+                time_us : time_us,
+                chan1   : uint16_t(hover + noise(20)),
+                chan2   : uint16_t(hover + noise(20)),
+                chan3   : uint16_t(hover + noise(20)),
+                chan4   : uint16_t(hover + noise(20)),
+                chan5   : 1000,
+                chan6   : 1000,
+                chan7   : 1000,
+                chan8   : 1000,
+                chan9   : 0,
+                chan10  : 0,
+                chan11  : 0,
+                chan12  : 0,
+                chan13  : 0,
+                chan14  : 0,
+            };
+            memcpy(msg, &pkt, sizeof(pkt));
+            msg_len = sizeof(pkt);
+        }
+        const uint32_t n = MIN(uint32_t(msg_len), len - ofs);
+        memcpy(&buf[ofs], msg, n);
+        ofs += n;
+        tick++;
+        time_us += 1250;
+    }
+}
+
+// the second of two frames is compressed against the first, as the
+// file backend does for all but the first frame of a log
+static void BM_LogCompressFrame(benchmark::State& state)
+{
+    static uint16_t hash_table[AP_Logger_Compress::HASH_TABLE_SIZE];
+    static uint8_t src[2 * FRAME_SIZE];
+    static uint8_t frame[sizeof(AP_Logger_Compress::FrameHeader) + AP_Logger_Compress::max_compressed_size(FRAME_SIZE)];
+    fill_flight_log(src, sizeof(src));
+
+    while (state.KeepRunning()) {
+        uint32_t len = AP_Logger_Compress::build_frame(&src[FRAME_SIZE], FRAME_SIZE, frame, hash_table, FRAME_SIZE);
+        gbenchmark_escape(&len);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * FRAME_SIZE);
+}
+
+static void BM_LogDecodeFrame(benchmark::State& state)
+{
+    static uint16_t hash_table[AP_Logger_Compress::HASH_TABLE_SIZE];
+    static uint8_t src[2 * FRAME_SIZE];
+    static uint8_t frame[sizeof(AP_Logger_Compress::FrameHeader) + AP_Logger_Compress::max_compressed_size(FRAME_SIZE)];
+    static uint8_t out[2 * FRAME_SIZE];
+    fill_flight_log(src, sizeof(src));
+    AP_Logger_Compress::build_frame(&src[FRAME_SIZE], FRAME_SIZE, frame, hash_table, FRAME_SIZE);
+    AP_Logger_Compress::FrameHeader hdr;
+    memcpy(&hdr, frame, sizeof(hdr));
+    memcpy(out, src, FRAME_SIZE);
+
+    while (state.KeepRunning()) {
+        bool ok = AP_Logger_Compress::decode_frame(hdr, &frame[sizeof(hdr)], &out[FRAME_SIZE], FRAME_SIZE);
+        gbenchmark_escape(&ok);
+    }
+    state.SetBytesProcessed(int64_t(state.iterations()) * FRAME_SIZE);
+}
+
+BENCHMARK(BM_LogCompressFrame);
+BENCHMARK(BM_LogDecodeFrame);
+
+BENCHMARK_MAIN();
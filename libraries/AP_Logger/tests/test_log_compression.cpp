@@ -0,0 +1,208 @@
+#include <AP_gtest.h>
+#include <AP_HAL/AP_HAL.h>
+
+#include <AP_Logger/AP_Logger_Compress.h>
+#include <AP_Logger/LogStructure.h>
+#include <AP_Math/AP_Math.h>
+
+#include <string.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const uint16_t FRAME_SIZE = 4096;
+
+/*
+  fill a buffer with data that looks like a log: a few message types
+  with slowly changing fields
+ */
+static void fill_log_like(uint8_t *buf, uint32_t len)
+{
+    uint64_t time_us = 1000000;
+    uint32_t ofs = 0;
+    uint8_t msgid = 0;
+    while (ofs < len) {
+        uint8_t msg[32] {};
+        msg[0] = HEAD_BYTE1;
+        msg[1] = HEAD_BYTE2;
+        msg[2] = 100 + msgid;
+        memcpy(&msg[3], &time_us, sizeof(time_us));
+        for (uint8_t i=11; i<sizeof(msg); i++) {
+            msg[i] = uint8_t(msgid * 7 + (time_us >> 12) + (i & 3));
+        }
+        const uint32_t n = MIN(uint32_t(sizeof(msg)), len - ofs);
+        memcpy(&buf[ofs], msg, n);
+        ofs += n;
+        time_us += 2500;
+        msgid = (msgid + 1) % 5;
+    }
+}
+
+static void fill_random(uint8_t *buf, uint32_t len, uint32_t seed)
+{
+    for (uint32_t i=0; i<len; i++) {
+        seed = seed * 1103515245U + 12345U;
+        buf[i] = seed >> 16;
+    }
+}
+
+// build a frame from src and decode it again, checking the result
+static uint32_t round_trip(const uint8_t *src, uint16_t len)
+{
+    uint16_t hash_table[AP_Logger_Compress::HASH_TABLE_SIZE];
+    uint8_t frame[sizeof(AP_Logger_Compress::FrameHeader) + AP_Logger_Compress::max_compressed_size(FRAME_SIZE)];
+    uint8_t out[FRAME_SIZE];
+
+    const uint32_t frame_len = AP_Logger_Compress::build_frame(src, len, frame, hash_table);
+    EXPECT_GE(frame_len, sizeof(AP_Logger_Compress::FrameHeader));
+
+    AP_Logger_Compress::FrameHeader hdr;
+    memcpy(&hdr, frame, sizeof(hdr));
+    EXPECT_TRUE(AP_Logger_Compress::valid_frame_header(hdr, FRAME_SIZE));
+    EXPECT_EQ(hdr.raw_len, len);
+    EXPECT_EQ(frame_len, sizeof(hdr) + hdr.data_len);
+    EXPECT_TRUE(AP_Logger_Compress::decode_frame(hdr, &frame[sizeof(hdr)], out));
+    EXPECT_EQ(memcmp(src, out, len), 0);
+    return frame_len;
+}
+
+TEST(AP_Logger_Compress, FileHeader)
+{
+    AP_Logger_Compress::FileHeader hdr;
+    AP_Logger_Compress::init_file_header(hdr, FRAME_SIZE);
+    EXPECT_TRUE(AP_Logger_Compress::valid_file_header(hdr));
+    EXPECT_EQ(hdr.frame_size, FRAME_SIZE);
+
+    // a plain log starts with a message header, not the magic
+    const uint8_t plain[sizeof(hdr)] { HEAD_BYTE1, HEAD_BYTE2, LOG_FORMAT_MSG };
+    memcpy(&hdr, plain, sizeof(hdr));
+    EXPECT_FALSE(AP_Logger_Compress::valid_file_header(hdr));
+}
+
+TEST(AP_Logger_Compress, LogLikeData)
+{
+    uint8_t src[FRAME_SIZE];
+    fill_log_like(src, sizeof(src));
+    const uint32_t frame_len = round_trip(src, sizeof(src));
+    // log data should compress well
+    EXPECT_LT(frame_len, sizeof(src) / 2);
+
+    // partial frames, as written when logging stops
+    for (uint16_t len : { 1, 5, 12, 13, 100, 1000, 4095 }) {
+        round_trip(src, len);
+    }
+}
+
+TEST(AP_Logger_Compress, StoredFrame)
+{
+    uint8_t src[FRAME_SIZE];
+    fill_random(src, sizeof(src), 42);
+    const uint32_t frame_len = round_trip(src, sizeof(src));
+    // random data can't be compressed so is stored
+    EXPECT_EQ(frame_len, sizeof(AP_Logger_Compress::FrameHeader) + sizeof(src));
+}
+
+TEST(AP_Logger_Compress, MixedData)
+{
+    uint8_t src[FRAME_SIZE];
+    for (uint32_t seed=1; seed<50; seed++) {
+        fill_log_like(src, sizeof(src));
+        fill_random(&src[seed * 37], seed * 11, seed);
+        round_trip(src, sizeof(src));
+    }
+}
+
+TEST(AP_Logger_Compress, PrefixedFrames)
+{
+    // consecutive frames as the file backend builds them, each
+    // immediately after the previous one
+    const uint16_t num_frames = 4;
+    uint8_t src[num_frames * FRAME_SIZE];
+    fill_log_like(src, sizeof(src));
+    fill_random(&src[FRAME_SIZE + 100], 500, 7);
+    // the last frame repeats the one before it
+    memcpy(&src[(num_frames-1) * FRAME_SIZE], &src[(num_frames-2) * FRAME_SIZE], FRAME_SIZE);
+
+    uint16_t hash_table[AP_Logger_Compress::HASH_TABLE_SIZE];
+    uint8_t frame[sizeof(AP_Logger_Compress::FrameHeader) + AP_Logger_Compress::max_compressed_size(FRAME_SIZE)];
+    uint8_t out[sizeof(src)];
+    uint16_t prev_len = 0;
+    uint32_t frame_len = 0;
+    for (uint16_t i=0; i<num_frames; i++) {
+        frame_len = AP_Logger_Compress::build_frame(&src[i * FRAME_SIZE], FRAME_SIZE, frame, hash_table, prev_len);
+
+        AP_Logger_Compress::FrameHeader hdr;
+        memcpy(&hdr, frame, sizeof(hdr));
+        EXPECT_TRUE(AP_Logger_Compress::valid_frame_header(hdr, FRAME_SIZE));
+        EXPECT_EQ(bool(hdr.flags & uint8_t(AP_Logger_Compress::FrameFlags::PREFIXED)), i > 0);
+        EXPECT_TRUE(AP_Logger_Compress::decode_frame(hdr, &frame[sizeof(hdr)], &out[i * FRAME_SIZE], prev_len));
+        if (i > 0) {
+            // the frame can't be decoded without the previous one
+            EXPECT_FALSE(AP_Logger_Compress::decode_frame(hdr, &frame[sizeof(hdr)], &out[i * FRAME_SIZE]));
+        }
+        prev_len = FRAME_SIZE;
+    }
+    EXPECT_EQ(memcmp(src, out, sizeof(src)), 0);
+    // a repeated frame is one long match into the previous frame
+    EXPECT_LT(frame_len, sizeof(AP_Logger_Compress::FrameHeader) + 32);
+}
+
+TEST(AP_Logger_Compress, CorruptFrame)
+{
+    uint16_t hash_table[AP_Logger_Compress::HASH_TABLE_SIZE];
+    uint8_t src[FRAME_SIZE];
+    uint8_t frame[sizeof(AP_Logger_Compress::FrameHeader) + AP_Logger_Compress::max_compressed_size(FRAME_SIZE)];
+    uint8_t out[FRAME_SIZE];
+    fill_log_like(src, sizeof(src));
+
+    AP_Logger_Compress::build_frame(src, sizeof(src), frame, hash_table);
+    AP_Logger_Compress::FrameHeader hdr;
+    memcpy(&hdr, frame, sizeof(hdr));
+
+    // a frame claiming to be bigger than the file frame size is rejected
+    EXPECT_FALSE(AP_Logger_Compress::valid_frame_header(hdr, FRAME_SIZE/2));
+
+    // bad magic is rejected
+    AP_Logger_Compress::FrameHeader bad_hdr = hdr;
+    bad_hdr.magic[0] ^= 1;
+    EXPECT_FALSE(AP_Logger_Compress::valid_frame_header(bad_hdr, FRAME_SIZE));
+
+    /*
+      corruption of the data must be caught by decompression or the
+      crc. Some changes to match offsets still give the same output as
+      the data repeats, which is harmless
+     */
+    uint8_t *data = &frame[sizeof(hdr)];
+    uint16_t detected = 0;
+    for (uint16_t i=0; i<hdr.data_len; i++) {
+        data[i] ^= 0x10;
+        if (AP_Logger_Compress::decode_frame(hdr, data, out)) {
+            EXPECT_EQ(memcmp(src, out, sizeof(src)), 0);
+        } else {
+            detected++;
+        }
+        data[i] ^= 0x10;
+    }
+    EXPECT_GT(detected, hdr.data_len / 2);
+    EXPECT_TRUE(AP_Logger_Compress::decode_frame(hdr, data, out));
+}
+
+TEST(AP_Logger_Compress, DecompressOverflow)
+{
+    uint16_t hash_table[AP_Logger_Compress::HASH_TABLE_SIZE];
+    uint8_t src[FRAME_SIZE];
+    uint8_t compressed[AP_Logger_Compress::max_compressed_size(FRAME_SIZE)];
+    uint8_t out[FRAME_SIZE];
+    fill_log_like(src, sizeof(src));
+
+    const uint32_t len = AP_Logger_Compress::compress(src, sizeof(src), compressed, sizeof(compressed), hash_table);
+    EXPECT_GT(len, 0U);
+    EXPECT_EQ(AP_Logger_Compress::decompress(compressed, len, out, sizeof(out)), int32_t(sizeof(src)));
+    // output buffer too small
+    EXPECT_EQ(AP_Logger_Compress::decompress(compressed, len, out, sizeof(out)-1), -1);
+    // truncated input
+    EXPECT_EQ(AP_Logger_Compress::decompress(compressed, len-1, out, sizeof(out)), -1);
+    // too much data to compress against a dictionary
+    EXPECT_EQ(AP_Logger_Compress::compress(src, sizeof(src), compressed, sizeof(compressed), hash_table, 65535 - sizeof(src) + 1), 0U);
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,102 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// number of points tested in each iteration
+#define NUM_TEST_POINTS 256
+
+/*
+  synthetic fence of n points around a lat/lon in 1e-7 degrees, with a
+  jagged radius as a hand drawn fence would have, and test points
+  spread over an area a little larger than the fence
+ */
+class Polygon_Benchmark {
+public:
+    Polygon_Benchmark(uint16_t n) :
+        _num_points(n)
+    {
+        const Vector2l centre{-353632620, 1491652370};
+        const float radius = 50000;
+        _points = new Vector2l[n+1];
+        for (uint16_t i = 0; i < n; i++) {
+            const float angle = radians(360.0f * i / n);
+            const float r = radius * (0.7f + 0.3f * sinf(i * 7.0f));
+            _points[i] = Vector2l{int32_t(centre.x + r * cosf(angle)), int32_t(centre.y + r * sinf(angle))};
+        }
+        _points[n] = _points[0];
+        for (uint16_t i = 0; i < NUM_TEST_POINTS; i++) {
+            const float angle = radians(i * 137.5f);
+            const float r = radius * 1.2f * (i + 0.5f) / NUM_TEST_POINTS;
+            _test_points[i] = Vector2l{int32_t(centre.x + r * cosf(angle)), int32_t(centre.y + r * sinf(angle))};
+        }
+    }
+
+    ~Polygon_Benchmark()
+    {
+        delete[] _points;
+    }
+
+    bool init_index()
+    {
+        return _index.init(_points, _num_points+1);
+    }
+
+    uint16_t outside_count() const
+    {
+        uint16_t count = 0;
+        for (uint16_t i = 0; i < NUM_TEST_POINTS; i++) {
+            count += Polygon_outside(_test_points[i], _points, _num_points+1) ? 1 : 0;
+        }
+        return count;
+    }
+
+    uint16_t index_outside_count() const
+    {
+        uint16_t count = 0;
+        for (uint16_t i = 0; i < NUM_TEST_POINTS; i++) {
+            count += _index.outside(_test_points[i]) ? 1 : 0;
+        }
+        return count;
+    }
+
+private:
+    uint16_t _num_points;
+    Vector2l *_points;
+    Vector2l _test_points[NUM_TEST_POINTS];
+    Polygon_index<int32_t> _index;
+};
+
+static void BM_PolygonOutside(benchmark::State &state)
+{
+    Polygon_Benchmark *bench = new Polygon_Benchmark(state.range(0));
+    while (state.KeepRunning()) {
+        uint16_t count = bench->outside_count();
+        gbenchmark_escape(&count);
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_TEST_POINTS);
+    delete bench;
+}
+
+static void BM_PolygonIndexOutside(benchmark::State &state)
+{
+    Polygon_Benchmark *bench = new Polygon_Benchmark(state.range(0));
+    if (!bench->init_index()) {
+        state.SkipWithError("index allocation failed");
+    } else if (bench->index_outside_count() != bench->outside_count()) {
+        state.SkipWithError("index does not match Polygon_outside");
+    }
+    while (state.KeepRunning()) {
+        uint16_t count = bench->index_outside_count();
+        gbenchmark_escape(&count);
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_TEST_POINTS);
+    delete bench;
+}
+
+// small fences, typical fences and the largest a fence upload allows
+BENCHMARK(BM_PolygonOutside)->Arg(8)->Arg(64)->Arg(254);
+BENCHMARK(BM_PolygonIndexOutside)->Arg(8)->Arg(64)->Arg(254);
+
+BENCHMARK_MAIN();
@@ -26,6 +26,55 @@
  */
 
 
+/*
+ *  return true if a ray from P in the x direction crosses the edge
+ *  from Vi to Vj. Each crossing toggles whether P is outside the
+ *  polygon
+ */
+template <typename T>
+static inline bool Polygon_edge_crossed(const Vector2<T> &P, const Vector2<T> &Vi, const Vector2<T> &Vj)
+{
+    if ((Vi.y > P.y) == (Vj.y > P.y)) {
+        return false;
+    }
+    const T dx1 = P.x - Vi.x;
+    const T dx2 = Vj.x - Vi.x;
+    const T dy1 = P.y - Vi.y;
+    const T dy2 = Vj.y - Vi.y;
+    const int8_t dx1s = (dx1 < 0) ? -1 : 1;
+    const int8_t dx2s = (dx2 < 0) ? -1 : 1;
+    const int8_t dy1s = (dy1 < 0) ? -1 : 1;
+    const int8_t dy2s = (dy2 < 0) ? -1 : 1;
+    const int8_t m1 = dx1s * dy2s;
+    const int8_t m2 = dx2s * dy1s;
+    // we avoid the 64 bit multiplies if we can based on sign checks.
+    if (dy2 < 0) {
+        if (m1 > m2) {
+            return true;
+        } else if (m1 < m2) {
+            return false;
+        } else {
+            if (std::is_floating_point<T>::value) {
+                return dx1 * dy2 > dx2 * dy1;
+            } else {
+                return dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1;
+            }
+        }
+    } else {
+        if (m1 < m2) {
+            return true;
+        } else if (m1 > m2) {
+            return false;
+        } else {
+            if (std::is_floating_point<T>::value) {
+                return dx1 * dy2 < dx2 * dy1;
+            } else {
+                return dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1;
+            }
+        }
+    }
+}
+
 /*
  *  Polygon_outside(): test for a point in a polygon
  *     Input:   P = a point,
@@ -54,52 +103,8 @@ bool Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n)
         if (j >= n) {
             j = 0;
         }
-        if ((V[i].y > P.y) == (V[j].y > P.y)) {
-            continue;
-        }
-        const T dx1 = P.x - V[i].x;
-        const T dx2 = V[j].x - V[i].x;
-        const T dy1 = P.y - V[i].y;
-        const T dy2 = V[j].y - V[i].y;
-        const int8_t dx1s = (dx1 < 0) ? -1 : 1;
-        const int8_t dx2s = (dx2 < 0) ? -1 : 1;
-        const int8_t dy1s = (dy1 < 0) ? -1 : 1;
-        const int8_t dy2s = (dy2 < 0) ? -1 : 1;
-        const int8_t m1 = dx1s * dy2s;
-        const int8_t m2 = dx2s * dy1s;
-        // we avoid the 64 bit multiplies if we can based on sign checks.
-        if (dy2 < 0) {
-            if (m1 > m2) {
-                outside = !outside;
-            } else if (m1 < m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 > dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 > dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
-        } else {
-            if (m1 < m2) {
-                outside = !outside;
-            } else if (m1 > m2) {
-                continue;
-            } else {
-                if (std::is_floating_point<T>::value) {
-                    if ( dx1 * dy2 < dx2 * dy1 ) {
-                        outside = !outside;
-                    }
-                } else {
-                    if ( dx1 * (int64_t)dy2 < dx2 * (int64_t)dy1 ) {
-                        outside = !outside;
-                    }
-                }
-            }
+        if (Polygon_edge_crossed(P, V[i], V[j])) {
+            outside = !outside;
         }
     }
     return outside;
@@ -118,7 +123,158 @@ bool Polygon_complete(const Vector2<T> *V, unsigned n)
     return (n >= 4 && V[n-1] == V[0]);
 }
 
+/*
+  build the bounding box and edge bands for a polygon. Each edge is
+  put in every band its y range overlaps, so every edge which could
+  be crossed by a ray from a point is in the band of that point
+ */
+template <typename T>
+bool Polygon_index<T>::init(const Vector2<T> *V, unsigned n, uint16_t min_points, uint16_t max_bands)
+{
+    clear();
+
+    if (V == nullptr || n == 0) {
+        return true;
+    }
+    if (Polygon_complete(V, n)) {
+        n--;
+    }
+    if (n > UINT16_MAX) {
+        return true;
+    }
+    _points = V;
+    _num_points = n;
+
+    _min = _max = V[0];
+    for (uint16_t i=1; i<_num_points; i++) {
+        _min.x = MIN(_min.x, V[i].x);
+        _min.y = MIN(_min.y, V[i].y);
+        _max.x = MAX(_max.x, V[i].x);
+        _max.y = MAX(_max.y, V[i].y);
+    }
+
+    if (_num_points < min_points || max_bands == 0 || !(_max.y > _min.y)) {
+        // small enough to test every edge
+        return true;
+    }
+
+    // aim for a few edges per band, but halve the number of bands if
+    // long edges would put too many entries in them
+    uint16_t num_bands = MIN(_num_points / 4U, max_bands);
+    uint32_t num_entries;
+    while (true) {
+        _num_bands = num_bands;
+        num_entries = 0;
+        for (uint16_t i=0; i<_num_points; i++) {
+            const uint16_t j = (i+1 < _num_points) ? i+1 : 0;
+            num_entries += 1 + band(MAX(V[i].y, V[j].y)) - band(MIN(V[i].y, V[j].y));
+        }
+        if (num_entries <= 4U * _num_points || num_bands == 1) {
+            break;
+        }
+        num_bands /= 2;
+    }
+    _num_bands = 0;
+    if (num_entries > UINT16_MAX) {
+        return true;
+    }
+
+    _band_start = new uint16_t[num_bands+1];
+    _band_edges = new uint16_t[num_entries];
+    if (_band_start == nullptr || _band_edges == nullptr) {
+        delete[] _band_start;
+        delete[] _band_edges;
+        _band_start = nullptr;
+        _band_edges = nullptr;
+        return false;
+    }
+    _num_bands = num_bands;
+
+    // count the edges in each band, then turn the counts into offsets
+    memset(_band_start, 0, (num_bands+1) * sizeof(_band_start[0]));
+    for (uint16_t i=0; i<_num_points; i++) {
+        const uint16_t j = (i+1 < _num_points) ? i+1 : 0;
+        const uint16_t last = band(MAX(V[i].y, V[j].y));
+        for (uint16_t b=band(MIN(V[i].y, V[j].y)); b<=last; b++) {
+            _band_start[b+1]++;
+        }
+    }
+    for (uint16_t b=0; b<_num_bands; b++) {
+        _band_start[b+1] += _band_start[b];
+    }
+
+    // fill in the bands, using the start offsets as insertion points
+    // and shifting them back afterwards
+    for (uint16_t i=0; i<_num_points; i++) {
+        const uint16_t j = (i+1 < _num_points) ? i+1 : 0;
+        const uint16_t last = band(MAX(V[i].y, V[j].y));
+        for (uint16_t b=band(MIN(V[i].y, V[j].y)); b<=last; b++) {
+            _band_edges[_band_start[b]++] = i;
+        }
+    }
+    for (uint16_t b=_num_bands; b>0; b--) {
+        _band_start[b] = _band_start[b-1];
+    }
+    _band_start[0] = 0;
+
+    return true;
+}
+
+template <typename T>
+void Polygon_index<T>::clear()
+{
+    delete[] _band_start;
+    delete[] _band_edges;
+    _band_start = nullptr;
+    _band_edges = nullptr;
+    _num_bands = 0;
+    _points = nullptr;
+    _num_points = 0;
+}
+
+template <typename T>
+uint16_t Polygon_index<T>::band(T y) const
+{
+    // both calculations are monotonic in y, so an edge spanning y1
+    // to y2 covers every band of a y between them
+    uint32_t b;
+    if (std::is_floating_point<T>::value) {
+        b = float(y - _min.y) * _num_bands / float(_max.y - _min.y);
+    } else {
+        b = (int64_t(y) - _min.y) * _num_bands / (int64_t(_max.y) - _min.y + 1);
+    }
+    return MIN(b, _num_bands - 1U);
+}
+
+template <typename T>
+bool Polygon_index<T>::outside(const Vector2<T> &P) const
+{
+    // a ray from a point outside the bounding box crosses an even
+    // number of edges, if any
+    if (_num_points == 0 ||
+        P.x < _min.x || P.x > _max.x ||
+        P.y < _min.y || P.y > _max.y) {
+        return true;
+    }
+    if (_num_bands == 0) {
+        return Polygon_outside(P, _points, _num_points);
+    }
+
+    const uint16_t b = band(P.y);
+    bool outside = true;
+    for (uint16_t k=_band_start[b]; k<_band_start[b+1]; k++) {
+        const uint16_t i = _band_edges[k];
+        const uint16_t j = (i+1 < _num_points) ? i+1 : 0;
+        if (Polygon_edge_crossed(P, _points[i], _points[j])) {
+            outside = !outside;
+        }
+    }
+    return outside;
+}
+
 // Necessary to avoid linker errors
+template class Polygon_index<int32_t>;
+template class Polygon_index<float>;
 template bool Polygon_outside<int32_t>(const Vector2l &P, const Vector2l *V, unsigned n);
 template bool Polygon_complete<int32_t>(const Vector2l *V, unsigned n);
 template bool Polygon_outside<float>(const Vector2f &P, const Vector2f *V, unsigned n);
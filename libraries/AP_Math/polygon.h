@@ -24,6 +24,54 @@ bool        Polygon_outside(const Vector2<T> &P, const Vector2<T> *V, unsigned n
 template <typename T>
 bool        Polygon_complete(const Vector2<T> *V, unsigned n) WARN_IF_UNUSED;
 
+/*
+  index over the edges of a polygon to speed up Polygon_outside()
+  tests on polygons with many points. Points outside the bounding box
+  are rejected straight away, and the edges are bucketed into bands of
+  y so that a test only looks at the edges in the band of the point
+ */
+template <typename T>
+class Polygon_index {
+public:
+    Polygon_index() {}
+    ~Polygon_index() { clear(); }
+
+    CLASS_NO_COPY(Polygon_index);
+
+    // build the index for polygon V of n points. V must stay valid
+    // while the index is in use. Edge bands are only built for
+    // polygons of at least min_points points and use at most
+    // max_bands bands. Returns false if memory for the bands could
+    // not be allocated, the index still works without them
+    bool init(const Vector2<T> *V, unsigned n, uint16_t min_points=16, uint16_t max_bands=64) WARN_IF_UNUSED;
+
+    // free the bands and forget the polygon
+    void clear();
+
+    // returns the same result as Polygon_outside(P, V, n)
+    bool outside(const Vector2<T> &P) const WARN_IF_UNUSED;
+
+    // bounding box of the polygon
+    const Vector2<T> &min_point() const { return _min; }
+    const Vector2<T> &max_point() const { return _max; }
+
+    // number of edge bands, zero if the polygon is not banded
+    uint16_t num_bands() const { return _num_bands; }
+
+private:
+    // band holding y, y must be within the bounding box
+    uint16_t band(T y) const;
+
+    const Vector2<T> *_points = nullptr;
+    uint16_t _num_points = 0;       // not including a closing point
+    Vector2<T> _min;
+    Vector2<T> _max;
+
+    uint16_t _num_bands = 0;
+    uint16_t *_band_start = nullptr; // _num_bands+1 offsets into _band_edges
+    uint16_t *_band_edges = nullptr; // index of first point of each edge in the band
+};
+
 /*
   determine if the polygon of N verticies defined by points V is
   intersected by a line from point p1 to point p2
@@ -356,6 +356,123 @@ TEST(Polygon, simple)
     TEST_POLYGON_POINTS(SIMPLE_boundary, SIMPLE_test_points);
 }
 
+// deterministic pseudo-random numbers so failures are repeatable
+static uint32_t polygon_index_seed = 1;
+static float polygon_index_rand(float lo, float hi)
+{
+    polygon_index_seed = polygon_index_seed * 1103515245U + 12345U;
+    return lo + (hi - lo) * ((polygon_index_seed >> 8) & 0xFFFF) / 65535.0f;
+}
+
+/*
+  fill V with a star shaped polygon of n points around centre, with a
+  jagged radius so that many edges share bands, and close it
+ */
+template <typename T>
+static void polygon_index_star(Vector2<T> *V, uint16_t n, const Vector2<T> &centre, float radius)
+{
+    for (uint16_t i=0; i<n; i++) {
+        const float angle = radians(360.0f * i / n);
+        const float r = radius * polygon_index_rand(0.3f, 1.0f);
+        V[i] = Vector2<T>{T(centre.x + r * cosf(angle)), T(centre.y + r * sinf(angle))};
+    }
+    V[n] = V[0];
+}
+
+/*
+  check Polygon_index gives the same answer as Polygon_outside for
+  random points in and around the polygon, and for points on its
+  vertices and at the y values of its vertices
+ */
+template <typename T>
+static void polygon_index_check(const Vector2<T> *V, uint16_t n)
+{
+    Polygon_index<T> open_index;
+    Polygon_index<T> closed_index;
+    EXPECT_TRUE(open_index.init(V, n));
+    EXPECT_TRUE(closed_index.init(V, n+1));
+    if (n >= 16) {
+        EXPECT_NE(open_index.num_bands(), 0U);
+    }
+
+    const Vector2<T> &lo = open_index.min_point();
+    const Vector2<T> &hi = open_index.max_point();
+    const float margin_x = (hi.x - lo.x) * 0.2f;
+    const float margin_y = (hi.y - lo.y) * 0.2f;
+    for (uint16_t i=0; i<n; i++) {
+        EXPECT_GE(V[i].x, lo.x);
+        EXPECT_GE(V[i].y, lo.y);
+        EXPECT_LE(V[i].x, hi.x);
+        EXPECT_LE(V[i].y, hi.y);
+    }
+
+    uint32_t num_inside = 0;
+    for (uint16_t i=0; i<5000; i++) {
+        Vector2<T> P{T(polygon_index_rand(lo.x - margin_x, hi.x + margin_x)),
+                     T(polygon_index_rand(lo.y - margin_y, hi.y + margin_y))};
+        if (i % 4 == 1) {
+            // on the y of a vertex, where edges start and end
+            P.y = V[i % n].y;
+        } else if (i % 4 == 2) {
+            P = V[i % n];
+        }
+        const bool outside = Polygon_outside(P, V, n);
+        EXPECT_EQ(outside, open_index.outside(P));
+        EXPECT_EQ(outside, closed_index.outside(P));
+        num_inside += outside ? 0 : 1;
+    }
+    // make sure both sides of the boundary were tested
+    EXPECT_GT(num_inside, 100U);
+    EXPECT_LT(num_inside, 4900U);
+}
+
+TEST(Polygon, index_matches_outside_long)
+{
+    // jagged fences around a lat/lon in 1e-7 degrees
+    const uint16_t sizes[] { 3, 10, 16, 50, 254 };
+    for (uint16_t n : sizes) {
+        Vector2l V[255];
+        polygon_index_star(V, n, Vector2l{-353632620, 1491652370}, 50000);
+        polygon_index_check(V, n);
+    }
+}
+
+TEST(Polygon, index_matches_outside_float)
+{
+    // jagged polygons in cm offsets from the origin
+    const uint16_t sizes[] { 3, 10, 16, 50, 254 };
+    for (uint16_t n : sizes) {
+        Vector2f V[255];
+        polygon_index_star(V, n, Vector2f{-2000, 5000}, 30000);
+        polygon_index_check(V, n);
+    }
+}
+
+TEST(Polygon, index_matches_outside_comb)
+{
+    // a comb of long teeth along y, so most edges span most bands
+    Vector2l V[101];
+    const uint16_t teeth = 25;
+    for (uint16_t i=0; i<teeth; i++) {
+        V[i*2] = Vector2l{int32_t(i * 1000), 0};
+        V[i*2+1] = Vector2l{int32_t(i * 1000 + 500), 100000};
+    }
+    V[teeth*2] = Vector2l{int32_t(teeth * 1000), 0};
+    V[teeth*2+1] = Vector2l{int32_t(teeth * 1000), -1000};
+    V[teeth*2+2] = Vector2l{0, -1000};
+    const uint16_t n = teeth*2+3;
+    V[n] = V[0];
+    polygon_index_check(V, n);
+}
+
+TEST(Polygon, index_empty)
+{
+    Polygon_index<float> index;
+    EXPECT_TRUE(index.outside(Vector2f{0, 0}));
+    EXPECT_TRUE(index.init(nullptr, 0));
+    EXPECT_TRUE(index.outside(Vector2f{0, 0}));
+}
+
 AP_GTEST_MAIN()
 
 
@@ -126,6 +126,7 @@
 
 class NavEKF3_core : public NavEKF_core_common
 {
+    friend class NavEKF3_core_Benchmark;
 public:
     // Constructor
     NavEKF3_core(class NavEKF3 *_frontend);
@@ -0,0 +1,70 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  run the covariance prediction of a single core from a fixed
+  in-flight state with all 24 states active
+ */
+class NavEKF3_core_Benchmark {
+public:
+    NavEKF3_core_Benchmark() {
+        // the core constructor leaves most members to the zeroed memory
+        // NavEKF3::InitialiseFilter() allocates cores in, so use the zeroing operator new
+        frontend = new NavEKF3();
+        core = new NavEKF3_core(frontend);
+
+        core->stateIndexLim = 23;
+        core->dtEkfAvg = EKF_TARGET_DT;
+        core->imuDataDelayed.delAngDT = EKF_TARGET_DT;
+        core->imuDataDelayed.delVelDT = EKF_TARGET_DT;
+        core->imuDataDelayed.delAng = Vector3F(0.001, -0.002, 0.0005);
+        core->imuDataDelayed.delVel = Vector3F(0.01, 0.02, -0.118);
+        core->stateStruct.quat.from_euler(0.1, -0.05, 1.0);
+        core->stateStruct.gyro_bias = Vector3F(1e-5, -2e-5, 3e-6);
+        core->stateStruct.accel_bias = Vector3F(1e-4, 2e-4, -1e-4);
+        core->prevTnb.identity();
+
+        // symmetric, diagonally dominant starting covariance
+        for (uint8_t i = 0; i < 24; i++) {
+            for (uint8_t j = 0; j <= i; j++) {
+                const ftype v = (i == j) ? 1e-2 * (i + 1) : 1e-5 * ((i * 7 + j * 3) % 11 - 5);
+                P_init[i][j] = P_init[j][i] = v;
+            }
+        }
+    }
+
+    ~NavEKF3_core_Benchmark() {
+        delete core;
+        delete frontend;
+    }
+
+    void predict() {
+        memcpy(&core->P, &P_init, sizeof(P_init));
+        core->CovariancePrediction(nullptr);
+    }
+
+    const NavEKF3_core::Matrix24 &get_P() const { return core->P; }
+
+private:
+    NavEKF3 *frontend;
+    NavEKF3_core *core;
+    NavEKF3_core::Matrix24 P_init;
+};
+
+static void BM_EKF3CovariancePrediction(benchmark::State &state)
+{
+    NavEKF3_core_Benchmark *bench = new NavEKF3_core_Benchmark();
+    while (state.KeepRunning()) {
+        bench->predict();
+        gbenchmark_escape(bench);
+    }
+    delete bench;
+}
+
+BENCHMARK(BM_EKF3CovariancePrediction);
+
+BENCHMARK_MAIN();
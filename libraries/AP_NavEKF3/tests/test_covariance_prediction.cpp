@@ -0,0 +1,939 @@
+#include <AP_gtest.h>
+
+#include <AP_NavEKF3/AP_NavEKF3.h>
+#include <AP_NavEKF3/AP_NavEKF3_core.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  compare CovariancePrediction() with the fully generated code it
+  replaced, which is kept below as the reference. Two cores are given
+  the same randomised state and covariance and each is run through one
+  prediction
+ */
+class NavEKF3_core_Benchmark {
+public:
+    NavEKF3_core_Benchmark() {
+        frontend = new NavEKF3();
+        core = new NavEKF3_core(frontend);
+        reference = new NavEKF3_core(frontend);
+    }
+
+    ~NavEKF3_core_Benchmark() {
+        delete reference;
+        delete core;
+        delete frontend;
+    }
+
+    // run both predictions from the state given by seed and check they match
+    void check_prediction(uint32_t seed, bool quat_reset);
+
+    // state index limits covered by the checks so far
+    uint32_t state_index_lims_seen = 0;
+
+private:
+    void randomise(NavEKF3_core &c, uint32_t seed) const;
+    static void reference_prediction(NavEKF3_core &c, Vector3F *rotVarVecPtr);
+
+    NavEKF3 *frontend;
+    NavEKF3_core *core;
+    NavEKF3_core *reference;
+};
+
+// deterministic pseudo-random numbers so failures are repeatable
+static ftype ekf_rand(uint32_t &seed, ftype lo, ftype hi)
+{
+    seed = seed * 1103515245U + 12345U;
+    return lo + (hi - lo) * ((seed >> 8) & 0xFFFF) / 65535.0;
+}
+
+void NavEKF3_core_Benchmark::randomise(NavEKF3_core &c, uint32_t seed) const
+{
+    frontend->_gyrNoise.set(ekf_rand(seed, 0.001, 0.1));
+    frontend->_accNoise.set(ekf_rand(seed, 0.05, 1.0));
+    frontend->_gyroBiasProcessNoise.set(ekf_rand(seed, 1e-4, 1e-2));
+    frontend->_accelBiasProcessNoise.set(ekf_rand(seed, 1e-4, 1e-2));
+    frontend->_magEarthProcessNoise.set(ekf_rand(seed, 1e-4, 1e-2));
+    frontend->_magBodyProcessNoise.set(ekf_rand(seed, 1e-4, 1e-2));
+    frontend->_windVelProcessNoise.set(ekf_rand(seed, 0.01, 1.0));
+    frontend->_wndVarHgtRateScale.set(ekf_rand(seed, 0, 1));
+
+    c.inhibitWindStates = ekf_rand(seed, 0, 1) > 0.5;
+    c.inhibitMagStates = ekf_rand(seed, 0, 1) > 0.5;
+    c.lastInhibitMagStates = c.inhibitMagStates;
+    c.inhibitDelVelBiasStates = ekf_rand(seed, 0, 1) > 0.5;
+    c.inhibitDelAngBiasStates = ekf_rand(seed, 0, 1) > 0.5;
+    c.updateStateIndexLim();
+    c.needMagBodyVarReset = ekf_rand(seed, 0, 1) > 0.8;
+    c.needEarthBodyVarReset = false;
+    c.badIMUdata = ekf_rand(seed, 0, 1) > 0.8;
+    c.onGround = ekf_rand(seed, 0, 1) > 0.5;
+    c.dragTimeout = ekf_rand(seed, 0, 1) > 0.5;
+    c.filterStatus.flags.dead_reckoning = ekf_rand(seed, 0, 1) > 0.8;
+    c.tasDataDelayed.allowFusion = ekf_rand(seed, 0, 1) > 0.5;
+    for (uint8_t i = 0; i < 3; i++) {
+        c.dvelBiasAxisInhibit[i] = ekf_rand(seed, 0, 1) > 0.8;
+        c.dvelBiasAxisVarPrev[i] = ekf_rand(seed, 1e-6, 1e-4);
+    }
+    c.vertVelVarClipCounter = ekf_rand(seed, 0, 1) > 0.8 ? 10 : 0;
+
+    c.dtEkfAvg = EKF_TARGET_DT;
+    c.imuDataDelayed.delAngDT = EKF_TARGET_DT * ekf_rand(seed, 0.8, 1.2);
+    c.imuDataDelayed.delVelDT = EKF_TARGET_DT * ekf_rand(seed, 0.8, 1.2);
+    for (uint8_t i = 0; i < 3; i++) {
+        c.imuDataDelayed.delAng[i] = ekf_rand(seed, -0.01, 0.01);
+        c.imuDataDelayed.delVel[i] = ekf_rand(seed, -0.2, 0.2);
+    }
+    c.hgtRate = ekf_rand(seed, -2, 2);
+    for (uint8_t i = 4; i < 24; i++) {
+        c.statesArray[i] = ekf_rand(seed, -1, 1) * ((i >= 10 && i <= 15) ? 1e-3 : 1);
+    }
+    c.stateStruct.quat.from_euler(ekf_rand(seed, -1, 1), ekf_rand(seed, -1, 1), ekf_rand(seed, -M_PI, M_PI));
+    c.stateStruct.quat.inverse().rotation_matrix(c.prevTnb);
+
+    // symmetric, diagonally dominant covariance, sometimes with
+    // position variances large enough to stop their growth
+    const ftype pos_scale = ekf_rand(seed, 0, 1) > 0.8 ? 1e4 : 1;
+    for (uint8_t i = 0; i < 24; i++) {
+        c.P[i][i] = ekf_rand(seed, 1e-5, 1e-1) * ((i == 7 || i == 8) ? pos_scale : 1);
+    }
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = 0; j < i; j++) {
+            c.P[i][j] = c.P[j][i] = ekf_rand(seed, -0.2, 0.2) * sqrtF(c.P[i][i] * c.P[j][j]);
+        }
+    }
+}
+
+void NavEKF3_core_Benchmark::check_prediction(uint32_t seed, bool quat_reset)
+{
+    Vector3F rotVarVec(1e-3, 2e-3, 3e-3);
+    Vector3F *rotVarVecPtr = quat_reset ? &rotVarVec : nullptr;
+
+    randomise(*core, seed);
+    core->CovariancePrediction(rotVarVecPtr);
+    randomise(*reference, seed);
+    reference_prediction(*reference, rotVarVecPtr);
+
+    state_index_lims_seen |= 1U << core->stateIndexLim;
+
+    /*
+      the expressions are evaluated in the same order so the results
+      are normally identical. Allow for a compiler contracting them
+      into fused multiply-adds differently in the two translation units
+     */
+    for (uint8_t i = 0; i < 24; i++) {
+        for (uint8_t j = 0; j < 24; j++) {
+            const ftype tolerance = 1e-5 * sqrtF(fabsF(reference->P[i][i] * reference->P[j][j])) + 1e-12;
+            EXPECT_NEAR(core->P[i][j], reference->P[i][j], tolerance) << "P[" << int(i) << "][" << int(j) << "] seed " << seed;
+        }
+    }
+    EXPECT_NEAR(core->tiltErrorVariance, reference->tiltErrorVariance, 1e-5 * reference->tiltErrorVariance);
+    EXPECT_FLOAT_EQ(core->hgtRate, reference->hgtRate);
+    EXPECT_EQ(core->vertVelVarClipCounter, reference->vertVelVarClipCounter);
+    for (uint8_t i = 0; i < 3; i++) {
+        EXPECT_EQ(core->dvelBiasAxisInhibit[i], reference->dvelBiasAxisInhibit[i]);
+    }
+}
+
+/*
+  CovariancePrediction() as it was generated before the static states
+  were handled in loops
+ */
+void NavEKF3_core_Benchmark::reference_prediction(NavEKF3_core &c, Vector3F *rotVarVecPtr)
+{
+    ftype daxVar;       // X axis delta angle noise variance rad^2
+    ftype dayVar;       // Y axis delta angle noise variance rad^2
+    ftype dazVar;       // Z axis delta angle noise variance rad^2
+    ftype dvxVar;       // X axis delta velocity variance noise (m/s)^2
+    ftype dvyVar;       // Y axis delta velocity variance noise (m/s)^2
+    ftype dvzVar;       // Z axis delta velocity variance noise (m/s)^2
+    ftype dvx;          // X axis delta velocity (m/s)
+    ftype dvy;          // Y axis delta velocity (m/s)
+    ftype dvz;          // Z axis delta velocity (m/s)
+    ftype dax;          // X axis delta angle (rad)
+    ftype day;          // Y axis delta angle (rad)
+    ftype daz;          // Z axis delta angle (rad)
+    ftype q0;           // attitude quaternion
+    ftype q1;           // attitude quaternion
+    ftype q2;           // attitude quaternion
+    ftype q3;           // attitude quaternion
+    ftype dax_b;        // X axis delta angle measurement bias (rad)
+    ftype day_b;        // Y axis delta angle measurement bias (rad)
+    ftype daz_b;        // Z axis delta angle measurement bias (rad)
+    ftype dvx_b;        // X axis delta velocity measurement bias (rad)
+    ftype dvy_b;        // Y axis delta velocity measurement bias (rad)
+    ftype dvz_b;        // Z axis delta velocity measurement bias (rad)
+
+    // Calculate the time step used by the covariance prediction as an average of the gyro and accel integration period
+    // Constrain to prevent bad timing jitter causing numerical conditioning problems with the covariance prediction
+    c.dt = constrain_ftype(0.5f*(c.imuDataDelayed.delAngDT+c.imuDataDelayed.delVelDT),0.5f * c.dtEkfAvg, 2.0f * c.dtEkfAvg);
+
+    // use filtered height rate to increase wind process noise when climbing or descending
+    // this allows for wind gradient effects.Filter height rate using a 10 second time constant filter
+    ftype alpha = 0.1f * c.dt;
+    c.hgtRate = c.hgtRate * (1.0f - alpha) - c.stateStruct.velocity.z * alpha;
+
+    // calculate covariance prediction process noise added to diagonals of predicted covariance matrix
+    // error growth of first 10 kinematic states is built into auto-code for covariance prediction and driven by IMU noise parameters
+    NavEKF3_core::Vector14 processNoiseVariance = {};
+
+    if (!c.inhibitDelAngBiasStates) {
+        ftype dAngBiasVar = sq(sq(c.dt) * constrain_ftype(c.frontend->_gyroBiasProcessNoise, 0.0, 1.0));
+        for (uint8_t i=0; i<=2; i++) processNoiseVariance[i] = dAngBiasVar;
+    }
+
+    if (!c.inhibitDelVelBiasStates) {
+        // default process noise (m/s)^2
+        ftype dVelBiasVar = sq(sq(c.dt) * constrain_ftype(c.frontend->_accelBiasProcessNoise, 0.0, 1.0));
+        for (uint8_t i=3; i<=5; i++) {
+            processNoiseVariance[i] = dVelBiasVar;
+        }
+    }
+
+    if (!c.inhibitMagStates && c.lastInhibitMagStates) {
+        // when starting 3D fusion we want to reset mag variances
+        c.needMagBodyVarReset = true;
+        c.needEarthBodyVarReset = true;
+    }
+
+    if (c.needMagBodyVarReset) {
+        // reset body mag variances
+        c.needMagBodyVarReset = false;
+        c.zeroCols(c.P,19,21);
+        c.zeroRows(c.P,19,21);
+        c.P[19][19] = sq(c.frontend->_magNoise);
+        c.P[20][20] = c.P[19][19];
+        c.P[21][21] = c.P[19][19];
+    }
+
+    if (c.needEarthBodyVarReset) {
+        // reset mag earth field variances
+        c.needEarthBodyVarReset = false;
+        c.zeroCols(c.P,16,18);
+        c.zeroRows(c.P,16,18);
+        c.P[16][16] = sq(c.frontend->_magNoise);
+        c.P[17][17] = c.P[16][16];
+        c.P[18][18] = c.P[16][16];
+        // Fusing the declinaton angle as an observaton with a 20 deg uncertainty helps
+        // to stabilise the earth field.
+        c.FuseDeclination(radians(20.0f));
+    }
+
+    if (!c.inhibitMagStates) {
+        ftype magEarthVar = sq(c.dt * constrain_ftype(c.frontend->_magEarthProcessNoise, 0.0f, 1.0f));
+        ftype magBodyVar  = sq(c.dt * constrain_ftype(c.frontend->_magBodyProcessNoise, 0.0f, 1.0f));
+        for (uint8_t i=6; i<=8; i++) processNoiseVariance[i] = magEarthVar;
+        for (uint8_t i=9; i<=11; i++) processNoiseVariance[i] = magBodyVar;
+    }
+    c.lastInhibitMagStates = c.inhibitMagStates;
+
+    if (!c.inhibitWindStates) {
+        const bool isDragFusionDeadReckoning = c.filterStatus.flags.dead_reckoning && !c.dragTimeout;
+        if (isDragFusionDeadReckoning) {
+            // when dead reckoning using drag fusion stop learning wind states to provide a more stable velocity estimate
+            c.P[23][23] = c.P[22][22] = 0.0f;
+        } else {
+	        ftype windVelVar  = sq(c.dt * constrain_ftype(c.frontend->_windVelProcessNoise, 0.0f, 1.0f) * (1.0f + constrain_ftype(c.frontend->_wndVarHgtRateScale, 0.0f, 1.0f) * fabsF(c.hgtRate)));
+	        if (!c.tasDataDelayed.allowFusion) {
+	            // Allow wind states to recover faster when using sideslip fusion with a failed airspeed sesnor
+	            windVelVar *= 10.0f;
+	        }
+	        for (uint8_t i=12; i<=13; i++) processNoiseVariance[i] = windVelVar;
+        }
+    }
+
+    // set variables used to calculate covariance growth
+    dvx = c.imuDataDelayed.delVel.x;
+    dvy = c.imuDataDelayed.delVel.y;
+    dvz = c.imuDataDelayed.delVel.z;
+    dax = c.imuDataDelayed.delAng.x;
+    day = c.imuDataDelayed.delAng.y;
+    daz = c.imuDataDelayed.delAng.z;
+    q0 = c.stateStruct.quat[0];
+    q1 = c.stateStruct.quat[1];
+    q2 = c.stateStruct.quat[2];
+    q3 = c.stateStruct.quat[3];
+    dax_b = c.stateStruct.gyro_bias.x;
+    day_b = c.stateStruct.gyro_bias.y;
+    daz_b = c.stateStruct.gyro_bias.z;
+    dvx_b = c.stateStruct.accel_bias.x;
+    dvy_b = c.stateStruct.accel_bias.y;
+    dvz_b = c.stateStruct.accel_bias.z;
+
+    bool quatCovResetOnly = false;
+    if (rotVarVecPtr != nullptr) {
+        // Handle special case where we are initialising the quaternion covariances using an earth frame
+        // vector defining the variance of the angular alignment uncertainty. Convert he varaince vector
+        // to a matrix and rotate into body frame. Use the exisiting gyro error propagation mechanism to
+        // propagate the body frame angular uncertainty variances.
+        const Vector3F &rotVarVec = *rotVarVecPtr;
+        Matrix3F R_ef = Matrix3F (
+            rotVarVec.x, 0.0f, 0.0f,
+            0.0f, rotVarVec.y, 0.0f,
+            0.0f, 0.0f, rotVarVec.z);
+        Matrix3F Tnb;
+        c.stateStruct.quat.inverse().rotation_matrix(Tnb);
+        Matrix3F R_bf = Tnb * R_ef * Tnb.transposed();
+        daxVar = R_bf.a.x;
+        dayVar = R_bf.b.y;
+        dazVar = R_bf.c.z;
+        quatCovResetOnly = true;
+        c.zeroRows(c.P,0,3);
+        c.zeroCols(c.P,0,3);
+    } else {
+        ftype _gyrNoise = constrain_ftype(c.frontend->_gyrNoise, 0.0f, 1.0f);
+        daxVar = dayVar = dazVar = sq(c.dt*_gyrNoise);
+    }
+    ftype _accNoise = c.badIMUdata ? BAD_IMU_DATA_ACC_P_NSE : constrain_ftype(c.frontend->_accNoise, 0.0f, BAD_IMU_DATA_ACC_P_NSE);
+    dvxVar = dvyVar = dvzVar = sq(c.dt*_accNoise);
+
+    if (!c.inhibitDelVelBiasStates) {
+        for (uint8_t stateIndex = 13; stateIndex <= 15; stateIndex++) {
+            const uint8_t index = stateIndex - 13;
+
+            // Don't attempt learning of IMU delta velocty bias if on ground and not aligned with the gravity vector
+            const bool is_bias_observable = (fabsF(c.prevTnb[index][2]) > 0.8f) || !c.onGround;
+
+            if (!is_bias_observable && !c.dvelBiasAxisInhibit[index]) {
+                // store variances to be reinstated wben learning can commence later
+                c.dvelBiasAxisVarPrev[index] = c.P[stateIndex][stateIndex];
+                c.dvelBiasAxisInhibit[index] = true;
+            } else if (is_bias_observable && c.dvelBiasAxisInhibit[index]) {
+                c.P[stateIndex][stateIndex] = c.dvelBiasAxisVarPrev[index];
+                c.dvelBiasAxisInhibit[index] = false;
+            }
+        }
+    }
+
+    // calculate the predicted covariance due to inertial sensor error propagation
+    // we calculate the lower diagonal and copy to take advantage of symmetry
+
+    // intermediate calculations
+    const ftype PS0 = sq(q1);
+    const ftype PS1 = 0.25F*daxVar;
+    const ftype PS2 = sq(q2);
+    const ftype PS3 = 0.25F*dayVar;
+    const ftype PS4 = sq(q3);
+    const ftype PS5 = 0.25F*dazVar;
+    const ftype PS6 = 0.5F*q1;
+    const ftype PS7 = 0.5F*q2;
+    const ftype PS8 = PS7*c.P[10][11];
+    const ftype PS9 = 0.5F*q3;
+    const ftype PS10 = PS9*c.P[10][12];
+    const ftype PS11 = 0.5F*dax - 0.5F*dax_b;
+    const ftype PS12 = 0.5F*day - 0.5F*day_b;
+    const ftype PS13 = 0.5F*daz - 0.5F*daz_b;
+    const ftype PS14 = PS10 - PS11*c.P[1][10] - PS12*c.P[2][10] - PS13*c.P[3][10] + PS6*c.P[10][10] + PS8 + c.P[0][10];
+    const ftype PS15 = PS6*c.P[10][11];
+    const ftype PS16 = PS9*c.P[11][12];
+    const ftype PS17 = -PS11*c.P[1][11] - PS12*c.P[2][11] - PS13*c.P[3][11] + PS15 + PS16 + PS7*c.P[11][11] + c.P[0][11];
+    const ftype PS18 = PS6*c.P[10][12];
+    const ftype PS19 = PS7*c.P[11][12];
+    const ftype PS20 = -PS11*c.P[1][12] - PS12*c.P[2][12] - PS13*c.P[3][12] + PS18 + PS19 + PS9*c.P[12][12] + c.P[0][12];
+    const ftype PS21 = PS12*c.P[1][2];
+    const ftype PS22 = -PS13*c.P[1][3];
+    const ftype PS23 = -PS11*c.P[1][1] - PS21 + PS22 + PS6*c.P[1][10] + PS7*c.P[1][11] + PS9*c.P[1][12] + c.P[0][1];
+    const ftype PS24 = -PS11*c.P[1][2];
+    const ftype PS25 = PS13*c.P[2][3];
+    const ftype PS26 = -PS12*c.P[2][2] + PS24 - PS25 + PS6*c.P[2][10] + PS7*c.P[2][11] + PS9*c.P[2][12] + c.P[0][2];
+    const ftype PS27 = PS11*c.P[1][3];
+    const ftype PS28 = -PS12*c.P[2][3];
+    const ftype PS29 = -PS13*c.P[3][3] - PS27 + PS28 + PS6*c.P[3][10] + PS7*c.P[3][11] + PS9*c.P[3][12] + c.P[0][3];
+    const ftype PS30 = PS11*c.P[0][1];
+    const ftype PS31 = PS12*c.P[0][2];
+    const ftype PS32 = PS13*c.P[0][3];
+    const ftype PS33 = -PS30 - PS31 - PS32 + PS6*c.P[0][10] + PS7*c.P[0][11] + PS9*c.P[0][12] + c.P[0][0];
+    const ftype PS34 = 0.5F*q0;
+    const ftype PS35 = q2*q3;
+    const ftype PS36 = q0*q1;
+    const ftype PS37 = q1*q3;
+    const ftype PS38 = q0*q2;
+    const ftype PS39 = q1*q2;
+    const ftype PS40 = q0*q3;
+    const ftype PS41 = 2*PS2;
+    const ftype PS42 = 2*PS4 - 1;
+    const ftype PS43 = PS41 + PS42;
+    const ftype PS44 = -PS11*c.P[1][13] - PS12*c.P[2][13] - PS13*c.P[3][13] + PS6*c.P[10][13] + PS7*c.P[11][13] + PS9*c.P[12][13] + c.P[0][13];
+    const ftype PS45 = PS37 + PS38;
+    const ftype PS46 = -PS11*c.P[1][15] - PS12*c.P[2][15] - PS13*c.P[3][15] + PS6*c.P[10][15] + PS7*c.P[11][15] + PS9*c.P[12][15] + c.P[0][15];
+    const ftype PS47 = 2*PS46;
+    const ftype PS48 = dvy - dvy_b;
+    const ftype PS49 = PS48*q0;
+    const ftype PS50 = dvz - dvz_b;
+    const ftype PS51 = PS50*q1;
+    const ftype PS52 = dvx - dvx_b;
+    const ftype PS53 = PS52*q3;
+    const ftype PS54 = PS49 - PS51 + 2*PS53;
+    const ftype PS55 = 2*PS29;
+    const ftype PS56 = -PS39 + PS40;
+    const ftype PS57 = -PS11*c.P[1][14] - PS12*c.P[2][14] - PS13*c.P[3][14] + PS6*c.P[10][14] + PS7*c.P[11][14] + PS9*c.P[12][14] + c.P[0][14];
+    const ftype PS58 = 2*PS57;
+    const ftype PS59 = PS48*q2;
+    const ftype PS60 = PS50*q3;
+    const ftype PS61 = PS59 + PS60;
+    const ftype PS62 = 2*PS23;
+    const ftype PS63 = PS50*q2;
+    const ftype PS64 = PS48*q3;
+    const ftype PS65 = -PS64;
+    const ftype PS66 = PS63 + PS65;
+    const ftype PS67 = 2*PS33;
+    const ftype PS68 = PS50*q0;
+    const ftype PS69 = PS48*q1;
+    const ftype PS70 = PS52*q2;
+    const ftype PS71 = PS68 + PS69 - 2*PS70;
+    const ftype PS72 = 2*PS26;
+    const ftype PS73 = -PS11*c.P[1][4] - PS12*c.P[2][4] - PS13*c.P[3][4] + PS6*c.P[4][10] + PS7*c.P[4][11] + PS9*c.P[4][12] + c.P[0][4];
+    const ftype PS74 = 2*PS0;
+    const ftype PS75 = PS42 + PS74;
+    const ftype PS76 = PS39 + PS40;
+    const ftype PS77 = 2*PS44;
+    const ftype PS78 = PS51 - PS53;
+    const ftype PS79 = -PS70;
+    const ftype PS80 = PS68 + 2*PS69 + PS79;
+    const ftype PS81 = -PS35 + PS36;
+    const ftype PS82 = PS52*q1;
+    const ftype PS83 = PS60 + PS82;
+    const ftype PS84 = PS52*q0;
+    const ftype PS85 = PS63 - 2*PS64 + PS84;
+    const ftype PS86 = -PS11*c.P[1][5] - PS12*c.P[2][5] - PS13*c.P[3][5] + PS6*c.P[5][10] + PS7*c.P[5][11] + PS9*c.P[5][12] + c.P[0][5];
+    const ftype PS87 = PS41 + PS74 - 1;
+    const ftype PS88 = PS35 + PS36;
+    const ftype PS89 = 2*PS63 + PS65 + PS84;
+    const ftype PS90 = -PS37 + PS38;
+    const ftype PS91 = PS59 + PS82;
+    const ftype PS92 = PS69 + PS79;
+    const ftype PS93 = PS49 - 2*PS51 + PS53;
+    const ftype PS94 = -PS11*c.P[1][6] - PS12*c.P[2][6] - PS13*c.P[3][6] + PS6*c.P[6][10] + PS7*c.P[6][11] + PS9*c.P[6][12] + c.P[0][6];
+    const ftype PS95 = sq(q0);
+    const ftype PS96 = -PS34*c.P[10][11];
+    const ftype PS97 = PS11*c.P[0][11] - PS12*c.P[3][11] + PS13*c.P[2][11] - PS19 + PS9*c.P[11][11] + PS96 + c.P[1][11];
+    const ftype PS98 = PS13*c.P[0][2];
+    const ftype PS99 = PS12*c.P[0][3];
+    const ftype PS100 = PS11*c.P[0][0] - PS34*c.P[0][10] - PS7*c.P[0][12] + PS9*c.P[0][11] + PS98 - PS99 + c.P[0][1];
+    const ftype PS101 = PS11*c.P[0][2];
+    const ftype PS102 = PS101 + PS13*c.P[2][2] + PS28 - PS34*c.P[2][10] - PS7*c.P[2][12] + PS9*c.P[2][11] + c.P[1][2];
+    const ftype PS103 = PS9*c.P[10][11];
+    const ftype PS104 = PS7*c.P[10][12];
+    const ftype PS105 = PS103 - PS104 + PS11*c.P[0][10] - PS12*c.P[3][10] + PS13*c.P[2][10] - PS34*c.P[10][10] + c.P[1][10];
+    const ftype PS106 = -PS34*c.P[10][12];
+    const ftype PS107 = PS106 + PS11*c.P[0][12] - PS12*c.P[3][12] + PS13*c.P[2][12] + PS16 - PS7*c.P[12][12] + c.P[1][12];
+    const ftype PS108 = PS11*c.P[0][3];
+    const ftype PS109 = PS108 - PS12*c.P[3][3] + PS25 - PS34*c.P[3][10] - PS7*c.P[3][12] + PS9*c.P[3][11] + c.P[1][3];
+    const ftype PS110 = PS13*c.P[1][2];
+    const ftype PS111 = PS12*c.P[1][3];
+    const ftype PS112 = PS110 - PS111 + PS30 - PS34*c.P[1][10] - PS7*c.P[1][12] + PS9*c.P[1][11] + c.P[1][1];
+    const ftype PS113 = PS11*c.P[0][13] - PS12*c.P[3][13] + PS13*c.P[2][13] - PS34*c.P[10][13] - PS7*c.P[12][13] + PS9*c.P[11][13] + c.P[1][13];
+    const ftype PS114 = PS11*c.P[0][15] - PS12*c.P[3][15] + PS13*c.P[2][15] - PS34*c.P[10][15] - PS7*c.P[12][15] + PS9*c.P[11][15] + c.P[1][15];
+    const ftype PS115 = 2*PS114;
+    const ftype PS116 = 2*PS109;
+    const ftype PS117 = PS11*c.P[0][14] - PS12*c.P[3][14] + PS13*c.P[2][14] - PS34*c.P[10][14] - PS7*c.P[12][14] + PS9*c.P[11][14] + c.P[1][14];
+    const ftype PS118 = 2*PS117;
+    const ftype PS119 = 2*PS112;
+    const ftype PS120 = 2*PS100;
+    const ftype PS121 = 2*PS102;
+    const ftype PS122 = PS11*c.P[0][4] - PS12*c.P[3][4] + PS13*c.P[2][4] - PS34*c.P[4][10] - PS7*c.P[4][12] + PS9*c.P[4][11] + c.P[1][4];
+    const ftype PS123 = 2*PS113;
+    const ftype PS124 = PS11*c.P[0][5] - PS12*c.P[3][5] + PS13*c.P[2][5] - PS34*c.P[5][10] - PS7*c.P[5][12] + PS9*c.P[5][11] + c.P[1][5];
+    const ftype PS125 = PS11*c.P[0][6] - PS12*c.P[3][6] + PS13*c.P[2][6] - PS34*c.P[6][10] - PS7*c.P[6][12] + PS9*c.P[6][11] + c.P[1][6];
+    const ftype PS126 = -PS34*c.P[11][12];
+    const ftype PS127 = -PS10 + PS11*c.P[3][12] + PS12*c.P[0][12] + PS126 - PS13*c.P[1][12] + PS6*c.P[12][12] + c.P[2][12];
+    const ftype PS128 = PS11*c.P[3][3] + PS22 - PS34*c.P[3][11] + PS6*c.P[3][12] - PS9*c.P[3][10] + PS99 + c.P[2][3];
+    const ftype PS129 = PS13*c.P[0][1];
+    const ftype PS130 = PS108 + PS12*c.P[0][0] - PS129 - PS34*c.P[0][11] + PS6*c.P[0][12] - PS9*c.P[0][10] + c.P[0][2];
+    const ftype PS131 = PS6*c.P[11][12];
+    const ftype PS132 = -PS103 + PS11*c.P[3][11] + PS12*c.P[0][11] - PS13*c.P[1][11] + PS131 - PS34*c.P[11][11] + c.P[2][11];
+    const ftype PS133 = PS11*c.P[3][10] + PS12*c.P[0][10] - PS13*c.P[1][10] + PS18 - PS9*c.P[10][10] + PS96 + c.P[2][10];
+    const ftype PS134 = PS12*c.P[0][1];
+    const ftype PS135 = -PS13*c.P[1][1] + PS134 + PS27 - PS34*c.P[1][11] + PS6*c.P[1][12] - PS9*c.P[1][10] + c.P[1][2];
+    const ftype PS136 = PS11*c.P[2][3];
+    const ftype PS137 = -PS110 + PS136 + PS31 - PS34*c.P[2][11] + PS6*c.P[2][12] - PS9*c.P[2][10] + c.P[2][2];
+    const ftype PS138 = PS11*c.P[3][13] + PS12*c.P[0][13] - PS13*c.P[1][13] - PS34*c.P[11][13] + PS6*c.P[12][13] - PS9*c.P[10][13] + c.P[2][13];
+    const ftype PS139 = PS11*c.P[3][15] + PS12*c.P[0][15] - PS13*c.P[1][15] - PS34*c.P[11][15] + PS6*c.P[12][15] - PS9*c.P[10][15] + c.P[2][15];
+    const ftype PS140 = 2*PS139;
+    const ftype PS141 = 2*PS128;
+    const ftype PS142 = PS11*c.P[3][14] + PS12*c.P[0][14] - PS13*c.P[1][14] - PS34*c.P[11][14] + PS6*c.P[12][14] - PS9*c.P[10][14] + c.P[2][14];
+    const ftype PS143 = 2*PS142;
+    const ftype PS144 = 2*PS135;
+    const ftype PS145 = 2*PS130;
+    const ftype PS146 = 2*PS137;
+    const ftype PS147 = PS11*c.P[3][4] + PS12*c.P[0][4] - PS13*c.P[1][4] - PS34*c.P[4][11] + PS6*c.P[4][12] - PS9*c.P[4][10] + c.P[2][4];
+    const ftype PS148 = 2*PS138;
+    const ftype PS149 = PS11*c.P[3][5] + PS12*c.P[0][5] - PS13*c.P[1][5] - PS34*c.P[5][11] + PS6*c.P[5][12] - PS9*c.P[5][10] + c.P[2][5];
+    const ftype PS150 = PS11*c.P[3][6] + PS12*c.P[0][6] - PS13*c.P[1][6] - PS34*c.P[6][11] + PS6*c.P[6][12] - PS9*c.P[6][10] + c.P[2][6];
+    const ftype PS151 = PS106 - PS11*c.P[2][10] + PS12*c.P[1][10] + PS13*c.P[0][10] - PS15 + PS7*c.P[10][10] + c.P[3][10];
+    const ftype PS152 = PS12*c.P[1][1] + PS129 + PS24 - PS34*c.P[1][12] - PS6*c.P[1][11] + PS7*c.P[1][10] + c.P[1][3];
+    const ftype PS153 = -PS101 + PS13*c.P[0][0] + PS134 - PS34*c.P[0][12] - PS6*c.P[0][11] + PS7*c.P[0][10] + c.P[0][3];
+    const ftype PS154 = PS104 - PS11*c.P[2][12] + PS12*c.P[1][12] + PS13*c.P[0][12] - PS131 - PS34*c.P[12][12] + c.P[3][12];
+    const ftype PS155 = -PS11*c.P[2][11] + PS12*c.P[1][11] + PS126 + PS13*c.P[0][11] - PS6*c.P[11][11] + PS8 + c.P[3][11];
+    const ftype PS156 = -PS11*c.P[2][2] + PS21 - PS34*c.P[2][12] - PS6*c.P[2][11] + PS7*c.P[2][10] + PS98 + c.P[2][3];
+    const ftype PS157 = PS111 - PS136 + PS32 - PS34*c.P[3][12] - PS6*c.P[3][11] + PS7*c.P[3][10] + c.P[3][3];
+    const ftype PS158 = -PS11*c.P[2][13] + PS12*c.P[1][13] + PS13*c.P[0][13] - PS34*c.P[12][13] - PS6*c.P[11][13] + PS7*c.P[10][13] + c.P[3][13];
+    const ftype PS159 = -PS11*c.P[2][15] + PS12*c.P[1][15] + PS13*c.P[0][15] - PS34*c.P[12][15] - PS6*c.P[11][15] + PS7*c.P[10][15] + c.P[3][15];
+    const ftype PS160 = 2*PS159;
+    const ftype PS161 = 2*PS157;
+    const ftype PS162 = -PS11*c.P[2][14] + PS12*c.P[1][14] + PS13*c.P[0][14] - PS34*c.P[12][14] - PS6*c.P[11][14] + PS7*c.P[10][14] + c.P[3][14];
+    const ftype PS163 = 2*PS162;
+    const ftype PS164 = 2*PS152;
+    const ftype PS165 = 2*PS153;
+    const ftype PS166 = 2*PS156;
+    const ftype PS167 = -PS11*c.P[2][4] + PS12*c.P[1][4] + PS13*c.P[0][4] - PS34*c.P[4][12] - PS6*c.P[4][11] + PS7*c.P[4][10] + c.P[3][4];
+    const ftype PS168 = 2*PS158;
+    const ftype PS169 = -PS11*c.P[2][5] + PS12*c.P[1][5] + PS13*c.P[0][5] - PS34*c.P[5][12] - PS6*c.P[5][11] + PS7*c.P[5][10] + c.P[3][5];
+    const ftype PS170 = -PS11*c.P[2][6] + PS12*c.P[1][6] + PS13*c.P[0][6] - PS34*c.P[6][12] - PS6*c.P[6][11] + PS7*c.P[6][10] + c.P[3][6];
+    const ftype PS171 = 2*PS45;
+    const ftype PS172 = 2*PS56;
+    const ftype PS173 = 2*PS61;
+    const ftype PS174 = 2*PS66;
+    const ftype PS175 = 2*PS71;
+    const ftype PS176 = 2*PS54;
+    const ftype PS177 = -PS171*c.P[13][15] + PS172*c.P[13][14] + PS173*c.P[1][13] + PS174*c.P[0][13] + PS175*c.P[2][13] - PS176*c.P[3][13] + PS43*c.P[13][13] + c.P[4][13];
+    const ftype PS178 = -PS171*c.P[15][15] + PS172*c.P[14][15] + PS173*c.P[1][15] + PS174*c.P[0][15] + PS175*c.P[2][15] - PS176*c.P[3][15] + PS43*c.P[13][15] + c.P[4][15];
+    const ftype PS179 = -PS171*c.P[3][15] + PS172*c.P[3][14] + PS173*c.P[1][3] + PS174*c.P[0][3] + PS175*c.P[2][3] - PS176*c.P[3][3] + PS43*c.P[3][13] + c.P[3][4];
+    const ftype PS180 = -PS171*c.P[14][15] + PS172*c.P[14][14] + PS173*c.P[1][14] + PS174*c.P[0][14] + PS175*c.P[2][14] - PS176*c.P[3][14] + PS43*c.P[13][14] + c.P[4][14];
+    const ftype PS181 = -PS171*c.P[1][15] + PS172*c.P[1][14] + PS173*c.P[1][1] + PS174*c.P[0][1] + PS175*c.P[1][2] - PS176*c.P[1][3] + PS43*c.P[1][13] + c.P[1][4];
+    const ftype PS182 = -PS171*c.P[0][15] + PS172*c.P[0][14] + PS173*c.P[0][1] + PS174*c.P[0][0] + PS175*c.P[0][2] - PS176*c.P[0][3] + PS43*c.P[0][13] + c.P[0][4];
+    const ftype PS183 = -PS171*c.P[2][15] + PS172*c.P[2][14] + PS173*c.P[1][2] + PS174*c.P[0][2] + PS175*c.P[2][2] - PS176*c.P[2][3] + PS43*c.P[2][13] + c.P[2][4];
+    const ftype PS184 = 4*dvyVar;
+    const ftype PS185 = 4*dvzVar;
+    const ftype PS186 = -PS171*c.P[4][15] + PS172*c.P[4][14] + PS173*c.P[1][4] + PS174*c.P[0][4] + PS175*c.P[2][4] - PS176*c.P[3][4] + PS43*c.P[4][13] + c.P[4][4];
+    const ftype PS187 = 2*PS177;
+    const ftype PS188 = 2*PS182;
+    const ftype PS189 = 2*PS181;
+    const ftype PS190 = 2*PS81;
+    const ftype PS191 = 2*PS183;
+    const ftype PS192 = 2*PS179;
+    const ftype PS193 = 2*PS76;
+    const ftype PS194 = PS43*dvxVar;
+    const ftype PS195 = PS75*dvyVar;
+    const ftype PS196 = -PS171*c.P[5][15] + PS172*c.P[5][14] + PS173*c.P[1][5] + PS174*c.P[0][5] + PS175*c.P[2][5] - PS176*c.P[3][5] + PS43*c.P[5][13] + c.P[4][5];
+    const ftype PS197 = 2*PS88;
+    const ftype PS198 = PS87*dvzVar;
+    const ftype PS199 = 2*PS90;
+    const ftype PS200 = -PS171*c.P[6][15] + PS172*c.P[6][14] + PS173*c.P[1][6] + PS174*c.P[0][6] + PS175*c.P[2][6] - PS176*c.P[3][6] + PS43*c.P[6][13] + c.P[4][6];
+    const ftype PS201 = 2*PS83;
+    const ftype PS202 = 2*PS78;
+    const ftype PS203 = 2*PS85;
+    const ftype PS204 = 2*PS80;
+    const ftype PS205 = PS190*c.P[14][15] - PS193*c.P[13][14] + PS201*c.P[2][14] - PS202*c.P[0][14] + PS203*c.P[3][14] - PS204*c.P[1][14] + PS75*c.P[14][14] + c.P[5][14];
+    const ftype PS206 = PS190*c.P[13][15] - PS193*c.P[13][13] + PS201*c.P[2][13] - PS202*c.P[0][13] + PS203*c.P[3][13] - PS204*c.P[1][13] + PS75*c.P[13][14] + c.P[5][13];
+    const ftype PS207 = PS190*c.P[0][15] - PS193*c.P[0][13] + PS201*c.P[0][2] - PS202*c.P[0][0] + PS203*c.P[0][3] - PS204*c.P[0][1] + PS75*c.P[0][14] + c.P[0][5];
+    const ftype PS208 = PS190*c.P[1][15] - PS193*c.P[1][13] + PS201*c.P[1][2] - PS202*c.P[0][1] + PS203*c.P[1][3] - PS204*c.P[1][1] + PS75*c.P[1][14] + c.P[1][5];
+    const ftype PS209 = PS190*c.P[15][15] - PS193*c.P[13][15] + PS201*c.P[2][15] - PS202*c.P[0][15] + PS203*c.P[3][15] - PS204*c.P[1][15] + PS75*c.P[14][15] + c.P[5][15];
+    const ftype PS210 = PS190*c.P[2][15] - PS193*c.P[2][13] + PS201*c.P[2][2] - PS202*c.P[0][2] + PS203*c.P[2][3] - PS204*c.P[1][2] + PS75*c.P[2][14] + c.P[2][5];
+    const ftype PS211 = PS190*c.P[3][15] - PS193*c.P[3][13] + PS201*c.P[2][3] - PS202*c.P[0][3] + PS203*c.P[3][3] - PS204*c.P[1][3] + PS75*c.P[3][14] + c.P[3][5];
+    const ftype PS212 = 4*dvxVar;
+    const ftype PS213 = PS190*c.P[5][15] - PS193*c.P[5][13] + PS201*c.P[2][5] - PS202*c.P[0][5] + PS203*c.P[3][5] - PS204*c.P[1][5] + PS75*c.P[5][14] + c.P[5][5];
+    const ftype PS214 = 2*PS89;
+    const ftype PS215 = 2*PS91;
+    const ftype PS216 = 2*PS92;
+    const ftype PS217 = 2*PS93;
+    const ftype PS218 = PS190*c.P[6][15] - PS193*c.P[6][13] + PS201*c.P[2][6] - PS202*c.P[0][6] + PS203*c.P[3][6] - PS204*c.P[1][6] + PS75*c.P[6][14] + c.P[5][6];
+    const ftype PS219 = -PS197*c.P[14][15] + PS199*c.P[13][15] - PS214*c.P[2][15] + PS215*c.P[3][15] + PS216*c.P[0][15] + PS217*c.P[1][15] + PS87*c.P[15][15] + c.P[6][15];
+    const ftype PS220 = -PS197*c.P[14][14] + PS199*c.P[13][14] - PS214*c.P[2][14] + PS215*c.P[3][14] + PS216*c.P[0][14] + PS217*c.P[1][14] + PS87*c.P[14][15] + c.P[6][14];
+    const ftype PS221 = -PS197*c.P[13][14] + PS199*c.P[13][13] - PS214*c.P[2][13] + PS215*c.P[3][13] + PS216*c.P[0][13] + PS217*c.P[1][13] + PS87*c.P[13][15] + c.P[6][13];
+    const ftype PS222 = -PS197*c.P[6][14] + PS199*c.P[6][13] - PS214*c.P[2][6] + PS215*c.P[3][6] + PS216*c.P[0][6] + PS217*c.P[1][6] + PS87*c.P[6][15] + c.P[6][6];
+
+    c.nextP[0][0] = PS0*PS1 - PS11*PS23 - PS12*PS26 - PS13*PS29 + PS14*PS6 + PS17*PS7 + PS2*PS3 + PS20*PS9 + PS33 + PS4*PS5;
+    c.nextP[0][1] = -PS1*PS36 + PS11*PS33 - PS12*PS29 + PS13*PS26 - PS14*PS34 + PS17*PS9 - PS20*PS7 + PS23 + PS3*PS35 - PS35*PS5;
+    c.nextP[1][1] = PS1*PS95 + PS100*PS11 + PS102*PS13 - PS105*PS34 - PS107*PS7 - PS109*PS12 + PS112 + PS2*PS5 + PS3*PS4 + PS9*PS97;
+    c.nextP[0][2] = -PS1*PS37 + PS11*PS29 + PS12*PS33 - PS13*PS23 - PS14*PS9 - PS17*PS34 + PS20*PS6 + PS26 - PS3*PS38 + PS37*PS5;
+    c.nextP[1][2] = PS1*PS40 + PS100*PS12 + PS102 - PS105*PS9 + PS107*PS6 + PS109*PS11 - PS112*PS13 - PS3*PS40 - PS34*PS97 - PS39*PS5;
+    c.nextP[2][2] = PS0*PS5 + PS1*PS4 + PS11*PS128 + PS12*PS130 + PS127*PS6 - PS13*PS135 - PS132*PS34 - PS133*PS9 + PS137 + PS3*PS95;
+    c.nextP[0][3] = PS1*PS39 - PS11*PS26 + PS12*PS23 + PS13*PS33 + PS14*PS7 - PS17*PS6 - PS20*PS34 + PS29 - PS3*PS39 - PS40*PS5;
+    c.nextP[1][3] = -PS1*PS38 + PS100*PS13 - PS102*PS11 + PS105*PS7 - PS107*PS34 + PS109 + PS112*PS12 - PS3*PS37 + PS38*PS5 - PS6*PS97;
+    c.nextP[2][3] = -PS1*PS35 - PS11*PS137 + PS12*PS135 - PS127*PS34 + PS128 + PS13*PS130 - PS132*PS6 + PS133*PS7 + PS3*PS36 - PS36*PS5;
+    c.nextP[3][3] = PS0*PS3 + PS1*PS2 - PS11*PS156 + PS12*PS152 + PS13*PS153 + PS151*PS7 - PS154*PS34 - PS155*PS6 + PS157 + PS5*PS95;
+
+    if (quatCovResetOnly) {
+        // covariance matrix is symmetrical, so copy diagonals and copy lower half in nextP
+        // to lower and upper half in P
+        for (uint8_t row = 0; row <= 3; row++) {
+            // copy diagonals
+            c.P[row][row] = constrain_ftype(c.nextP[row][row], 0.0f, 1.0f);
+            // copy off diagonals
+            for (uint8_t column = 0 ; column < row; column++) {
+                c.P[row][column] = c.P[column][row] = c.nextP[column][row];
+            }
+        }
+        c.calcTiltErrorVariance();
+        return;
+    }
+
+    c.nextP[0][4] = PS43*PS44 - PS45*PS47 - PS54*PS55 + PS56*PS58 + PS61*PS62 + PS66*PS67 + PS71*PS72 + PS73;
+    c.nextP[1][4] = PS113*PS43 - PS115*PS45 - PS116*PS54 + PS118*PS56 + PS119*PS61 + PS120*PS66 + PS121*PS71 + PS122;
+    c.nextP[2][4] = PS138*PS43 - PS140*PS45 - PS141*PS54 + PS143*PS56 + PS144*PS61 + PS145*PS66 + PS146*PS71 + PS147;
+    c.nextP[3][4] = PS158*PS43 - PS160*PS45 - PS161*PS54 + PS163*PS56 + PS164*PS61 + PS165*PS66 + PS166*PS71 + PS167;
+    c.nextP[4][4] = -PS171*PS178 + PS172*PS180 + PS173*PS181 + PS174*PS182 + PS175*PS183 - PS176*PS179 + PS177*PS43 + PS184*sq(PS56) + PS185*sq(PS45) + PS186 + sq(PS43)*dvxVar;
+    c.nextP[0][5] = PS47*PS81 + PS55*PS85 + PS57*PS75 - PS62*PS80 - PS67*PS78 + PS72*PS83 - PS76*PS77 + PS86;
+    c.nextP[1][5] = PS115*PS81 + PS116*PS85 + PS117*PS75 - PS119*PS80 - PS120*PS78 + PS121*PS83 - PS123*PS76 + PS124;
+    c.nextP[2][5] = PS140*PS81 + PS141*PS85 + PS142*PS75 - PS144*PS80 - PS145*PS78 + PS146*PS83 - PS148*PS76 + PS149;
+    c.nextP[3][5] = PS160*PS81 + PS161*PS85 + PS162*PS75 - PS164*PS80 - PS165*PS78 + PS166*PS83 - PS168*PS76 + PS169;
+    c.nextP[4][5] = PS172*PS195 + PS178*PS190 + PS180*PS75 - PS185*PS45*PS81 - PS187*PS76 - PS188*PS78 - PS189*PS80 + PS191*PS83 + PS192*PS85 - PS193*PS194 + PS196;
+    c.nextP[5][5] = PS185*sq(PS81) + PS190*PS209 - PS193*PS206 + PS201*PS210 - PS202*PS207 + PS203*PS211 - PS204*PS208 + PS205*PS75 + PS212*sq(PS76) + PS213 + sq(PS75)*dvyVar;
+    c.nextP[0][6] = PS46*PS87 + PS55*PS91 - PS58*PS88 + PS62*PS93 + PS67*PS92 - PS72*PS89 + PS77*PS90 + PS94;
+    c.nextP[1][6] = PS114*PS87 + PS116*PS91 - PS118*PS88 + PS119*PS93 + PS120*PS92 - PS121*PS89 + PS123*PS90 + PS125;
+    c.nextP[2][6] = PS139*PS87 + PS141*PS91 - PS143*PS88 + PS144*PS93 + PS145*PS92 - PS146*PS89 + PS148*PS90 + PS150;
+    c.nextP[3][6] = PS159*PS87 + PS161*PS91 - PS163*PS88 + PS164*PS93 + PS165*PS92 - PS166*PS89 + PS168*PS90 + PS170;
+    c.nextP[4][6] = -PS171*PS198 + PS178*PS87 - PS180*PS197 - PS184*PS56*PS88 + PS187*PS90 + PS188*PS92 + PS189*PS93 - PS191*PS89 + PS192*PS91 + PS194*PS199 + PS200;
+    c.nextP[5][6] = PS190*PS198 - PS195*PS197 - PS197*PS205 + PS199*PS206 + PS207*PS216 + PS208*PS217 + PS209*PS87 - PS210*PS214 + PS211*PS215 - PS212*PS76*PS90 + PS218;
+    c.nextP[6][6] = PS184*sq(PS88) - PS197*PS220 + PS199*PS221 + PS212*sq(PS90) - PS214*(-PS197*c.P[2][14] + PS199*c.P[2][13] - PS214*c.P[2][2] + PS215*c.P[2][3] + PS216*c.P[0][2] + PS217*c.P[1][2] + PS87*c.P[2][15] + c.P[2][6]) + PS215*(-PS197*c.P[3][14] + PS199*c.P[3][13] - PS214*c.P[2][3] + PS215*c.P[3][3] + PS216*c.P[0][3] + PS217*c.P[1][3] + PS87*c.P[3][15] + c.P[3][6]) + PS216*(-PS197*c.P[0][14] + PS199*c.P[0][13] - PS214*c.P[0][2] + PS215*c.P[0][3] + PS216*c.P[0][0] + PS217*c.P[0][1] + PS87*c.P[0][15] + c.P[0][6]) + PS217*(-PS197*c.P[1][14] + PS199*c.P[1][13] - PS214*c.P[1][2] + PS215*c.P[1][3] + PS216*c.P[0][1] + PS217*c.P[1][1] + PS87*c.P[1][15] + c.P[1][6]) + PS219*PS87 + PS222 + sq(PS87)*dvzVar;
+    c.nextP[0][7] = -PS11*c.P[1][7] - PS12*c.P[2][7] - PS13*c.P[3][7] + PS6*c.P[7][10] + PS7*c.P[7][11] + PS73*c.dt + PS9*c.P[7][12] + c.P[0][7];
+    c.nextP[1][7] = PS11*c.P[0][7] - PS12*c.P[3][7] + PS122*c.dt + PS13*c.P[2][7] - PS34*c.P[7][10] - PS7*c.P[7][12] + PS9*c.P[7][11] + c.P[1][7];
+    c.nextP[2][7] = PS11*c.P[3][7] + PS12*c.P[0][7] - PS13*c.P[1][7] + PS147*c.dt - PS34*c.P[7][11] + PS6*c.P[7][12] - PS9*c.P[7][10] + c.P[2][7];
+    c.nextP[3][7] = -PS11*c.P[2][7] + PS12*c.P[1][7] + PS13*c.P[0][7] + PS167*c.dt - PS34*c.P[7][12] - PS6*c.P[7][11] + PS7*c.P[7][10] + c.P[3][7];
+    c.nextP[4][7] = -PS171*c.P[7][15] + PS172*c.P[7][14] + PS173*c.P[1][7] + PS174*c.P[0][7] + PS175*c.P[2][7] - PS176*c.P[3][7] + PS186*c.dt + PS43*c.P[7][13] + c.P[4][7];
+    c.nextP[5][7] = PS190*c.P[7][15] - PS193*c.P[7][13] + PS201*c.P[2][7] - PS202*c.P[0][7] + PS203*c.P[3][7] - PS204*c.P[1][7] + PS75*c.P[7][14] + c.P[5][7] + c.dt*(PS190*c.P[4][15] - PS193*c.P[4][13] + PS201*c.P[2][4] - PS202*c.P[0][4] + PS203*c.P[3][4] - PS204*c.P[1][4] + PS75*c.P[4][14] + c.P[4][5]);
+    c.nextP[6][7] = -PS197*c.P[7][14] + PS199*c.P[7][13] - PS214*c.P[2][7] + PS215*c.P[3][7] + PS216*c.P[0][7] + PS217*c.P[1][7] + PS87*c.P[7][15] + c.P[6][7] + c.dt*(-PS197*c.P[4][14] + PS199*c.P[4][13] - PS214*c.P[2][4] + PS215*c.P[3][4] + PS216*c.P[0][4] + PS217*c.P[1][4] + PS87*c.P[4][15] + c.P[4][6]);
+    c.nextP[7][7] = c.P[4][7]*c.dt + c.P[7][7] + c.dt*(c.P[4][4]*c.dt + c.P[4][7]);
+    c.nextP[0][8] = -PS11*c.P[1][8] - PS12*c.P[2][8] - PS13*c.P[3][8] + PS6*c.P[8][10] + PS7*c.P[8][11] + PS86*c.dt + PS9*c.P[8][12] + c.P[0][8];
+    c.nextP[1][8] = PS11*c.P[0][8] - PS12*c.P[3][8] + PS124*c.dt + PS13*c.P[2][8] - PS34*c.P[8][10] - PS7*c.P[8][12] + PS9*c.P[8][11] + c.P[1][8];
+    c.nextP[2][8] = PS11*c.P[3][8] + PS12*c.P[0][8] - PS13*c.P[1][8] + PS149*c.dt - PS34*c.P[8][11] + PS6*c.P[8][12] - PS9*c.P[8][10] + c.P[2][8];
+    c.nextP[3][8] = -PS11*c.P[2][8] + PS12*c.P[1][8] + PS13*c.P[0][8] + PS169*c.dt - PS34*c.P[8][12] - PS6*c.P[8][11] + PS7*c.P[8][10] + c.P[3][8];
+    c.nextP[4][8] = -PS171*c.P[8][15] + PS172*c.P[8][14] + PS173*c.P[1][8] + PS174*c.P[0][8] + PS175*c.P[2][8] - PS176*c.P[3][8] + PS196*c.dt + PS43*c.P[8][13] + c.P[4][8];
+    c.nextP[5][8] = PS190*c.P[8][15] - PS193*c.P[8][13] + PS201*c.P[2][8] - PS202*c.P[0][8] + PS203*c.P[3][8] - PS204*c.P[1][8] + PS213*c.dt + PS75*c.P[8][14] + c.P[5][8];
+    c.nextP[6][8] = -PS197*c.P[8][14] + PS199*c.P[8][13] - PS214*c.P[2][8] + PS215*c.P[3][8] + PS216*c.P[0][8] + PS217*c.P[1][8] + PS87*c.P[8][15] + c.P[6][8] + c.dt*(-PS197*c.P[5][14] + PS199*c.P[5][13] - PS214*c.P[2][5] + PS215*c.P[3][5] + PS216*c.P[0][5] + PS217*c.P[1][5] + PS87*c.P[5][15] + c.P[5][6]);
+    c.nextP[7][8] = c.P[4][8]*c.dt + c.P[7][8] + c.dt*(c.P[4][5]*c.dt + c.P[5][7]);
+    c.nextP[8][8] = c.P[5][8]*c.dt + c.P[8][8] + c.dt*(c.P[5][5]*c.dt + c.P[5][8]);
+    c.nextP[0][9] = -PS11*c.P[1][9] - PS12*c.P[2][9] - PS13*c.P[3][9] + PS6*c.P[9][10] + PS7*c.P[9][11] + PS9*c.P[9][12] + PS94*c.dt + c.P[0][9];
+    c.nextP[1][9] = PS11*c.P[0][9] - PS12*c.P[3][9] + PS125*c.dt + PS13*c.P[2][9] - PS34*c.P[9][10] - PS7*c.P[9][12] + PS9*c.P[9][11] + c.P[1][9];
+    c.nextP[2][9] = PS11*c.P[3][9] + PS12*c.P[0][9] - PS13*c.P[1][9] + PS150*c.dt - PS34*c.P[9][11] + PS6*c.P[9][12] - PS9*c.P[9][10] + c.P[2][9];
+    c.nextP[3][9] = -PS11*c.P[2][9] + PS12*c.P[1][9] + PS13*c.P[0][9] + PS170*c.dt - PS34*c.P[9][12] - PS6*c.P[9][11] + PS7*c.P[9][10] + c.P[3][9];
+    c.nextP[4][9] = -PS171*c.P[9][15] + PS172*c.P[9][14] + PS173*c.P[1][9] + PS174*c.P[0][9] + PS175*c.P[2][9] - PS176*c.P[3][9] + PS200*c.dt + PS43*c.P[9][13] + c.P[4][9];
+    c.nextP[5][9] = PS190*c.P[9][15] - PS193*c.P[9][13] + PS201*c.P[2][9] - PS202*c.P[0][9] + PS203*c.P[3][9] - PS204*c.P[1][9] + PS218*c.dt + PS75*c.P[9][14] + c.P[5][9];
+    c.nextP[6][9] = -PS197*c.P[9][14] + PS199*c.P[9][13] - PS214*c.P[2][9] + PS215*c.P[3][9] + PS216*c.P[0][9] + PS217*c.P[1][9] + PS222*c.dt + PS87*c.P[9][15] + c.P[6][9];
+    c.nextP[7][9] = c.P[4][9]*c.dt + c.P[7][9] + c.dt*(c.P[4][6]*c.dt + c.P[6][7]);
+    c.nextP[8][9] = c.P[5][9]*c.dt + c.P[8][9] + c.dt*(c.P[5][6]*c.dt + c.P[6][8]);
+    c.nextP[9][9] = c.P[6][9]*c.dt + c.P[9][9] + c.dt*(c.P[6][6]*c.dt + c.P[6][9]);
+
+    if (c.stateIndexLim > 9) {
+        c.nextP[0][10] = PS14;
+        c.nextP[1][10] = PS105;
+        c.nextP[2][10] = PS133;
+        c.nextP[3][10] = PS151;
+        c.nextP[4][10] = -PS171*c.P[10][15] + PS172*c.P[10][14] + PS173*c.P[1][10] + PS174*c.P[0][10] + PS175*c.P[2][10] - PS176*c.P[3][10] + PS43*c.P[10][13] + c.P[4][10];
+        c.nextP[5][10] = PS190*c.P[10][15] - PS193*c.P[10][13] + PS201*c.P[2][10] - PS202*c.P[0][10] + PS203*c.P[3][10] - PS204*c.P[1][10] + PS75*c.P[10][14] + c.P[5][10];
+        c.nextP[6][10] = -PS197*c.P[10][14] + PS199*c.P[10][13] - PS214*c.P[2][10] + PS215*c.P[3][10] + PS216*c.P[0][10] + PS217*c.P[1][10] + PS87*c.P[10][15] + c.P[6][10];
+        c.nextP[7][10] = c.P[4][10]*c.dt + c.P[7][10];
+        c.nextP[8][10] = c.P[5][10]*c.dt + c.P[8][10];
+        c.nextP[9][10] = c.P[6][10]*c.dt + c.P[9][10];
+        c.nextP[10][10] = c.P[10][10];
+        c.nextP[0][11] = PS17;
+        c.nextP[1][11] = PS97;
+        c.nextP[2][11] = PS132;
+        c.nextP[3][11] = PS155;
+        c.nextP[4][11] = -PS171*c.P[11][15] + PS172*c.P[11][14] + PS173*c.P[1][11] + PS174*c.P[0][11] + PS175*c.P[2][11] - PS176*c.P[3][11] + PS43*c.P[11][13] + c.P[4][11];
+        c.nextP[5][11] = PS190*c.P[11][15] - PS193*c.P[11][13] + PS201*c.P[2][11] - PS202*c.P[0][11] + PS203*c.P[3][11] - PS204*c.P[1][11] + PS75*c.P[11][14] + c.P[5][11];
+        c.nextP[6][11] = -PS197*c.P[11][14] + PS199*c.P[11][13] - PS214*c.P[2][11] + PS215*c.P[3][11] + PS216*c.P[0][11] + PS217*c.P[1][11] + PS87*c.P[11][15] + c.P[6][11];
+        c.nextP[7][11] = c.P[4][11]*c.dt + c.P[7][11];
+        c.nextP[8][11] = c.P[5][11]*c.dt + c.P[8][11];
+        c.nextP[9][11] = c.P[6][11]*c.dt + c.P[9][11];
+        c.nextP[10][11] = c.P[10][11];
+        c.nextP[11][11] = c.P[11][11];
+        c.nextP[0][12] = PS20;
+        c.nextP[1][12] = PS107;
+        c.nextP[2][12] = PS127;
+        c.nextP[3][12] = PS154;
+        c.nextP[4][12] = -PS171*c.P[12][15] + PS172*c.P[12][14] + PS173*c.P[1][12] + PS174*c.P[0][12] + PS175*c.P[2][12] - PS176*c.P[3][12] + PS43*c.P[12][13] + c.P[4][12];
+        c.nextP[5][12] = PS190*c.P[12][15] - PS193*c.P[12][13] + PS201*c.P[2][12] - PS202*c.P[0][12] + PS203*c.P[3][12] - PS204*c.P[1][12] + PS75*c.P[12][14] + c.P[5][12];
+        c.nextP[6][12] = -PS197*c.P[12][14] + PS199*c.P[12][13] - PS214*c.P[2][12] + PS215*c.P[3][12] + PS216*c.P[0][12] + PS217*c.P[1][12] + PS87*c.P[12][15] + c.P[6][12];
+        c.nextP[7][12] = c.P[4][12]*c.dt + c.P[7][12];
+        c.nextP[8][12] = c.P[5][12]*c.dt + c.P[8][12];
+        c.nextP[9][12] = c.P[6][12]*c.dt + c.P[9][12];
+        c.nextP[10][12] = c.P[10][12];
+        c.nextP[11][12] = c.P[11][12];
+        c.nextP[12][12] = c.P[12][12];
+
+        if (c.stateIndexLim > 12) {
+            c.nextP[0][13] = PS44;
+            c.nextP[1][13] = PS113;
+            c.nextP[2][13] = PS138;
+            c.nextP[3][13] = PS158;
+            c.nextP[4][13] = PS177;
+            c.nextP[5][13] = PS206;
+            c.nextP[6][13] = PS221;
+            c.nextP[7][13] = c.P[4][13]*c.dt + c.P[7][13];
+            c.nextP[8][13] = c.P[5][13]*c.dt + c.P[8][13];
+            c.nextP[9][13] = c.P[6][13]*c.dt + c.P[9][13];
+            c.nextP[10][13] = c.P[10][13];
+            c.nextP[11][13] = c.P[11][13];
+            c.nextP[12][13] = c.P[12][13];
+            c.nextP[13][13] = c.P[13][13];
+            c.nextP[0][14] = PS57;
+            c.nextP[1][14] = PS117;
+            c.nextP[2][14] = PS142;
+            c.nextP[3][14] = PS162;
+            c.nextP[4][14] = PS180;
+            c.nextP[5][14] = PS205;
+            c.nextP[6][14] = PS220;
+            c.nextP[7][14] = c.P[4][14]*c.dt + c.P[7][14];
+            c.nextP[8][14] = c.P[5][14]*c.dt + c.P[8][14];
+            c.nextP[9][14] = c.P[6][14]*c.dt + c.P[9][14];
+            c.nextP[10][14] = c.P[10][14];
+            c.nextP[11][14] = c.P[11][14];
+            c.nextP[12][14] = c.P[12][14];
+            c.nextP[13][14] = c.P[13][14];
+            c.nextP[14][14] = c.P[14][14];
+            c.nextP[0][15] = PS46;
+            c.nextP[1][15] = PS114;
+            c.nextP[2][15] = PS139;
+            c.nextP[3][15] = PS159;
+            c.nextP[4][15] = PS178;
+            c.nextP[5][15] = PS209;
+            c.nextP[6][15] = PS219;
+            c.nextP[7][15] = c.P[4][15]*c.dt + c.P[7][15];
+            c.nextP[8][15] = c.P[5][15]*c.dt + c.P[8][15];
+            c.nextP[9][15] = c.P[6][15]*c.dt + c.P[9][15];
+            c.nextP[10][15] = c.P[10][15];
+            c.nextP[11][15] = c.P[11][15];
+            c.nextP[12][15] = c.P[12][15];
+            c.nextP[13][15] = c.P[13][15];
+            c.nextP[14][15] = c.P[14][15];
+            c.nextP[15][15] = c.P[15][15];
+
+            if (c.stateIndexLim > 15) {
+                c.nextP[0][16] = -PS11*c.P[1][16] - PS12*c.P[2][16] - PS13*c.P[3][16] + PS6*c.P[10][16] + PS7*c.P[11][16] + PS9*c.P[12][16] + c.P[0][16];
+                c.nextP[1][16] = PS11*c.P[0][16] - PS12*c.P[3][16] + PS13*c.P[2][16] - PS34*c.P[10][16] - PS7*c.P[12][16] + PS9*c.P[11][16] + c.P[1][16];
+                c.nextP[2][16] = PS11*c.P[3][16] + PS12*c.P[0][16] - PS13*c.P[1][16] - PS34*c.P[11][16] + PS6*c.P[12][16] - PS9*c.P[10][16] + c.P[2][16];
+                c.nextP[3][16] = -PS11*c.P[2][16] + PS12*c.P[1][16] + PS13*c.P[0][16] - PS34*c.P[12][16] - PS6*c.P[11][16] + PS7*c.P[10][16] + c.P[3][16];
+                c.nextP[4][16] = -PS171*c.P[15][16] + PS172*c.P[14][16] + PS173*c.P[1][16] + PS174*c.P[0][16] + PS175*c.P[2][16] - PS176*c.P[3][16] + PS43*c.P[13][16] + c.P[4][16];
+                c.nextP[5][16] = PS190*c.P[15][16] - PS193*c.P[13][16] + PS201*c.P[2][16] - PS202*c.P[0][16] + PS203*c.P[3][16] - PS204*c.P[1][16] + PS75*c.P[14][16] + c.P[5][16];
+                c.nextP[6][16] = -PS197*c.P[14][16] + PS199*c.P[13][16] - PS214*c.P[2][16] + PS215*c.P[3][16] + PS216*c.P[0][16] + PS217*c.P[1][16] + PS87*c.P[15][16] + c.P[6][16];
+                c.nextP[7][16] = c.P[4][16]*c.dt + c.P[7][16];
+                c.nextP[8][16] = c.P[5][16]*c.dt + c.P[8][16];
+                c.nextP[9][16] = c.P[6][16]*c.dt + c.P[9][16];
+                c.nextP[10][16] = c.P[10][16];
+                c.nextP[11][16] = c.P[11][16];
+                c.nextP[12][16] = c.P[12][16];
+                c.nextP[13][16] = c.P[13][16];
+                c.nextP[14][16] = c.P[14][16];
+                c.nextP[15][16] = c.P[15][16];
+                c.nextP[16][16] = c.P[16][16];
+                c.nextP[0][17] = -PS11*c.P[1][17] - PS12*c.P[2][17] - PS13*c.P[3][17] + PS6*c.P[10][17] + PS7*c.P[11][17] + PS9*c.P[12][17] + c.P[0][17];
+                c.nextP[1][17] = PS11*c.P[0][17] - PS12*c.P[3][17] + PS13*c.P[2][17] - PS34*c.P[10][17] - PS7*c.P[12][17] + PS9*c.P[11][17] + c.P[1][17];
+                c.nextP[2][17] = PS11*c.P[3][17] + PS12*c.P[0][17] - PS13*c.P[1][17] - PS34*c.P[11][17] + PS6*c.P[12][17] - PS9*c.P[10][17] + c.P[2][17];
+                c.nextP[3][17] = -PS11*c.P[2][17] + PS12*c.P[1][17] + PS13*c.P[0][17] - PS34*c.P[12][17] - PS6*c.P[11][17] + PS7*c.P[10][17] + c.P[3][17];
+                c.nextP[4][17] = -PS171*c.P[15][17] + PS172*c.P[14][17] + PS173*c.P[1][17] + PS174*c.P[0][17] + PS175*c.P[2][17] - PS176*c.P[3][17] + PS43*c.P[13][17] + c.P[4][17];
+                c.nextP[5][17] = PS190*c.P[15][17] - PS193*c.P[13][17] + PS201*c.P[2][17] - PS202*c.P[0][17] + PS203*c.P[3][17] - PS204*c.P[1][17] + PS75*c.P[14][17] + c.P[5][17];
+                c.nextP[6][17] = -PS197*c.P[14][17] + PS199*c.P[13][17] - PS214*c.P[2][17] + PS215*c.P[3][17] + PS216*c.P[0][17] + PS217*c.P[1][17] + PS87*c.P[15][17] + c.P[6][17];
+                c.nextP[7][17] = c.P[4][17]*c.dt + c.P[7][17];
+                c.nextP[8][17] = c.P[5][17]*c.dt + c.P[8][17];
+                c.nextP[9][17] = c.P[6][17]*c.dt + c.P[9][17];
+                c.nextP[10][17] = c.P[10][17];
+                c.nextP[11][17] = c.P[11][17];
+                c.nextP[12][17] = c.P[12][17];
+                c.nextP[13][17] = c.P[13][17];
+                c.nextP[14][17] = c.P[14][17];
+                c.nextP[15][17] = c.P[15][17];
+                c.nextP[16][17] = c.P[16][17];
+                c.nextP[17][17] = c.P[17][17];
+                c.nextP[0][18] = -PS11*c.P[1][18] - PS12*c.P[2][18] - PS13*c.P[3][18] + PS6*c.P[10][18] + PS7*c.P[11][18] + PS9*c.P[12][18] + c.P[0][18];
+                c.nextP[1][18] = PS11*c.P[0][18] - PS12*c.P[3][18] + PS13*c.P[2][18] - PS34*c.P[10][18] - PS7*c.P[12][18] + PS9*c.P[11][18] + c.P[1][18];
+                c.nextP[2][18] = PS11*c.P[3][18] + PS12*c.P[0][18] - PS13*c.P[1][18] - PS34*c.P[11][18] + PS6*c.P[12][18] - PS9*c.P[10][18] + c.P[2][18];
+                c.nextP[3][18] = -PS11*c.P[2][18] + PS12*c.P[1][18] + PS13*c.P[0][18] - PS34*c.P[12][18] - PS6*c.P[11][18] + PS7*c.P[10][18] + c.P[3][18];
+                c.nextP[4][18] = -PS171*c.P[15][18] + PS172*c.P[14][18] + PS173*c.P[1][18] + PS174*c.P[0][18] + PS175*c.P[2][18] - PS176*c.P[3][18] + PS43*c.P[13][18] + c.P[4][18];
+                c.nextP[5][18] = PS190*c.P[15][18] - PS193*c.P[13][18] + PS201*c.P[2][18] - PS202*c.P[0][18] + PS203*c.P[3][18] - PS204*c.P[1][18] + PS75*c.P[14][18] + c.P[5][18];
+                c.nextP[6][18] = -PS197*c.P[14][18] + PS199*c.P[13][18] - PS214*c.P[2][18] + PS215*c.P[3][18] + PS216*c.P[0][18] + PS217*c.P[1][18] + PS87*c.P[15][18] + c.P[6][18];
+                c.nextP[7][18] = c.P[4][18]*c.dt + c.P[7][18];
+                c.nextP[8][18] = c.P[5][18]*c.dt + c.P[8][18];
+                c.nextP[9][18] = c.P[6][18]*c.dt + c.P[9][18];
+                c.nextP[10][18] = c.P[10][18];
+                c.nextP[11][18] = c.P[11][18];
+                c.nextP[12][18] = c.P[12][18];
+                c.nextP[13][18] = c.P[13][18];
+                c.nextP[14][18] = c.P[14][18];
+                c.nextP[15][18] = c.P[15][18];
+                c.nextP[16][18] = c.P[16][18];
+                c.nextP[17][18] = c.P[17][18];
+                c.nextP[18][18] = c.P[18][18];
+                c.nextP[0][19] = -PS11*c.P[1][19] - PS12*c.P[2][19] - PS13*c.P[3][19] + PS6*c.P[10][19] + PS7*c.P[11][19] + PS9*c.P[12][19] + c.P[0][19];
+                c.nextP[1][19] = PS11*c.P[0][19] - PS12*c.P[3][19] + PS13*c.P[2][19] - PS34*c.P[10][19] - PS7*c.P[12][19] + PS9*c.P[11][19] + c.P[1][19];
+                c.nextP[2][19] = PS11*c.P[3][19] + PS12*c.P[0][19] - PS13*c.P[1][19] - PS34*c.P[11][19] + PS6*c.P[12][19] - PS9*c.P[10][19] + c.P[2][19];
+                c.nextP[3][19] = -PS11*c.P[2][19] + PS12*c.P[1][19] + PS13*c.P[0][19] - PS34*c.P[12][19] - PS6*c.P[11][19] + PS7*c.P[10][19] + c.P[3][19];
+                c.nextP[4][19] = -PS171*c.P[15][19] + PS172*c.P[14][19] + PS173*c.P[1][19] + PS174*c.P[0][19] + PS175*c.P[2][19] - PS176*c.P[3][19] + PS43*c.P[13][19] + c.P[4][19];
+                c.nextP[5][19] = PS190*c.P[15][19] - PS193*c.P[13][19] + PS201*c.P[2][19] - PS202*c.P[0][19] + PS203*c.P[3][19] - PS204*c.P[1][19] + PS75*c.P[14][19] + c.P[5][19];
+                c.nextP[6][19] = -PS197*c.P[14][19] + PS199*c.P[13][19] - PS214*c.P[2][19] + PS215*c.P[3][19] + PS216*c.P[0][19] + PS217*c.P[1][19] + PS87*c.P[15][19] + c.P[6][19];
+                c.nextP[7][19] = c.P[4][19]*c.dt + c.P[7][19];
+                c.nextP[8][19] = c.P[5][19]*c.dt + c.P[8][19];
+                c.nextP[9][19] = c.P[6][19]*c.dt + c.P[9][19];
+                c.nextP[10][19] = c.P[10][19];
+                c.nextP[11][19] = c.P[11][19];
+                c.nextP[12][19] = c.P[12][19];
+                c.nextP[13][19] = c.P[13][19];
+                c.nextP[14][19] = c.P[14][19];
+                c.nextP[15][19] = c.P[15][19];
+                c.nextP[16][19] = c.P[16][19];
+                c.nextP[17][19] = c.P[17][19];
+                c.nextP[18][19] = c.P[18][19];
+                c.nextP[19][19] = c.P[19][19];
+                c.nextP[0][20] = -PS11*c.P[1][20] - PS12*c.P[2][20] - PS13*c.P[3][20] + PS6*c.P[10][20] + PS7*c.P[11][20] + PS9*c.P[12][20] + c.P[0][20];
+                c.nextP[1][20] = PS11*c.P[0][20] - PS12*c.P[3][20] + PS13*c.P[2][20] - PS34*c.P[10][20] - PS7*c.P[12][20] + PS9*c.P[11][20] + c.P[1][20];
+                c.nextP[2][20] = PS11*c.P[3][20] + PS12*c.P[0][20] - PS13*c.P[1][20] - PS34*c.P[11][20] + PS6*c.P[12][20] - PS9*c.P[10][20] + c.P[2][20];
+                c.nextP[3][20] = -PS11*c.P[2][20] + PS12*c.P[1][20] + PS13*c.P[0][20] - PS34*c.P[12][20] - PS6*c.P[11][20] + PS7*c.P[10][20] + c.P[3][20];
+                c.nextP[4][20] = -PS171*c.P[15][20] + PS172*c.P[14][20] + PS173*c.P[1][20] + PS174*c.P[0][20] + PS175*c.P[2][20] - PS176*c.P[3][20] + PS43*c.P[13][20] + c.P[4][20];
+                c.nextP[5][20] = PS190*c.P[15][20] - PS193*c.P[13][20] + PS201*c.P[2][20] - PS202*c.P[0][20] + PS203*c.P[3][20] - PS204*c.P[1][20] + PS75*c.P[14][20] + c.P[5][20];
+                c.nextP[6][20] = -PS197*c.P[14][20] + PS199*c.P[13][20] - PS214*c.P[2][20] + PS215*c.P[3][20] + PS216*c.P[0][20] + PS217*c.P[1][20] + PS87*c.P[15][20] + c.P[6][20];
+                c.nextP[7][20] = c.P[4][20]*c.dt + c.P[7][20];
+                c.nextP[8][20] = c.P[5][20]*c.dt + c.P[8][20];
+                c.nextP[9][20] = c.P[6][20]*c.dt + c.P[9][20];
+                c.nextP[10][20] = c.P[10][20];
+                c.nextP[11][20] = c.P[11][20];
+                c.nextP[12][20] = c.P[12][20];
+                c.nextP[13][20] = c.P[13][20];
+                c.nextP[14][20] = c.P[14][20];
+                c.nextP[15][20] = c.P[15][20];
+                c.nextP[16][20] = c.P[16][20];
+                c.nextP[17][20] = c.P[17][20];
+                c.nextP[18][20] = c.P[18][20];
+                c.nextP[19][20] = c.P[19][20];
+                c.nextP[20][20] = c.P[20][20];
+                c.nextP[0][21] = -PS11*c.P[1][21] - PS12*c.P[2][21] - PS13*c.P[3][21] + PS6*c.P[10][21] + PS7*c.P[11][21] + PS9*c.P[12][21] + c.P[0][21];
+                c.nextP[1][21] = PS11*c.P[0][21] - PS12*c.P[3][21] + PS13*c.P[2][21] - PS34*c.P[10][21] - PS7*c.P[12][21] + PS9*c.P[11][21] + c.P[1][21];
+                c.nextP[2][21] = PS11*c.P[3][21] + PS12*c.P[0][21] - PS13*c.P[1][21] - PS34*c.P[11][21] + PS6*c.P[12][21] - PS9*c.P[10][21] + c.P[2][21];
+                c.nextP[3][21] = -PS11*c.P[2][21] + PS12*c.P[1][21] + PS13*c.P[0][21] - PS34*c.P[12][21] - PS6*c.P[11][21] + PS7*c.P[10][21] + c.P[3][21];
+                c.nextP[4][21] = -PS171*c.P[15][21] + PS172*c.P[14][21] + PS173*c.P[1][21] + PS174*c.P[0][21] + PS175*c.P[2][21] - PS176*c.P[3][21] + PS43*c.P[13][21] + c.P[4][21];
+                c.nextP[5][21] = PS190*c.P[15][21] - PS193*c.P[13][21] + PS201*c.P[2][21] - PS202*c.P[0][21] + PS203*c.P[3][21] - PS204*c.P[1][21] + PS75*c.P[14][21] + c.P[5][21];
+                c.nextP[6][21] = -PS197*c.P[14][21] + PS199*c.P[13][21] - PS214*c.P[2][21] + PS215*c.P[3][21] + PS216*c.P[0][21] + PS217*c.P[1][21] + PS87*c.P[15][21] + c.P[6][21];
+                c.nextP[7][21] = c.P[4][21]*c.dt + c.P[7][21];
+                c.nextP[8][21] = c.P[5][21]*c.dt + c.P[8][21];
+                c.nextP[9][21] = c.P[6][21]*c.dt + c.P[9][21];
+                c.nextP[10][21] = c.P[10][21];
+                c.nextP[11][21] = c.P[11][21];
+                c.nextP[12][21] = c.P[12][21];
+                c.nextP[13][21] = c.P[13][21];
+                c.nextP[14][21] = c.P[14][21];
+                c.nextP[15][21] = c.P[15][21];
+                c.nextP[16][21] = c.P[16][21];
+                c.nextP[17][21] = c.P[17][21];
+                c.nextP[18][21] = c.P[18][21];
+                c.nextP[19][21] = c.P[19][21];
+                c.nextP[20][21] = c.P[20][21];
+                c.nextP[21][21] = c.P[21][21];
+
+                if (c.stateIndexLim > 21) {
+                    c.nextP[0][22] = -PS11*c.P[1][22] - PS12*c.P[2][22] - PS13*c.P[3][22] + PS6*c.P[10][22] + PS7*c.P[11][22] + PS9*c.P[12][22] + c.P[0][22];
+                    c.nextP[1][22] = PS11*c.P[0][22] - PS12*c.P[3][22] + PS13*c.P[2][22] - PS34*c.P[10][22] - PS7*c.P[12][22] + PS9*c.P[11][22] + c.P[1][22];
+                    c.nextP[2][22] = PS11*c.P[3][22] + PS12*c.P[0][22] - PS13*c.P[1][22] - PS34*c.P[11][22] + PS6*c.P[12][22] - PS9*c.P[10][22] + c.P[2][22];
+                    c.nextP[3][22] = -PS11*c.P[2][22] + PS12*c.P[1][22] + PS13*c.P[0][22] - PS34*c.P[12][22] - PS6*c.P[11][22] + PS7*c.P[10][22] + c.P[3][22];
+                    c.nextP[4][22] = -PS171*c.P[15][22] + PS172*c.P[14][22] + PS173*c.P[1][22] + PS174*c.P[0][22] + PS175*c.P[2][22] - PS176*c.P[3][22] + PS43*c.P[13][22] + c.P[4][22];
+                    c.nextP[5][22] = PS190*c.P[15][22] - PS193*c.P[13][22] + PS201*c.P[2][22] - PS202*c.P[0][22] + PS203*c.P[3][22] - PS204*c.P[1][22] + PS75*c.P[14][22] + c.P[5][22];
+                    c.nextP[6][22] = -PS197*c.P[14][22] + PS199*c.P[13][22] - PS214*c.P[2][22] + PS215*c.P[3][22] + PS216*c.P[0][22] + PS217*c.P[1][22] + PS87*c.P[15][22] + c.P[6][22];
+                    c.nextP[7][22] = c.P[4][22]*c.dt + c.P[7][22];
+                    c.nextP[8][22] = c.P[5][22]*c.dt + c.P[8][22];
+                    c.nextP[9][22] = c.P[6][22]*c.dt + c.P[9][22];
+                    c.nextP[10][22] = c.P[10][22];
+                    c.nextP[11][22] = c.P[11][22];
+                    c.nextP[12][22] = c.P[12][22];
+                    c.nextP[13][22] = c.P[13][22];
+                    c.nextP[14][22] = c.P[14][22];
+                    c.nextP[15][22] = c.P[15][22];
+                    c.nextP[16][22] = c.P[16][22];
+                    c.nextP[17][22] = c.P[17][22];
+                    c.nextP[18][22] = c.P[18][22];
+                    c.nextP[19][22] = c.P[19][22];
+                    c.nextP[20][22] = c.P[20][22];
+                    c.nextP[21][22] = c.P[21][22];
+                    c.nextP[22][22] = c.P[22][22];
+                    c.nextP[0][23] = -PS11*c.P[1][23] - PS12*c.P[2][23] - PS13*c.P[3][23] + PS6*c.P[10][23] + PS7*c.P[11][23] + PS9*c.P[12][23] + c.P[0][23];
+                    c.nextP[1][23] = PS11*c.P[0][23] - PS12*c.P[3][23] + PS13*c.P[2][23] - PS34*c.P[10][23] - PS7*c.P[12][23] + PS9*c.P[11][23] + c.P[1][23];
+                    c.nextP[2][23] = PS11*c.P[3][23] + PS12*c.P[0][23] - PS13*c.P[1][23] - PS34*c.P[11][23] + PS6*c.P[12][23] - PS9*c.P[10][23] + c.P[2][23];
+                    c.nextP[3][23] = -PS11*c.P[2][23] + PS12*c.P[1][23] + PS13*c.P[0][23] - PS34*c.P[12][23] - PS6*c.P[11][23] + PS7*c.P[10][23] + c.P[3][23];
+                    c.nextP[4][23] = -PS171*c.P[15][23] + PS172*c.P[14][23] + PS173*c.P[1][23] + PS174*c.P[0][23] + PS175*c.P[2][23] - PS176*c.P[3][23] + PS43*c.P[13][23] + c.P[4][23];
+                    c.nextP[5][23] = PS190*c.P[15][23] - PS193*c.P[13][23] + PS201*c.P[2][23] - PS202*c.P[0][23] + PS203*c.P[3][23] - PS204*c.P[1][23] + PS75*c.P[14][23] + c.P[5][23];
+                    c.nextP[6][23] = -PS197*c.P[14][23] + PS199*c.P[13][23] - PS214*c.P[2][23] + PS215*c.P[3][23] + PS216*c.P[0][23] + PS217*c.P[1][23] + PS87*c.P[15][23] + c.P[6][23];
+                    c.nextP[7][23] = c.P[4][23]*c.dt + c.P[7][23];
+                    c.nextP[8][23] = c.P[5][23]*c.dt + c.P[8][23];
+                    c.nextP[9][23] = c.P[6][23]*c.dt + c.P[9][23];
+                    c.nextP[10][23] = c.P[10][23];
+                    c.nextP[11][23] = c.P[11][23];
+                    c.nextP[12][23] = c.P[12][23];
+                    c.nextP[13][23] = c.P[13][23];
+                    c.nextP[14][23] = c.P[14][23];
+                    c.nextP[15][23] = c.P[15][23];
+                    c.nextP[16][23] = c.P[16][23];
+                    c.nextP[17][23] = c.P[17][23];
+                    c.nextP[18][23] = c.P[18][23];
+                    c.nextP[19][23] = c.P[19][23];
+                    c.nextP[20][23] = c.P[20][23];
+                    c.nextP[21][23] = c.P[21][23];
+                    c.nextP[22][23] = c.P[22][23];
+                    c.nextP[23][23] = c.P[23][23];
+                }
+            }
+        }
+    }
+
+    // add the general state process noise variances
+    if (c.stateIndexLim > 9) {
+        for (uint8_t i=10; i<=c.stateIndexLim; i++) {
+            c.nextP[i][i] = c.nextP[i][i] + processNoiseVariance[i-10];
+        }
+    }
+
+    // inactive delta velocity bias states have all covariances zeroed to prevent
+    // interacton with other states
+    if (!c.inhibitDelVelBiasStates) {
+        for (uint8_t index=0; index<3; index++) {
+            const uint8_t stateIndex = index + 13;
+            if (c.dvelBiasAxisInhibit[index]) {
+                c.zeroCols(c.nextP,stateIndex,stateIndex);
+                c.nextP[stateIndex][stateIndex] = c.dvelBiasAxisVarPrev[index];
+            }
+        }
+    }
+
+    // if the total position variance exceeds 1e4 (100m), then stop covariance
+    // growth by setting the predicted to the previous values
+    // This prevent an ill conditioned matrix from occurring for long periods
+    // without GPS
+    if ((c.P[7][7] + c.P[8][8]) > 1e4f) {
+        for (uint8_t i=7; i<=8; i++)
+        {
+            for (uint8_t j=0; j<=c.stateIndexLim; j++)
+            {
+                c.nextP[i][j] = c.P[i][j];
+                c.nextP[j][i] = c.P[j][i];
+            }
+        }
+    }
+
+    // covariance matrix is symmetrical, so copy diagonals and copy lower half in nextP
+    // to lower and upper half in P
+    for (uint8_t row = 0; row <= c.stateIndexLim; row++) {
+        // copy diagonals
+        c.P[row][row] = c.nextP[row][row];
+        // copy off diagonals
+        for (uint8_t column = 0 ; column < row; column++) {
+            c.P[row][column] = c.P[column][row] = c.nextP[column][row];
+        }
+    }
+
+    // constrain values to prevent ill-conditioning
+    c.ConstrainVariances();
+
+    if (c.vertVelVarClipCounter > 0) {
+        c.vertVelVarClipCounter--;
+    }
+
+    c.calcTiltErrorVariance();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+    c.verifyTiltErrorVariance();
+#endif
+}
+
+TEST(NavEKF3_core, CovariancePrediction)
+{
+    NavEKF3_core_Benchmark *bench = new NavEKF3_core_Benchmark();
+    for (uint32_t seed = 1; seed <= 500; seed++) {
+        bench->check_prediction(seed, false);
+    }
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        bench->check_prediction(seed, true);
+    }
+
+    // every combination of inhibited states must have been covered
+    EXPECT_EQ(bench->state_index_lims_seen, (1U << 9) | (1U << 12) | (1U << 15) | (1U << 21) | (1U << 23));
+    delete bench;
+}
+
+AP_GTEST_MAIN()
@@ -104,6 +104,15 @@ uint16_t AP_Param::_count_marker;
 uint16_t AP_Param::_count_marker_done;
 HAL_Semaphore AP_Param::_count_sem;
 
+#if AP_PARAM_NAME_INDEX_ENABLED
+AP_Param::NameIndexEntry *AP_Param::_name_index;
+uint16_t AP_Param::_name_index_size;
+uint16_t AP_Param::_name_index_marker;
+uint32_t AP_Param::_name_index_build_ms;
+bool AP_Param::_name_index_tried;
+HAL_Semaphore AP_Param::_name_index_sem;
+#endif
+
 // storage and naming information about all types that can be saved
 const AP_Param::Info *AP_Param::_var_info;
 
@@ -904,52 +913,294 @@ AP_Param::find_group(const char *name, uint16_t vindex, ptrdiff_t group_offset,
 }
 
 
+// Find a variable by name within one top level variable
+//
+AP_Param *
+AP_Param::find_in_var(uint16_t vindex, const char *name, enum ap_var_type *ptype, uint16_t *flags)
+{
+    const auto &info = var_info(vindex);
+    uint8_t type = info.type;
+    if (type == AP_PARAM_GROUP) {
+        uint8_t len = strnlen(info.name, AP_MAX_NAME_SIZE);
+        if (strncmp(name, info.name, len) != 0) {
+            return nullptr;
+        }
+        const struct GroupInfo *group_info = get_group_info(info);
+        if (group_info == nullptr) {
+            return nullptr;
+        }
+        AP_Param *ap = find_group(name + len, vindex, 0, group_info, ptype);
+        if (ap != nullptr && flags != nullptr) {
+            uint32_t group_element = 0;
+            const struct GroupInfo *ginfo;
+            struct GroupNesting group_nesting {};
+            uint8_t idx;
+            ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
+            if (ginfo != nullptr) {
+                *flags = ginfo->flags;
+            }
+        }
+        return ap;
+    }
+    if (strcasecmp(name, info.name) == 0) {
+        ptrdiff_t base;
+        if (!get_base(info, base)) {
+            return nullptr;
+        }
+        *ptype = (enum ap_var_type)type;
+        return (AP_Param *)base;
+    }
+    return nullptr;
+}
+
 // Find a variable by name.
 //
 AP_Param *
 AP_Param::find(const char *name, enum ap_var_type *ptype, uint16_t *flags)
+{
+#if AP_PARAM_NAME_INDEX_ENABLED
+    // if another thread is using the index then search without it
+    // rather than waiting
+    if (_name_index_sem.take_nonblocking()) {
+        AP_Param *ap;
+        const bool indexed = find_indexed(name, ptype, flags, ap);
+        _name_index_sem.give();
+        if (indexed) {
+            // the index holds every name find_linear() can match, so
+            // a miss here is a miss there too
+            return ap;
+        }
+    }
+#endif
+    return find_linear(name, ptype, flags);
+}
+
+// Find a variable by name, checking every top level variable
+//
+AP_Param *
+AP_Param::find_linear(const char *name, enum ap_var_type *ptype, uint16_t *flags)
 {
     for (uint16_t i=0; i<_num_vars; i++) {
-        const auto &info = var_info(i);
-        uint8_t type = info.type;
+        AP_Param *ap = find_in_var(i, name, ptype, flags);
+        if (ap != nullptr) {
+            return ap;
+        }
+        // we continue looking as we want to allow top level
+        // parameter to have the same prefix name as group
+        // parameters, for example CAM_P_G
+    }
+    return nullptr;
+}
+
+#if AP_PARAM_NAME_INDEX_ENABLED
+// FNV-1a hash of a parameter name, ignoring case as find_linear() does
+uint32_t AP_Param::name_hash(const char *name)
+{
+    uint32_t h = 2166136261U;
+    for (uint8_t i=0; i<AP_MAX_NAME_SIZE && name[i] != 0; i++) {
+        uint8_t c = name[i];
+        if (c >= 'a' && c <= 'z') {
+            c -= 'a' - 'A';
+        }
+        h ^= c;
+        h *= 16777619U;
+    }
+    return h;
+}
+
+/*
+  add one name to the name index. If the set of parameters grew since
+  the index was sized the name is dropped, the count marker will have
+  changed so the index is not used until it is rebuilt
+ */
+void AP_Param::name_index_insert(const char *name, uint16_t key)
+{
+    const uint32_t h = name_hash(name);
+    const uint16_t check = MAX(h >> 16, 1U);
+    const uint16_t mask = _name_index_size - 1;
+    for (uint16_t i = h & mask, n = 0; n < _name_index_size; i = (i+1) & mask, n++) {
+        NameIndexEntry &e = _name_index[i];
+        if (e.check == 0) {
+            e.check = check;
+            e.key = key;
+            return;
+        }
+    }
+}
+
+/*
+  add the names of the parameters in a group to the name index,
+  following the same nesting as find_group(). name holds the prefix
+  of prefix_len characters. Returns the number of names, which are
+  only inserted if insert is true
+ */
+uint16_t AP_Param::name_index_add_group(uint16_t vindex, const struct GroupInfo *group_info, ptrdiff_t group_offset,
+                                        char *name, uint8_t prefix_len, bool insert)
+{
+    uint16_t count = 0;
+    enum ap_var_type type;
+    for (uint8_t i=0;
+         (type=(enum ap_var_type)group_info[i].type) != AP_PARAM_NONE;
+         i++) {
+        strncpy(&name[prefix_len], group_info[i].name, AP_MAX_NAME_SIZE-prefix_len);
+        const uint8_t len = strnlen(name, AP_MAX_NAME_SIZE);
         if (type == AP_PARAM_GROUP) {
-            uint8_t len = strnlen(info.name, AP_MAX_NAME_SIZE);
-            if (strncmp(name, info.name, len) != 0) {
+            const struct GroupInfo *ginfo = get_group_info(group_info[i]);
+            if (ginfo == nullptr) {
                 continue;
             }
-            const struct GroupInfo *group_info = get_group_info(info);
-            if (group_info == nullptr) {
+            ptrdiff_t new_offset = group_offset;
+            if (!adjust_group_offset(vindex, group_info[i], new_offset)) {
                 continue;
             }
-            AP_Param *ap = find_group(name + len, i, 0, group_info, ptype);
-            if (ap != nullptr) {
-                if (flags != nullptr) {
-                    uint32_t group_element = 0;
-                    const struct GroupInfo *ginfo;
-                    struct GroupNesting group_nesting {};
-                    uint8_t idx;
-                    ap->find_var_info(&group_element, ginfo, group_nesting, &idx);
-                    if (ginfo != nullptr) {
-                        *flags = ginfo->flags;
-                    }
+            count += name_index_add_group(vindex, ginfo, new_offset, name, len, insert);
+            continue;
+        }
+        if (insert) {
+            name_index_insert(name, vindex);
+        }
+        count++;
+        if (type == AP_PARAM_VECTOR3F && len + 2 <= AP_MAX_NAME_SIZE) {
+            // find_group() also matches the elements of a Vector3f
+            for (uint8_t idx=0; idx<3; idx++) {
+                name[len] = '_';
+                name[len+1] = 'X' + idx;
+                name[len+2] = 0;
+                if (insert) {
+                    name_index_insert(name, vindex);
                 }
-                return ap;
+                count++;
             }
-            // we continue looking as we want to allow top level
-            // parameter to have the same prefix name as group
-            // parameters, for example CAM_P_G
-        } else if (strcasecmp(name, info.name) == 0) {
-            *ptype = (enum ap_var_type)type;
-            ptrdiff_t base;
-            if (!get_base(info, base)) {
-                return nullptr;
+            name[len] = 0;
+        }
+    }
+    return count;
+}
+
+/*
+  add the names of all parameters to the name index, including ones
+  hidden by frame type or enable parameters as find_linear() finds
+  those too. Returns the number of names, which are only inserted if
+  insert is true
+ */
+uint16_t AP_Param::name_index_add_all(bool insert)
+{
+    uint16_t count = 0;
+    char name[AP_MAX_NAME_SIZE+1] {};
+    for (uint16_t i=0; i<_num_vars; i++) {
+        const auto &info = var_info(i);
+        strncpy(name, info.name, AP_MAX_NAME_SIZE);
+        if (info.type == AP_PARAM_GROUP) {
+            const struct GroupInfo *group_info = get_group_info(info);
+            if (group_info != nullptr) {
+                count += name_index_add_group(i, group_info, 0, name, strnlen(name, AP_MAX_NAME_SIZE), insert);
             }
-            return (AP_Param *)base;
+        } else if (info.type <= AP_PARAM_VECTOR3F) {
+            if (insert) {
+                name_index_insert(name, i);
+            }
+            count++;
         }
     }
-    return nullptr;
+    return count;
+}
+
+/*
+  build the name index from the names of all parameters. Called with
+  _name_index_sem held
+ */
+bool AP_Param::build_name_index(void)
+{
+    // anything invalidating the count while we are building will
+    // cause another rebuild
+    const uint16_t marker = _count_marker;
+
+    const uint16_t count = name_index_add_all(false);
+
+    // keep the table no more than 3/4 full so probe chains stay short
+    uint16_t size = 64;
+    while (size < count + count/3 && size < 0x8000) {
+        size *= 2;
+    }
+    if (size != _name_index_size) {
+        delete[] _name_index;
+        _name_index = new NameIndexEntry[size];
+        if (_name_index == nullptr) {
+            _name_index_size = 0;
+            return false;
+        }
+        _name_index_size = size;
+    }
+    memset(_name_index, 0, size*sizeof(NameIndexEntry));
+
+    name_index_add_all(true);
+
+    _name_index_marker = marker;
+    return true;
 }
 
+/*
+  build the name index if it is missing or out of date. Building walks
+  every parameter twice, so this is only called after load_all() and
+  from the IO thread, never from find()
+ */
+void AP_Param::update_name_index(void)
+{
+    if (_name_index != nullptr && _name_index_marker == _count_marker) {
+        return;
+    }
+    // scripts may add parameters one at a time, don't rebuild
+    // more than once a second while that is happening
+    const uint32_t now_ms = AP_HAL::millis();
+    if (_name_index_tried && now_ms - _name_index_build_ms < 1000) {
+        return;
+    }
+    _name_index_tried = true;
+    _name_index_build_ms = now_ms;
+
+    WITH_SEMAPHORE(_name_index_sem);
+    build_name_index();
+}
+
+/*
+  find a variable using the name index. Called with _name_index_sem
+  held. Returns false if the index is missing or out of date, leaving
+  the search to find_linear(). Otherwise ap is set to what
+  find_linear() would return, nullptr if no parameter has that name
+ */
+bool AP_Param::find_indexed(const char *name, enum ap_var_type *ptype, uint16_t *flags, AP_Param *&ap)
+{
+    if (_name_index == nullptr || _name_index_marker != _count_marker) {
+        return false;
+    }
+
+    ap = nullptr;
+    uint16_t ap_key = _num_vars;
+    const uint32_t h = name_hash(name);
+    const uint16_t check = MAX(h >> 16, 1U);
+    const uint16_t mask = _name_index_size - 1;
+    for (uint16_t i = h & mask, n = 0; n < _name_index_size; i = (i+1) & mask, n++) {
+        const NameIndexEntry &e = _name_index[i];
+        if (e.check == 0) {
+            break;
+        }
+        // find_linear() returns the match in the first top level
+        // variable, so only earlier ones need checking
+        if (e.check != check || e.key >= ap_key) {
+            continue;
+        }
+        // different names can share a hash, so search the top level
+        // variable the same way find_linear() does
+        AP_Param *vp = find_in_var(e.key, name, ptype, flags);
+        if (vp != nullptr) {
+            ap = vp;
+            ap_key = e.key;
+        }
+    }
+    return true;
+}
+#endif // AP_PARAM_NAME_INDEX_ENABLED
+
 // Find a variable by index. Note that this is quite slow.
 //
 AP_Param *
@@ -1283,6 +1534,10 @@ void AP_Param::save_io_handler(void)
     if (hal.scheduler->is_system_initialized()) {
         // pay the cost of parameter counting in the IO thread
         count_parameters();
+#if AP_PARAM_NAME_INDEX_ENABLED
+        // and of rebuilding the name index
+        update_name_index();
+#endif
     }
 }
 
@@ -1542,6 +1797,12 @@ bool AP_Param::load_all()
         if (is_sentinal(phdr)) {
             // we've reached the sentinal
             sentinal_offset = ofs;
+            // loaded enable parameters may have changed the set of
+            // visible parameters
+            invalidate_count();
+#if AP_PARAM_NAME_INDEX_ENABLED
+            update_name_index();
+#endif
             return true;
         }
 
@@ -1558,6 +1819,10 @@ bool AP_Param::load_all()
 
     // we didn't find the sentinal
     Debug("no sentinal in load_all");
+    invalidate_count();
+#if AP_PARAM_NAME_INDEX_ENABLED
+    update_name_index();
+#endif
     return false;
 }
 
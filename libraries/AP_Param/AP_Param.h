@@ -320,6 +320,17 @@ public:
     ///
     static AP_Param * find(const char *name, enum ap_var_type *ptype, uint16_t *flags = nullptr);
 
+    /// Find a variable by name by searching all of _var_info, without
+    /// using the name index. Slow, used for comparison in benchmarks
+    static AP_Param * find_linear(const char *name, enum ap_var_type *ptype, uint16_t *flags = nullptr);
+
+#if AP_PARAM_NAME_INDEX_ENABLED
+    /// Build the name index used by find() if it is missing or the set
+    /// of parameters has changed. Called after load_all() and from the
+    /// IO thread, find() searches without the index until this runs
+    static void update_name_index(void);
+#endif
+
     /// set a default value by name
     ///
     /// @param  name            The full name of the variable to be found.
@@ -797,6 +808,36 @@ private:
     static HAL_Semaphore        _count_sem;
     static const struct Info *  _var_info;
 
+    // find a variable by name within the top level variable vindex
+    static AP_Param *find_in_var(uint16_t vindex, const char *name, enum ap_var_type *ptype, uint16_t *flags);
+
+#if AP_PARAM_NAME_INDEX_ENABLED
+    /*
+      open addressing hash table from parameter name to the top level
+      variable holding it, used by find(). It is rebuilt by
+      update_name_index() when the parameter count is invalidated, as
+      that happens whenever tables are added or pointer objects are
+      loaded
+     */
+    struct NameIndexEntry {
+        uint16_t check;     // upper bits of the name hash, 0 if unused
+        uint16_t key;       // top level var_info index
+    };
+    static NameIndexEntry *     _name_index;
+    static uint16_t             _name_index_size;    // number of entries, a power of 2
+    static uint16_t             _name_index_marker;  // _count_marker when built
+    static uint32_t             _name_index_build_ms;
+    static bool                 _name_index_tried;
+    static HAL_Semaphore        _name_index_sem;
+    static uint32_t             name_hash(const char *name);
+    static void                 name_index_insert(const char *name, uint16_t key);
+    static uint16_t             name_index_add_group(uint16_t vindex, const struct GroupInfo *group_info, ptrdiff_t group_offset,
+                                                     char *name, uint8_t prefix_len, bool insert);
+    static uint16_t             name_index_add_all(bool insert);
+    static bool                 build_name_index(void);
+    static bool                 find_indexed(const char *name, enum ap_var_type *ptype, uint16_t *flags, AP_Param *&ap);
+#endif
+
 #if AP_PARAM_DYNAMIC_ENABLED
     // allow for a dynamically allocated var table
     static uint16_t             _num_vars_base;
@@ -8,6 +8,11 @@
 #define AP_PARAM_DEFAULTS_FILE_PARSING_ENABLED AP_FILESYSTEM_FILE_READING_ENABLED
 #endif
 
+// hash index used to speed up AP_Param::find()
+#ifndef AP_PARAM_NAME_INDEX_ENABLED
+#define AP_PARAM_NAME_INDEX_ENABLED (HAL_MEM_CLASS >= HAL_MEM_CLASS_1000)
+#endif
+
 #ifndef FORCE_APJ_DEFAULT_PARAMETERS
 #define FORCE_APJ_DEFAULT_PARAMETERS 0
 #endif
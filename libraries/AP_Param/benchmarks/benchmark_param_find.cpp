@@ -0,0 +1,114 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Param/AP_Param.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  a synthetic parameter table about the size of the Copter parameter
+  set, made of groups of float parameters plus top level scalars. The
+  real Copter table needs the whole vehicle linked in, so it can't be
+  used from a library benchmark
+ */
+class BenchGroup {
+public:
+    BenchGroup() {
+        AP_Param::setup_object_defaults(this, var_info);
+    }
+    static const struct AP_Param::GroupInfo var_info[];
+    AP_Float p[40];
+};
+
+#define P(n) AP_GROUPINFO("P" #n, n, BenchGroup, p[n], 0)
+
+const struct AP_Param::GroupInfo BenchGroup::var_info[] = {
+    P(0),  P(1),  P(2),  P(3),  P(4),  P(5),  P(6),  P(7),  P(8),  P(9),
+    P(10), P(11), P(12), P(13), P(14), P(15), P(16), P(17), P(18), P(19),
+    P(20), P(21), P(22), P(23), P(24), P(25), P(26), P(27), P(28), P(29),
+    P(30), P(31), P(32), P(33), P(34), P(35), P(36), P(37), P(38), P(39),
+    AP_GROUPEND
+};
+
+static BenchGroup groups[32];
+static AP_Float scalars[64];
+
+#define G(n) { "G" #n "_", (const void *)&groups[n], { group_info : BenchGroup::var_info }, 0, n, AP_PARAM_GROUP }
+#define S(n) { "S" #n, (const void *)&scalars[n], { def_value : 0 }, 0, 32+n, AP_PARAM_FLOAT }
+
+static const AP_Param::Info var_info[] = {
+    G(0),  G(1),  G(2),  G(3),  G(4),  G(5),  G(6),  G(7),
+    G(8),  G(9),  G(10), G(11), G(12), G(13), G(14), G(15),
+    G(16), G(17), G(18), G(19), G(20), G(21), G(22), G(23),
+    G(24), G(25), G(26), G(27), G(28), G(29), G(30), G(31),
+    S(0),  S(1),  S(2),  S(3),  S(4),  S(5),  S(6),  S(7),
+    S(8),  S(9),  S(10), S(11), S(12), S(13), S(14), S(15),
+    S(16), S(17), S(18), S(19), S(20), S(21), S(22), S(23),
+    S(24), S(25), S(26), S(27), S(28), S(29), S(30), S(31),
+    S(32), S(33), S(34), S(35), S(36), S(37), S(38), S(39),
+    S(40), S(41), S(42), S(43), S(44), S(45), S(46), S(47),
+    S(48), S(49), S(50), S(51), S(52), S(53), S(54), S(55),
+    S(56), S(57), S(58), S(59), S(60), S(61), S(62), S(63),
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+static const uint16_t MAX_NAMES = 32*40 + 64;
+static char names[MAX_NAMES][AP_MAX_NAME_SIZE+1];
+static uint16_t num_names;
+
+// collect the names of all parameters to look up
+static void setup_names()
+{
+    if (num_names != 0) {
+        return;
+    }
+    AP_Param::ParamToken token;
+    enum ap_var_type type;
+    for (AP_Param *ap = AP_Param::first(&token, &type);
+         ap != nullptr && num_names < MAX_NAMES;
+         ap = AP_Param::next_scalar(&token, &type)) {
+        ap->copy_name_token(token, names[num_names], sizeof(names[0]), true);
+        num_names++;
+    }
+#if AP_PARAM_NAME_INDEX_ENABLED
+    // normally built after load_all()
+    AP_Param::update_name_index();
+#endif
+}
+
+static void BM_ParamFindLinear(benchmark::State& state)
+{
+    setup_names();
+    uint16_t i = 0;
+    enum ap_var_type type;
+    while (state.KeepRunning()) {
+        gbenchmark_escape(AP_Param::find_linear(names[i], &type));
+        i = (i + 1) % num_names;
+    }
+}
+
+static void BM_ParamFindIndexed(benchmark::State& state)
+{
+    setup_names();
+    uint16_t i = 0;
+    enum ap_var_type type;
+    while (state.KeepRunning()) {
+        gbenchmark_escape(AP_Param::find(names[i], &type));
+        i = (i + 1) % num_names;
+    }
+}
+
+static void BM_ParamFindMissing(benchmark::State& state)
+{
+    enum ap_var_type type;
+    while (state.KeepRunning()) {
+        gbenchmark_escape(AP_Param::find("G31_NOT_A_PARAM", &type));
+    }
+}
+
+BENCHMARK(BM_ParamFindLinear);
+BENCHMARK(BM_ParamFindIndexed);
+BENCHMARK(BM_ParamFindMissing);
+
+BENCHMARK_MAIN();
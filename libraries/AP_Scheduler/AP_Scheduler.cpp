@@ -67,7 +67,7 @@ const AP_Param::GroupInfo AP_Scheduler::var_info[] = {
     // @Param: OPTIONS
     // @DisplayName: Scheduling options
     // @Description: This controls optional aspects of the scheduler.
-    // @Bitmask: 0:Enable per-task perf info
+    // @Bitmask: 0:Enable per-task perf info,1:Enable task trace logging on long loops
     // @User: Advanced
     AP_GROUPINFO("OPTIONS",  2, AP_Scheduler, _options, 0),
 
@@ -130,9 +130,7 @@ void AP_Scheduler::init(const AP_Scheduler::Task *tasks, uint8_t num_tasks, uint
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
 
-    if (_options & uint8_t(Options::RECORD_TASK_INFO)) {
-        perf_info.allocate_task_info(_num_tasks);
-    }
+    update_task_stats_allocation();
 
     _log_performance_bit = log_performance_bit;
 
@@ -279,7 +277,7 @@ void AP_Scheduler::run(uint32_t time_available)
                   (unsigned)_task_time_allowed);
         }
 
-        perf_info.update_task_info(i, time_taken, overrun);
+        perf_info.update_task_info(i, _task_time_started, time_taken, overrun);
 
         if (time_taken >= time_available) {
             /*
@@ -411,8 +409,17 @@ void AP_Scheduler::loop()
     }
 
     // check loop time
-    perf_info.check_loop_time(sample_time_us - _loop_timer_start_us);
-        
+    const uint32_t loop_time_us = sample_time_us - _loop_timer_start_us;
+    perf_info.check_loop_time(loop_time_us);
+
+#if AP_SCHEDULER_TASK_TRACE_ENABLED && HAL_LOGGING_ENABLED
+    // dump the tasks which ran in the previous loop if it went over time
+    if (perf_info.has_task_trace() &&
+        loop_time_us > perf_info.get_overtime_threshold_us()) {
+        Log_Write_Task_Trace(_loop_timer_start_us, sample_time_us);
+    }
+#endif
+
     _loop_timer_start_us = sample_time_us;
 
 #if AP_SIM_ENABLED && CONFIG_HAL_BOARD != HAL_BOARD_SITL
@@ -429,15 +436,14 @@ void AP_Scheduler::update_logging()
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+        Log_Write_Loop_Histogram();
+#endif
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
     // dynamically update the per-task perf counter
-    if (!(_options & uint8_t(Options::RECORD_TASK_INFO)) && perf_info.has_task_info()) {
-        perf_info.free_task_info();
-    } else if ((_options & uint8_t(Options::RECORD_TASK_INFO)) && !perf_info.has_task_info()) {
-        perf_info.allocate_task_info(_num_tasks);
-    }
+    update_task_stats_allocation();
 }
 
 // Write a performance monitoring packet
@@ -463,24 +469,139 @@ void AP_Scheduler::Log_Write_Performance()
     };
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
+
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+// Write the main loop time histogram
+void AP_Scheduler::Log_Write_Loop_Histogram()
+{
+    const AP::PerfInfo::LatencyHistogram &hist = perf_info.get_loop_histogram();
+    struct log_SchedHist pkt = {
+        LOG_PACKET_HEADER_INIT(LOG_SCHED_HIST_MSG),
+        time_us : AP_HAL::micros64(),
+    };
+    static_assert(ARRAY_SIZE(pkt.counts) == AP::PerfInfo::LatencyHistogram::NUM_BUCKETS, "histogram size mismatch");
+    memcpy(pkt.counts, hist.counts, sizeof(pkt.counts));
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+}
+#endif
+
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+/*
+  write out the traced tasks which started between loop_start_us and
+  loop_end_us. This is called when a loop has taken longer than the
+  overtime threshold to show which tasks consumed the time
+ */
+void AP_Scheduler::Log_Write_Task_Trace(uint32_t loop_start_us, uint32_t loop_end_us)
+{
+    AP_Logger *logger = AP_Logger::get_singleton();
+    if (logger == nullptr || !logger->logging_started()) {
+        return;
+    }
+
+    // limit the rate of trace dumps so a continuously overloaded
+    // CPU does not flood the log
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - _last_task_trace_log_ms < 100) {
+        return;
+    }
+    _last_task_trace_log_ms = now_ms;
+
+    const uint64_t now_us = AP_HAL::micros64();
+    const uint32_t loop_time_us = loop_end_us - loop_start_us;
+    for (uint8_t i = 0; i < perf_info.get_num_task_trace(); i++) {
+        const AP::PerfInfo::TaskTrace *tt = perf_info.get_task_trace(i);
+        const uint32_t offset_us = tt->start_us - loop_start_us;
+        if (offset_us >= loop_time_us) {
+            // not part of this loop
+            continue;
+        }
+        const struct log_SchedTrace pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_SCHED_TRACE_MSG),
+            time_us      : now_us - (uint32_t(now_us) - tt->start_us),
+            offset_us    : uint16_t(MIN(offset_us, UINT16_MAX)),
+            task_time_us : tt->time_us,
+            loop_time_us : uint16_t(MIN(loop_time_us, UINT16_MAX)),
+            task_index   : tt->task_index,
+            overrun      : tt->overrun,
+        };
+        logger->WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+#endif  // AP_SCHEDULER_TASK_TRACE_ENABLED
 #endif  // HAL_LOGGING_ENABLED
 
+// allocate or free the per-task statistics and task trace based on _options
+void AP_Scheduler::update_task_stats_allocation()
+{
+    if (!(_options & uint8_t(Options::RECORD_TASK_INFO)) && perf_info.has_task_info()) {
+        perf_info.free_task_info();
+    } else if ((_options & uint8_t(Options::RECORD_TASK_INFO)) && !perf_info.has_task_info()) {
+        perf_info.allocate_task_info(_num_tasks);
+    }
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    if (!(_options & uint8_t(Options::RECORD_TASK_TRACE)) && perf_info.has_task_trace()) {
+        perf_info.free_task_trace();
+    } else if ((_options & uint8_t(Options::RECORD_TASK_TRACE)) && !perf_info.has_task_trace()) {
+        perf_info.allocate_task_trace();
+    }
+#endif
+}
+
+// fill names with the name of each task in the combined task list.
+// Tasks are merged from the vehicle and common lists in priority
+// order, in the same way as run()
+void AP_Scheduler::get_task_names(const char **names) const
+{
+    uint8_t vehicle_tasks_offset = 0;
+    uint8_t common_tasks_offset = 0;
+
+    for (uint8_t i = 0; i < _num_tasks; i++) {
+        // In case of a tie the vehicle-specific entry wins.
+        bool vehicle_task;
+        if (vehicle_tasks_offset < _num_vehicle_tasks &&
+            common_tasks_offset < _num_common_tasks) {
+            vehicle_task = _vehicle_tasks[vehicle_tasks_offset].priority <= _common_tasks[common_tasks_offset].priority;
+        } else {
+            vehicle_task = vehicle_tasks_offset < _num_vehicle_tasks;
+        }
+        names[i] = vehicle_task ? _vehicle_tasks[vehicle_tasks_offset++].name : _common_tasks[common_tasks_offset++].name;
+    }
+}
+
 // display task statistics as text buffer for @SYS/tasks.txt
 void AP_Scheduler::task_info(ExpandingString &str)
 {
     // a header to allow for machine parsers to determine format
     str.printf("TasksV2\n");
 
-    // dynamically enable statistics collection
+    // dynamically enable statistics collection. The task trace is
+    // enabled separately with SCHED_OPTIONS and is shown whether or
+    // not statistics are being collected
     if (!(_options & uint8_t(Options::RECORD_TASK_INFO))) {
         _options.set(_options | uint8_t(Options::RECORD_TASK_INFO));
-        return;
     }
 
-    if (perf_info.get_task_info(0) == nullptr) {
+    // task names are looked up once per read rather than per line
+    const char **names = new const char *[_num_tasks];
+    if (names == nullptr) {
         return;
     }
+    get_task_names(names);
+
+    if (perf_info.get_task_info(0) != nullptr) {
+        task_stats_info(str, names);
+    }
 
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    task_trace_info(str, names);
+#endif
+
+    delete[] names;
+}
+
+// display per-task statistics and latency histograms
+void AP_Scheduler::task_stats_info(ExpandingString &str, const char * const *names)
+{
     // baseline the total time taken by all tasks
     float total_time = 1.0f;
     for (uint8_t i = 0; i < _num_tasks + 1; i++) {
@@ -490,46 +611,54 @@ void AP_Scheduler::task_info(ExpandingString &str)
         }
     }
 
-    uint8_t vehicle_tasks_offset = 0;
-    uint8_t common_tasks_offset = 0;
-
     for (uint8_t i = 0; i < _num_tasks; i++) {
         const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
-        const char *task_name;
-
-        // determine which of the common task / vehicle task to run
-        bool run_vehicle_task = false;
-        if (vehicle_tasks_offset < _num_vehicle_tasks &&
-            common_tasks_offset < _num_common_tasks) {
-            // still have entries on both lists; compare the
-            // priorities.  In case of a tie the vehicle-specific
-            // entry wins.
-            const Task &vehicle_task = _vehicle_tasks[vehicle_tasks_offset];
-            const Task &common_task = _common_tasks[common_tasks_offset];
-            if (vehicle_task.priority <= common_task.priority) {
-                run_vehicle_task = true;
-            }
-        } else if (vehicle_tasks_offset < _num_vehicle_tasks) {
-            // out of common tasks to run
-            run_vehicle_task = true;
-        } else if (common_tasks_offset < _num_common_tasks) {
-            // out of vehicle tasks to run
-            run_vehicle_task = false;
-        } else {
-            // this is an error; the outside loop should have terminated
-            INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
-            return;
-        }
+        ti->print(names[i], total_time, str);
+    }
 
-        if (run_vehicle_task) {
-            task_name = _vehicle_tasks[vehicle_tasks_offset++].name;
-        } else {
-            task_name = _common_tasks[common_tasks_offset++].name;
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    // latency histograms for the main loop and each task that has run
+#if AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
+    const char* name_fmt = "%-32.32s";
+#else
+    const char* name_fmt = "%-16.16s";
+#endif
+    str.printf("\nLatencyHistogram\n");
+    str.printf(name_fmt, "");
+    AP::PerfInfo::LatencyHistogram::print_header(str);
+    str.printf(name_fmt, "Loop");
+    perf_info.get_loop_histogram().print(str);
+    for (uint8_t i = 0; i < _num_tasks; i++) {
+        const AP::PerfInfo::TaskInfo* ti = perf_info.get_task_info(i);
+        if (ti == nullptr || ti->tick_count == 0) {
+            continue;
         }
+        str.printf(name_fmt, names[i]);
+        ti->histogram.print(str);
+    }
+#endif
+}
 
-        ti->print(task_name, total_time, str);
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+// display the task trace ring buffer, oldest first
+void AP_Scheduler::task_trace_info(ExpandingString &str, const char * const *names)
+{
+    if (!perf_info.has_task_trace()) {
+        return;
+    }
+    str.printf("\nTaskTrace\n");
+    for (uint8_t i = 0; i < perf_info.get_num_task_trace(); i++) {
+        const AP::PerfInfo::TaskTrace *tt = perf_info.get_task_trace(i);
+        str.printf("%10u %10u %5u %3u%s %s\n",
+                   unsigned(tt->start_us),
+                   unsigned(tt->start_us + tt->time_us),
+                   unsigned(tt->time_us),
+                   unsigned(tt->task_index),
+                   tt->overrun ? "*" : " ",
+                   tt->task_index < _num_tasks ? names[tt->task_index] : "?");
     }
 }
+#endif
 
 namespace AP {
 
@@ -91,7 +91,8 @@ public:
     };
 
     enum class Options : uint8_t {
-        RECORD_TASK_INFO = 1 << 0
+        RECORD_TASK_INFO = 1 << 0,
+        RECORD_TASK_TRACE = 1 << 1,
     };
 
     enum FastTaskPriorities {
@@ -114,6 +115,16 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    // write out main loop time histogram to logger
+    void Log_Write_Loop_Histogram();
+#endif
+
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    // write out the traced tasks which ran between the given times
+    void Log_Write_Task_Trace(uint32_t loop_start_us, uint32_t loop_end_us);
+#endif
+
     // call when one tick has passed
     void tick(void);
 
@@ -200,6 +211,23 @@ private:
 
     // scheduler options
     AP_Int8 _options;
+
+    // fill names with the name of each task in the combined task list
+    void get_task_names(const char **names) const;
+
+    // print per-task statistics and latency histograms for @SYS/tasks.txt
+    void task_stats_info(ExpandingString &str, const char * const *names);
+
+    // allocate or free per-task statistics based on _options
+    void update_task_stats_allocation();
+
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    // print the task trace ring buffer for @SYS/tasks.txt
+    void task_trace_info(ExpandingString &str, const char * const *names);
+
+    // time we last wrote a task trace to the log
+    uint32_t _last_task_trace_log_ms;
+#endif
     
     // calculated loop period in usec
     uint16_t _loop_period_us;
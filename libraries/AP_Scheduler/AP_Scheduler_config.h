@@ -9,3 +9,18 @@
 #ifndef AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED
 #define AP_SCHEDULER_EXTENDED_TASKINFO_ENABLED 1
 #endif
+
+// log2-bucketed latency histograms for each task and the main loop
+#ifndef AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+#define AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED BOARD_FLASH_SIZE > 1024
+#endif
+
+// ring-buffered trace of task start/end times, dumped on long loops
+#ifndef AP_SCHEDULER_TASK_TRACE_ENABLED
+#define AP_SCHEDULER_TASK_TRACE_ENABLED BOARD_FLASH_SIZE > 1024
+#endif
+
+// number of task runs kept in the trace ring buffer
+#ifndef AP_SCHEDULER_TASK_TRACE_SIZE
+#define AP_SCHEDULER_TASK_TRACE_SIZE 64
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <AP_Logger/LogStructure.h>
+#include "AP_Scheduler_config.h"
+
+#define LOG_IDS_FROM_SCHEDULER \
+    LOG_SCHED_TRACE_MSG, \
+    LOG_SCHED_HIST_MSG
+
+// @LoggerMessage: SCHT
+// @Description: Scheduler task trace, written for each task run in a loop that took longer than the overtime threshold
+// @Field: TimeUS: Time the task started
+// @Field: Ofs: Time from the start of the loop to the start of the task
+// @Field: T: Time taken by the task
+// @Field: LT: Total time taken by the loop
+// @Field: Id: Index of the task in the scheduler task table
+// @Field: Ovr: True if the task exceeded its allowed time
+
+struct PACKED log_SchedTrace {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t offset_us;
+    uint16_t task_time_us;
+    uint16_t loop_time_us;
+    uint8_t task_index;
+    uint8_t overrun;
+};
+
+// @LoggerMessage: SCHH
+// @Description: Scheduler main loop time histogram. Bucket 0 counts loops shorter than 8us, each following bucket counts loops up to double the limit of the previous bucket and B11 counts loops of 8192us or more
+// @Field: TimeUS: Time since system startup
+// @Field: B0: Loops shorter than 8us
+// @Field: B1: Loops shorter than 16us
+// @Field: B2: Loops shorter than 32us
+// @Field: B3: Loops shorter than 64us
+// @Field: B4: Loops shorter than 128us
+// @Field: B5: Loops shorter than 256us
+// @Field: B6: Loops shorter than 512us
+// @Field: B7: Loops shorter than 1024us
+// @Field: B8: Loops shorter than 2048us
+// @Field: B9: Loops shorter than 4096us
+// @Field: B10: Loops shorter than 8192us
+// @Field: B11: Loops of 8192us or longer
+
+struct PACKED log_SchedHist {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint16_t counts[12];
+};
+
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+#define LOG_STRUCTURE_FROM_SCHEDULER_TRACE \
+    { LOG_SCHED_TRACE_MSG, sizeof(log_SchedTrace), \
+      "SCHT", "QHHHBB", "TimeUS,Ofs,T,LT,Id,Ovr", "ssss--", "FFFF--" },
+#else
+#define LOG_STRUCTURE_FROM_SCHEDULER_TRACE
+#endif
+
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+#define LOG_STRUCTURE_FROM_SCHEDULER_HIST \
+    { LOG_SCHED_HIST_MSG, sizeof(log_SchedHist), \
+      "SCHH", "QHHHHHHHHHHHH", "TimeUS,B0,B1,B2,B3,B4,B5,B6,B7,B8,B9,B10,B11", "s------------", "F------------" },
+#else
+#define LOG_STRUCTURE_FROM_SCHEDULER_HIST
+#endif
+
+#define LOG_STRUCTURE_FROM_SCHEDULER \
+    LOG_STRUCTURE_FROM_SCHEDULER_TRACE \
+    LOG_STRUCTURE_FROM_SCHEDULER_HIST
@@ -25,6 +25,9 @@ void AP::PerfInfo::reset()
     if (_task_info != nullptr) {
         memset(_task_info, 0, (_num_tasks) * sizeof(TaskInfo));
     }
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    memset(&loop_histogram, 0, sizeof(loop_histogram));
+#endif
 }
 
 // ignore_loop - ignore this loop from performance measurements (used to reduce false positive when arming)
@@ -52,9 +55,54 @@ void AP::PerfInfo::free_task_info()
     _num_tasks = 0;
 }
 
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+// allocate the ring buffer used to trace task start and end times
+void AP::PerfInfo::allocate_task_trace()
+{
+    _task_trace = new TaskTrace[AP_SCHEDULER_TASK_TRACE_SIZE];
+    if (_task_trace == nullptr) {
+        DEV_PRINTF("Unable to allocate scheduler TaskTrace\n");
+    }
+    _task_trace_head = 0;
+    _task_trace_count = 0;
+}
+
+void AP::PerfInfo::free_task_trace()
+{
+    delete[] _task_trace;
+    _task_trace = nullptr;
+    _task_trace_head = 0;
+    _task_trace_count = 0;
+}
+
+// return a task trace entry, with index 0 being the oldest entry
+const AP::PerfInfo::TaskTrace* AP::PerfInfo::get_task_trace(uint8_t idx) const
+{
+    if (_task_trace == nullptr || idx >= _task_trace_count) {
+        return nullptr;
+    }
+    const uint8_t oldest = (_task_trace_head + AP_SCHEDULER_TASK_TRACE_SIZE - _task_trace_count) % AP_SCHEDULER_TASK_TRACE_SIZE;
+    return &_task_trace[(oldest + idx) % AP_SCHEDULER_TASK_TRACE_SIZE];
+}
+#endif  // AP_SCHEDULER_TASK_TRACE_ENABLED
+
 // called after each run of a task to update its statistics based on measurements taken by the scheduler
-void AP::PerfInfo::update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun)
+void AP::PerfInfo::update_task_info(uint8_t task_index, uint32_t task_start_us, uint16_t task_time_us, bool overrun)
 {
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    if (_task_trace != nullptr) {
+        TaskTrace &tt = _task_trace[_task_trace_head];
+        tt.start_us = task_start_us;
+        tt.time_us = task_time_us;
+        tt.task_index = task_index;
+        tt.overrun = overrun;
+        _task_trace_head = (_task_trace_head + 1) % AP_SCHEDULER_TASK_TRACE_SIZE;
+        if (_task_trace_count < AP_SCHEDULER_TASK_TRACE_SIZE) {
+            _task_trace_count++;
+        }
+    }
+#endif
+
     if (_task_info == nullptr) {
         return;
     }
@@ -80,8 +128,77 @@ void AP::PerfInfo::TaskInfo::update(uint16_t task_time_us, bool overrun)
     if (overrun) {
         overrun_count++;
     }
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    histogram.update(task_time_us);
+#endif
+}
+
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+void AP::PerfInfo::LatencyHistogram::update(uint32_t time_us)
+{
+    uint8_t bucket = 0;
+    if (time_us >= (1U<<MIN_SHIFT)) {
+        // index of the highest set bit gives log2 of the time
+        const uint8_t log2_time = 31 - __builtin_clz(time_us);
+        bucket = log2_time + 1 - MIN_SHIFT;
+        if (bucket >= NUM_BUCKETS) {
+            bucket = NUM_BUCKETS - 1;
+        }
+    }
+    if (counts[bucket] < UINT16_MAX) {
+        counts[bucket]++;
+    }
+}
+
+// exclusive upper limit of a bucket in microseconds, 0 for the unbounded last bucket
+uint32_t AP::PerfInfo::LatencyHistogram::bucket_limit_us(uint8_t bucket)
+{
+    if (bucket >= NUM_BUCKETS - 1) {
+        return 0;
+    }
+    return 1U << (bucket + MIN_SHIFT);
+}
+
+// return the upper limit of the bucket in which the given percentile
+// of samples falls. Returns 0 if there are no samples or the
+// percentile is in the unbounded last bucket
+uint32_t AP::PerfInfo::LatencyHistogram::get_percentile_us(uint8_t percent) const
+{
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < NUM_BUCKETS; i++) {
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const uint32_t target = (total * MIN(unsigned(percent), 100U) + 99U) / 100U;
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < NUM_BUCKETS; i++) {
+        sum += counts[i];
+        if (sum >= target) {
+            return bucket_limit_us(i);
+        }
+    }
+    return 0;
+}
+
+void AP::PerfInfo::LatencyHistogram::print_header(ExpandingString& str)
+{
+    for (uint8_t i = 0; i < NUM_BUCKETS - 1; i++) {
+        str.printf(" <%-4u", unsigned(bucket_limit_us(i)));
+    }
+    str.printf(" >=%-4u   P50   P99\n", unsigned(bucket_limit_us(NUM_BUCKETS - 2)));
 }
 
+void AP::PerfInfo::LatencyHistogram::print(ExpandingString& str) const
+{
+    for (uint8_t i = 0; i < NUM_BUCKETS; i++) {
+        str.printf(" %5u", unsigned(counts[i]));
+    }
+    str.printf(" %5u %5u\n", unsigned(get_percentile_us(50)), unsigned(get_percentile_us(99)));
+}
+#endif  // AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+
 void AP::PerfInfo::TaskInfo::print(const char* task_name, uint32_t total_time, ExpandingString& str) const
 {
     uint16_t avg = 0;
@@ -122,6 +239,9 @@ void AP::PerfInfo::check_loop_time(uint32_t time_in_micros)
     }
     sigma_time += time_in_micros;
     sigmasquared_time += time_in_micros * time_in_micros;
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    loop_histogram.update(time_in_micros);
+#endif
 
     /* we keep a filtered loop time for use as G_Dt which is the
        predicted time for the next loop. We remove really excessive
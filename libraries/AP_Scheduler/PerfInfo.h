@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <AP_Common/ExpandingString.h>
+#include "AP_Scheduler_config.h"
 
 namespace AP {
 
@@ -9,6 +10,29 @@ class PerfInfo {
 public:
     PerfInfo() {}
 
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    /*
+      log2 bucketed latency histogram. Bucket 0 holds times below
+      (1<<MIN_SHIFT) microseconds, each following bucket covers twice
+      the range of the previous one and the last bucket holds
+      everything longer
+     */
+    struct LatencyHistogram {
+        static constexpr uint8_t NUM_BUCKETS = 12;
+        static constexpr uint8_t MIN_SHIFT = 3;
+
+        uint16_t counts[NUM_BUCKETS];
+
+        void update(uint32_t time_us);
+        // exclusive upper limit of a bucket in microseconds, 0 for the last bucket
+        static uint32_t bucket_limit_us(uint8_t bucket);
+        // upper limit of the bucket containing the given percentile of samples
+        uint32_t get_percentile_us(uint8_t percent) const;
+        void print(ExpandingString& str) const;
+        static void print_header(ExpandingString& str);
+    };
+#endif
+
     // per-task timing information
     struct TaskInfo {
         uint16_t min_time_us;
@@ -17,11 +41,24 @@ public:
         uint32_t tick_count;
         uint16_t slip_count;
         uint16_t overrun_count;
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+        LatencyHistogram histogram;
+#endif
 
         void update(uint16_t task_time_us, bool overrun);
         void print(const char* task_name, uint32_t total_time, ExpandingString& str) const;
     };
 
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    // one entry in the task trace ring buffer
+    struct TaskTrace {
+        uint32_t start_us;
+        uint16_t time_us;
+        uint8_t task_index;
+        bool overrun;
+    };
+#endif
+
     /* Do not allow copies */
     CLASS_NO_COPY(PerfInfo);
 
@@ -34,6 +71,7 @@ public:
     uint16_t get_num_long_running() const;
     uint32_t get_avg_time() const;
     uint32_t get_stddev_time() const;
+    uint32_t get_overtime_threshold_us() const { return overtime_threshold_micros; }
     float    get_filtered_time() const;
     float get_filtered_loop_rate_hz() const;
     void set_loop_rate(uint16_t rate_hz);
@@ -50,7 +88,7 @@ public:
         return (_task_info && task_index < _num_tasks) ? &_task_info[task_index] : nullptr;
     }
     // called after each run of a task to update its statistics based on measurements taken by the scheduler
-    void update_task_info(uint8_t task_index, uint16_t task_time_us, bool overrun);
+    void update_task_info(uint8_t task_index, uint32_t task_start_us, uint16_t task_time_us, bool overrun);
     // record that a task slipped
     void task_slipped(uint8_t task_index) {
         if (_task_info && task_index < _num_tasks) {
@@ -58,6 +96,22 @@ public:
         }
     }
 
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    // histogram of main loop times
+    const LatencyHistogram &get_loop_histogram() const { return loop_histogram; }
+#endif
+
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    // allocate the task trace ring buffer
+    void allocate_task_trace();
+    void free_task_trace();
+    bool has_task_trace() const { return _task_trace != nullptr; }
+    // number of entries currently held in the trace
+    uint8_t get_num_task_trace() const { return _task_trace_count; }
+    // return a trace entry, 0 being the oldest
+    const TaskTrace* get_task_trace(uint8_t idx) const;
+#endif
+
 private:
     uint16_t loop_rate_hz;
     uint16_t overtime_threshold_micros;
@@ -73,6 +127,14 @@ private:
     // performance monitoring
     uint8_t _num_tasks;
     TaskInfo* _task_info;
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    LatencyHistogram loop_histogram;
+#endif
+#if AP_SCHEDULER_TASK_TRACE_ENABLED
+    TaskTrace* _task_trace;
+    uint8_t _task_trace_head;
+    uint8_t _task_trace_count;
+#endif
 };
 
 };
@@ -94,6 +94,7 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @Bitmask: 3: log runtime memory usage and execution time
     // @Bitmask: 4: Disable pre-arm check
     // @Bitmask: 5: Save CRC of current scripts to loaded and running checksum parameters enabling pre-arm
+    // @Bitmask: 6: log CPU time used by each script every 10 seconds
     // @User: Advanced
     AP_GROUPINFO("DEBUG_OPTS", 4, AP_Scripting, _debug_options, 0),
 
@@ -160,6 +161,64 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
     // @RebootRequired: True
     // @User: Advanced
     AP_GROUPINFO("THD_PRIORITY", 14, AP_Scripting, _thd_priority, uint8_t(ThreadPriority::NORMAL)),
+
+    // @Param: FAIR_SHARE
+    // @DisplayName: Scripting fair share
+    // @Description: When more than one script is due to run, run the one that has used the least CPU time first instead of the one that has been due longest, so a script that takes a long time to run cannot hold up the others. CPU time is divided by each script's weight, which is 1 unless set with SCR_FS_CRC and SCR_FS_WGT
+    // @Values: 0:Disabled, 1:Enabled
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("FAIR_SHARE", 16, AP_Scripting, _fair_share, 0),
+
+    // @Param: FS_CRC1
+    // @DisplayName: Fair share script checksum 1
+    // @Description: CRC32 checksum of the script given the weight SCR_FS_WGT1 when SCR_FAIR_SHARE is enabled, as listed in @SYS/scripts.txt. Only the lower 23 bits are compared. -1 disables
+    // @User: Advanced
+    AP_GROUPINFO("FS_CRC1", 17, AP_Scripting, _fair_share_crc[0], -1),
+
+    // @Param: FS_WGT1
+    // @DisplayName: Fair share weight 1
+    // @Description: Share of the scripting thread given to the script with checksum SCR_FS_CRC1 when SCR_FAIR_SHARE is enabled. Its CPU time is divided by this weight, so a script with weight 2 can use twice the time of a script with the default weight of 1 before it waits for the others
+    // @Range: 1 100
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("FS_WGT1", 18, AP_Scripting, _fair_share_weight[0], 1),
+
+    // @Param: FS_CRC2
+    // @CopyFieldsFrom: SCR_FS_CRC1
+    // @DisplayName: Fair share script checksum 2
+    // @Description: CRC32 checksum of the script given the weight SCR_FS_WGT2 when SCR_FAIR_SHARE is enabled, as listed in @SYS/scripts.txt. Only the lower 23 bits are compared. -1 disables
+    AP_GROUPINFO("FS_CRC2", 19, AP_Scripting, _fair_share_crc[1], -1),
+
+    // @Param: FS_WGT2
+    // @CopyFieldsFrom: SCR_FS_WGT1
+    // @DisplayName: Fair share weight 2
+    // @Description: Share of the scripting thread given to the script with checksum SCR_FS_CRC2 when SCR_FAIR_SHARE is enabled
+    AP_GROUPINFO("FS_WGT2", 20, AP_Scripting, _fair_share_weight[1], 1),
+
+    // @Param: FS_CRC3
+    // @CopyFieldsFrom: SCR_FS_CRC1
+    // @DisplayName: Fair share script checksum 3
+    // @Description: CRC32 checksum of the script given the weight SCR_FS_WGT3 when SCR_FAIR_SHARE is enabled, as listed in @SYS/scripts.txt. Only the lower 23 bits are compared. -1 disables
+    AP_GROUPINFO("FS_CRC3", 21, AP_Scripting, _fair_share_crc[2], -1),
+
+    // @Param: FS_WGT3
+    // @CopyFieldsFrom: SCR_FS_WGT1
+    // @DisplayName: Fair share weight 3
+    // @Description: Share of the scripting thread given to the script with checksum SCR_FS_CRC3 when SCR_FAIR_SHARE is enabled
+    AP_GROUPINFO("FS_WGT3", 22, AP_Scripting, _fair_share_weight[2], 1),
+
+    // @Param: FS_CRC4
+    // @CopyFieldsFrom: SCR_FS_CRC1
+    // @DisplayName: Fair share script checksum 4
+    // @Description: CRC32 checksum of the script given the weight SCR_FS_WGT4 when SCR_FAIR_SHARE is enabled, as listed in @SYS/scripts.txt. Only the lower 23 bits are compared. -1 disables
+    AP_GROUPINFO("FS_CRC4", 23, AP_Scripting, _fair_share_crc[3], -1),
+
+    // @Param: FS_WGT4
+    // @CopyFieldsFrom: SCR_FS_WGT1
+    // @DisplayName: Fair share weight 4
+    // @Description: Share of the scripting thread given to the script with checksum SCR_FS_CRC4 when SCR_FAIR_SHARE is enabled
+    AP_GROUPINFO("FS_WGT4", 24, AP_Scripting, _fair_share_weight[3], 1),
     
     AP_GROUPEND
 };
@@ -445,6 +504,24 @@ void AP_Scripting::restart_all()
     _stop = true;
 }
 
+// print per-script CPU statistics for @SYS/scripts.txt
+void AP_Scripting::scripts_info(ExpandingString &str)
+{
+    lua_scripts::scripts_info(str);
+}
+
+// fair share weight of the script with the given checksum, set by the operator with SCR_FS_CRC and SCR_FS_WGT
+uint8_t AP_Scripting::fair_share_weight(uint32_t crc) const
+{
+    for (uint8_t i = 0; i < ARRAY_SIZE(_fair_share_crc); i++) {
+        if ((_fair_share_crc[i] != -1) &&
+            (((uint32_t)_fair_share_crc[i].get() & checksum_param_mask) == (crc & checksum_param_mask))) {
+            return constrain_int16(_fair_share_weight[i].get(), 1, 100);
+        }
+    }
+    return 1;
+}
+
 #if HAL_GCS_ENABLED
 void AP_Scripting::handle_message(const mavlink_message_t &msg, const mavlink_channel_t chan) {
     if (mavlink_data.rx_buffer == nullptr) {
@@ -18,6 +18,7 @@
 
 #include <GCS_MAVLink/GCS_config.h>
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/ExpandingString.h>
 #include <AP_Param/AP_Param.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_Mission/AP_Mission.h>
@@ -32,6 +33,8 @@
 
 #define SCRIPTING_MAX_NUM_PWM_SOURCE 4
 
+#define SCRIPTING_NUM_FAIR_SHARE_WEIGHTS 4
+
 #if AP_NETWORKING_ENABLED
 #ifndef SCRIPTING_MAX_NUM_NET_SOCKET
 #define SCRIPTING_MAX_NUM_NET_SOCKET 50
@@ -90,6 +93,18 @@ public:
     };
     uint16_t get_disabled_dir() { return uint16_t(_dir_disable.get());}
 
+    bool fair_share_enabled() const { return _fair_share != 0; }
+
+    // print per-script CPU statistics for @SYS/scripts.txt
+    void scripts_info(ExpandingString &str);
+
+    // fair share weight of the script with the given checksum
+    uint8_t fair_share_weight(uint32_t crc) const;
+
+    // Mask down to 23 bits for comparison with parameters, this the length of the a float mantissa, to deal with the float transport of parameters over MAVLink
+    // The full range of uint32 integers cannot be represented by a float.
+    static const uint32_t checksum_param_mask = 0x007FFFFF;
+
     // the number of and storage for i2c devices
     uint8_t num_i2c_devices;
     AP_HAL::OwnPtr<AP_HAL::I2CDevice> *_i2c_dev[SCRIPTING_MAX_NUM_I2C_DEVICE];
@@ -154,10 +169,6 @@ private:
     // Check if DEBUG_OPTS bit has been set to save current checksum values to params
     void save_checksum();
 
-    // Mask down to 23 bits for comparison with parameters, this the length of the a float mantissa, to deal with the float transport of parameters over MAVLink
-    // The full range of uint32 integers cannot be represented by a float.
-    const uint32_t checksum_param_mask = 0x007FFFFF;
-
     enum class ThreadPriority : uint8_t {
         NORMAL = 0,
         IO = 1,
@@ -180,6 +191,10 @@ private:
 
     AP_Enum<ThreadPriority> _thd_priority;
 
+    AP_Int8 _fair_share;
+    AP_Int32 _fair_share_crc[SCRIPTING_NUM_FAIR_SHARE_WEIGHTS];
+    AP_Int8 _fair_share_weight[SCRIPTING_NUM_FAIR_SHARE_WEIGHTS];
+
     bool _thread_failed; // thread allocation failed
     bool _init_failed;  // true if memory allocation failed
     bool _restart; // true if scripts should be restarted
@@ -40,15 +40,27 @@ uint32_t lua_scripts::loaded_checksum;
 uint32_t lua_scripts::running_checksum;
 HAL_Semaphore lua_scripts::crc_sem;
 
+lua_scripts *lua_scripts::stats_instance;
+HAL_Semaphore lua_scripts::stats_sem;
+
 lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_options, struct AP_Scripting::terminal_s &_terminal)
     : _vm_steps(vm_steps),
       _debug_options(debug_options),
      terminal(_terminal)
 {
     _heap.create(heap_size, 4);
+
+    WITH_SEMAPHORE(stats_sem);
+    stats_instance = this;
 }
 
 lua_scripts::~lua_scripts() {
+    {
+        WITH_SEMAPHORE(stats_sem);
+        if (stats_instance == this) {
+            stats_instance = nullptr;
+        }
+    }
     _heap.destroy();
 }
 
@@ -127,6 +139,19 @@ int lua_scripts::atpanic(lua_State *L) {
     return 0;
 }
 
+#if HAL_LOGGING_ENABLED
+// copy a script name to a log field, dropping the directory if the name is too long
+static void copy_log_name(char *dest, size_t len, const char *name)
+{
+    const char * name_short = strrchr(name, '/');
+    if ((strlen(name) > len) && (name_short != nullptr)) {
+        strncpy_noterm(dest, name_short+1, len);
+    } else {
+        strncpy_noterm(dest, name, len);
+    }
+}
+#endif // HAL_LOGGING_ENABLED
+
 // helper for print and log of runtime stats
 void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem)
 {
@@ -146,18 +171,137 @@ void lua_scripts::update_stats(const char *name, uint32_t run_time, int total_me
             total_mem    : total_mem,
             run_mem      : run_mem
         };
-        const char * name_short = strrchr(name, '/');
-        if ((strlen(name) > sizeof(pkt.name)) && (name_short != nullptr)) {
-            strncpy_noterm(pkt.name, name_short+1, sizeof(pkt.name));
-        } else {
-            strncpy_noterm(pkt.name, name, sizeof(pkt.name));
-        }
+        copy_log_name(pkt.name, sizeof(pkt.name), name);
         AP::logger().WriteBlock(&pkt, sizeof(pkt));
     }
 #endif // HAL_LOGGING_ENABLED
 }
 
+// update CPU statistics after a script has run
+void lua_scripts::update_script_stats(script_info *script, uint32_t run_time_us)
+{
+    WITH_SEMAPHORE(stats_sem);
+    script->run_count++;
+    script->run_time_us += run_time_us;
+    script->fair_share_time_us += run_time_us / MAX(script->fair_share_weight, 1U);
+    script->max_run_time_us = MAX(script->max_run_time_us, run_time_us);
+    script->period_max_run_time_us = MAX(script->period_max_run_time_us, run_time_us);
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    script->period_histogram.update(run_time_us);
+#endif
+}
+
+#if HAL_LOGGING_ENABLED && AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+// percentile of a script's run times in the current statistics period. The
+// last histogram bucket has no upper limit, so the longest run is used there
+static uint32_t period_percentile_us(const AP::PerfInfo::LatencyHistogram &histogram, uint8_t percent, uint32_t max_run_time_us)
+{
+    const uint32_t time_us = histogram.get_percentile_us(percent);
+    return (time_us != 0) ? time_us : max_run_time_us;
+}
+#endif
+
+// end the current statistics period, logging CPU statistics of each script if enabled
+void lua_scripts::end_stats_period()
+{
+    WITH_SEMAPHORE(stats_sem);
+
+    const uint32_t now_ms = AP_HAL::millis();
+#if HAL_LOGGING_ENABLED
+    const uint32_t period_ms = now_ms - _stats_period_start_ms;
+    const bool log_stats = (_debug_options.get() & uint8_t(DebugLevel::LOG_STATS)) != 0;
+#endif
+    _stats_period_start_ms = now_ms;
+
+    for (script_info *script = scripts; script != nullptr; script = script->next) {
+#if HAL_LOGGING_ENABLED
+        if (log_stats) {
+            log_script_stats(script, script->run_count - script->period_start_run_count,
+                             script->run_time_us - script->period_start_run_time_us, period_ms);
+        }
+#endif
+
+        // start the next period
+        script->period_start_run_count = script->run_count;
+        script->period_start_run_time_us = script->run_time_us;
+        script->period_max_run_time_us = 0;
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+        script->last_period_histogram = script->period_histogram;
+        script->period_histogram = {};
+#endif
+    }
+}
+
+#if HAL_LOGGING_ENABLED
+// log CPU statistics of a script for the period that has just ended
+void lua_scripts::log_script_stats(const script_info *script, uint32_t runs, uint32_t run_time_us, uint32_t period_ms)
+{
+    struct log_ScriptStats pkt {
+        LOG_PACKET_HEADER_INIT(LOG_SCRIPT_STATS_MSG),
+        time_us      : AP_HAL::micros64(),
+        name         : {},
+        runs         : runs,
+        run_time     : run_time_us,
+        max_time     : script->max_run_time_us,
+        pct          : (period_ms > 0) ? (run_time_us * 0.1f / period_ms) : 0.0f,
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+        p50_time     : period_percentile_us(script->period_histogram, 50, script->period_max_run_time_us),
+        p99_time     : period_percentile_us(script->period_histogram, 99, script->period_max_run_time_us),
+#else
+        p50_time     : 0,
+        p99_time     : 0,
+#endif
+    };
+    copy_log_name(pkt.name, sizeof(pkt.name), script->name);
+    AP::logger().WriteBlock(&pkt, sizeof(pkt));
+}
+#endif // HAL_LOGGING_ENABLED
+
+// print per-script CPU statistics for @SYS/scripts.txt
+void lua_scripts::scripts_info(ExpandingString &str)
+{
+    WITH_SEMAPHORE(stats_sem);
+
+    // a header to allow for machine parsers to determine format
+    str.printf("ScriptsV1\n");
+
+    if (stats_instance == nullptr) {
+        return;
+    }
+
+    // baseline the total time taken by all scripts
+    uint64_t total_time_us = 1;
+    for (const script_info *script = stats_instance->scripts; script != nullptr; script = script->next) {
+        total_time_us += script->run_time_us;
+    }
+
+    for (const script_info *script = stats_instance->scripts; script != nullptr; script = script->next) {
+        const char *name = strrchr(script->name, '/');
+        name = (name != nullptr) ? name + 1 : script->name;
+        const uint32_t avg = (script->run_count > 0) ? (script->run_time_us / script->run_count) : 0;
+        str.printf("%-24.24s RUNS=%7u AVG=%6u MAX=%6u TIME=%8ums, TOT=%4.1f%% CRC=%u WGT=%u\n", name,
+                   unsigned(script->run_count), unsigned(avg), unsigned(script->max_run_time_us),
+                   unsigned(script->run_time_us / 1000U), script->run_time_us * 100.0f / total_time_us,
+                   unsigned(script->crc & AP_Scripting::checksum_param_mask), unsigned(script->fair_share_weight));
+    }
+
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+    // run time histograms of each script over the last statistics period
+    str.printf("\nRunTimeHistogram (last %us)\n", unsigned(stats_period_ms / 1000U));
+    str.printf("%-24.24s", "");
+    AP::PerfInfo::LatencyHistogram::print_header(str);
+    for (const script_info *script = stats_instance->scripts; script != nullptr; script = script->next) {
+        const char *name = strrchr(script->name, '/');
+        str.printf("%-24.24s", (name != nullptr) ? name + 1 : script->name);
+        script->last_period_histogram.print(str);
+    }
+#endif
+}
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
+    const int loadMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    const uint32_t loadStart = AP_HAL::micros();
+
     if (int error = luaL_loadfile(L, filename)) {
         switch (error) {
             case LUA_ERRSYNTAX:
@@ -179,9 +323,6 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
         }
     }
 
-    const int loadMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-    const uint32_t loadStart = AP_HAL::micros();
-
     script_info *new_script = (script_info *)_heap.allocate(sizeof(script_info));
     if (new_script == nullptr) {
         // No memory, shouldn't happen, we even attempted to do a GC
@@ -194,10 +335,14 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
     create_sandbox(L);
     lua_setupvalue(L, -2, 1);
 
+    // time and memory used to compile the script and create its sandbox
     const uint32_t loadEnd = AP_HAL::micros();
     const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
 
-    update_stats(filename, loadEnd-loadStart, endMem, loadMem);
+    if ((_debug_options.get() & uint8_t(DebugLevel::RUNTIME_MSG)) != 0) {
+        GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Loaded %s", filename);
+    }
+    update_stats(filename, loadEnd-loadStart, endMem, endMem-loadMem);
 
     new_script->name = filename;
     new_script->lua_ref = luaL_ref(L, LUA_REGISTRYINDEX);   // cache the reference
@@ -216,6 +361,9 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
         }
     }
 
+    // the operator sets the share of the scripting thread by checksum
+    new_script->fair_share_weight = AP_Scripting::get_singleton()->fair_share_weight(new_script->crc);
+
     return new_script;
 }
 
@@ -282,12 +430,30 @@ void lua_scripts::load_all_scripts_in_dir(lua_State *L, const char *dirname) {
         }
         snprintf(filename, size, "%s/%s", dirname, de->d_name);
 
+        // make room in the run queues first, they don't grow once scripts are running
+        const uint16_t num_scripts = _waiting.size() + 1;
+        if (!_waiting.reserve(num_scripts) || !_ready.reserve(num_scripts)) {
+            set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "Insufficent memory loading %s", filename);
+            _heap.deallocate(filename);
+            continue;
+        }
+
         // we have something that looks like a lua file, attempt to load it
         script_info * script = load_script(L, filename);
         if (script == nullptr) {
             _heap.deallocate(filename);
             continue;
         }
+
+        {
+            // add to the end of the list of loaded scripts
+            WITH_SEMAPHORE(stats_sem);
+            script_info **tail = &scripts;
+            while (*tail != nullptr) {
+                tail = &(*tail)->next;
+            }
+            *tail = script;
+        }
         reschedule_script(script);
 
 #if HAL_LOGGER_FILE_CONTENTS_ENABLED
@@ -306,8 +472,42 @@ void lua_scripts::reset_loop_overtime(lua_State *L) {
     lua_sethook(L, hook, LUA_MASKCOUNT, vm_steps);
 }
 
-void lua_scripts::run_next_script(lua_State *L) {
-    if (scripts == nullptr) {
+// return the script that should run next, nullptr if no scripts are loaded
+lua_scripts::script_info *lua_scripts::next_script(uint64_t now_ms) {
+    if (_fair_share) {
+        // move the scripts that are due to the ready queue
+        for (script_info *script = _waiting.top(); (script != nullptr) && (script->next_run_ms <= now_ms); script = _waiting.top()) {
+            _waiting.pop();
+            // don't let a script bank CPU time while it was not due
+            script->fair_share_time_us = MAX(script->fair_share_time_us, _fair_share_min_us);
+            _ready.push(script);
+        }
+        if (_ready.top() != nullptr) {
+            return _ready.top();
+        }
+    }
+    return _waiting.top();
+}
+
+// take a script out of the run queues
+void lua_scripts::dequeue_script(script_info *script) {
+    if (_ready.remove(script)) {
+        // the ready queue is run in order of CPU time used, so this is the least of the queue
+        _fair_share_min_us = MAX(_fair_share_min_us, script->fair_share_time_us);
+    } else {
+        _waiting.remove(script);
+    }
+}
+
+bool lua_scripts::fair_share_before(const script_info *a, const script_info *b) {
+    if (a->fair_share_time_us != b->fair_share_time_us) {
+        return a->fair_share_time_us < b->fair_share_time_us;
+    }
+    return runs_before(a, b);
+}
+
+void lua_scripts::run_next_script(lua_State *L, script_info *script) {
+    if (script == nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         AP_HAL::panic("Lua: Attempted to run a script without any scripts queued");
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
@@ -315,9 +515,8 @@ void lua_scripts::run_next_script(lua_State *L) {
     }
 
     uint64_t start_time_ms = AP_HAL::millis64();
-    // strip the selected script out of the list
-    script_info *script = scripts;
-    scripts = script->next;
+    // strip the selected script out of the run queues
+    dequeue_script(script);
 
     // reset the hook to clear the counter
     reset_loop_overtime(L);
@@ -329,7 +528,18 @@ void lua_scripts::run_next_script(lua_State *L) {
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->lua_ref);
     AP::scripting()->set_current_ref(script->lua_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    const uint32_t startUs = AP_HAL::micros();
+
+    const int error = lua_pcall(L, 0, LUA_MULTRET, 0);
+
+    // record stats now, the script is freed if it is removed
+    const uint32_t runTime = AP_HAL::micros() - startUs;
+    const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    update_stats(script->name, runTime, endMem, endMem - startMem);
+    update_script_stats(script, runTime);
+
+    if (error) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
             set_and_print_new_error_message(MAV_SEVERITY_CRITICAL, "%s exceeded time limit", script->name);
@@ -388,15 +598,15 @@ void lua_scripts::remove_script(lua_State *L, script_info *script) {
         return;
     }
 
-    // ensure that the script isn't in the loaded list for any reason
-    if (scripts == nullptr) {
-        // nothing to do, already not in the list
-    } else if (scripts == script) {
-        scripts = script->next;
-    } else {
-        for(script_info * current = scripts; current->next != nullptr; current = current->next) {
-            if (current->next == script) {
-                current->next = script->next;
+    // ensure that the script isn't queued to run for any reason
+    dequeue_script(script);
+
+    {
+        // remove from the list of loaded scripts
+        WITH_SEMAPHORE(stats_sem);
+        for (script_info **current = &scripts; *current != nullptr; current = &(*current)->next) {
+            if (*current == script) {
+                *current = script->next;
                 break;
             }
         }
@@ -424,31 +634,115 @@ void lua_scripts::reschedule_script(script_info *script) {
        return;
     }
 
-    script->next = nullptr;
-    if (scripts == nullptr) {
-        scripts = script;
-        return;
+    if (!_waiting.push(script)) {
+        // room is reserved for every script as it is loaded
+#if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
+        AP_HAL::panic("Lua: Script run queue is full");
+#endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
     }
+}
 
-    uint64_t next_run_ms = script->next_run_ms;
+// make room for at least n scripts, returns false if memory could not be allocated
+bool lua_scripts::script_queue::reserve(uint16_t n) {
+    if (n <= capacity) {
+        return true;
+    }
+    // grow in steps to avoid reallocating as each script is loaded
+    const uint16_t new_capacity = MAX(n, capacity * 2U);
+    script_info **new_items = (script_info **)_heap.change_size(items, capacity * sizeof(script_info *), new_capacity * sizeof(script_info *));
+    if (new_items == nullptr) {
+        return false;
+    }
+    items = new_items;
+    capacity = new_capacity;
+    return true;
+}
 
-    if (scripts->next_run_ms > next_run_ms) {
-        script->next = scripts;
-        scripts = script;
-        return;
+void lua_scripts::script_queue::free_storage() {
+    _heap.deallocate(items);
+    items = nullptr;
+    count = 0;
+    capacity = 0;
+}
+
+// add a script, returns false if there is no room
+bool lua_scripts::script_queue::push(script_info *script) {
+    if (count >= capacity) {
+        return false;
     }
+    items[count] = script;
+    sift_up(count++);
+    return true;
+}
 
-    script_info *previous = scripts;
-    while (previous->next != nullptr) {
-        if (previous->next->next_run_ms > next_run_ms) {
-            script->next = previous->next;
-            previous->next = script;
-            return;
+lua_scripts::script_info *lua_scripts::script_queue::pop() {
+    if (count == 0) {
+        return nullptr;
+    }
+    script_info *script = items[0];
+    items[0] = items[--count];
+    sift_down(0);
+    return script;
+}
+
+// remove a script from anywhere in the queue, returns false if it was not queued
+bool lua_scripts::script_queue::remove(const script_info *script) {
+    for (uint16_t i = 0; i < count; i++) {
+        if (items[i] != script) {
+            continue;
+        }
+        // replace with the last script, which may belong above or below this position
+        items[i] = items[--count];
+        if (i < count) {
+            sift_up(i);
+            sift_down(i);
+        }
+        return true;
+    }
+    return false;
+}
+
+void lua_scripts::script_queue::sift_up(uint16_t idx) {
+    script_info *script = items[idx];
+    while (idx > 0) {
+        const uint16_t parent = (idx - 1) / 2;
+        if (!before(script, items[parent])) {
+            break;
+        }
+        items[idx] = items[parent];
+        idx = parent;
+    }
+    items[idx] = script;
+}
+
+void lua_scripts::script_queue::sift_down(uint16_t idx) {
+    script_info *script = items[idx];
+    while (true) {
+        const uint16_t left = 2 * idx + 1;
+        if (left >= count) {
+            break;
+        }
+        uint16_t child = left;
+        if ((left + 1 < count) && before(items[left + 1], items[left])) {
+            child = left + 1;
         }
-        previous = previous->next;
+        if (!before(items[child], script)) {
+            break;
+        }
+        items[idx] = items[child];
+        idx = child;
     }
+    items[idx] = script;
+}
 
-    previous->next = script;
+// check the heap order, for AP_SCRIPTING_CHECKS
+bool lua_scripts::script_queue::is_valid() const {
+    for (uint16_t i = 1; i < count; i++) {
+        if (before(items[i], items[(i - 1) / 2])) {
+            return false;
+        }
+    }
+    return true;
 }
 
 MultiHeap lua_scripts::_heap;
@@ -511,6 +805,9 @@ void lua_scripts::run(void) {
     lua_atpanic(L, atpanic);
     load_generated_bindings(L);
 
+    _fair_share = AP_Scripting::get_singleton()->fair_share_enabled();
+    _fair_share_min_us = 0;
+
 #ifndef HAL_CONSOLE_DISABLED
     const int loaded_mem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
     DEV_PRINTF("Lua: State memory usage: %i + %i\n", inital_mem, loaded_mem - inital_mem);
@@ -551,52 +848,42 @@ void lua_scripts::run(void) {
         }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
-        if (scripts != nullptr) {
+        script_info *script = next_script(AP_HAL::millis64());
+        if (script != nullptr) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
-              // Sanity check that the scripts list is ordered correctly
-              script_info *sanity = scripts;
-              while (sanity->next != nullptr) {
-                  if (sanity->next_run_ms > sanity->next->next_run_ms) {
-                      AP_HAL::panic("Lua: Script tasking order has been violated");
-                  }
-                  sanity = sanity->next;
-              }
+            // Sanity check that the run queues are ordered correctly
+            if (!_waiting.is_valid() || !_ready.is_valid()) {
+                AP_HAL::panic("Lua: Script tasking order has been violated");
+            }
 #endif // defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
 
             // compute delay time
             uint64_t now_ms = AP_HAL::millis64();
-            if (now_ms < scripts->next_run_ms) {
-                hal.scheduler->delay(scripts->next_run_ms - now_ms);
+            if (now_ms < script->next_run_ms) {
+                hal.scheduler->delay(script->next_run_ms - now_ms);
             }
 
             if ((_debug_options.get() & uint8_t(DebugLevel::RUNTIME_MSG)) != 0) {
-                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Running %s", scripts->name);
+                GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: Running %s", script->name);
             }
-            // copy name for logging, cant do it after as script reschedule moves the pointers
-            const char * script_name = scripts->name;
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             void *istate = hal.scheduler->disable_interrupts_save();
 #endif
 
-            const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-            const uint32_t loadEnd = AP_HAL::micros();
-
-            run_next_script(L);
-
-            const uint32_t runEnd = AP_HAL::micros();
-            const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+            run_next_script(L, script);
 
 #if DISABLE_INTERRUPTS_FOR_SCRIPT_RUN
             hal.scheduler->restore_interrupts(istate);
 #endif
 
-            update_stats(script_name, runEnd - loadEnd, endMem, endMem - startMem);
-
-
             // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
             lua_gc(L, LUA_GCCOLLECT, 0);
 
+            if (AP_HAL::millis() - _stats_period_start_ms >= stats_period_ms) {
+                end_stats_period();
+            }
+
         } else {
             if ((_debug_options.get() & uint8_t(DebugLevel::NO_SCRIPTS_TO_RUN)) != 0) {
                 GCS_SEND_TEXT(MAV_SEVERITY_DEBUG, "Lua: No scripts to run");
@@ -617,6 +904,8 @@ void lua_scripts::run(void) {
     while (scripts != nullptr) {
         remove_script(lua_state, scripts);
     }
+    _waiting.free_storage();
+    _ready.free_storage();
 
     if (lua_state != nullptr) {
         lua_close(lua_state); // shutdown the old state
@@ -27,6 +27,8 @@
 #include <GCS_MAVLink/GCS_MAVLink.h>
 #include <AP_HAL/Semaphores.h>
 #include <AP_Common/MultiHeap.h>
+#include <AP_Common/ExpandingString.h>
+#include <AP_Scheduler/PerfInfo.h>
 #include "lua_common_defs.h"
 
 #include "lua/src/lua.hpp"
@@ -55,8 +57,12 @@ public:
         LOG_RUNTIME = 1U << 3,
         DISABLE_PRE_ARM = 1U << 4,
         SAVE_CHECKSUM = 1U << 5,
+        LOG_STATS = 1U << 6,
     };
 
+    // print per-script CPU statistics for @SYS/scripts.txt
+    static void scripts_info(ExpandingString &str);
+
 private:
 
     void create_sandbox(lua_State *L);
@@ -67,16 +73,92 @@ private:
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        uint32_t crc;         // crc32 checksum
        char *name;           // filename for the script // FIXME: This information should be available from Lua
-       script_info *next;
+       script_info *next;    // next loaded script
+       uint64_t run_time_us; // total time spent running the script
+       uint64_t fair_share_time_us; // run time divided by weight, raised to the least of the ready queue when the script becomes due
+       uint8_t fair_share_weight;   // relative share of the scripting thread, from SCR_FS_WGT
+       uint32_t run_count;
+       uint32_t max_run_time_us;
+       uint32_t period_start_run_count;   // run count and time at the start of the current statistics period
+       uint64_t period_start_run_time_us;
+       uint32_t period_max_run_time_us;   // longest run in the current statistics period
+#if AP_SCHEDULER_LATENCY_HISTOGRAM_ENABLED
+       AP::PerfInfo::LatencyHistogram period_histogram;      // run times in the current statistics period
+       AP::PerfInfo::LatencyHistogram last_period_histogram; // run times in the last complete statistics period
+#endif
     } script_info;
 
+    /*
+      binary heap of scripts, ordered by a comparison function. Storage
+      is allocated from the scripting heap and only grows when reserved,
+      so scripts can be pushed while running without allocating
+     */
+    class script_queue {
+    public:
+        typedef bool (*before_fn)(const script_info *a, const script_info *b);
+
+        script_queue(before_fn _before) : before(_before) {}
+
+        CLASS_NO_COPY(script_queue);
+
+        // make room for at least n scripts, returns false if memory could not be allocated
+        bool reserve(uint16_t n);
+        void free_storage();
+
+        uint16_t size() const { return count; }
+        script_info *top() const { return (count > 0) ? items[0] : nullptr; }
+
+        // add a script, returns false if there is no room
+        bool push(script_info *script);
+        script_info *pop();
+
+        // remove a script from anywhere in the queue, returns false if it was not queued
+        bool remove(const script_info *script);
+
+        // check the heap order, for AP_SCRIPTING_CHECKS
+        bool is_valid() const;
+
+    private:
+        void sift_up(uint16_t idx);
+        void sift_down(uint16_t idx);
+
+        before_fn before;
+        script_info **items;
+        uint16_t count;
+        uint16_t capacity;
+    };
+
+    // scripts waiting to run are ordered by next run time, scripts that are due are ordered by
+    // the CPU time they have used when fair sharing is enabled
+    static bool runs_before(const script_info *a, const script_info *b) { return a->next_run_ms < b->next_run_ms; }
+    static bool fair_share_before(const script_info *a, const script_info *b);
+
     script_info *load_script(lua_State *L, char *filename);
 
     void reset_loop_overtime(lua_State *L);
 
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
 
-    void run_next_script(lua_State *L);
+    // return the script that should run next, nullptr if no scripts are loaded
+    script_info *next_script(uint64_t now_ms);
+
+    void run_next_script(lua_State *L, script_info *script);
+
+    // take a script out of the run queues
+    void dequeue_script(script_info *script);
+
+    // update CPU statistics after a script has run
+    void update_script_stats(script_info *script, uint32_t run_time_us);
+
+    // end the current statistics period, logging CPU statistics of each script if enabled
+    void end_stats_period();
+    static const uint32_t stats_period_ms = 10000;
+    uint32_t _stats_period_start_ms;
+
+#if HAL_LOGGING_ENABLED
+    // log CPU statistics of a script for the period that has just ended
+    void log_script_stats(const script_info *script, uint32_t runs, uint32_t run_time_us, uint32_t period_ms);
+#endif
 
     void remove_script(lua_State *L, script_info *script);
 
@@ -97,7 +179,12 @@ private:
     int docall(lua_State *L, int narg, int nres) const;
     int sandbox_ref;
 
-    script_info *scripts; // linked list of scripts to be run, sorted by next run time (soonest first)
+    script_info *scripts; // linked list of loaded scripts, in load order
+
+    script_queue _waiting{runs_before};       // scripts to run, soonest first
+    script_queue _ready{fair_share_before};   // scripts that are due, least CPU time used first
+    bool _fair_share;                         // copy of SCR_FAIR_SHARE taken at start
+    uint64_t _fair_share_min_us;              // CPU time of the last script taken from the ready queue
 
     // hook will be run when CPU time for a script is exceeded
     // it must be static to be passed to the C API
@@ -116,6 +203,10 @@ private:
 
     static MultiHeap _heap;
 
+    // instance reporting stats in @SYS/scripts.txt, the stats and list of loaded scripts are protected by stats_sem
+    static lua_scripts *stats_instance;
+    static HAL_Semaphore stats_sem;
+
     // helper for print and log of runtime stats
     void update_stats(const char *name, uint32_t run_time, int total_mem, int run_mem);
 
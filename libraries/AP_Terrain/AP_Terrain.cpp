@@ -49,7 +49,7 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
 
     // @Param: SPACING
     // @DisplayName: Terrain grid spacing
-    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in the vehicle keeping 12 grid squares in memory with each grid square having a size of 2.7 kilometers by 3.2 kilometers. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
+    // @Description: Distance between terrain grid points in meters. This controls the horizontal resolution of the terrain data that is stored on te SD card and requested from the ground station. If your GCS is using the ArduPilot SRTM database like Mission Planner or MAVProxy, then a resolution of 100 meters is appropriate. Grid spacings lower than 100 meters waste SD card space if the GCS cannot provide that resolution. The grid spacing also controls how much data is kept in memory during flight. A larger grid spacing will allow for a larger amount of data in memory. A grid spacing of 100 meters results in each grid square held in memory having a size of 2.7 kilometers by 3.2 kilometers. The number of grid squares held in memory is set by TERRAIN_CACHE_SZ. Any additional grid squares are stored on the SD once they are fetched from the GCS and will be loaded as needed.
     // @Units: m
     // @Increment: 1
     // @User: Advanced
@@ -77,6 +77,14 @@ const AP_Param::GroupInfo AP_Terrain::var_info[] = {
     // @Range: 0 50
     // @User: Advanced
     AP_GROUPINFO("OFS_MAX",  4, AP_Terrain, offset_max, 30),
+
+    // @Param: CACHE_SZ
+    // @DisplayName: Terrain cache size
+    // @Description: The number of terrain grid blocks kept in memory. Each block takes a little over 2 kilobytes. Blocks beyond the first 12 are used to load terrain data along the upcoming legs of a mission before the vehicle reaches them. If there is not enough memory for the requested size then 12 blocks are used.
+    // @Range: 12 128
+    // @RebootRequired: True
+    // @User: Advanced
+    AP_GROUPINFO("CACHE_SZ", 5, AP_Terrain, cache_sz, TERRAIN_CACHE_SZ_DEFAULT),
     
     AP_GROUPEND
 };
@@ -377,6 +385,9 @@ void AP_Terrain::update(void)
     // check for pending mission data
     update_mission_data();
 
+    // load grids ahead of the vehicle on the mission
+    update_mission_prefetch();
+
 #if HAL_RALLY_ENABLED
     // check for pending rally data
     update_rally_data();
@@ -471,6 +482,9 @@ void AP_Terrain::log_terrain_data()
         pending        : pending,
         loaded         : loaded,
         reference_offset : have_reference_offset?reference_offset:0,
+        cache_hits     : cache_hits,
+        cache_misses   : cache_misses,
+        prefetched     : cache_prefetches,
     };
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
 }
@@ -488,13 +502,20 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+    uint16_t size = constrain_int16(cache_sz, TERRAIN_GRID_BLOCK_CACHE_SIZE, 128);
+    cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
+    if (cache == nullptr && size > TERRAIN_GRID_BLOCK_CACHE_SIZE) {
+        // fall back to the minimum size for normal operation
+        GCS_SEND_TEXT(MAV_SEVERITY_WARNING, "Terrain: cache of %u blocks failed", unsigned(size));
+        size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+        cache = (struct grid_cache *)calloc(size, sizeof(cache[0]));
+    }
     if (cache == nullptr) {
         GCS_SEND_TEXT(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
         return false;
     }
-    cache_size = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    cache_size = size;
     return true;
 }
 
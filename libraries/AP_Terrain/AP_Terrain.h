@@ -50,9 +50,26 @@
 #define TERRAIN_GRID_BLOCK_SIZE_X (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_X)
 #define TERRAIN_GRID_BLOCK_SIZE_Y (TERRAIN_GRID_MAVLINK_SIZE*TERRAIN_GRID_BLOCK_MUL_Y)
 
-// number of grid_blocks in the LRU memory cache
+// minimum number of grid_blocks in the LRU memory cache needed to
+// cover the area around the vehicle. Cache entries beyond this are
+// used for mission prefetch
 #define TERRAIN_GRID_BLOCK_CACHE_SIZE 12
 
+// default size of the LRU memory cache, set with TERRAIN_CACHE_SZ
+#ifndef TERRAIN_CACHE_SZ_DEFAULT
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_1000
+#define TERRAIN_CACHE_SZ_DEFAULT 32
+#else
+#define TERRAIN_CACHE_SZ_DEFAULT TERRAIN_GRID_BLOCK_CACHE_SIZE
+#endif
+#endif
+
+// maximum number of mission legs to prefetch along
+#define TERRAIN_PREFETCH_MAX_LEGS 10
+
+// interval between walks of the mission legs for prefetch
+#define TERRAIN_PREFETCH_INTERVAL_MS 1000
+
 // format of grid on disk
 #define TERRAIN_GRID_FORMAT_VERSION 1
 
@@ -79,6 +96,7 @@
  */
 
 class AP_Terrain {
+    friend class AP_Terrain_Test;
 public:
     AP_Terrain();
 
@@ -263,10 +281,26 @@ private:
 
         volatile enum GridCacheState state;
 
-        // the last time access was requested to this block, used for LRU
+        // the last time access was requested to this block, used for
+        // LRU. For a prefetched block this is the last prefetch pass
+        // that wanted it
         uint32_t last_access_ms;
+
+        // loaded ahead of the vehicle and not yet used by a lookup
+        bool prefetched;
     };
 
+    /*
+      choose the cache entry to replace. Free entries go first, then
+      prefetched entries, then entries used by lookups, least recently
+      used first. Entries with updates waiting to be written to disk go
+      last. A prefetch replaces neither an entry it already wanted in
+      this pass (pass_ms) nor any of the TERRAIN_GRID_BLOCK_CACHE_SIZE
+      most recently used entries, which hold the grids around the
+      vehicle. Returns -1 if there is no entry a prefetch may replace
+     */
+    static int16_t find_replacement(const struct grid_cache *cache, uint16_t cache_size, bool prefetch, uint32_t pass_ms);
+
     /*
       grid_info is a broken down representation of a Location, giving
       the index terms for finding the right grid
@@ -304,6 +338,18 @@ private:
     */
     struct grid_cache &find_grid_cache(const struct grid_info &info);
 
+    /*
+      find the cache index of a grid given a grid_info, or -1 if not
+      in the cache
+    */
+    int16_t find_grid_cache_idx(const struct grid_info &info);
+
+    /*
+      replace the grid at cache index idx with the grid for a
+      grid_info, marking it for loading from disk
+    */
+    struct grid_cache &claim_grid_cache(const struct grid_info &info, uint16_t idx);
+
     /*
       calculate bit number in grid_block bitmap. This corresponds to a
       bit representing a 4x4 mavlink transmitted block
@@ -354,6 +400,12 @@ private:
      */
     void update_mission_data(void);
 
+    /*
+      load grids along the upcoming mission legs into the cache
+     */
+    void update_mission_prefetch(void);
+    bool prefetch_location(const Location &loc, uint32_t pass_ms, int16_t &last_idx, uint16_t &count, uint16_t max_count);
+
     /*
       check for missing rally data
      */
@@ -371,15 +423,24 @@ private:
     AP_Int16 grid_spacing; // meters between grid points
     AP_Int16 options; // option bits
     AP_Float offset_max;
+    AP_Int16 cache_sz;
 
     enum class Options {
         DisableDownload = (1U<<0),
     };
 
     // cache of grids in memory, LRU
-    uint8_t cache_size = 0;
+    uint16_t cache_size = 0;
     struct grid_cache *cache = nullptr;
 
+    // index of the last grid found, checked first on lookup
+    uint16_t last_cache_idx;
+
+    // cache statistics for logging
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    uint32_t cache_prefetches;
+
     // a grid_cache block waiting for disk IO
     enum DiskIoState {
         DiskIoIdle      = 0,
@@ -449,6 +510,9 @@ private:
     // grid spacing during mission check
     uint16_t last_mission_spacing;
 
+    // last time grids along the mission were prefetched
+    uint32_t last_prefetch_ms;
+
     // next rally command to check
     uint16_t next_rally_index;
 
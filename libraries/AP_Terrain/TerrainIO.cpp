@@ -89,7 +89,9 @@ void AP_Terrain::schedule_disk_io(void)
                 cache[cache_idx].grid = disk_block.block;
             }
             cache[cache_idx].state = GRID_CACHE_VALID;
-            cache[cache_idx].last_access_ms = AP_HAL::millis();
+            if (!cache[cache_idx].prefetched) {
+                cache[cache_idx].last_access_ms = AP_HAL::millis();
+            }
         }
         disk_io_state = DiskIoIdle;
         break;
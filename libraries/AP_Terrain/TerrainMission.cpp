@@ -26,6 +26,7 @@
 #include <AP_Mission/AP_Mission.h>
 #include <AP_Rally/AP_Rally.h>
 #include <AP_GPS/AP_GPS.h>
+#include <AP_AHRS/AP_AHRS.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -114,6 +115,111 @@ void AP_Terrain::update_mission_data(void)
 #endif  // AP_MISSION_ENABLED
 }
 
+/*
+  make sure the grid for a location is in the cache, loading it if
+  needed. Prefetched grids stay below grids used by lookups in the LRU
+  order, so they never push out the grids around the vehicle.
+  last_idx and count track the number of distinct grids visited.
+  Returns false once max_count grids have been visited or there is no
+  room for more
+ */
+bool AP_Terrain::prefetch_location(const Location &loc, uint32_t pass_ms, int16_t &last_idx, uint16_t &count, uint16_t max_count)
+{
+    struct grid_info info;
+    calculate_grid_info(loc, info);
+
+    int16_t i = find_grid_cache_idx(info);
+    if (i == last_idx && i != -1) {
+        // still in the same grid
+        return true;
+    }
+    if (count >= max_count) {
+        return false;
+    }
+    if (i == -1) {
+        i = find_replacement(cache, cache_size, true, pass_ms);
+        if (i == -1) {
+            return false;
+        }
+        // the disk read is done by schedule_disk_io()
+        claim_grid_cache(info, i);
+        cache[i].prefetched = true;
+        cache_prefetches++;
+    }
+    if (cache[i].prefetched) {
+        // keep it for this pass, without moving it ahead of grids
+        // used by lookups
+        cache[i].last_access_ms = pass_ms;
+    }
+    last_idx = i;
+    count++;
+    return true;
+}
+
+/*
+  walk the legs of the mission ahead of the vehicle, loading the grids
+  they pass through into the cache before we get there. At most the
+  cache entries beyond TERRAIN_GRID_BLOCK_CACHE_SIZE are used, and the
+  most recently used grids are never replaced, see find_replacement()
+ */
+void AP_Terrain::update_mission_prefetch(void)
+{
+#if AP_MISSION_ENABLED
+    if (cache_size <= TERRAIN_GRID_BLOCK_CACHE_SIZE || grid_spacing <= 0) {
+        return;
+    }
+    // reading the mission from storage and walking the legs is too
+    // slow to do on every update
+    const uint32_t pass_ms = AP_HAL::millis();
+    if (pass_ms - last_prefetch_ms < TERRAIN_PREFETCH_INTERVAL_MS) {
+        return;
+    }
+    last_prefetch_ms = pass_ms;
+    const AP_Mission *mission = AP::mission();
+    if (mission == nullptr || mission->state() != AP_Mission::MISSION_RUNNING) {
+        return;
+    }
+    Location prev_loc;
+    if (!AP::ahrs().get_location(prev_loc)) {
+        return;
+    }
+
+    // step along legs at a quarter of the grid block size so no grid
+    // on the leg is skipped
+    const float step = 0.25 * MIN(TERRAIN_GRID_BLOCK_SPACING_X, TERRAIN_GRID_BLOCK_SPACING_Y) * grid_spacing;
+    const uint16_t max_count = cache_size - TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    uint16_t count = 0;
+    int16_t last_idx = -1;
+
+    uint16_t index = mission->get_current_nav_index();
+    for (uint8_t legs=0; legs<TERRAIN_PREFETCH_MAX_LEGS; index++) {
+        AP_Mission::Mission_Command cmd;
+        if (!mission->read_cmd_from_storage(index, cmd)) {
+            break;
+        }
+        if (!AP_Mission::is_nav_cmd(cmd) ||
+            (cmd.content.location.lat == 0 && cmd.content.location.lng == 0)) {
+            continue;
+        }
+        const Location &loc = cmd.content.location;
+        const float leg_length = prev_loc.get_distance(loc);
+        const float bearing = prev_loc.get_bearing_to(loc) * 0.01;
+        for (float d = 0; d < leg_length; d += step) {
+            Location loc2 = prev_loc;
+            loc2.offset_bearing(bearing, d);
+            if (!prefetch_location(loc2, pass_ms, last_idx, count, max_count)) {
+                return;
+            }
+        }
+        if (!prefetch_location(loc, pass_ms, last_idx, count, max_count)) {
+            return;
+        }
+        prev_loc = loc;
+        legs++;
+    }
+#endif  // AP_MISSION_ENABLED
+}
+
 #if HAL_RALLY_ENABLED
 /*
   check that we have fetched all rally terrain data
@@ -102,28 +102,87 @@ void AP_Terrain::calculate_grid_info(const Location &loc, struct grid_info &info
 
 
 /*
-  find a grid structure given a grid_info
+  find the cache index of a grid given a grid_info, or -1 if not in
+  the cache
  */
-AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
+int16_t AP_Terrain::find_grid_cache_idx(const struct grid_info &info)
 {
-    uint16_t oldest_i = 0;
-
-    // see if we have that grid
+    // lookups are usually for the same grid as last time
+    if (last_cache_idx < cache_size) {
+        const struct grid_block &grid = cache[last_cache_idx].grid;
+        if (TERRAIN_LATLON_EQUAL(grid.lat,info.grid_lat) &&
+            TERRAIN_LATLON_EQUAL(grid.lon,info.grid_lon) &&
+            grid.spacing == grid_spacing) {
+            return last_cache_idx;
+        }
+    }
     for (uint16_t i=0; i<cache_size; i++) {
         if (TERRAIN_LATLON_EQUAL(cache[i].grid.lat,info.grid_lat) &&
             TERRAIN_LATLON_EQUAL(cache[i].grid.lon,info.grid_lon) &&
             cache[i].grid.spacing == grid_spacing) {
-            cache[i].last_access_ms = AP_HAL::millis();
-            return cache[i];
+            last_cache_idx = i;
+            return i;
+        }
+    }
+    return -1;
+}
+
+/*
+  choose the cache entry to replace, see AP_Terrain.h
+ */
+int16_t AP_Terrain::find_replacement(const struct grid_cache *cache, uint16_t cache_size, bool prefetch, uint32_t pass_ms)
+{
+    // ordering for replacement, lowest first: free entries, then
+    // prefetched entries, then entries used by lookups, each least
+    // recently used first, with dirty entries after all clean ones
+    auto rank = [](const struct grid_cache &c) {
+        return (uint64_t(c.state == GRID_CACHE_DIRTY) << 34) |
+               (uint64_t(c.state != GRID_CACHE_INVALID) << 33) |
+               (uint64_t(!c.prefetched) << 32) |
+               c.last_access_ms;
+    };
+
+    int16_t best = -1;
+    for (uint16_t i=0; i<cache_size; i++) {
+        const struct grid_cache &c = cache[i];
+        if (prefetch && c.prefetched && c.last_access_ms == pass_ms) {
+            // wanted by this prefetch pass already
+            continue;
         }
-        if (cache[i].last_access_ms < cache[oldest_i].last_access_ms) {
-            oldest_i = i;
+        if (best == -1 || rank(c) < rank(cache[best])) {
+            best = i;
         }
     }
+    if (!prefetch || best == -1 || cache[best].state == GRID_CACHE_INVALID) {
+        return best;
+    }
+    if (cache[best].state == GRID_CACHE_DIRTY) {
+        // prefetch never discards updates
+        return -1;
+    }
+    if (cache[best].prefetched) {
+        return best;
+    }
 
-    // Not found. Use the oldest grid and make it this grid,
-    // initially unpopulated
-    struct grid_cache &grid = cache[oldest_i];
+    // a prefetch may only replace an entry used by lookups if the
+    // grids around the vehicle fit in the entries used more recently
+    uint16_t newer = 0;
+    for (uint16_t i=0; i<cache_size; i++) {
+        if (i != best && cache[i].state != GRID_CACHE_INVALID && !cache[i].prefetched &&
+            cache[i].last_access_ms >= cache[best].last_access_ms) {
+            newer++;
+        }
+    }
+    return newer >= TERRAIN_GRID_BLOCK_CACHE_SIZE ? best : -1;
+}
+
+/*
+  replace the grid at cache index idx with the grid for a grid_info,
+  initially unpopulated and waiting for a disk read
+ */
+AP_Terrain::grid_cache &AP_Terrain::claim_grid_cache(const struct grid_info &info, uint16_t idx)
+{
+    struct grid_cache &grid = cache[idx];
     memset(&grid, 0, sizeof(grid));
 
     grid.grid.lat = info.grid_lat;
@@ -139,9 +198,30 @@ AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info
     // mark as waiting for disk read
     grid.state = GRID_CACHE_DISKWAIT;
 
+    last_cache_idx = idx;
+
     return grid;
 }
 
+/*
+  find a grid structure given a grid_info
+ */
+AP_Terrain::grid_cache &AP_Terrain::find_grid_cache(const struct grid_info &info)
+{
+    // see if we have that grid
+    const int16_t i = find_grid_cache_idx(info);
+    if (i != -1) {
+        cache_hits++;
+        cache[i].last_access_ms = AP_HAL::millis();
+        cache[i].prefetched = false;
+        return cache[i];
+    }
+
+    // Not found. Use the oldest grid and make it this grid
+    cache_misses++;
+    return claim_grid_cache(info, find_replacement(cache, cache_size, false, 0));
+}
+
 /*
   find cache index of disk_block
  */
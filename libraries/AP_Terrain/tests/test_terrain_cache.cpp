@@ -0,0 +1,183 @@
+#include <AP_gtest.h>
+#include <AP_HAL/HAL.h>
+#include <AP_Terrain/AP_Terrain.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if AP_TERRAIN_AVAILABLE
+
+/*
+  access to the private cache replacement policy of AP_Terrain, which
+  makes this class a friend
+ */
+class AP_Terrain_Test {
+public:
+    typedef AP_Terrain::grid_cache grid_cache;
+    static constexpr AP_Terrain::GridCacheState GRID_CACHE_VALID = AP_Terrain::GRID_CACHE_VALID;
+    static constexpr AP_Terrain::GridCacheState GRID_CACHE_DIRTY = AP_Terrain::GRID_CACHE_DIRTY;
+
+    static int16_t find_replacement(const grid_cache *cache, uint16_t cache_size, bool prefetch, uint32_t pass_ms) {
+        return AP_Terrain::find_replacement(cache, cache_size, prefetch, pass_ms);
+    }
+};
+
+#define CACHE_SIZE 16
+
+static AP_Terrain_Test::grid_cache cache[CACHE_SIZE];
+
+// mark an entry as used by a lookup at time_ms
+static void set_used(uint16_t i, uint32_t time_ms)
+{
+    cache[i].state = AP_Terrain_Test::GRID_CACHE_VALID;
+    cache[i].prefetched = false;
+    cache[i].last_access_ms = time_ms;
+}
+
+// mark an entry as prefetched in the pass at pass_ms
+static void set_prefetched(uint16_t i, uint32_t pass_ms)
+{
+    cache[i].state = AP_Terrain_Test::GRID_CACHE_VALID;
+    cache[i].prefetched = true;
+    cache[i].last_access_ms = pass_ms;
+}
+
+static void clear_cache()
+{
+    memset(cache, 0, sizeof(cache));
+}
+
+TEST(TerrainCache, FreeEntriesFirst)
+{
+    clear_cache();
+    for (uint16_t i=0; i<CACHE_SIZE-1; i++) {
+        set_used(i, 100+i);
+    }
+    // the last entry has never been used
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, false, 0), CACHE_SIZE-1);
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, 1000), CACHE_SIZE-1);
+}
+
+TEST(TerrainCache, LookupReplacesPrefetchedFirst)
+{
+    clear_cache();
+    for (uint16_t i=0; i<CACHE_SIZE; i++) {
+        set_used(i, 100+i);
+    }
+    // a prefetched entry is replaced before older entries used by lookups
+    set_prefetched(7, 500);
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, false, 0), 7);
+
+    // without prefetched entries it is plain LRU
+    set_used(7, 600);
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, false, 0), 0);
+}
+
+TEST(TerrainCache, DirtyEntriesLast)
+{
+    clear_cache();
+    for (uint16_t i=0; i<CACHE_SIZE; i++) {
+        set_used(i, 100+i);
+    }
+    cache[0].state = AP_Terrain_Test::GRID_CACHE_DIRTY;
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, false, 0), 1);
+
+    // a lookup still gets an entry when everything is dirty
+    for (uint16_t i=0; i<CACHE_SIZE; i++) {
+        cache[i].state = AP_Terrain_Test::GRID_CACHE_DIRTY;
+    }
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, false, 0), 0);
+
+    // but a prefetch never discards updates
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, 1000), -1);
+}
+
+TEST(TerrainCache, PrefetchKeepsVehicleGrids)
+{
+    clear_cache();
+    // the 12 grids around the vehicle, all recently used
+    for (uint16_t i=0; i<TERRAIN_GRID_BLOCK_CACHE_SIZE; i++) {
+        set_used(i, 200+i);
+    }
+    // grids prefetched by an earlier pass
+    for (uint16_t i=TERRAIN_GRID_BLOCK_CACHE_SIZE; i<CACHE_SIZE; i++) {
+        set_prefetched(i, 100);
+    }
+
+    // a new pass reuses the prefetched entries
+    int16_t idx = AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, 1000);
+    EXPECT_GE(idx, TERRAIN_GRID_BLOCK_CACHE_SIZE);
+
+    // once this pass has claimed them all there is no more room
+    for (uint16_t i=TERRAIN_GRID_BLOCK_CACHE_SIZE; i<CACHE_SIZE; i++) {
+        set_prefetched(i, 1000);
+    }
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, 1000), -1);
+
+    // an entry used by lookups well before the vehicle grids can go
+    clear_cache();
+    for (uint16_t i=0; i<CACHE_SIZE; i++) {
+        set_used(i, 200+i);
+    }
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, 1000), 0);
+    set_prefetched(0, 1000);
+    set_prefetched(1, 1000);
+    set_prefetched(2, 1000);
+    set_prefetched(3, 1000);
+    EXPECT_EQ(AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, 1000), -1);
+}
+
+/*
+  a vehicle looking up the same 12 grids every second while prefetch
+  walks a long mission must never have to reload one of them
+ */
+TEST(TerrainCache, NoThrashing)
+{
+    clear_cache();
+    const uint16_t vehicle_grids = TERRAIN_GRID_BLOCK_CACHE_SIZE;
+    int32_t grid_id[CACHE_SIZE];
+    for (uint16_t i=0; i<CACHE_SIZE; i++) {
+        grid_id[i] = -1;
+    }
+
+    uint32_t reloads = 0;
+    uint32_t next_mission_grid = 1000;
+    for (uint32_t now_ms=1000; now_ms<100000; now_ms+=1000) {
+        // lookups around the vehicle
+        for (int32_t g=0; g<vehicle_grids; g++) {
+            int16_t idx = -1;
+            for (uint16_t i=0; i<CACHE_SIZE; i++) {
+                if (grid_id[i] == g) {
+                    idx = i;
+                }
+            }
+            if (idx == -1) {
+                if (now_ms > 1000) {
+                    reloads++;
+                }
+                idx = AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, false, 0);
+                ASSERT_NE(idx, -1);
+                grid_id[idx] = g;
+            }
+            set_used(idx, now_ms + g);
+        }
+
+        // a prefetch pass over the next mission grids, more than fit
+        const uint32_t pass_ms = now_ms + 500;
+        for (uint32_t g=next_mission_grid; g<next_mission_grid+10; g++) {
+            const int16_t idx = AP_Terrain_Test::find_replacement(cache, CACHE_SIZE, true, pass_ms);
+            if (idx == -1) {
+                break;
+            }
+            // only free or prefetched entries are replaced
+            EXPECT_TRUE(grid_id[idx] == -1 || grid_id[idx] >= 1000);
+            grid_id[idx] = g;
+            set_prefetched(idx, pass_ms);
+        }
+        next_mission_grid += 2;
+    }
+    EXPECT_EQ(reloads, 0U);
+}
+
+#endif // AP_TERRAIN_AVAILABLE
+
+AP_GTEST_MAIN()
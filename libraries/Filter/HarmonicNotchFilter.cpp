@@ -132,6 +132,8 @@ const AP_Param::GroupInfo HarmonicNotchFilterParams::var_info[] = {
 template <class T>
 HarmonicNotchFilter<T>::~HarmonicNotchFilter() {
     delete[] _filters;
+    delete[] _bank.coeffs;
+    delete[] _bank.state;
     _num_filters = 0;
     _num_enabled_filters = 0;
 }
@@ -159,7 +161,7 @@ void HarmonicNotchFilter<T>::init(float sample_freq_hz, float center_freq_hz, fl
 
     // position the individual notches so that the attenuation is no worse than a single notch
     // calculate attenuation and quality from the shaping constraints
-    NotchFilter<T>::calculate_A_and_Q(center_freq_hz, bandwidth_hz / _composite_notches, attenuation_dB, _A, _Q);
+    NotchFilter<float>::calculate_A_and_Q(center_freq_hz, bandwidth_hz / _composite_notches, attenuation_dB, _A, _Q);
 
     _initialised = true;
     update(center_freq_hz);
@@ -177,14 +179,82 @@ void HarmonicNotchFilter<T>::allocate_filters(uint8_t num_notches, uint32_t harm
     _harmonics = harmonics;
 
     if (_num_filters > 0) {
-        _filters = new NotchFilter<T>[_num_filters];
-        if (_filters == nullptr) {
-            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter", (unsigned int)(_num_filters * sizeof(NotchFilter<T>)));
+        _filters = new NotchFilter<float>[_num_filters];
+        if (_filters == nullptr || !allocate_bank(_num_filters)) {
+            GCS_SEND_TEXT(MAV_SEVERITY_ERROR, "Failed to allocate %u bytes for notch filter",
+                          (unsigned int)(_num_filters * (sizeof(NotchFilter<float>) + 5*sizeof(float) + 4*sizeof(T))));
+            delete[] _filters;
+            _filters = nullptr;
             _num_filters = 0;
         }
     }
 }
 
+/*
+  allocate the coefficient and state arrays. Each array holds one
+  element per filter, keeping the values used together for a stage
+  close together and letting apply() use packed arithmetic across the
+  axes of a vector sample
+ */
+template <class T>
+bool HarmonicNotchFilter<T>::allocate_bank(uint16_t num_filters)
+{
+    float *coeffs = new float[5*num_filters];
+    T *state = new T[4*num_filters];
+    if (coeffs == nullptr || state == nullptr) {
+        delete[] coeffs;
+        delete[] state;
+        return false;
+    }
+
+    if (_bank.coeffs != nullptr) {
+        // each array keeps its position within the larger allocation
+        for (uint8_t i = 0; i < 5; i++) {
+            memcpy(&coeffs[i*num_filters], &_bank.coeffs[i*_num_filters], sizeof(float)*_num_filters);
+        }
+        for (uint8_t i = 0; i < 4; i++) {
+            memcpy(&state[i*num_filters], &_bank.state[i*_num_filters], sizeof(T)*_num_filters);
+        }
+        delete[] _bank.coeffs;
+        delete[] _bank.state;
+    }
+
+    _bank.coeffs = coeffs;
+    _bank.b0 = &coeffs[0];
+    _bank.b1 = &coeffs[num_filters];
+    _bank.b2 = &coeffs[2*num_filters];
+    _bank.a1 = &coeffs[3*num_filters];
+    _bank.a2 = &coeffs[4*num_filters];
+
+    _bank.state = state;
+    _bank.ntchsig1 = &state[0];
+    _bank.ntchsig2 = &state[num_filters];
+    _bank.signal1 = &state[2*num_filters];
+    _bank.signal2 = &state[3*num_filters];
+
+    return true;
+}
+
+/*
+  copy the coefficients of the enabled filters into the bank after
+  their center frequencies have been updated
+ */
+template <class T>
+void HarmonicNotchFilter<T>::update_bank()
+{
+    bool ready = true;
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+        const NotchFilter<float> &filter = _filters[i];
+        _bank.b0[i] = filter.b0;
+        _bank.b1[i] = filter.b1;
+        _bank.b2[i] = filter.b2;
+        _bank.a1[i] = filter.a1;
+        _bank.a2[i] = filter.a2;
+        ready = ready && filter.initialised && !filter.need_reset;
+    }
+    _bank.ready = ready;
+}
+
 /*
   expand the number of filters at runtime, allowing for RPM sources such as lua scripts
  */
@@ -199,8 +269,9 @@ void HarmonicNotchFilter<T>::expand_filter_count(uint16_t total_notches)
       note that we rely on the semaphore in
       AP_InertialSensor_Backend.cpp to make this thread safe
      */
-    auto filters = new NotchFilter<T>[total_notches];
-    if (filters == nullptr) {
+    auto filters = new NotchFilter<float>[total_notches];
+    if (filters == nullptr || !allocate_bank(total_notches)) {
+        delete[] filters;
         _alloc_has_failed = true;
         return;
     }
@@ -252,6 +323,8 @@ void HarmonicNotchFilter<T>::update(float center_freq_hz)
             }
         }
     }
+
+    update_bank();
 }
 
 /*
@@ -307,6 +380,8 @@ void HarmonicNotchFilter<T>::update(uint8_t num_centers, const float center_freq
             }
         }
     }
+
+    update_bank();
 }
 
 /*
@@ -326,22 +401,73 @@ T HarmonicNotchFilter<T>::apply(const T &sample)
     }
 #endif
 
-    T output = sample;
-    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
 #if NOTCH_DEBUG_LOGGING
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
         if (!_filters[i].initialised) {
             ::dprintf(dfd, "------- ");
         } else {
             ::dprintf(dfd, "%.4f ", _filters[i]._center_freq_hz);
         }
-#endif
-        output = _filters[i].apply(output);
     }
-#if NOTCH_DEBUG_LOGGING
     if (_num_enabled_filters > 0) {
         ::dprintf(dfd, "\n");
     }
 #endif
+
+    if (!_bank.ready) {
+        return apply_with_reset(sample);
+    }
+
+    // run the sample through each stage in turn, this is the same
+    // calculation as NotchFilter::apply() for each filter
+    T output = sample;
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+        const T input = output;
+        output = input*_bank.b0[i] + _bank.ntchsig1[i]*_bank.b1[i] + _bank.ntchsig2[i]*_bank.b2[i]
+            - _bank.signal1[i]*_bank.a1[i] - _bank.signal2[i]*_bank.a2[i];
+
+        _bank.ntchsig2[i] = _bank.ntchsig1[i];
+        _bank.ntchsig1[i] = input;
+
+        _bank.signal2[i] = _bank.signal1[i];
+        _bank.signal1[i] = output;
+    }
+    return output;
+}
+
+/*
+  apply a sample where one or more of the enabled filters is not
+  initialised or needs a reset. Those filters pass the sample through
+  and update their delayed samples, as NotchFilter::apply() does
+ */
+template <class T>
+T HarmonicNotchFilter<T>::apply_with_reset(const T &sample)
+{
+    bool ready = true;
+    T output = sample;
+    for (uint16_t i = 0; i < _num_enabled_filters; i++) {
+        NotchFilter<float> &filter = _filters[i];
+        const T input = output;
+        if (!filter.initialised || filter.need_reset) {
+            _bank.signal1[i] = input;
+            _bank.signal2[i] = input;
+            _bank.ntchsig1[i] = input;
+            _bank.ntchsig2[i] = input;
+            filter.need_reset = false;
+            ready = ready && filter.initialised;
+            continue;
+        }
+
+        output = input*_bank.b0[i] + _bank.ntchsig1[i]*_bank.b1[i] + _bank.ntchsig2[i]*_bank.b2[i]
+            - _bank.signal1[i]*_bank.a1[i] - _bank.signal2[i]*_bank.a2[i];
+
+        _bank.ntchsig2[i] = _bank.ntchsig1[i];
+        _bank.ntchsig1[i] = input;
+
+        _bank.signal2[i] = _bank.signal1[i];
+        _bank.signal1[i] = output;
+    }
+    _bank.ready = ready;
     return output;
 }
 
@@ -358,6 +484,7 @@ void HarmonicNotchFilter<T>::reset()
     for (uint16_t i = 0; i < _num_filters; i++) {
         _filters[i].reset();
     }
+    _bank.ready = false;
 }
 
 /*
@@ -45,8 +45,29 @@ public:
     void reset();
 
 private:
-    // underlying bank of notch filters
-    NotchFilter<T>*  _filters;
+    // allocate the coefficient and state arrays for num_filters filters,
+    // copying across the contents of any existing arrays
+    bool allocate_bank(uint16_t num_filters);
+    // copy the coefficients of the enabled filters into the bank
+    void update_bank();
+    // apply a sample to the enabled filters where some need initialising
+    T apply_with_reset(const T &sample);
+
+    // underlying bank of notch filters. These hold the frequency and
+    // coefficient calculation, the coefficients and state used when
+    // filtering are held in the arrays below
+    NotchFilter<float>*  _filters;
+
+    // coefficients and state of each filter in contiguous arrays so that
+    // apply() can run through every stage in one pass
+    struct {
+        float *coeffs;
+        T *state;
+        float *b0, *b1, *b2, *a1, *a2;
+        T *ntchsig1, *ntchsig2, *signal1, *signal2;
+        // true when all enabled filters are initialised and have no pending reset
+        bool ready;
+    } _bank;
     // sample frequency for each filter
     float _sample_freq_hz;
     // base double notch bandwidth for each filter
@@ -0,0 +1,74 @@
+#include <AP_gbenchmark.h>
+
+#include <Filter/HarmonicNotchFilter.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+static const float rate_hz = 8000;
+static const float base_freq_hz = 40;
+static const float bandwidth_hz = 20;
+static const float attenuation_dB = 40;
+// all 16 harmonics
+static const uint32_t harmonics = 0xFFFF;
+
+static Vector3f next_sample(uint32_t &s)
+{
+    const float t = s++ / rate_hz;
+    return Vector3f(sinf(t * 2 * M_PI * 150), sinf(t * 2 * M_PI * 240), cosf(t * 2 * M_PI * 330));
+}
+
+/*
+  the same notches applied one filter object at a time, as the
+  harmonic notch did before keeping its filters in contiguous arrays
+ */
+static void BM_NotchFilterChain(benchmark::State &state)
+{
+    const uint8_t composite = state.range(0);
+    const uint8_t num_filters = HNF_MAX_HARMONICS * composite;
+    NotchFilter<Vector3f> *filters = new NotchFilter<Vector3f>[num_filters];
+    float A, Q;
+    NotchFilter<Vector3f>::calculate_A_and_Q(base_freq_hz, bandwidth_hz / composite, attenuation_dB, A, Q);
+    const float spread = bandwidth_hz / (32 * base_freq_hz);
+    uint8_t n = 0;
+    for (uint8_t h = 0; h < HNF_MAX_HARMONICS; h++) {
+        const float notch_center = base_freq_hz * (h+1);
+        if (composite != 2) {
+            filters[n++].init_with_A_and_Q(rate_hz, notch_center, A, Q);
+        }
+        if (composite > 1) {
+            filters[n++].init_with_A_and_Q(rate_hz, notch_center * (1.0 - spread), A, Q);
+            filters[n++].init_with_A_and_Q(rate_hz, notch_center * (1.0 + spread), A, Q);
+        }
+    }
+
+    uint32_t s = 0;
+    while (state.KeepRunning()) {
+        Vector3f v = next_sample(s);
+        for (uint8_t i = 0; i < n; i++) {
+            v = filters[i].apply(v);
+        }
+        gbenchmark_escape(&v);
+    }
+    delete[] filters;
+}
+
+static void BM_HarmonicNotchFilter(benchmark::State &state)
+{
+    const uint8_t composite = state.range(0);
+    HarmonicNotchFilter<Vector3f> *filter = new HarmonicNotchFilter<Vector3f>();
+    filter->allocate_filters(1, harmonics, composite);
+    filter->init(rate_hz, base_freq_hz, bandwidth_hz, attenuation_dB);
+
+    uint32_t s = 0;
+    while (state.KeepRunning()) {
+        Vector3f v = filter->apply(next_sample(s));
+        gbenchmark_escape(&v);
+    }
+    delete filter;
+}
+
+// single, double and triple notches on each of the 16 harmonics
+BENCHMARK(BM_NotchFilterChain)->Arg(1)->Arg(2)->Arg(3);
+BENCHMARK(BM_HarmonicNotchFilter)->Arg(1)->Arg(2)->Arg(3);
+
+BENCHMARK_MAIN();
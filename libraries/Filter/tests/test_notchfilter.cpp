@@ -156,4 +156,80 @@ TEST(NotchFilterTest, HarmonicNotchTest)
     EXPECT_NEAR(integrals[9].get_lag_degrees(10), 112.23, 0.5);
 }
 
+/*
+  test that the harmonic notch gives exactly the same output as the
+  equivalent chain of individual notch filters while the center
+  frequency moves and the filters are reset
+ */
+TEST(NotchFilterTest, HarmonicNotchEquivalenceTest)
+{
+    const uint32_t harmonics = 0b1000001011;
+    const uint8_t num_harmonics = __builtin_popcount(harmonics);
+    const float rate_hz = 2000;
+    const float bandwidth = 40;
+    const float attenuation_dB = 40;
+    const uint32_t samples = 5000;
+
+    for (uint8_t composite = 1; composite <= 3; composite++) {
+        HarmonicNotchFilter<Vector3f> harmonic_notch {};
+        harmonic_notch.allocate_filters(1, harmonics, composite);
+
+        NotchFilter<Vector3f> filters[3*num_harmonics] {};
+        uint8_t num_enabled = 0;
+        float A, Q;
+        NotchFilter<Vector3f>::calculate_A_and_Q(80, bandwidth / composite, attenuation_dB, A, Q);
+        const float spread = bandwidth / (32 * 80);
+        const float nyquist_limit = rate_hz * 0.48f;
+
+        for (uint32_t s=0; s<samples; s++) {
+            // move the notch every 100 samples, taking the higher harmonics above the limit
+            if (s % 100 == 0) {
+                const float center_freq_hz = 80 + 60 * sinf(s * 0.001);
+                if (s == 0) {
+                    harmonic_notch.init(rate_hz, 80, bandwidth, attenuation_dB);
+                }
+                harmonic_notch.update(center_freq_hz);
+
+                num_enabled = 0;
+                for (uint8_t h=0; h<HNF_MAX_HARMONICS; h++) {
+                    if (!((1U<<h) & harmonics)) {
+                        continue;
+                    }
+                    const float notch_center = center_freq_hz * (h+1);
+                    if (composite != 2 && notch_center < nyquist_limit) {
+                        filters[num_enabled++].init_with_A_and_Q(rate_hz, notch_center, A, Q);
+                    }
+                    if (composite > 1) {
+                        float notch_center_double = notch_center * (1.0 - spread);
+                        if (notch_center_double < nyquist_limit) {
+                            filters[num_enabled++].init_with_A_and_Q(rate_hz, notch_center_double, A, Q);
+                        }
+                        notch_center_double = notch_center * (1.0 + spread);
+                        if (notch_center_double < nyquist_limit) {
+                            filters[num_enabled++].init_with_A_and_Q(rate_hz, notch_center_double, A, Q);
+                        }
+                    }
+                }
+            }
+            if (s == samples / 2) {
+                harmonic_notch.reset();
+                for (auto &f : filters) {
+                    f.reset();
+                }
+            }
+
+            const float t = s / rate_hz;
+            const Vector3f sample { sinf(t * 2 * M_PI * 150), 0.3f * sinf(t * 2 * M_PI * 240), 0.2f * cosf(t * 2 * M_PI * 330) };
+            Vector3f expected = sample;
+            for (uint8_t i=0; i<num_enabled; i++) {
+                expected = filters[i].apply(expected);
+            }
+            const Vector3f v = harmonic_notch.apply(sample);
+            EXPECT_EQ(v.x, expected.x);
+            EXPECT_EQ(v.y, expected.y);
+            EXPECT_EQ(v.z, expected.z);
+        }
+    }
+}
+
 AP_GTEST_MAIN()
@@ -306,10 +306,15 @@ public:
         return GCS_MAVLINK::active_channel_mask() & (1 << (chan-MAVLINK_COMM_0));
     }
     bool is_streaming() const {
-        return sending_bucket_id != no_bucket_to_send;
+        return num_deferred_streams != 0;
     }
 
     mavlink_channel_t get_chan() const { return chan; }
+
+#if AP_MAVLINK_FTP_ENABLED
+    // fill in @SYS/ftp.txt with FTP transfer statistics
+    static void ftp_info(class ExpandingString &str);
+#endif
     uint32_t get_last_heartbeat_time() const { return last_heartbeat_time; };
 
     uint32_t        last_heartbeat_time; // milliseconds
@@ -817,7 +822,7 @@ private:
 
     // "special" messages such as heartbeat, next_param etc are stored
     // separately to stream-rated messages like AHRS2 etc.  If these
-    // were to be stored in buckets then they would be slowed down
+    // were to be stored with the streams then they would be slowed down
     // based on stream_slowdown, which we have not traditionally done.
     struct deferred_message_t {
         const ap_message id;
@@ -838,20 +843,40 @@ private:
     // cache of which deferred message should be sent next:
     int8_t next_deferred_message_to_send_cache = -1;
 
-    struct deferred_message_bucket_t {
-        Bitmask<MSG_LAST> ap_message_ids;
-        uint16_t interval_ms;
-        uint16_t last_sent_ms; // from AP_HAL::millis16()
+    // stream-rated messages are kept in a binary min-heap ordered on
+    // the time each is next due to be sent, so every message is sent
+    // at its own interval.  Entries are allocated as messages are
+    // scheduled rather than reserving space for every ap_message
+    struct deferred_stream_t {
+        ap_message id;
+        uint16_t interval_ms;   // interval requested for this message
+        uint32_t due_ms;        // from AP_HAL::millis()
     };
-    deferred_message_bucket_t deferred_message_bucket[10];
-    static const uint8_t no_bucket_to_send = -1;
+    deferred_stream_t *deferred_streams;
+    uint8_t num_deferred_streams;
+    uint8_t deferred_streams_capacity;
+    // slowdown and penalty multiplier the due times were calculated with
+    uint16_t deferred_streams_slowdown_ms;
+    uint8_t deferred_streams_multiplier = 1;
     static const ap_message no_message_to_send = (ap_message)-1;
-    uint8_t sending_bucket_id = no_bucket_to_send;
-    Bitmask<MSG_LAST> bucket_message_ids_to_send;
 
-    ap_message next_deferred_bucket_message_to_send(uint16_t now16_ms);
-    void find_next_bucket_to_send(uint16_t now16_ms);
-    void remove_message_from_bucket(int8_t bucket, ap_message id);
+    ap_message next_deferred_stream_message_to_send(uint32_t now_ms) const;
+    void reschedule_deferred_stream(uint32_t now_ms);
+    int16_t find_deferred_stream(ap_message id) const;
+    bool expand_deferred_streams();
+    void add_deferred_stream(ap_message id, uint16_t interval_ms);
+    void remove_deferred_stream(uint8_t i);
+    uint8_t sift_deferred_stream_up(uint8_t i);
+    void sift_deferred_stream_down(uint8_t i);
+    // recalculate due times if the slowdown or penalty has changed
+    void update_deferred_stream_penalty();
+
+    // count of stream-rated messages sent, for achieved-vs-requested
+    // rate statistics
+    uint32_t deferred_stream_send_count;
+    uint32_t deferred_stream_send_count_logged;
+    // sum of the requested rates of all stream-rated messages
+    float get_requested_stream_rate() const;
 
     // bitmask of IDs the code has spontaneously decided it wants to
     // send out.  Examples include HEARTBEAT (gcs_send_heartbeat)
@@ -893,10 +918,13 @@ private:
     // read file, set message intervals from it:
     void get_intervals_from_filepath(const char *path, DefaultIntervalsFromFiles &);
 #endif
-    // return interval deferred message bucket should be sent after.
-    // When sending parameters and waypoints this may be longer than
-    // the interval specified in "deferred"
-    uint16_t get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const;
+    // multiplier applied to stream intervals while sending parameters,
+    // waypoints or ftp replies
+    uint8_t get_stream_penalty_multiplier() const;
+    // return interval a stream message should be sent after.  When
+    // sending parameters and waypoints this may be longer than the
+    // requested interval
+    static uint16_t get_reschedule_interval_ms(uint16_t interval_ms, uint16_t slowdown_ms, uint8_t multiplier);
 
     bool do_try_send_message(const ap_message id);
 
@@ -1006,6 +1034,27 @@ private:
         int16_t current_session;
         uint32_t last_send_ms;
         uint8_t need_banner_send_mask;
+
+        // read-ahead buffer for file reads, allocated on first read
+        uint8_t *readahead;
+        uint32_t readahead_offset; // file offset of readahead[0]
+        uint16_t readahead_len;    // bytes valid in readahead
+
+        // burst read pacing on links without flow control, adapted
+        // to the data the GCS asks for again
+        uint32_t pace_bps;         // paced rate, bytes/s on the wire
+        mavlink_channel_t pace_chan;
+        uint32_t burst_end_offset; // offset after the last byte sent in a burst
+        bool burst_loss;           // GCS has asked for data we sent again
+        bool tx_full;              // waited for space on the link
+
+        struct {
+            uint32_t bytes_sent;
+            uint32_t bursts;
+            uint32_t retries;
+            uint32_t fs_reads;
+            uint32_t last_rate_bps; // file data rate of the last burst
+        } stats;
     };
     static struct ftp_state ftp;
 
@@ -1018,6 +1067,9 @@ private:
     bool send_ftp_reply(const pending_ftp &reply);
     void ftp_worker(void);
     void ftp_push_replies(pending_ftp &reply);
+    static ssize_t ftp_read(uint32_t offset, uint8_t *data, uint16_t len);
+    static void ftp_check_reread(uint32_t offset);
+    static uint32_t ftp_update_pace(mavlink_channel_t chan, uint32_t offset, uint32_t bw);
 #endif  // AP_MAVLINK_FTP_ENABLED
 
     void send_distance_sensor(const class AP_RangeFinder_Backend *sensor, const uint8_t instance) const;
@@ -1091,7 +1143,8 @@ private:
         uint16_t statustext_last_sent_ms;
         uint32_t behind;
         uint32_t out_of_time;
-        uint16_t fnbts_maxtime;
+        uint16_t reschedule_maxtime;
+        uint32_t stream_send_count;
         uint32_t max_retry_deferred_body_us;
         uint8_t max_retry_deferred_body_type;
     } try_send_message_stats;
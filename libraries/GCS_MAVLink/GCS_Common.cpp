@@ -1145,104 +1145,210 @@ bool GCS_MAVLINK::should_send_message_in_delay_callback(const ap_message id) con
     return false;
 }
 
-uint16_t GCS_MAVLINK::get_reschedule_interval_ms(const deferred_message_bucket_t &deferred) const
+uint8_t GCS_MAVLINK::get_stream_penalty_multiplier() const
 {
-    uint32_t interval_ms = deferred.interval_ms;
-
-    interval_ms += stream_slowdown_ms;
+    uint8_t multiplier = 1;
 
     // slow most messages down if we're transfering parameters or
     // waypoints:
     if (_queued_parameter) {
         // we are sending parameters, penalize streams:
-        interval_ms *= 4;
+        multiplier *= 4;
     }
     if (requesting_mission_items()) {
         // we are sending requests for waypoints, penalize streams:
-        interval_ms *= 4;
+        multiplier *= 4;
     }
 #if AP_MAVLINK_FTP_ENABLED
     if (AP_HAL::millis() - ftp.last_send_ms < 500) {
         // we are sending ftp replies
-        interval_ms *= 4;
+        multiplier *= 4;
     }
 #endif
 
-    if (interval_ms > 60000) {
+    return multiplier;
+}
+
+uint16_t GCS_MAVLINK::get_reschedule_interval_ms(uint16_t interval_ms, uint16_t slowdown_ms, uint8_t multiplier)
+{
+    const uint32_t ret = (uint32_t(interval_ms) + slowdown_ms) * multiplier;
+    if (ret > 60000) {
         return 60000;
     }
+    return ret;
+}
+
+/*
+  the due times in the stream heap include the current slowdown and
+  penalty.  When either changes move each due time by the change in
+  its reschedule interval, keeping the time it was last sent
+ */
+void GCS_MAVLINK::update_deferred_stream_penalty()
+{
+    const uint16_t slowdown_ms = stream_slowdown_ms;
+    const uint8_t multiplier = get_stream_penalty_multiplier();
+    if (slowdown_ms == deferred_streams_slowdown_ms &&
+        multiplier == deferred_streams_multiplier) {
+        return;
+    }
+    for (uint8_t i=0; i<num_deferred_streams; i++) {
+        deferred_stream_t &entry = deferred_streams[i];
+        entry.due_ms -= get_reschedule_interval_ms(entry.interval_ms, deferred_streams_slowdown_ms, deferred_streams_multiplier);
+        entry.due_ms += get_reschedule_interval_ms(entry.interval_ms, slowdown_ms, multiplier);
+    }
+    deferred_streams_slowdown_ms = slowdown_ms;
+    deferred_streams_multiplier = multiplier;
 
-    return interval_ms;
+    // entries have moved by different amounts; restore heap order
+    for (int16_t i=num_deferred_streams/2-1; i>=0; i--) {
+        sift_deferred_stream_down(i);
+    }
 }
 
-// typical runtime on fmuv3: 5 microseconds for 3 buckets
-void GCS_MAVLINK::find_next_bucket_to_send(uint16_t now16_ms)
+// returns index of id in deferred_streams[] or -1 if not present
+int16_t GCS_MAVLINK::find_deferred_stream(ap_message id) const
 {
-#if GCS_DEBUG_SEND_MESSAGE_TIMINGS
-    void *data = hal.scheduler->disable_interrupts_save();
-    uint32_t start_us = AP_HAL::micros();
-#endif
+    for (uint8_t i=0; i<num_deferred_streams; i++) {
+        if (deferred_streams[i].id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-    // all done sending this bucket... find another bucket...
-    sending_bucket_id = no_bucket_to_send;
-    uint16_t ms_before_send_next_bucket_to_send = UINT16_MAX;
-    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-        if (deferred_message_bucket[i].ap_message_ids.count() == 0) {
-            // no entries
-            continue;
+/*
+  grow the stream heap.  Links typically stream a few dozen messages,
+  so space is allocated in small steps rather than for every ap_message
+ */
+bool GCS_MAVLINK::expand_deferred_streams()
+{
+    if (deferred_streams_capacity >= MSG_LAST) {
+        return false;
+    }
+    const uint8_t new_capacity = MIN(deferred_streams_capacity + 8, MSG_LAST);
+    deferred_stream_t *new_streams = new deferred_stream_t[new_capacity];
+    if (new_streams == nullptr) {
+        return false;
+    }
+    if (deferred_streams != nullptr) {
+        memcpy(new_streams, deferred_streams, sizeof(deferred_streams[0]) * num_deferred_streams);
+    }
+    delete[] deferred_streams;
+    deferred_streams = new_streams;
+    deferred_streams_capacity = new_capacity;
+    return true;
+}
+
+// move entry i towards the root until its parent is due before it,
+// returning its new index
+uint8_t GCS_MAVLINK::sift_deferred_stream_up(uint8_t i)
+{
+    const deferred_stream_t entry = deferred_streams[i];
+    while (i > 0) {
+        const uint8_t parent = (i - 1) / 2;
+        if (int32_t(deferred_streams[parent].due_ms - entry.due_ms) <= 0) {
+            break;
         }
-        const uint16_t interval = get_reschedule_interval_ms(deferred_message_bucket[i]);
-        const uint16_t ms_since_last_sent = now16_ms - deferred_message_bucket[i].last_sent_ms;
-        uint16_t ms_before_send_this_bucket;
-        if (ms_since_last_sent > interval) {
-            // should already have sent this bucket!
-            ms_before_send_this_bucket = 0;
-        } else {
-            ms_before_send_this_bucket = interval - ms_since_last_sent;
+        deferred_streams[i] = deferred_streams[parent];
+        i = parent;
+    }
+    deferred_streams[i] = entry;
+    return i;
+}
+
+// move entry i away from the root until both its children are due
+// after it
+void GCS_MAVLINK::sift_deferred_stream_down(uint8_t i)
+{
+    const deferred_stream_t entry = deferred_streams[i];
+    while (true) {
+        uint16_t child = 2U * i + 1;
+        if (child >= num_deferred_streams) {
+            break;
         }
-        if (ms_before_send_this_bucket < ms_before_send_next_bucket_to_send) {
-            sending_bucket_id = i;
-            ms_before_send_next_bucket_to_send = ms_before_send_this_bucket;
+        if (child + 1U < num_deferred_streams &&
+            int32_t(deferred_streams[child+1].due_ms - deferred_streams[child].due_ms) < 0) {
+            child++;
+        }
+        if (int32_t(entry.due_ms - deferred_streams[child].due_ms) <= 0) {
+            break;
         }
+        deferred_streams[i] = deferred_streams[child];
+        i = child;
     }
-    if (sending_bucket_id != no_bucket_to_send) {
-        bucket_message_ids_to_send = deferred_message_bucket[sending_bucket_id].ap_message_ids;
-    } else {
-        bucket_message_ids_to_send.clearall();
+    deferred_streams[i] = entry;
+}
+
+void GCS_MAVLINK::add_deferred_stream(ap_message id, uint16_t interval_ms)
+{
+    deferred_stream_t &entry = deferred_streams[num_deferred_streams];
+    entry.id = id;
+    entry.interval_ms = interval_ms;
+    entry.due_ms = AP_HAL::millis() + get_reschedule_interval_ms(interval_ms, deferred_streams_slowdown_ms, deferred_streams_multiplier);
+    sift_deferred_stream_up(num_deferred_streams++);
+}
+
+void GCS_MAVLINK::remove_deferred_stream(uint8_t i)
+{
+    num_deferred_streams--;
+    if (i == num_deferred_streams) {
+        return;
     }
+    // fill the hole with the last entry, which may belong either
+    // above or below it
+    deferred_streams[i] = deferred_streams[num_deferred_streams];
+    sift_deferred_stream_down(sift_deferred_stream_up(i));
+}
+
+// typical runtime is a handful of comparisons: log2 of the number of
+// stream-rated messages
+void GCS_MAVLINK::reschedule_deferred_stream(uint32_t now_ms)
+{
+#if GCS_DEBUG_SEND_MESSAGE_TIMINGS
+    void *data = hal.scheduler->disable_interrupts_save();
+    uint32_t start_us = AP_HAL::micros();
+#endif
+
+    deferred_stream_t &entry = deferred_streams[0];
+    // we try to keep output on a regular clock to avoid user
+    // support questions:
+    const uint16_t interval_ms = get_reschedule_interval_ms(entry.interval_ms, deferred_streams_slowdown_ms, deferred_streams_multiplier);
+    entry.due_ms += interval_ms;
+    // but we do not want to try to catch up too much:
+    if (int32_t(now_ms - entry.due_ms) > 0) {
+        entry.due_ms = now_ms + interval_ms;
+    }
+    sift_deferred_stream_down(0);
 
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     uint32_t delta_us = AP_HAL::micros() - start_us;
     hal.scheduler->restore_interrupts(data);
-    if (delta_us > try_send_message_stats.fnbts_maxtime) {
-        try_send_message_stats.fnbts_maxtime = delta_us;
+    if (delta_us > try_send_message_stats.reschedule_maxtime) {
+        try_send_message_stats.reschedule_maxtime = delta_us;
     }
 #endif
 }
 
-ap_message GCS_MAVLINK::next_deferred_bucket_message_to_send(uint16_t now16_ms)
+ap_message GCS_MAVLINK::next_deferred_stream_message_to_send(uint32_t now_ms) const
 {
-    if (sending_bucket_id == no_bucket_to_send) {
+    if (num_deferred_streams == 0) {
         // could happen if all streamrates are zero?
         return no_message_to_send;
     }
-
-    const uint16_t ms_since_last_sent = now16_ms - deferred_message_bucket[sending_bucket_id].last_sent_ms;
-    if (ms_since_last_sent < get_reschedule_interval_ms(deferred_message_bucket[sending_bucket_id])) {
-        // not time to send this bucket
+    if (int32_t(now_ms - deferred_streams[0].due_ms) < 0) {
+        // not time to send the earliest message
         return no_message_to_send;
     }
+    return deferred_streams[0].id;
+}
 
-    const int16_t next = bucket_message_ids_to_send.first_set();
-    if (next == -1) {
-        // should not happen
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        AP_HAL::panic("next_deferred_bucket_message_to_send called on empty bucket");
-#endif
-        find_next_bucket_to_send(now16_ms);
-        return no_message_to_send;
+float GCS_MAVLINK::get_requested_stream_rate() const
+{
+    float rate_hz = 0;
+    for (uint8_t i=0; i<num_deferred_streams; i++) {
+        rate_hz += 1000.0f / deferred_streams[i].interval_ms;
     }
-    return (ap_message)next;
+    return rate_hz;
 }
 
 // call try_send_message if appropriate.  Incorporates debug code to
@@ -1471,6 +1577,8 @@ void GCS_MAVLINK::update_send()
         deferred_messages_initialised = true;
     }
 
+    update_deferred_stream_penalty();
+
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
     uint32_t retry_deferred_body_start = AP_HAL::micros();
 #endif
@@ -1540,23 +1648,15 @@ void GCS_MAVLINK::update_send()
             continue;
         }
 
-        ap_message next = next_deferred_bucket_message_to_send(start16);
+        ap_message next = next_deferred_stream_message_to_send(start);
         if (next != no_message_to_send) {
             if (!do_try_send_message(next)) {
                 break;
             }
-            bucket_message_ids_to_send.clear(next);
-            if (bucket_message_ids_to_send.count() == 0) {
-                // we sent everything in the bucket.  Reschedule it.
-                // we try to keep output on a regular clock to avoid
-                // user support questions:
-                const uint16_t interval_ms = get_reschedule_interval_ms(deferred_message_bucket[sending_bucket_id]);
-                deferred_message_bucket[sending_bucket_id].last_sent_ms += interval_ms;
-                // but we do not want to try to catch up too much:
-                if (uint16_t(start16 - deferred_message_bucket[sending_bucket_id].last_sent_ms) > interval_ms) {
-                    deferred_message_bucket[sending_bucket_id].last_sent_ms = start16;
-                }
-                find_next_bucket_to_send(start16);
+            deferred_stream_send_count++;
+            // sending may have changed the schedule
+            if (num_deferred_streams != 0 && deferred_streams[0].id == next) {
+                reschedule_deferred_stream(start);
             }
 #if GCS_DEBUG_SEND_MESSAGE_TIMINGS
                 const uint32_t stop = AP_HAL::micros();
@@ -1586,34 +1686,6 @@ void GCS_MAVLINK::update_send()
     last_tx_seq = _channel_status.current_tx_seq;
 }
 
-void GCS_MAVLINK::remove_message_from_bucket(int8_t bucket, ap_message id)
-{
-    deferred_message_bucket[bucket].ap_message_ids.clear(id);
-    if (deferred_message_bucket[bucket].ap_message_ids.count() == 0) {
-        // bucket empty.  Free it:
-        deferred_message_bucket[bucket].interval_ms = 0;
-        deferred_message_bucket[bucket].last_sent_ms = 0;
-    }
-
-    if (bucket == sending_bucket_id) {
-        bucket_message_ids_to_send.clear(id);
-        if (bucket_message_ids_to_send.count() == 0) {
-            find_next_bucket_to_send(AP_HAL::millis16());
-        } else {
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-            if (deferred_message_bucket[bucket].interval_ms == 0 &&
-                deferred_message_bucket[bucket].last_sent_ms == 0) {
-                // we just freed this bucket!  this would mean that
-                // somehow our messages-still-to-send was a superset
-                // of the messages in the bucket we were sending,
-                // which would be bad.
-                INTERNAL_ERROR(AP_InternalError::error_t::flow_of_control);
-            }
-#endif
-        }
-    }
-}
-
 bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_ms)
 {
     if (id == MSG_NEXT_PARAM) {
@@ -1642,82 +1714,36 @@ bool GCS_MAVLINK::set_ap_message_interval(enum ap_message id, uint16_t interval_
         return true;
     }
 
-    // see which bucket has the closest interval:
-    int8_t closest_bucket = -1;
-    uint16_t closest_bucket_interval_delta = UINT16_MAX;
-    int8_t in_bucket = -1;
-    int8_t empty_bucket_id = -1;
-    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-        const deferred_message_bucket_t &bucket = deferred_message_bucket[i];
-        if (bucket.interval_ms == 0) {
-            // unused bucket
-            if (empty_bucket_id == -1) {
-                empty_bucket_id = i;
-            }
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-            if (bucket.ap_message_ids.count() != 0) {
-                AP_HAL::panic("Bucket %u has zero interval but with ids set", i);
-            }
-#endif
-            continue;
-        }
-        if (bucket.ap_message_ids.get(id)) {
-            in_bucket = i;
-        }
-        const uint16_t interval_delta = abs(bucket.interval_ms - interval_ms);
-        if (interval_delta < closest_bucket_interval_delta) {
-            closest_bucket = i;
-            closest_bucket_interval_delta = interval_delta;
+    const int16_t index = find_deferred_stream(id);
+    if (interval_ms == 0) {
+        // told to remove from scheduling
+        if (index != -1) {
+            remove_deferred_stream(index);
         }
-    }
-
-    if (in_bucket == -1 && interval_ms == 0) {
-        // not in a bucket and told to remove from scheduling
         return true;
     }
 
-    if (in_bucket != -1) {
-        if (interval_ms == 0) {
-            // remove it
-            remove_message_from_bucket(in_bucket, id);
-            return true;
-        }
-        if (closest_bucket_interval_delta == 0 &&
-            in_bucket == closest_bucket) {
+    if (index != -1) {
+        deferred_stream_t &entry = deferred_streams[index];
+        if (entry.interval_ms == interval_ms) {
             // don't need to move it
             return true;
         }
-        // remove from existing bucket
-        remove_message_from_bucket(in_bucket, id);
-        if (empty_bucket_id == -1 &&
-            deferred_message_bucket[in_bucket].ap_message_ids.count() == 0) {
-            empty_bucket_id = in_bucket;
-        }
+        // keep the time it was last sent, moving the next send to
+        // suit the new interval
+        entry.due_ms -= get_reschedule_interval_ms(entry.interval_ms, deferred_streams_slowdown_ms, deferred_streams_multiplier);
+        entry.due_ms += get_reschedule_interval_ms(interval_ms, deferred_streams_slowdown_ms, deferred_streams_multiplier);
+        entry.interval_ms = interval_ms;
+        sift_deferred_stream_down(sift_deferred_stream_up(index));
+        return true;
     }
 
-    if (closest_bucket == -1 && empty_bucket_id == -1) {
-        // gah?!
-#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
-        ::fprintf(stderr, "no buckets?!\n");
-        abort();
-#endif
+    if (num_deferred_streams == deferred_streams_capacity &&
+        !expand_deferred_streams()) {
         return false;
     }
 
-    if (closest_bucket_interval_delta != 0 &&
-        empty_bucket_id != -1) {
-        // allocate a bucket for this interval
-        deferred_message_bucket[empty_bucket_id].interval_ms = interval_ms;
-        deferred_message_bucket[empty_bucket_id].last_sent_ms = AP_HAL::millis16();
-        closest_bucket = empty_bucket_id;
-    }
-
-    deferred_message_bucket[closest_bucket].ap_message_ids.set(id);
-
-    if (sending_bucket_id == no_bucket_to_send) {
-        sending_bucket_id = closest_bucket;
-        bucket_message_ids_to_send = deferred_message_bucket[closest_bucket].ap_message_ids;
-    }
+    add_deferred_stream(id, interval_ms);
 
     return true;
 }
@@ -1915,12 +1941,12 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
                             try_send_message_stats.behind);
             try_send_message_stats.behind = 0;
         }
-        if (try_send_message_stats.fnbts_maxtime) {
+        if (try_send_message_stats.reschedule_maxtime) {
             gcs().send_text(MAV_SEVERITY_INFO,
-                            "GCS.chan(%u): fnbts_maxtime=%uus",
+                            "GCS.chan(%u): reschedule_maxtime=%uus",
                             chan,
-                            try_send_message_stats.fnbts_maxtime);
-            try_send_message_stats.fnbts_maxtime = 0;
+                            try_send_message_stats.reschedule_maxtime);
+            try_send_message_stats.reschedule_maxtime = 0;
         }
         if (try_send_message_stats.max_retry_deferred_body_us) {
             gcs().send_text(MAV_SEVERITY_INFO,
@@ -1932,15 +1958,16 @@ GCS_MAVLINK::update_receive(uint32_t max_time_us)
             try_send_message_stats.max_retry_deferred_body_us = 0;
         }
 
-        for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
+        if (num_deferred_streams != 0) {
+            const uint32_t sent = deferred_stream_send_count - try_send_message_stats.stream_send_count;
+            const uint16_t dt_ms = now16_ms - try_send_message_stats.statustext_last_sent_ms;
             gcs().send_text(MAV_SEVERITY_INFO,
-                            "B. intvl. (%u): %u %u %u %u %u",
+                            "GCS.chan(%u): streams=%u rate=%.1f/%.1fHz",
                             chan,
-                            deferred_message_bucket[0].interval_ms,
-                            deferred_message_bucket[1].interval_ms,
-                            deferred_message_bucket[2].interval_ms,
-                            deferred_message_bucket[3].interval_ms,
-                            deferred_message_bucket[4].interval_ms);
+                            num_deferred_streams,
+                            sent * 1000.0f / dt_ms,
+                            get_requested_stream_rate());
+            try_send_message_stats.stream_send_count = deferred_stream_send_count;
         }
 
         try_send_message_stats.statustext_last_sent_ms = now16_ms;
@@ -1971,6 +1998,12 @@ void GCS_MAVLINK::log_mavlink_stats()
         flags |= (uint8_t)Flags::LOCKED;
     }
 
+    // last_mavlink_stats_logged is the time of the previous MAV message
+    const uint32_t now_ms = AP_HAL::millis();
+    const uint32_t dt_ms = now_ms - last_mavlink_stats_logged;
+    const uint32_t streams_sent = deferred_stream_send_count - deferred_stream_send_count_logged;
+    deferred_stream_send_count_logged = deferred_stream_send_count;
+
     const struct log_MAV pkt{
     LOG_PACKET_HEADER_INIT(LOG_MAV_MSG),
     time_us                : AP_HAL::micros64(),
@@ -1981,6 +2014,8 @@ void GCS_MAVLINK::log_mavlink_stats()
     flags                  : flags,
     stream_slowdown_ms     : stream_slowdown_ms,
     times_full             : out_of_space_to_send_count,
+    stream_rate_requested  : get_requested_stream_rate(),
+    stream_rate_achieved   : dt_ms > 0 ? streams_sent * 1000.0f / dt_ms : 0,
     };
 
     AP::logger().WriteBlock(&pkt, sizeof(pkt));
@@ -3013,13 +3048,11 @@ bool GCS_MAVLINK::get_ap_message_interval(ap_message id, uint16_t &interval_ms)
         return true;
     }
 
-    // check the deferred message buckets:
-    for (uint8_t i=0; i<ARRAY_SIZE(deferred_message_bucket); i++) {
-        const deferred_message_bucket_t &bucket = deferred_message_bucket[i];
-        if (bucket.ap_message_ids.get(id)) {
-            interval_ms = bucket.interval_ms;
-            return true;
-        }
+    // check the stream-rated messages:
+    const int16_t index = find_deferred_stream(id);
+    if (index != -1) {
+        interval_ms = deferred_streams[index].interval_ms;
+        return true;
     }
 
     return false;
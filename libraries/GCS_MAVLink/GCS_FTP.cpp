@@ -26,6 +26,7 @@
 #include <AP_Filesystem/AP_Filesystem.h>
 #include <AP_HAL/utility/sparse-endian.h>
 #include <AP_BoardConfig/AP_BoardConfig.h>
+#include <AP_Common/ExpandingString.h>
 
 extern const AP_HAL::HAL& hal;
 
@@ -156,6 +157,7 @@ void GCS_MAVLINK::ftp_error(struct pending_ftp &response, FTP_ERROR error) {
 void GCS_MAVLINK::ftp_push_replies(pending_ftp &reply)
 {
     while (!send_ftp_reply(reply)) {
+        ftp.tx_full = true;
         hal.scheduler->delay(2);
     }
 }
@@ -176,6 +178,7 @@ void GCS_MAVLINK::ftp_worker(void) {
         // if it's a rerequest and we still have the last response then send it
         if ((request.sysid == reply.sysid) && (request.compid == reply.compid) &&
             (request.session == reply.session) && (request.seq_number + 1 == reply.seq_number)) {
+            ftp.stats.retries++;
             ftp_push_replies(reply);
             continue;
         }
@@ -232,6 +235,9 @@ void GCS_MAVLINK::ftp_worker(void) {
                         ftp.fd = -1;
                     }
                     ftp.current_session = -1;
+                    // give the read-ahead buffer back until the next read
+                    delete[] ftp.readahead;
+                    ftp.readahead = nullptr;
                     reply.opcode = FTP_OP::Ack;
                     break;
                 case FTP_OP::ListDirectory:
@@ -278,6 +284,9 @@ void GCS_MAVLINK::ftp_worker(void) {
                         }
                         ftp.mode = FTP_FILE_MODE::Read;
                         ftp.current_session = request.session;
+                        ftp.readahead_len = 0;
+                        ftp.burst_end_offset = 0;
+                        ftp.burst_loss = false;
 
                         reply.opcode = FTP_OP::Ack;
                         reply.size = sizeof(uint32_t);
@@ -303,14 +312,10 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                        ftp_check_reread(request.offset);
 
                         // fill the buffer
-                        const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data),request.size));
+                        const ssize_t read_bytes = ftp_read(request.offset, reply.data, MIN(sizeof(reply.data),request.size));
                         if (read_bytes == -1) {
                             ftp_error(reply, FTP_ERROR::FailErrno);
                             break;
@@ -472,35 +477,35 @@ void GCS_MAVLINK::ftp_worker(void) {
                             break;
                         }
 
-                        // seek to requested offset
-                        if (AP::FS().lseek(ftp.fd, request.offset, SEEK_SET) == -1) {
-                            ftp_error(reply, FTP_ERROR::FailErrno);
-                            break;
-                        }
+                        ftp_check_reread(request.offset);
 
                         /*
-                          calculate a burst delay so that FTP burst
-                          transfer doesn't use more than 1/3 of
-                          available bandwidth on links that don't have
-                          flow control. This reduces the chance of
-                          lost packets a lot, which results in overall
-                          faster transfers
+                          pace the burst on links that don't have
+                          flow control, starting at 1/3 of the
+                          available bandwidth and adapting to the
+                          data the GCS asks for again. This reduces
+                          the chance of lost packets a lot, which
+                          results in overall faster transfers
                          */
-                        uint32_t burst_delay_ms = 0;
+                        const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
+                        uint32_t pace_bps = 0;
                         if (valid_channel(request.chan)) {
                             auto *port = mavlink_comm_port[request.chan];
                             if (port != nullptr && port->get_flow_control() != AP_HAL::UARTDriver::FLOW_CONTROL_ENABLE) {
-                                const uint32_t bw = port->bw_in_bytes_per_second();
-                                const uint16_t pkt_size = PAYLOAD_SIZE(request.chan, FILE_TRANSFER_PROTOCOL) - (sizeof(reply.data) - max_read);
-                                burst_delay_ms = 3000 * pkt_size / bw;
+                                pace_bps = ftp_update_pace(request.chan, request.offset, port->bw_in_bytes_per_second());
                             }
                         }
+                        ftp.tx_full = false;
+
+                        const uint32_t burst_start_us = AP_HAL::micros();
+                        uint32_t burst_pkt_bytes = 0;
+                        uint32_t offset = request.offset;
 
                         // this transfer size is enough for a full parameter file with max parameters
                         const uint32_t transfer_size = 500;
                         for (uint32_t i = 0; (i < transfer_size); i++) {
                             // fill the buffer
-                            const ssize_t read_bytes = AP::FS().read(ftp.fd, reply.data, MIN(sizeof(reply.data), max_read));
+                            const ssize_t read_bytes = ftp_read(offset, reply.data, MIN(sizeof(reply.data), max_read));
                             if (read_bytes == -1) {
                                 ftp_error(reply, FTP_ERROR::FailErrno);
                                 break;
@@ -517,7 +522,7 @@ void GCS_MAVLINK::ftp_worker(void) {
                             }
 
                             reply.opcode = FTP_OP::Ack;
-                            reply.offset = request.offset + i * max_read;
+                            reply.offset = offset;
                             reply.burst_complete = (i == (transfer_size - 1));
                             reply.size = (uint8_t)read_bytes;
 
@@ -527,12 +532,32 @@ void GCS_MAVLINK::ftp_worker(void) {
                                 // ensure the NACK which we send next is at the right offset
                                 reply.offset += read_bytes;
                             }
+                            offset += read_bytes;
 
                             // prep the reply to be used again
                             reply.seq_number++;
 
-                            hal.scheduler->delay(burst_delay_ms);
+                            // sleep until we are back on the paced schedule
+                            burst_pkt_bytes += pkt_size;
+                            if (pace_bps != 0) {
+                                const uint32_t due_us = uint64_t(burst_pkt_bytes) * 1000000ULL / pace_bps;
+                                const uint32_t elapsed_us = AP_HAL::micros() - burst_start_us;
+                                if (due_us >= elapsed_us + 1000) {
+                                    hal.scheduler->delay((due_us - elapsed_us) / 1000);
+                                }
+                            }
+                        }
+
+                        const uint32_t burst_us = MAX(AP_HAL::micros() - burst_start_us, 1U);
+                        if (pace_bps != 0 && ftp.tx_full) {
+                            // the link could not keep up; pace at the rate it drained
+                            const uint32_t drained_bps = uint64_t(burst_pkt_bytes) * 1000000ULL / burst_us;
+                            ftp.pace_bps = MAX(MIN(ftp.pace_bps, drained_bps), 1U);
                         }
+                        ftp.burst_end_offset = offset;
+                        ftp.stats.bursts++;
+                        ftp.stats.bytes_sent += offset - request.offset;
+                        ftp.stats.last_rate_bps = uint64_t(offset - request.offset) * 1000000ULL / burst_us;
 
                         if (reply.opcode != FTP_OP::Nack) {
                             // prevent a duplicate packet send for
@@ -579,6 +604,96 @@ void GCS_MAVLINK::ftp_worker(void) {
     }
 }
 
+/*
+  read len bytes at offset from the open file into data, via the
+  read-ahead buffer. Returns the number of bytes read, which is short
+  only at the end of the file, or -1 on error
+ */
+ssize_t GCS_MAVLINK::ftp_read(uint32_t offset, uint8_t *data, uint16_t len)
+{
+    if (ftp.readahead == nullptr) {
+        ftp.readahead = new uint8_t[AP_MAVLINK_FTP_READAHEAD_SIZE];
+        ftp.readahead_len = 0;
+    }
+    if (ftp.readahead == nullptr) {
+        // no memory for read-ahead, read directly
+        if (AP::FS().lseek(ftp.fd, offset, SEEK_SET) == -1) {
+            return -1;
+        }
+        ftp.stats.fs_reads++;
+        return AP::FS().read(ftp.fd, data, len);
+    }
+
+    uint16_t copied = 0;
+    while (copied < len) {
+        const uint32_t ofs = offset + copied;
+        if (ofs < ftp.readahead_offset || ofs >= ftp.readahead_offset + ftp.readahead_len) {
+            // refill the buffer starting at the data we need
+            if (AP::FS().lseek(ftp.fd, ofs, SEEK_SET) == -1) {
+                ftp.readahead_len = 0;
+                return -1;
+            }
+            const ssize_t read_bytes = AP::FS().read(ftp.fd, ftp.readahead, AP_MAVLINK_FTP_READAHEAD_SIZE);
+            ftp.stats.fs_reads++;
+            if (read_bytes == -1) {
+                ftp.readahead_len = 0;
+                return -1;
+            }
+            ftp.readahead_offset = ofs;
+            ftp.readahead_len = read_bytes;
+            if (read_bytes == 0) {
+                // end of file
+                break;
+            }
+        }
+        const uint16_t n = MIN(uint32_t(len - copied), ftp.readahead_offset + ftp.readahead_len - ofs);
+        memcpy(&data[copied], &ftp.readahead[ofs - ftp.readahead_offset], n);
+        copied += n;
+    }
+    return copied;
+}
+
+// a read of data already sent in a burst means the GCS lost some of it
+void GCS_MAVLINK::ftp_check_reread(uint32_t offset)
+{
+    if (offset < ftp.burst_end_offset) {
+        ftp.burst_loss = true;
+        ftp.stats.retries++;
+    }
+}
+
+/*
+  return the rate in bytes/s to pace a burst read starting at offset,
+  given the link bandwidth. The rate is halved when the GCS has asked
+  for data from a burst again and raised by a quarter when a burst
+  arrived complete without filling the link
+ */
+uint32_t GCS_MAVLINK::ftp_update_pace(mavlink_channel_t chan, uint32_t offset, uint32_t bw)
+{
+    if (ftp.pace_bps == 0 || ftp.pace_chan != chan) {
+        ftp.pace_bps = bw / 3;
+        ftp.pace_chan = chan;
+    } else if (ftp.burst_loss) {
+        ftp.pace_bps = MAX(ftp.pace_bps / 2, bw / 8);
+    } else if (offset == ftp.burst_end_offset && !ftp.tx_full) {
+        ftp.pace_bps = MIN(ftp.pace_bps + ftp.pace_bps / 4, bw);
+    }
+    ftp.burst_loss = false;
+    ftp.pace_bps = MAX(ftp.pace_bps, 1U);
+    return ftp.pace_bps;
+}
+
+void GCS_MAVLINK::ftp_info(ExpandingString &str)
+{
+    str.printf("FTP bytes=%u bursts=%u rate=%uB/s pace=%uB/s retries=%u fsreads=%u\n",
+               unsigned(ftp.stats.bytes_sent),
+               unsigned(ftp.stats.bursts),
+               unsigned(ftp.stats.last_rate_bps),
+               unsigned(ftp.pace_bps),
+               unsigned(ftp.stats.retries),
+               unsigned(ftp.stats.fs_reads));
+}
+
 // calculates how much string length is needed to fit this in a list response
 int GCS_MAVLINK::gen_dir_entry(char *dest, size_t space, const char *path, const struct dirent * entry) {
     const bool is_file = entry->d_type == DT_REG || entry->d_type == DT_LNK;
@@ -88,6 +88,16 @@
 #define AP_MAVLINK_FTP_ENABLED HAL_GCS_ENABLED
 #endif
 
+// size of the buffer FTP file reads are made into; reply packets are
+// served from it so the filesystem sees a few large reads
+#ifndef AP_MAVLINK_FTP_READAHEAD_SIZE
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 4096
+#else
+#define AP_MAVLINK_FTP_READAHEAD_SIZE 1024
+#endif
+#endif
+
 // GCS should be using MISSION_REQUEST_INT instead; this is a waste of
 // flash.  MISSION_REQUEST was deprecated in June 2020.  We started
 // sending warnings to the GCS in Sep 2022 if this command was used.
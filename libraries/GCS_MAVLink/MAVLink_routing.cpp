@@ -25,13 +25,42 @@
 #include <AP_Common/AP_Common.h>
 #include "GCS.h"
 #include "MAVLink_routing.h"
+#include <AP_Logger/AP_Logger.h>
 
 extern const AP_HAL::HAL& hal;
 
 #define ROUTING_DEBUG 0
 
+// initial number of routes the table can hold before growing
+#define MAVLINK_MIN_ROUTES 8
+
+// Fibonacci hash of a sysid/compid or sysid into a table of 1<<bits slots
+static inline uint16_t route_hash(uint16_t key, uint8_t bits)
+{
+    return (uint32_t(key) * 2654435761U) >> (32 - bits);
+}
+
 // constructor
-MAVLink_routing::MAVLink_routing(void) : num_routes(0) {}
+MAVLink_routing::MAVLink_routing(void) :
+    routes(nullptr),
+    num_routes(0),
+    route_capacity(0),
+    route_index(nullptr),
+    systems(nullptr),
+    num_systems(0),
+    index_bits(0),
+    route_channel_mask(0),
+    stats{},
+    no_route_mask(0)
+{}
+
+// destructor
+MAVLink_routing::~MAVLink_routing(void)
+{
+    delete[] routes;
+    delete[] route_index;
+    delete[] systems;
+}
 
 /*
   forward a MAVLink message to the right port. This also
@@ -114,6 +143,8 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
     // so that find_mav_type works for all channels
     learn_route(in_link, msg);
 
+    update(AP_HAL::millis());
+
     if (msg.msgid == MAVLINK_MSG_ID_RADIO ||
         msg.msgid == MAVLINK_MSG_ID_RADIO_STATUS) {
         // don't forward RADIO packets
@@ -164,45 +195,52 @@ bool MAVLink_routing::check_and_forward(GCS_MAVLINK &in_link, const mavlink_mess
         return true;
     }
 
+    // find the channels matching the targets. A private channel
+    // only gets messages targeted at exactly the sysid/compid seen on it
+    const uint16_t private_mask = GCS_MAVLINK::private_channel_mask();
+    uint16_t mask = 0;
+    if (broadcast_system) {
+        mask = route_channel_mask & ~private_mask;
+    } else {
+        if (target_component >= 0) {
+            const route *r = find_route(target_system, target_component);
+            if (r != nullptr) {
+                mask = r->channel_mask;
+            }
+        }
+        if (broadcast_component || !match_system) {
+            mask |= find_system_channels(target_system) & ~private_mask;
+        }
+    }
+
+    // never send back on the incoming channel
+    mask &= ~(1U<<(in_link.get_chan()-MAVLINK_COMM_0));
+
     // forward on any channels matching the targets
     bool forwarded = false;
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS];
-    memset(sent_to_chan, 0, sizeof(sent_to_chan));
-    for (uint8_t i=0; i<num_routes; i++) {
-
-        // Skip if channel is private and the target system or component IDs do not match
-        GCS_MAVLINK *out_link = gcs().chan(routes[i].channel);
-        if (out_link == nullptr) {
-            // this is bad
+    for (uint8_t i=0; mask != 0 && i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((mask & (1U<<i)) == 0) {
             continue;
         }
-        if (out_link->is_private() &&
-            (target_system != routes[i].sysid ||
-             target_component != routes[i].compid)) {
+        mask &= ~(1U<<i);
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        GCS_MAVLINK *out_link = gcs().chan(channel);
+        if (out_link == nullptr) {
+            // this is bad
             continue;
         }
-
-        if (broadcast_system || (target_system == routes[i].sysid &&
-                                 (broadcast_component || 
-                                  target_component == routes[i].compid ||
-                                  !match_system))) {
-
-            if (&in_link != out_link && !sent_to_chan[routes[i].channel]) {
-                if (out_link->check_payload_size(msg.len)) {
+        if (out_link->check_payload_size(msg.len)) {
 #if ROUTING_DEBUG
-                    ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
-                             msg.msgid,
-                             (unsigned)in_link->get_chan(),
-                             (unsigned)routes[i].channel,
-                             (int)target_system,
-                             (int)target_component);
+            ::printf("fwd msg %u from chan %u on chan %u sysid=%d compid=%d\n",
+                     msg.msgid,
+                     (unsigned)in_link.get_chan(),
+                     (unsigned)channel,
+                     (int)target_system,
+                     (int)target_component);
 #endif
-                    _mavlink_resend_uart(routes[i].channel, &msg);
-                }
-                sent_to_chan[routes[i].channel] = true;
-                forwarded = true;
-            }
+            _mavlink_resend_uart(channel, &msg);
         }
+        forwarded = true;
     }
 
     if ((!forwarded && match_system) ||
@@ -229,29 +267,24 @@ void MAVLink_routing::send_to_components(uint32_t msgid, const char *pkt, uint8_
 
 void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entry_t *entry, const uint8_t pkt_len)
 {
-    bool sent_to_chan[MAVLINK_COMM_NUM_BUFFERS] {};
+    // channels on which our system ID has been seen
+    const uint16_t mask = find_system_channels(mavlink_system.sysid);
 
-    // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid != mavlink_system.sysid) {
-            // our system ID hasn't been seen on this link
-            continue;
-        }
-        if (sent_to_chan[routes[i].channel]) {
-            // we've already send it on this link
+    for (uint8_t i=0; i<MAVLINK_COMM_NUM_BUFFERS; i++) {
+        if ((mask & (1U<<i)) == 0) {
             continue;
         }
-        if (comm_get_txspace(routes[i].channel) <
-            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(routes[i].channel)) {
+        const mavlink_channel_t channel = (mavlink_channel_t)(MAVLINK_COMM_0 + i);
+        if (comm_get_txspace(channel) <
+            ((uint16_t)entry->max_msg_len) + GCS_MAVLINK::packet_overhead_chan(channel)) {
             // it doesn't fit on this channel
             continue;
         }
 #if ROUTING_DEBUG
-        ::printf("send msg %u on chan %u sysid=%u compid=%u\n",
+        ::printf("send msg %u on chan %u sysid=%u\n",
                  entry->msgid,
-                 (unsigned)routes[i].channel,
-                 (unsigned)routes[i].sysid,
-                 (unsigned)routes[i].compid);
+                 (unsigned)channel,
+                 (unsigned)mavlink_system.sysid);
 #endif
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
         if (entry->max_msg_len > pkt_len) {
@@ -259,13 +292,12 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
                           entry->max_msg_len, pkt_len);
         }
 #endif
-        _mav_finalize_message_chan_send(routes[i].channel,
+        _mav_finalize_message_chan_send(channel,
                                         entry->msgid,
                                         pkt,
                                         entry->min_msg_len,
                                         MIN(entry->max_msg_len, pkt_len),
                                         entry->crc_extra);
-        sent_to_chan[routes[i].channel] = true;
     }
 }
 
@@ -276,7 +308,7 @@ void MAVLink_routing::send_to_components(const char *pkt, const mavlink_msg_entr
 bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &compid, mavlink_channel_t &channel)
 {
     // check learned routes
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint16_t i=0; i<num_routes; i++) {
         if (routes[i].mavtype == mavtype) {
             sysid = routes[i].sysid;
             compid = routes[i].compid;
@@ -295,7 +327,7 @@ bool MAVLink_routing::find_by_mavtype(uint8_t mavtype, uint8_t &sysid, uint8_t &
  */
 bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const
 {
-    for (uint8_t i=0; i<num_routes; i++) {
+    for (uint16_t i=0; i<num_routes; i++) {
         if ((routes[i].mavtype == mavtype) && (routes[i].compid == compid)) {
             sysid = routes[i].sysid;
             channel = routes[i].channel;
@@ -305,12 +337,139 @@ bool MAVLink_routing::find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid
     return false;
 }
 
+/*
+  lookup a learned route, returns nullptr if not found
+*/
+MAVLink_routing::route *MAVLink_routing::find_route(uint8_t sysid, uint8_t compid) const
+{
+    if (route_index == nullptr) {
+        return nullptr;
+    }
+    const uint16_t slot_mask = (1U<<index_bits) - 1;
+    for (uint16_t slot = route_hash((sysid<<8) | compid, index_bits); ; slot = (slot + 1) & slot_mask) {
+        const uint16_t i = route_index[slot];
+        if (i == 0) {
+            return nullptr;
+        }
+        route &r = routes[i-1];
+        if (r.sysid == sysid && r.compid == compid) {
+            return &r;
+        }
+    }
+}
+
+/*
+  return the channels on which a system has been seen
+*/
+uint16_t MAVLink_routing::find_system_channels(uint8_t sysid) const
+{
+    if (systems == nullptr) {
+        return 0;
+    }
+    const uint16_t slot_mask = (1U<<index_bits) - 1;
+    for (uint16_t slot = route_hash(sysid, index_bits); ; slot = (slot + 1) & slot_mask) {
+        const system_route &s = systems[slot];
+        if (s.sysid == sysid) {
+            return s.channel_mask;
+        }
+        if (s.sysid == 0) {
+            return 0;
+        }
+    }
+}
+
+/*
+  add a route to the hash tables. The tables are always kept at most
+  half full so there is always a free slot
+*/
+void MAVLink_routing::index_route(uint16_t i)
+{
+    const route &r = routes[i];
+    const uint16_t slot_mask = (1U<<index_bits) - 1;
+
+    uint8_t probe = 1;
+    uint16_t slot = route_hash((r.sysid<<8) | r.compid, index_bits);
+    while (route_index[slot] != 0) {
+        slot = (slot + 1) & slot_mask;
+        probe++;
+    }
+    route_index[slot] = i + 1;
+    stats.max_probe = MAX(stats.max_probe, probe);
+
+    slot = route_hash(r.sysid, index_bits);
+    while (systems[slot].sysid != 0 && systems[slot].sysid != r.sysid) {
+        slot = (slot + 1) & slot_mask;
+    }
+    if (systems[slot].sysid == 0) {
+        systems[slot].sysid = r.sysid;
+        num_systems++;
+    }
+    systems[slot].channel_mask |= r.channel_mask;
+    route_channel_mask |= r.channel_mask;
+}
+
+/*
+  regenerate the hash tables from the routes
+*/
+void MAVLink_routing::rebuild_index()
+{
+    memset(route_index, 0, sizeof(route_index[0]) << index_bits);
+    memset(systems, 0, sizeof(systems[0]) << index_bits);
+    num_systems = 0;
+    route_channel_mask = 0;
+    stats.max_probe = 0;
+    for (uint16_t i=0; i<num_routes; i++) {
+        index_route(i);
+    }
+}
+
+/*
+  grow the routing table, returns false if the table is full
+*/
+bool MAVLink_routing::expand_routes()
+{
+    if (route_capacity >= MAVLINK_MAX_ROUTES) {
+        return false;
+    }
+    const uint16_t new_capacity = MIN(MAX(route_capacity * 2, MAVLINK_MIN_ROUTES), MAVLINK_MAX_ROUTES);
+
+    // keep the hash tables at most half full
+    uint8_t new_bits = 1;
+    while ((1U<<new_bits) < new_capacity * 2U) {
+        new_bits++;
+    }
+
+    route *new_routes = new route[new_capacity];
+    uint16_t *new_route_index = new uint16_t[1U<<new_bits];
+    system_route *new_systems = new system_route[1U<<new_bits];
+    if (new_routes == nullptr || new_route_index == nullptr || new_systems == nullptr) {
+        delete[] new_routes;
+        delete[] new_route_index;
+        delete[] new_systems;
+        return false;
+    }
+
+    if (routes != nullptr) {
+        memcpy(new_routes, routes, sizeof(routes[0]) * num_routes);
+    }
+    delete[] routes;
+    delete[] route_index;
+    delete[] systems;
+    routes = new_routes;
+    route_index = new_route_index;
+    systems = new_systems;
+    route_capacity = new_capacity;
+    index_bits = new_bits;
+
+    rebuild_index();
+    return true;
+}
+
 /*
   see if the message is for a new route and learn it
 */
 void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t &msg)
 {
-    uint8_t i;
     if (msg.sysid == 0) {
         // don't learn routes to the broadcast system
         return;
@@ -328,33 +487,124 @@ void MAVLink_routing::learn_route(GCS_MAVLINK &in_link, const mavlink_message_t
         return;
     }
     const mavlink_channel_t in_channel = in_link.get_chan();
-    for (i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid &&
-            routes[i].compid == msg.compid &&
-            routes[i].channel == in_channel) {
-            if (routes[i].mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-                routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+    const uint16_t channel_bit = 1U<<(in_channel-MAVLINK_COMM_0);
+
+    route *r = find_route(msg.sysid, msg.compid);
+    if (r != nullptr) {
+        r->last_seen_ms = AP_HAL::millis();
+        if (r->mavtype == 0 && msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+            r->mavtype = mavlink_msg_heartbeat_get_type(&msg);
+        }
+        if ((r->channel_mask & channel_bit) == 0) {
+            // known route seen on a new channel
+            r->channel_mask |= channel_bit;
+            route_channel_mask |= channel_bit;
+            const uint16_t slot_mask = (1U<<index_bits) - 1;
+            uint16_t slot = route_hash(msg.sysid, index_bits);
+            while (systems[slot].sysid != msg.sysid) {
+                slot = (slot + 1) & slot_mask;
             }
-            break;
+            systems[slot].channel_mask |= channel_bit;
+            stats.changed = true;
         }
+        return;
     }
-    if (i == num_routes && i<MAVLINK_MAX_ROUTES) {
-        routes[i].sysid = msg.sysid;
-        routes[i].compid = msg.compid;
-        routes[i].channel = in_channel;
-        if (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) {
-            routes[i].mavtype = mavlink_msg_heartbeat_get_type(&msg);
+
+    if (num_routes == route_capacity && (stats.full || !expand_routes())) {
+        if (!stats.full) {
+            stats.full = true;
+            failed_routes.clearall();
+            gcs().send_text(MAV_SEVERITY_WARNING, "MAVLink routing table full (%u routes)", (unsigned)num_routes);
+        }
+        // count each component only once, components sharing a hash
+        // are counted as one
+        const uint8_t bit = route_hash((msg.sysid<<8) | msg.compid, 8);
+        if (!failed_routes.get(bit)) {
+            failed_routes.set(bit);
+            stats.learn_failures++;
+            stats.changed = true;
         }
-        num_routes++;
+        return;
+    }
+
+    route &new_route = routes[num_routes];
+    new_route.sysid = msg.sysid;
+    new_route.compid = msg.compid;
+    new_route.channel = in_channel;
+    new_route.mavtype = (msg.msgid == MAVLINK_MSG_ID_HEARTBEAT) ? mavlink_msg_heartbeat_get_type(&msg) : 0;
+    new_route.channel_mask = channel_bit;
+    new_route.last_seen_ms = AP_HAL::millis();
+    index_route(num_routes);
+    num_routes++;
+    stats.changed = true;
 #if ROUTING_DEBUG
-        ::printf("learned route %u %u via %u\n",
-                 (unsigned)msg.sysid,
-                 (unsigned)msg.compid,
-                 (unsigned)in_channel);
+    ::printf("learned route %u %u via %u\n",
+             (unsigned)msg.sysid,
+             (unsigned)msg.compid,
+             (unsigned)in_channel);
 #endif
-    }
 }
 
+/*
+  forget routes that have not been seen recently and log changes to
+  the routing table. Runs at most once a second
+*/
+void MAVLink_routing::update(uint32_t now_ms)
+{
+    if (now_ms - stats.last_update_ms < 1000) {
+        return;
+    }
+    stats.last_update_ms = now_ms;
+
+    // compact the routes, keeping them in the order they were learned
+    uint16_t count = 0;
+    for (uint16_t i=0; i<num_routes; i++) {
+        if (now_ms - routes[i].last_seen_ms > MAVLINK_ROUTE_TIMEOUT_MS) {
+#if ROUTING_DEBUG
+            ::printf("forgot route %u %u\n",
+                     (unsigned)routes[i].sysid,
+                     (unsigned)routes[i].compid);
+#endif
+            continue;
+        }
+        if (count != i) {
+            routes[count] = routes[i];
+        }
+        count++;
+    }
+    if (count != num_routes) {
+        stats.aged_out += num_routes - count;
+        num_routes = count;
+        stats.full = false;
+        stats.changed = true;
+        rebuild_index();
+    }
+
+    if (!stats.changed) {
+        return;
+    }
+    stats.changed = false;
+
+#if HAL_LOGGING_ENABLED
+// @LoggerMessage: MRTE
+// @Description: MAVLink routing table statistics
+// @Field: TimeUS: Time since system startup
+// @Field: Rt: number of routes learned
+// @Field: Sys: number of systems the routes lead to
+// @Field: Cap: number of routes the table can hold before it must grow
+// @Field: Fail: number of components which could not be learned as the table was full
+// @Field: Aged: number of routes forgotten as they had not been seen recently
+// @Field: Prb: longest probe sequence in the route hash table
+    AP::logger().Write("MRTE", "TimeUS,Rt,Sys,Cap,Fail,Aged,Prb", "s------", "F------", "QHHHHHB",
+                       AP_HAL::micros64(),
+                       num_routes,
+                       num_systems,
+                       route_capacity,
+                       stats.learn_failures,
+                       stats.aged_out,
+                       stats.max_probe);
+#endif
+}
 
 /*
   special handling for heartbeat messages. To ensure routing
@@ -375,10 +625,9 @@ void MAVLink_routing::handle_heartbeat(GCS_MAVLINK &link, const mavlink_message_
     mask &= ~no_route_mask;
     
     // mask out channels that are known sources for this sysid/compid
-    for (uint8_t i=0; i<num_routes; i++) {
-        if (routes[i].sysid == msg.sysid && routes[i].compid == msg.compid) {
-            mask &= ~(1U<<((unsigned)(routes[i].channel-MAVLINK_COMM_0)));
-        }
+    const route *r = find_route(msg.sysid, msg.compid);
+    if (r != nullptr) {
+        mask &= ~r->channel_mask;
     }
 
     if (mask == 0) {
@@ -2,12 +2,30 @@
 /// @brief	handle routing of MAVLink packets by ID
 #pragma once
 
+#include <AP_HAL/AP_HAL_Boards.h>
 #include <AP_Common/AP_Common.h>
+#include <AP_Common/Bitmask.h>
 #include "GCS_MAVLink.h"
 
-// 20 routes should be enough for now. This may need to increase as
-// we make more extensive use of MAVLink forwarding
+// maximum number of routes that will be learned. The routing table
+// starts small and grows as routes are learned up to this limit
+#ifndef MAVLINK_MAX_ROUTES
+#if HAL_MEM_CLASS >= HAL_MEM_CLASS_500
+#define MAVLINK_MAX_ROUTES 256
+#elif HAL_MEM_CLASS >= HAL_MEM_CLASS_300
+#define MAVLINK_MAX_ROUTES 64
+#else
 #define MAVLINK_MAX_ROUTES 20
+#endif
+#endif
+
+// routes that have not been seen for this long are forgotten, after
+// which messages targeted at that component are not forwarded until it
+// is heard from again. Components that are still sending messages, such
+// as their heartbeats, are never forgotten
+#ifndef MAVLINK_ROUTE_TIMEOUT_MS
+#define MAVLINK_ROUTE_TIMEOUT_MS 60000
+#endif
 
 /*
   object to handle MAVLink packet routing
@@ -15,9 +33,13 @@
 class MAVLink_routing
 {
     friend class GCS_MAVLINK;
-    
+
 public:
     MAVLink_routing(void);
+    ~MAVLink_routing(void);
+
+    /* Do not allow copies */
+    CLASS_NO_COPY(MAVLink_routing);
 
     /*
       forward a MAVLink message to the right port. This also
@@ -50,22 +72,75 @@ public:
     bool find_by_mavtype_and_compid(uint8_t mavtype, uint8_t compid, uint8_t &sysid, mavlink_channel_t &channel) const;
 
 private:
-    // a simple linear routing table. We don't expect to have a lot of
-    // routes, so a scalable structure isn't worthwhile yet.
-    uint8_t num_routes;
+    // routes in the order they were learned. A route is a
+    // sysid/compid pair and the channels it has been seen on
     struct route {
         uint8_t sysid;
         uint8_t compid;
-        mavlink_channel_t channel;
+        mavlink_channel_t channel;  // first channel the route was seen on
         uint8_t mavtype;
-    } routes[MAVLINK_MAX_ROUTES];
-    
+        uint16_t channel_mask;      // all channels the route has been seen on
+        uint32_t last_seen_ms;
+    } *routes;
+    uint16_t num_routes;
+    uint16_t route_capacity;
+
+    // open addressing hash table on sysid/compid holding the index
+    // into routes plus one, zero is an empty slot
+    uint16_t *route_index;
+
+    // open addressing hash table on sysid holding the channels each
+    // system has been seen on, a sysid of zero is an empty slot
+    struct system_route {
+        uint8_t sysid;
+        uint16_t channel_mask;
+    } *systems;
+    uint16_t num_systems;
+
+    // both hash tables hold 1<<index_bits slots
+    uint8_t index_bits;
+
+    // channels any route has been seen on
+    uint16_t route_channel_mask;
+
+    // routing table statistics, logged when they change
+    struct {
+        uint32_t last_update_ms;
+        uint16_t learn_failures;
+        uint16_t aged_out;
+        uint8_t max_probe;
+        bool changed;
+        bool full;              // the table could not grow, not retried until a route ages out
+    } stats;
+
+    // hashes of the components that could not be learned since the
+    // table filled, so each is counted once in stats.learn_failures
+    Bitmask<256> failed_routes;
+
     // a channel mask to block routing as required
     uint8_t no_route_mask;
     
     // learn new routes
     void learn_route(GCS_MAVLINK &link, const mavlink_message_t &msg);
 
+    // lookup a learned route, returns nullptr if not found
+    route *find_route(uint8_t sysid, uint8_t compid) const;
+
+    // channels on which a system has been seen
+    uint16_t find_system_channels(uint8_t sysid) const;
+
+    // grow the routing table, returns false if the table is full
+    bool expand_routes();
+
+    // add a route to the hash tables
+    void index_route(uint16_t i);
+
+    // regenerate the hash tables from the routes
+    void rebuild_index();
+
+    // forget routes not seen recently and log changes to the table
+    void update(uint32_t now_ms);
+
     // extract target sysid and compid from a message
     void get_targets(const mavlink_message_t &msg, int16_t &sysid, int16_t &compid);
 
@@ -0,0 +1,94 @@
+#include <AP_gbenchmark.h>
+
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+const struct AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+GCS_Dummy _gcs;
+
+// messages per second of traffic to route in each iteration
+#define MESSAGE_RATE 10000
+
+/*
+  link fixed to a channel. The GCS has no links of its own so nothing
+  is ever sent and only the cost of routing is measured
+ */
+class GCS_MAVLINK_Benchmark : public GCS_MAVLINK_Dummy
+{
+public:
+    GCS_MAVLINK_Benchmark(GCS_MAVLINK_Parameters &params, AP_HAL::UARTDriver &uart, uint8_t instance) :
+        GCS_MAVLINK_Dummy(params, uart)
+    {
+        chan = (mavlink_channel_t)(MAVLINK_COMM_0 + instance);
+    }
+};
+
+/*
+  learn routes to components of a few systems on the outgoing links
+ */
+static void learn_routes(MAVLink_routing *routing, GCS_MAVLINK_Benchmark **links, uint8_t num_links, uint16_t num_routes)
+{
+    mavlink_message_t msg;
+    for (uint16_t i = 0; i < num_routes; i++) {
+        const uint8_t sysid = 2 + i / 200;
+        const uint8_t compid = 1 + i % 200;
+        mavlink_msg_heartbeat_pack(sysid, compid, &msg, MAV_TYPE_GIMBAL, MAV_AUTOPILOT_INVALID, 0, 0, MAV_STATE_ACTIVE);
+        routing->check_and_forward(*links[1 + i % (num_links - 1)], msg);
+    }
+}
+
+/*
+  route a second of traffic at 10k msgs/s arriving on a single link,
+  targeted at components spread over the other links
+ */
+static void BM_RoutingCheckAndForward(benchmark::State &state)
+{
+    const uint16_t num_routes = state.range(0);
+    const uint8_t num_links = 4;
+
+    MAVLink_routing *routing = new MAVLink_routing();
+    GCS_MAVLINK_Parameters *params = new GCS_MAVLINK_Parameters();
+    GCS_MAVLINK_Benchmark *links[num_links];
+    for (uint8_t i = 0; i < num_links; i++) {
+        // GCS_MAVLINK leaves members to the zeroing operator new, as
+        // GCS::create_gcs_mavlink_backend() allocates links on the vehicle
+        links[i] = new GCS_MAVLINK_Benchmark(*params, *hal.serial(0), i);
+    }
+
+    learn_routes(routing, links, num_links, num_routes);
+
+    // commands from a GCS on the first link to each of the components in turn
+    mavlink_message_t *commands = new mavlink_message_t[num_routes];
+    for (uint16_t i = 0; i < num_routes; i++) {
+        mavlink_msg_command_long_pack(255, MAV_COMP_ID_MISSIONPLANNER, &commands[i],
+                                      2 + i / 200, 1 + i % 200,
+                                      MAV_CMD_REQUEST_MESSAGE, 0, 0, 0, 0, 0, 0, 0, 0);
+    }
+
+    while (state.KeepRunning()) {
+        // refresh the routes so they are not forgotten during long runs
+        state.PauseTiming();
+        learn_routes(routing, links, num_links, num_routes);
+        state.ResumeTiming();
+        for (uint16_t i = 0; i < MESSAGE_RATE; i++) {
+            gbenchmark_escape(routing);
+            routing->check_and_forward(*links[0], commands[i % num_routes]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * MESSAGE_RATE);
+
+    delete[] commands;
+    for (uint8_t i = 0; i < num_links; i++) {
+        delete links[i];
+    }
+    delete params;
+    delete routing;
+}
+
+// 20 routes was the old fixed table size
+BENCHMARK(BM_RoutingCheckAndForward)->Arg(5)->Arg(20)->Arg(100)->Arg(MAVLINK_MAX_ROUTES);
+
+BENCHMARK_MAIN();
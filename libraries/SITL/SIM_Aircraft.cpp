@@ -306,6 +306,22 @@ void Aircraft::sync_frame_time(void)
         last_frame_count = frame_counter;
         last_fps_report_ms = now_ms;
     }
+
+    // report the average rate over the interval so instances which
+    // can't keep up stand out when many share a host
+    const int16_t report_s = sitl != nullptr ? sitl->rate_report_s.get() : 0;
+    if (report_s <= 0 || last_rate_report_ms == 0) {
+        rate_report_frame_count = frame_counter;
+        last_rate_report_ms = now_ms;
+    } else if (now_ms - last_rate_report_ms >= uint32_t(report_s) * 1000U) {
+        const float report_rate_hz = (frame_counter - rate_report_frame_count) * 1000.0f / (now_ms - last_rate_report_ms);
+        ::printf("SIM%u: rate %.1f/%.1fHz speedup %.2f/%.2f\n",
+                 unsigned(instance),
+                 report_rate_hz, rate_hz*target_speedup,
+                 report_rate_hz/rate_hz, target_speedup);
+        rate_report_frame_count = frame_counter;
+        last_rate_report_ms = now_ms;
+    }
 }
 
 /* add noise based on throttle level (from 0..1) */
@@ -235,6 +235,8 @@ protected:
     float achieved_rate_hz;  // achieved speedup rate
     int64_t sleep_debt_us;
     uint32_t last_frame_count;
+    uint32_t last_rate_report_ms;
+    uint32_t rate_report_frame_count;
     uint8_t instance;
     const char *autotest_dir;
     const char *frame;
@@ -194,6 +194,13 @@ const AP_Param::GroupInfo SIM::var_info2[] = {
     AP_GROUPINFO("TEMP_TCONST",  3, SIM,  temp_tconst, 30),
     AP_GROUPINFO("TEMP_BFACTOR", 4, SIM,  temp_baro_factor, 0),
 
+    // @Param: RATE_RPT
+    // @DisplayName: Simulation rate report interval
+    // @Description: If non-zero, the simulator prints its instance number with the target and achieved physics rate and speedup at this interval of wall-clock time. When running many instances on one host this shows which are not keeping up.
+    // @Units: s
+    // @User: Advanced
+    AP_GROUPINFO("RATE_RPT",     6, SIM,  rate_report_s, 0),
+
     AP_GROUPINFO("WIND_DIR_Z",  10, SIM,  wind_dir_z,     0),
     // @Param: WIND_T_
     // @DisplayName: Wind Profile Type